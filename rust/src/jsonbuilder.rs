@@ -433,6 +433,54 @@ impl JsonBuilder {
         Ok(self)
     }
 
+    /// Set a key and a signed integer type on an object.
+    pub fn set_int(&mut self, key: &str, val: i64) -> Result<&mut Self, JsonError> {
+        match self.current_state() {
+            State::ObjectNth => {
+                self.buf.push(',');
+            }
+            State::ObjectFirst => {
+                self.set_state(State::ObjectNth);
+            }
+            _ => {
+                return Err(JsonError::InvalidState);
+            }
+        }
+        self.buf.push('"');
+        self.buf.push_str(key);
+        self.buf.push_str("\":");
+        self.buf.push_str(&val.to_string());
+        Ok(self)
+    }
+
+    /// Set a key and a floating point value on an object.
+    ///
+    /// JSON has no representation for NaN or infinity, so like jansson
+    /// these values are not logged.
+    pub fn set_float(&mut self, key: &str, val: f64) -> Result<&mut Self, JsonError> {
+        if !val.is_finite() {
+            return Ok(self);
+        }
+        match self.current_state() {
+            State::ObjectNth => {
+                self.buf.push(',');
+            }
+            State::ObjectFirst => {
+                self.set_state(State::ObjectNth);
+            }
+            _ => {
+                return Err(JsonError::InvalidState);
+            }
+        }
+        self.buf.push('"');
+        self.buf.push_str(key);
+        self.buf.push_str("\":");
+        // debug formatting keeps the fractional part of integral values
+        // ("1.0" rather than "1") so the value is read back as a real
+        self.buf.push_str(&format!("{:?}", val));
+        Ok(self)
+    }
+
     pub fn set_bool(&mut self, key: &str, val: bool) -> Result<&mut Self, JsonError> {
         match self.current_state() {
             State::ObjectNth => {
@@ -455,6 +503,25 @@ impl JsonBuilder {
         Ok(self)
     }
 
+    /// Set a key with a JSON null value.
+    pub fn set_null(&mut self, key: &str) -> Result<&mut Self, JsonError> {
+        match self.current_state() {
+            State::ObjectNth => {
+                self.buf.push(',');
+            }
+            State::ObjectFirst => {
+                self.set_state(State::ObjectNth);
+            }
+            _ => {
+                return Err(JsonError::InvalidState);
+            }
+        }
+        self.buf.push('"');
+        self.buf.push_str(key);
+        self.buf.push_str("\":null");
+        Ok(self)
+    }
+
     pub fn capacity(&self) -> usize {
         self.buf.capacity()
     }
@@ -605,6 +672,20 @@ pub unsafe extern "C" fn jb_set_string(
     return false;
 }
 
+#[no_mangle]
+pub unsafe extern "C" fn jb_set_string_from_bytes(
+    js: &mut JsonBuilder, key: *const c_char, bytes: *const u8, len: u32,
+) -> bool {
+    if bytes == std::ptr::null() {
+        return false;
+    }
+    if let Ok(key) = CStr::from_ptr(key).to_str() {
+        let val = std::slice::from_raw_parts(bytes, len as usize);
+        return js.set_string_from_bytes(key, val).is_ok();
+    }
+    return false;
+}
+
 #[no_mangle]
 pub unsafe extern "C" fn jb_set_jsont(
     jb: &mut JsonBuilder, key: *const c_char, jsont: &mut json::JsonT,
@@ -641,6 +722,17 @@ pub unsafe extern "C" fn jb_append_string(js: &mut JsonBuilder, val: *const c_ch
     return false;
 }
 
+#[no_mangle]
+pub unsafe extern "C" fn jb_append_string_from_bytes(
+    js: &mut JsonBuilder, bytes: *const u8, len: u32,
+) -> bool {
+    if bytes == std::ptr::null() {
+        return false;
+    }
+    let val = std::slice::from_raw_parts(bytes, len as usize);
+    return js.append_string_from_bytes(val).is_ok();
+}
+
 #[no_mangle]
 pub unsafe extern "C" fn jb_append_uint(js: &mut JsonBuilder, val: u64) -> bool {
     return js.append_uint(val).is_ok();
@@ -654,6 +746,22 @@ pub unsafe extern "C" fn jb_set_uint(js: &mut JsonBuilder, key: *const c_char, v
     return false;
 }
 
+#[no_mangle]
+pub unsafe extern "C" fn jb_set_int(js: &mut JsonBuilder, key: *const c_char, val: i64) -> bool {
+    if let Ok(key) = CStr::from_ptr(key).to_str() {
+        return js.set_int(key, val).is_ok();
+    }
+    return false;
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn jb_set_float(js: &mut JsonBuilder, key: *const c_char, val: f64) -> bool {
+    if let Ok(key) = CStr::from_ptr(key).to_str() {
+        return js.set_float(key, val).is_ok();
+    }
+    return false;
+}
+
 #[no_mangle]
 pub unsafe extern "C" fn jb_set_bool(js: &mut JsonBuilder, key: *const c_char, val: bool) -> bool {
     if let Ok(key) = CStr::from_ptr(key).to_str() {
@@ -662,6 +770,14 @@ pub unsafe extern "C" fn jb_set_bool(js: &mut JsonBuilder, key: *const c_char, v
     return false;
 }
 
+#[no_mangle]
+pub unsafe extern "C" fn jb_set_null(js: &mut JsonBuilder, key: *const c_char) -> bool {
+    if let Ok(key) = CStr::from_ptr(key).to_str() {
+        return js.set_null(key).is_ok();
+    }
+    return false;
+}
+
 #[no_mangle]
 pub unsafe extern "C" fn jb_close(js: &mut JsonBuilder) -> bool {
     js.close().is_ok()
@@ -709,6 +825,19 @@ mod test {
         assert_eq!(jb.buf, r#"{"first":false,"second":true"#);
     }
 
+    #[test]
+    fn test_set_null() {
+        let mut jb = JsonBuilder::new_object();
+        jb.set_null("first").unwrap();
+        jb.set_uint("second", 1).unwrap();
+        jb.set_null("third").unwrap();
+        jb.close().unwrap();
+        assert_eq!(jb.buf, r#"{"first":null,"second":1,"third":null}"#);
+
+        let mut jb = JsonBuilder::new_array();
+        assert!(jb.set_null("first").is_err());
+    }
+
     #[test]
     fn test_object_in_object() -> Result<(), JsonError> {
         let mut js = JsonBuilder::new_object();
@@ -929,6 +1058,17 @@ mod test {
         assert_eq!(jb.buf, r#"["\\xf0\\xf1\\xf2""#);
     }
 
+    #[test]
+    fn test_set_int_float() {
+        let mut jb = JsonBuilder::new_object();
+        jb.set_int("a", -1).unwrap();
+        jb.set_float("b", 1.0).unwrap();
+        jb.set_float("c", 0.5).unwrap();
+        jb.set_float("nan", std::f64::NAN).unwrap();
+        jb.close().unwrap();
+        assert_eq!(jb.buf, r#"{"a":-1,"b":1.0,"c":0.5}"#);
+    }
+
     #[test]
     fn test_marks() {
         let mut jb = JsonBuilder::new_object();
@@ -17,19 +17,25 @@
 
 // written by Clément Galland <clement.galland@epita.fr>
 
-use crate::json::*;
+use crate::jsonbuilder::{JsonBuilder, JsonError};
 use crate::tftp::tftp::*;
 
-#[no_mangle]
-pub extern "C" fn rs_tftp_log_json_request(tx: &mut TFTPTransaction) -> *mut JsonT
+fn tftp_log_request(tx: &mut TFTPTransaction, js: &mut JsonBuilder) -> Result<(), JsonError>
 {
-    let js = Json::object();
+    js.open_object("tftp")?;
     match tx.opcode {
-        1 => js.set_string("packet", "read"),
-        2 => js.set_string("packet", "write"),
-        _ => js.set_string("packet", "error")
+        1 => js.set_string("packet", "read")?,
+        2 => js.set_string("packet", "write")?,
+        _ => js.set_string("packet", "error")?
     };
-    js.set_string("file", tx.filename.as_str());
-    js.set_string("mode", tx.mode.as_str());
-    js.unwrap()
+    js.set_string("file", tx.filename.as_str())?;
+    js.set_string("mode", tx.mode.as_str())?;
+    js.close()?;
+    Ok(())
+}
+
+#[no_mangle]
+pub extern "C" fn rs_tftp_log_json_request(tx: &mut TFTPTransaction, js: &mut JsonBuilder) -> bool
+{
+    tftp_log_request(tx, js).is_ok()
 }
@@ -156,7 +156,7 @@ output_json_dnp3_objects_template = """/* Copyright (C) 2015 Open Information Se
 #include "app-layer-dnp3-objects.h"
 #include "output-json-dnp3-objects.h"
 
-void OutputJsonDNP3SetItem(json_t *js, DNP3Object *object,
+void OutputJsonDNP3SetItem(JsonBuilder *js, DNP3Object *object,
     DNP3Point *point)
 {
 
@@ -165,36 +165,26 @@ void OutputJsonDNP3SetItem(json_t *js, DNP3Object *object,
         case DNP3_OBJECT_CODE({{object.group}}, {{object.variation}}): {
             DNP3ObjectG{{object.group}}V{{object.variation}} *data = point->data;
 {% for field in object.fields %}
-{% if is_integer_type(field.type) %}
-            json_object_set_new(js, "{{field.name}}",
-                json_integer(data->{{field.name}}));
+{% if is_unsigned_type(field.type) %}
+            jb_set_uint(js, "{{field.name}}", data->{{field.name}});
+{% elif is_integer_type(field.type) %}
+            jb_set_int(js, "{{field.name}}", data->{{field.name}});
 {% elif field.type in ["flt32", "flt64"] %}
-            json_object_set_new(js, "{{field.name}}",
-                json_real(data->{{field.name}}));
+            jb_set_float(js, "{{field.name}}", data->{{field.name}});
 {% elif field.type == "bytearray" %}
             unsigned long {{field.name}}_b64_len = data->{{field.len_field}} * 2;
             uint8_t {{field.name}}_b64[{{field.name}}_b64_len];
             Base64Encode(data->{{field.name}}, data->{{field.len_field}},
                 {{field.name}}_b64, &{{field.name}}_b64_len);
-            json_object_set_new(js, "data->{{field.name}}",
-                json_string((char *){{field.name}}_b64));
+            jb_set_string(js, "data->{{field.name}}", (char *){{field.name}}_b64);
 {% elif field.type == "vstr4" %}
-            json_object_set_new(js, "data->{{field.name}}", json_string(data->{{field.name}}));
+            jb_set_string(js, "data->{{field.name}}", data->{{field.name}});
 {% elif field.type == "chararray" %}
-            if (data->{{field.len_field}} > 0) {
-                /* First create a null terminated string as not all versions
-                 * of jansson have json_stringn. */
-                char tmpbuf[data->{{field.len_field}} + 1];
-                memcpy(tmpbuf, data->{{field.name}}, data->{{field.len_field}});
-                tmpbuf[data->{{field.len_field}}] = '\\0';
-                json_object_set_new(js, "{{field.name}}", json_string(tmpbuf));
-            } else {
-                json_object_set_new(js, "{{field.name}}", json_string(""));
-            }
+            jb_set_string_from_bytes(js, "{{field.name}}", (const uint8_t *)data->{{field.name}},
+                data->{{field.len_field}});
 {% elif field.type == "bstr8" %}
 {% for field in field.fields %}
-            json_object_set_new(js, "{{field.name}}",
-                json_integer(data->{{field.name}}));
+            jb_set_uint(js, "{{field.name}}", data->{{field.name}});
 {% endfor %}
 {% else %}
 {{ raise("Unhandled datatype: %s" % (field.type)) }}
@@ -222,6 +212,17 @@ def has_freeable_types(fields):
             return True
     return False
 
+def is_unsigned_type(datatype):
+    unsigned_types = [
+        "uint64",
+        "uint32",
+        "uint24",
+        "uint16",
+        "uint8",
+        "dnp3time",
+    ]
+    return datatype in unsigned_types
+
 def is_integer_type(datatype):
     integer_types = [
         "uint64",
@@ -717,6 +718,7 @@ def main():
         "raise": raise_helper,
         "objects": definitions["objects"],
         "is_integer_type": is_integer_type,
+        "is_unsigned_type": is_unsigned_type,
         "f_to_type": to_type,
         "f_has_freeable_types": has_freeable_types,
         "command_line": " ".join(sys.argv),
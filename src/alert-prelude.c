@@ -51,6 +51,7 @@
 #include "util-debug.h"
 #include "util-error.h"
 #include "util-print.h"
+#include "util-byte.h"
 
 #include "output.h"
 #include "output-json.h"
@@ -714,6 +715,32 @@ static void PacketToDataProtoTLS(const Packet *p, const PacketAlert *pa, idmef_a
 
 }
 
+/**
+ * \brief Add the SSH banner of one side of the connection
+ * \param tx_ptr SSH transaction
+ * \param dir STREAM_TOSERVER for the client, STREAM_TOCLIENT for the server
+ * \param alert IDMEF alert
+ */
+static void PacketToDataProtoSSHDir(void *tx_ptr, uint8_t dir, idmef_alert_t *alert)
+{
+    const uint8_t *buf = NULL;
+    uint32_t len = 0;
+
+    if (rs_ssh_tx_get_protocol(tx_ptr, &buf, &len, dir) == 0)
+        return;
+
+    char proto_version[len * 2 + 1];
+    BytesToStringBuffer(buf, len, proto_version, sizeof(proto_version));
+    AddStringData(alert, "proto_version", proto_version);
+
+    if (rs_ssh_tx_get_software(tx_ptr, &buf, &len, dir) == 0)
+        return;
+
+    char software_version[len * 2 + 1];
+    BytesToStringBuffer(buf, len, software_version, sizeof(software_version));
+    AddStringData(alert, "software_version", software_version);
+}
+
 /**
  * \brief Handle ALPROTO_SSH JSON information
  * \param p Packet where to extract data
@@ -723,7 +750,6 @@ static void PacketToDataProtoTLS(const Packet *p, const PacketAlert *pa, idmef_a
  */
 static void PacketToDataProtoSSH(const Packet *p, const PacketAlert *pa, idmef_alert_t *alert)
 {
-    json_t *js, *s_js;
     void *ssh_state = FlowGetAppState(p->flow);
 
     if (ssh_state == NULL)
@@ -731,22 +757,10 @@ static void PacketToDataProtoSSH(const Packet *p, const PacketAlert *pa, idmef_a
 
     void *tx_ptr = rs_ssh_state_get_tx(ssh_state, 0);
     BUG_ON(tx_ptr == NULL);
-    js = rs_ssh_log_json(tx_ptr);
-    if (unlikely(js == NULL))
-        return;
-
-    s_js = json_object_get(js, "server");
-    if (s_js != NULL) {
-        JsonToAdditionalData(NULL, s_js, alert);
-    }
-
-    s_js = json_object_get(js, "client");
-    if (s_js != NULL) {
-        JsonToAdditionalData(NULL, s_js, alert);
-    }
-
-    json_decref(js);
 
+    /* server first, then client */
+    PacketToDataProtoSSHDir(tx_ptr, STREAM_TOCLIENT, alert);
+    PacketToDataProtoSSHDir(tx_ptr, STREAM_TOSERVER, alert);
 }
 
 /**
@@ -64,6 +64,11 @@
 
 #include "runmodes.h"
 
+#ifdef BUILD_HYPERSCAN
+#include "util-hyperscan.h"
+#include <hs.h>
+#endif
+
 typedef struct AppLayerProtoDetectProbingParserElement_ {
     AppProto alproto;
     /* \todo don't really need it.  See if you can get rid of it */
@@ -131,6 +136,13 @@ typedef struct AppLayerProtoDetectPMCtx_ {
     AppLayerProtoDetectPMSignature **map;
     AppLayerProtoDetectPMSignature *head;
 
+#ifdef BUILD_HYPERSCAN
+    /** Hyperscan database with one pattern per signature. Offset and
+     *  depth are part of the patterns, so a match from this database
+     *  needs no further verification. NULL if not used. */
+    hs_database_t *hs_db;
+#endif
+
     /* \todo we don't need this except at setup time.  Get rid of it. */
     PatIntId max_pat_id;
     SigIntId max_sig_id;
@@ -153,6 +165,11 @@ typedef struct AppLayerProtoDetectCtx_ {
     /* Global SPM thread context prototype. */
     SpmGlobalThreadCtx *spm_global_thread_ctx;
 
+#ifdef BUILD_HYPERSCAN
+    /* Scratch prototype for the Hyperscan databases, cloned per thread. */
+    hs_scratch_t *hs_scratch;
+#endif
+
     AppLayerProtoDetectProbingParser *ctx_pp;
 
     /* Indicates the protocols that have registered themselves
@@ -169,6 +186,9 @@ struct AppLayerProtoDetectThreadCtx_ {
     /* The value 2 is for direction(0 - toserver, 1 - toclient). */
     MpmThreadCtx mpm_tctx[FLOW_PROTO_DEFAULT][2];
     SpmThreadCtx *spm_thread_ctx;
+#ifdef BUILD_HYPERSCAN
+    hs_scratch_t *hs_scratch;
+#endif
 };
 
 /* The global app layer proto detection context. */
@@ -182,13 +202,14 @@ static void AppLayerProtoDetectPEGetIpprotos(AppProto alproto,
 /** \internal
  *  \brief Handle SPM search for Signature
  *  \param buflen full size of the input buffer
- *  \param searchlen pattern matching portion of buffer */
+ *  \param searchlen pattern matching portion of buffer
+ *  \param verified pattern, offset and depth were already matched */
 static AppProto AppLayerProtoDetectPMMatchSignature(
         const AppLayerProtoDetectPMSignature *s,
         AppLayerProtoDetectThreadCtx *tctx,
         Flow *f, uint8_t direction,
         const uint8_t *buf, uint16_t buflen, uint16_t searchlen,
-        bool *rflow)
+        const bool verified, bool *rflow)
 {
     SCEnter();
 
@@ -203,15 +224,17 @@ static AppProto AppLayerProtoDetectPMMatchSignature(
         SCReturnUInt(ALPROTO_UNKNOWN);
     }
 
-    const uint8_t *sbuf = buf + s->cd->offset;
-    uint16_t ssearchlen = s->cd->depth - s->cd->offset;
-    SCLogDebug("s->co->offset (%"PRIu16") s->cd->depth (%"PRIu16")",
-               s->cd->offset, s->cd->depth);
+    if (!verified) {
+        const uint8_t *sbuf = buf + s->cd->offset;
+        uint16_t ssearchlen = s->cd->depth - s->cd->offset;
+        SCLogDebug("s->co->offset (%"PRIu16") s->cd->depth (%"PRIu16")",
+                   s->cd->offset, s->cd->depth);
 
-    uint8_t *found = SpmScan(s->cd->spm_ctx, tctx->spm_thread_ctx,
-            sbuf, ssearchlen);
-    if (found == NULL) {
-        SCReturnUInt(ALPROTO_UNKNOWN);
+        uint8_t *found = SpmScan(s->cd->spm_ctx, tctx->spm_thread_ctx,
+                sbuf, ssearchlen);
+        if (found == NULL) {
+            SCReturnUInt(ALPROTO_UNKNOWN);
+        }
     }
 
     SCLogDebug("matching, s->direction %s, our dir %s",
@@ -254,6 +277,38 @@ static AppProto AppLayerProtoDetectPMMatchSignature(
     SCReturnUInt(s->alproto);
 }
 
+#ifdef BUILD_HYPERSCAN
+static int PMHSMatchEvent(unsigned int id, unsigned long long from,
+        unsigned long long to, unsigned int flags, void *ctx)
+{
+    PrefilterRuleStore *pmq = ctx;
+    SigIntId sid = (SigIntId)id;
+    PrefilterAddSids(pmq, &sid, 1);
+    return 0;
+}
+
+/** \internal
+ *  \brief scan the buffer with the Hyperscan database, adding the ids
+ *         of the matching signatures to the pmq
+ *  \retval cnt number of matching signatures */
+static uint32_t PMHSSearch(const AppLayerProtoDetectPMCtx *pm_ctx,
+        AppLayerProtoDetectThreadCtx *tctx, const uint8_t *buf, uint16_t buflen)
+{
+    if (unlikely(buflen == 0))
+        return 0;
+
+    hs_error_t err = hs_scan(pm_ctx->hs_db, (const char *)buf, buflen, 0,
+            tctx->hs_scratch, PMHSMatchEvent, &tctx->pmq);
+    if (err != HS_SUCCESS) {
+        /* only happens with an invalid database or scratch, which we
+         * can't recover from */
+        SCLogError(SC_ERR_FATAL, "Hyperscan returned error %d", err);
+        exit(EXIT_FAILURE);
+    }
+    return tctx->pmq.rule_id_array_cnt;
+}
+#endif
+
 /**
  *  \retval 0 no matches
  *  \retval -1 no matches, mpm depth reached
@@ -271,7 +326,15 @@ static inline int PMGetProtoInspect(
     SCLogDebug("searchlen %u buflen %u", searchlen, buflen);
 
     /* do the mpm search */
-    uint32_t search_cnt = mpm_table[pm_ctx->mpm_ctx.mpm_type].Search(
+    uint32_t search_cnt;
+    bool verified = false;
+#ifdef BUILD_HYPERSCAN
+    if (pm_ctx->hs_db != NULL) {
+        search_cnt = PMHSSearch(pm_ctx, tctx, buf, searchlen);
+        verified = true;
+    } else
+#endif
+    search_cnt = mpm_table[pm_ctx->mpm_ctx.mpm_type].Search(
             &pm_ctx->mpm_ctx, mpm_tctx, &tctx->pmq,
             buf, searchlen);
     if (search_cnt == 0) {
@@ -291,7 +354,7 @@ static inline int PMGetProtoInspect(
         const AppLayerProtoDetectPMSignature *s = pm_ctx->map[tctx->pmq.rule_id_array[cnt]];
         while (s != NULL) {
             AppProto proto = AppLayerProtoDetectPMMatchSignature(s,
-                    tctx, f, direction, buf, buflen, searchlen, rflow);
+                    tctx, f, direction, buf, buflen, searchlen, verified, rflow);
 
             /* store each unique proto once */
             if (AppProtoIsValid(proto) &&
@@ -1395,6 +1458,92 @@ static int AppLayerProtoDetectPMPrepareMpm(AppLayerProtoDetectPMCtx *ctx)
     SCReturnInt(ret);
 }
 
+#ifdef BUILD_HYPERSCAN
+/** \internal
+ *  \brief build a Hyperscan database for the signatures of a ctx
+ *
+ *  Unlike the mpm, that dedups patterns and treats depth as relative to
+ *  the offset, each signature gets its own expression with the exact
+ *  offset and depth, so a match is a signature match.
+ *
+ *  \retval 0 on success, or when the database couldn't be built and the
+ *            mpm is used instead
+ */
+static int AppLayerProtoDetectPMPrepareHS(AppLayerProtoDetectPMCtx *ctx)
+{
+    SCEnter();
+
+    int ret = 0;
+    const uint32_t cnt = ctx->max_sig_id;
+    hs_compile_error_t *compile_err = NULL;
+
+    char **expressions = SCCalloc(cnt, sizeof(char *));
+    unsigned int *flags = SCCalloc(cnt, sizeof(unsigned int));
+    unsigned int *ids = SCCalloc(cnt, sizeof(unsigned int));
+    hs_expr_ext_t *ext = SCCalloc(cnt, sizeof(hs_expr_ext_t));
+    const hs_expr_ext_t **extp = SCCalloc(cnt, sizeof(hs_expr_ext_t *));
+    if (expressions == NULL || flags == NULL || ids == NULL ||
+            ext == NULL || extp == NULL)
+        goto error;
+
+    for (uint32_t i = 0; i < cnt; i++) {
+        const AppLayerProtoDetectPMSignature *s = ctx->map[i];
+        const DetectContentData *cd = s->cd;
+
+        expressions[i] = HSRenderPattern(cd->content, cd->content_len);
+        if (expressions[i] == NULL)
+            goto error;
+        ids[i] = s->id;
+        flags[i] = HS_FLAG_SINGLEMATCH;
+        if (cd->flags & DETECT_CONTENT_NOCASE)
+            flags[i] |= HS_FLAG_CASELESS;
+
+        /* offsets are for the end of the match */
+        ext[i].flags = HS_EXT_FLAG_MAX_OFFSET;
+        ext[i].max_offset = cd->depth;
+        if (cd->offset) {
+            ext[i].flags |= HS_EXT_FLAG_MIN_OFFSET;
+            ext[i].min_offset = cd->offset + cd->content_len;
+        }
+        extp[i] = &ext[i];
+    }
+
+    hs_error_t err = hs_compile_ext_multi((const char *const *)expressions,
+            flags, ids, extp, cnt, HS_MODE_BLOCK, NULL, &ctx->hs_db,
+            &compile_err);
+    if (err != HS_SUCCESS) {
+        SCLogWarning(SC_ERR_INITIALIZATION, "failed to compile hyperscan "
+                "database for protocol detection: %s, using mpm",
+                compile_err ? compile_err->message : "unknown error");
+        hs_free_compile_error(compile_err);
+        ctx->hs_db = NULL;
+        goto end;
+    }
+
+    err = hs_alloc_scratch(ctx->hs_db, &alpd_ctx.hs_scratch);
+    if (err != HS_SUCCESS) {
+        SCLogError(SC_ERR_INITIALIZATION, "failed to allocate hyperscan scratch");
+        goto error;
+    }
+    SCLogDebug("built hyperscan database for %u signatures", cnt);
+    goto end;
+ error:
+    ret = -1;
+ end:
+    if (expressions != NULL) {
+        for (uint32_t i = 0; i < cnt; i++) {
+            SCFree(expressions[i]);
+        }
+        SCFree(expressions);
+    }
+    SCFree(flags);
+    SCFree(ids);
+    SCFree(ext);
+    SCFree(extp);
+    SCReturnInt(ret);
+}
+#endif
+
 static void AppLayerProtoDetectPMFreeSignature(AppLayerProtoDetectPMSignature *sig)
 {
     SCEnter();
@@ -1586,6 +1735,11 @@ int AppLayerProtoDetectPrepareState(void)
                 goto error;
             if (AppLayerProtoDetectPMPrepareMpm(ctx_pm) < 0)
                 goto error;
+#ifdef BUILD_HYPERSCAN
+            if (ctx_pm->mpm_ctx.mpm_type == MPM_HS &&
+                    AppLayerProtoDetectPMPrepareHS(ctx_pm) < 0)
+                goto error;
+#endif
         }
     }
 
@@ -1807,6 +1961,12 @@ int AppLayerProtoDetectDeSetup(void)
         for (dir = 0; dir < 2; dir++) {
             pm_ctx = &alpd_ctx.ctx_ipp[ipproto_map].ctx_pm[dir];
             mpm_table[pm_ctx->mpm_ctx.mpm_type].DestroyCtx(&pm_ctx->mpm_ctx);
+#ifdef BUILD_HYPERSCAN
+            if (pm_ctx->hs_db != NULL) {
+                hs_free_database(pm_ctx->hs_db);
+                pm_ctx->hs_db = NULL;
+            }
+#endif
             for (id = 0; id < pm_ctx->max_sig_id; id++) {
                 sig = pm_ctx->map[id];
                 AppLayerProtoDetectPMFreeSignature(sig);
@@ -1817,6 +1977,12 @@ int AppLayerProtoDetectDeSetup(void)
     }
 
     SpmDestroyGlobalThreadCtx(alpd_ctx.spm_global_thread_ctx);
+#ifdef BUILD_HYPERSCAN
+    if (alpd_ctx.hs_scratch != NULL) {
+        hs_free_scratch(alpd_ctx.hs_scratch);
+        alpd_ctx.hs_scratch = NULL;
+    }
+#endif
 
     AppLayerProtoDetectFreeProbingParsers(alpd_ctx.ctx_pp);
 
@@ -1997,6 +2163,15 @@ AppLayerProtoDetectThreadCtx *AppLayerProtoDetectGetCtxThread(void)
         goto error;
     }
 
+#ifdef BUILD_HYPERSCAN
+    if (alpd_ctx.hs_scratch != NULL) {
+        if (hs_clone_scratch(alpd_ctx.hs_scratch, &alpd_tctx->hs_scratch) != HS_SUCCESS) {
+            SCLogError(SC_ERR_INITIALIZATION, "failed to clone hyperscan scratch");
+            goto error;
+        }
+    }
+#endif
+
     goto end;
  error:
     if (alpd_tctx != NULL)
@@ -2025,6 +2200,11 @@ void AppLayerProtoDetectDestroyCtxThread(AppLayerProtoDetectThreadCtx *alpd_tctx
     if (alpd_tctx->spm_thread_ctx != NULL) {
         SpmDestroyThreadCtx(alpd_tctx->spm_thread_ctx);
     }
+#ifdef BUILD_HYPERSCAN
+    if (alpd_tctx->hs_scratch != NULL) {
+        hs_free_scratch(alpd_tctx->hs_scratch);
+    }
+#endif
     SCFree(alpd_tctx);
 
     SCReturn;
@@ -3615,6 +3795,52 @@ static int AppLayerProtoDetectTest19(void)
     return result;
 }
 
+/** \test pattern offset and depth are absolute, the pattern has to fit
+ *        in between them completely */
+static int AppLayerProtoDetectTest20(void)
+{
+    AppLayerProtoDetectUnittestCtxBackup();
+    AppLayerProtoDetectSetup();
+
+    AppProto pm_results[ALPROTO_MAX];
+    Flow f;
+    memset(&f, 0x00, sizeof(f));
+    f.protomap = FlowGetProtoMapping(IPPROTO_TCP);
+
+    AppLayerProtoDetectPMRegisterPatternCS(IPPROTO_TCP, ALPROTO_HTTP, "ABC", 6, 2, STREAM_TOSERVER);
+
+    AppLayerProtoDetectPrepareState();
+    AppLayerProtoDetectThreadCtx *alpd_tctx = AppLayerProtoDetectGetCtxThread();
+    FAIL_IF_NULL(alpd_tctx);
+#ifdef BUILD_HYPERSCAN
+    const AppLayerProtoDetectPMCtx *pm_ctx = &alpd_ctx.ctx_ipp[FLOW_PROTO_TCP].ctx_pm[0];
+    FAIL_IF(pm_ctx->mpm_ctx.mpm_type == MPM_HS && pm_ctx->hs_db == NULL);
+#endif
+
+    const uint8_t *bufs[] = {
+        (const uint8_t *)"xxABCxxx",
+        (const uint8_t *)"xxxABCxx",
+        (const uint8_t *)"xABCxxxx",
+        (const uint8_t *)"xxxxABCx",
+    };
+    const uint32_t expect[] = { 1, 1, 0, 0 };
+
+    for (int i = 0; i < 4; i++) {
+        bool rdir = false;
+        memset(pm_results, 0, sizeof(pm_results));
+        f.flags = 0;
+        uint32_t cnt = AppLayerProtoDetectPMGetProto(alpd_tctx,
+                &f, bufs[i], 8, STREAM_TOSERVER, pm_results, &rdir);
+        FAIL_IF(cnt != expect[i]);
+        FAIL_IF(cnt == 1 && pm_results[0] != ALPROTO_HTTP);
+    }
+
+    AppLayerProtoDetectDestroyCtxThread(alpd_tctx);
+    AppLayerProtoDetectDeSetup();
+    AppLayerProtoDetectUnittestCtxRestore();
+    PASS;
+}
+
 void AppLayerProtoDetectUnittestsRegister(void)
 {
     SCEnter();
@@ -3638,6 +3864,7 @@ void AppLayerProtoDetectUnittestsRegister(void)
     UtRegisterTest("AppLayerProtoDetectTest17", AppLayerProtoDetectTest17);
     UtRegisterTest("AppLayerProtoDetectTest18", AppLayerProtoDetectTest18);
     UtRegisterTest("AppLayerProtoDetectTest19", AppLayerProtoDetectTest19);
+    UtRegisterTest("AppLayerProtoDetectTest20", AppLayerProtoDetectTest20);
 
     SCReturn;
 }
@@ -0,0 +1,583 @@
+/* Copyright (C) 2020 Open Information Security Foundation
+ *
+ * You can copy, redistribute or modify this Program under the terms of
+ * the GNU General Public License version 2 as published by the Free
+ * Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * version 2 along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/**
+ * \file
+ *
+ * Immutable open addressing table for read-only datasets.
+ *
+ * Sets marked 'read-only' are loaded once into a single blob: a header,
+ * a power of 2 sized array of slots and the entries. A slot holds the hash
+ * of an entry and its offset, so a lookup probes the slots linearly and
+ * only touches an entry if the hash matches. Nothing in the blob changes
+ * after it is built, so lookups take no locks and no references.
+ *
+ * Unlike util-rohash, entries are variable size (string sets) and carry
+ * the reputation value, and no memory is allocated per entry while
+ * loading.
+ *
+ * The blob has no pointers, so it can be written to a file as is
+ * ('suricata --dataset-compile') and mapped read only at startup. Loading
+ * such a file costs a few header checks, and instances on the same host
+ * share its pages through the page cache. Entries are bounds checked on
+ * lookup rather than at load time, so a damaged file can't make us read
+ * outside of the mapping.
+ */
+
+#include "suricata-common.h"
+#include "datasets.h"
+#include "datasets-readonly.h"
+#include "util-debug.h"
+#include "util-hash-lookup3.h"
+#include "util-hugepage.h"
+#include "util-memcmp.h"
+#include "util-unittest.h"
+
+#define DATASET_RO_MAGIC        "SCDSRO\x00\x01"
+#define DATASET_RO_VERSION      2
+/** written in host byte order, files of another byte order are rejected */
+#define DATASET_RO_BYTE_ORDER   0x01020304U
+/** entries are aligned to this, the slots store offsets in these units */
+#define DATASET_RO_ALIGN        8
+
+typedef struct DatasetRoHeader_ {
+    uint8_t magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint32_t type;          /**< enum DatasetTypes */
+    uint32_t reserved;
+    uint64_t cnt;           /**< unique entries */
+    uint64_t slots;         /**< number of slots, power of 2 */
+    uint64_t data_size;     /**< size of the entries in bytes */
+    uint8_t pad[16];
+} DatasetRoHeader;
+
+/* the header is part of the file format, it can't have implicit padding */
+_Static_assert(sizeof(DatasetRoHeader) == 64, "DatasetRoHeader must be 64 bytes");
+
+typedef struct DatasetRoSlot_ {
+    uint32_t hash;
+    uint32_t offset;        /**< (offset / DATASET_RO_ALIGN) + 1, 0 if empty */
+} DatasetRoSlot;
+
+typedef struct DatasetRoEntry_ {
+    uint32_t len;
+    uint16_t rep;
+    uint16_t pad;
+    uint8_t data[];
+} DatasetRoEntry;
+
+struct DatasetRo_ {
+    const DatasetRoHeader *hdr;
+    const DatasetRoSlot *slots;
+    const uint8_t *data;
+    uint64_t data_size;
+    uint32_t mask;
+    void *mem;
+    size_t map_size;        /**< size of the file mapping, 0 if not mapped */
+};
+
+struct DatasetRoBuilder_ {
+    enum DatasetTypes type;
+    uint64_t cnt;
+    uint8_t *data;
+    uint64_t data_size;
+    uint64_t data_alloc;
+};
+
+static inline uint32_t DatasetRoHash(const uint8_t *data, const uint32_t data_len)
+{
+    return hashlittle_safe(data, data_len, 0);
+}
+
+static inline uint64_t DatasetRoEntrySize(const uint32_t data_len)
+{
+    uint64_t size = sizeof(DatasetRoEntry) + data_len;
+    return (size + DATASET_RO_ALIGN - 1) & ~((uint64_t)DATASET_RO_ALIGN - 1);
+}
+
+DatasetRoBuilder *DatasetRoBuilderNew(enum DatasetTypes type)
+{
+    DatasetRoBuilder *b = SCCalloc(1, sizeof(*b));
+    if (unlikely(b == NULL))
+        return NULL;
+    b->type = type;
+    return b;
+}
+
+void DatasetRoBuilderFree(DatasetRoBuilder *b)
+{
+    if (b == NULL)
+        return;
+    if (b->data != NULL)
+        SCFree(b->data);
+    SCFree(b);
+}
+
+/**
+ *  \brief queue an entry for the table
+ *
+ *  Duplicates are only detected when the table is built.
+ *
+ *  \retval 1 queued
+ *  \retval -1 error
+ *  \retval -2 data has the wrong size for the set type
+ */
+int DatasetRoBuilderAdd(DatasetRoBuilder *b, const uint8_t *data, const uint32_t data_len,
+        const DataRepType *rep)
+{
+    if (b == NULL)
+        return -1;
+
+    switch (b->type) {
+        case DATASET_TYPE_MD5:
+            if (data_len != 16)
+                return -2;
+            break;
+        case DATASET_TYPE_SHA256:
+            if (data_len != 32)
+                return -2;
+            break;
+        case DATASET_TYPE_STRING:
+            break;
+    }
+
+    const uint64_t size = DatasetRoEntrySize(data_len);
+    if (b->data_size + size > b->data_alloc) {
+        uint64_t alloc = b->data_alloc ? b->data_alloc * 2 : 65536;
+        while (alloc < b->data_size + size)
+            alloc *= 2;
+        uint8_t *ptr = SCRealloc(b->data, alloc);
+        if (unlikely(ptr == NULL))
+            return -1;
+        b->data = ptr;
+        b->data_alloc = alloc;
+    }
+
+    DatasetRoEntry *e = (DatasetRoEntry *)(b->data + b->data_size);
+    memset(e, 0, size);
+    e->len = data_len;
+    e->rep = rep ? rep->value : 0;
+    memcpy(e->data, data, data_len);
+    b->data_size += size;
+    b->cnt++;
+    return 1;
+}
+
+static inline const DatasetRoEntry *DatasetRoSlotEntry(const uint8_t *data,
+        const DatasetRoSlot *s)
+{
+    return (const DatasetRoEntry *)(data + (uint64_t)(s->offset - 1) * DATASET_RO_ALIGN);
+}
+
+/**
+ *  \brief build the table from the queued entries and free the builder
+ *
+ *  If an entry was added more than once, the first one is kept.
+ *
+ *  \retval ro the table or NULL on error
+ */
+DatasetRo *DatasetRoBuild(DatasetRoBuilder *b)
+{
+    DatasetRo *ro = NULL;
+
+    if (b == NULL)
+        return NULL;
+    if (b->data_size / DATASET_RO_ALIGN >= UINT32_MAX) {
+        SCLogError(SC_ERR_DATASET, "read-only dataset too large: %"PRIu64" bytes",
+                b->data_size);
+        goto error;
+    }
+
+    /* keep the load factor at or below 3/4 */
+    uint64_t slots = 16;
+    while (slots * 3 < b->cnt * 4)
+        slots *= 2;
+    if (slots > ((uint64_t)1 << 32)) {
+        SCLogError(SC_ERR_DATASET, "read-only dataset has too many entries: %"PRIu64,
+                b->cnt);
+        goto error;
+    }
+
+    ro = SCCalloc(1, sizeof(*ro));
+    if (unlikely(ro == NULL))
+        goto error;
+
+    const size_t size = sizeof(DatasetRoHeader) + slots * sizeof(DatasetRoSlot) + b->data_size;
+    uint8_t *mem = HugePageAlloc(size);
+    if (unlikely(mem == NULL))
+        goto error;
+
+    DatasetRoHeader *hdr = (DatasetRoHeader *)mem;
+    DatasetRoSlot *tbl = (DatasetRoSlot *)(mem + sizeof(DatasetRoHeader));
+    uint8_t *data = mem + sizeof(DatasetRoHeader) + slots * sizeof(DatasetRoSlot);
+    if (b->data_size > 0)
+        memcpy(data, b->data, b->data_size);
+
+    const uint32_t mask = (uint32_t)(slots - 1);
+    uint64_t cnt = 0;
+    uint64_t offset = 0;
+    while (offset < b->data_size) {
+        const DatasetRoEntry *e = (const DatasetRoEntry *)(data + offset);
+        const uint32_t hash = DatasetRoHash(e->data, e->len);
+
+        uint32_t i = hash & mask;
+        for ( ; tbl[i].offset != 0; i = (i + 1) & mask) {
+            if (tbl[i].hash == hash) {
+                const DatasetRoEntry *o = DatasetRoSlotEntry(data, &tbl[i]);
+                if (o->len == e->len && SCMemcmp(o->data, e->data, e->len) == 0)
+                    break;
+            }
+        }
+        if (tbl[i].offset == 0) {
+            tbl[i].hash = hash;
+            tbl[i].offset = (uint32_t)(offset / DATASET_RO_ALIGN) + 1;
+            cnt++;
+        }
+        offset += DatasetRoEntrySize(e->len);
+    }
+
+    memset(hdr, 0, sizeof(*hdr));
+    memcpy(hdr->magic, DATASET_RO_MAGIC, sizeof(hdr->magic));
+    hdr->version = DATASET_RO_VERSION;
+    hdr->byte_order = DATASET_RO_BYTE_ORDER;
+    hdr->type = b->type;
+    hdr->cnt = cnt;
+    hdr->slots = slots;
+    hdr->data_size = b->data_size;
+
+    ro->mem = mem;
+    ro->hdr = hdr;
+    ro->slots = tbl;
+    ro->data = data;
+    ro->data_size = b->data_size;
+    ro->mask = mask;
+
+    SCLogDebug("built read-only dataset: %"PRIu64" entries, %"PRIu64" slots, "
+            "%"PRIuMAX" bytes", cnt, slots, (uintmax_t)size);
+    DatasetRoBuilderFree(b);
+    return ro;
+
+error:
+    if (ro != NULL)
+        SCFree(ro);
+    DatasetRoBuilderFree(b);
+    return NULL;
+}
+
+void DatasetRoFree(DatasetRo *ro)
+{
+    if (ro == NULL)
+        return;
+    if (ro->map_size > 0) {
+        munmap(ro->mem, ro->map_size);
+    } else {
+        HugePageFree(ro->mem);
+    }
+    SCFree(ro);
+}
+
+static size_t DatasetRoSize(const DatasetRoHeader *hdr)
+{
+    return sizeof(DatasetRoHeader) + hdr->slots * sizeof(DatasetRoSlot) + hdr->data_size;
+}
+
+/**
+ *  \brief check if a file is a compiled dataset
+ *
+ *  \retval 1 compiled dataset
+ *  \retval 0 something else, or can't be read
+ */
+int DatasetRoIsCompiled(const char *path)
+{
+    uint8_t magic[8];
+
+    FILE *fp = fopen(path, "r");
+    if (fp == NULL)
+        return 0;
+    size_t r = fread(magic, 1, sizeof(magic), fp);
+    fclose(fp);
+    return (r == sizeof(magic) && memcmp(magic, DATASET_RO_MAGIC, sizeof(magic)) == 0);
+}
+
+/**
+ *  \brief write the table to a file
+ *
+ *  The data goes to a temporary file first that is then renamed, so that
+ *  running instances keep their mapping of the old file.
+ *
+ *  \retval 0 ok
+ *  \retval -1 error
+ */
+int DatasetRoSave(const DatasetRo *ro, const char *path)
+{
+    char tmp[PATH_MAX];
+    if (snprintf(tmp, sizeof(tmp), "%s.tmp", path) >= (int)sizeof(tmp))
+        return -1;
+
+    FILE *fp = fopen(tmp, "w");
+    if (fp == NULL) {
+        SCLogError(SC_ERR_DATASET, "fopen '%s' failed: %s", tmp, strerror(errno));
+        return -1;
+    }
+    const size_t size = DatasetRoSize(ro->hdr);
+    if (fwrite(ro->hdr, 1, size, fp) != size) {
+        SCLogError(SC_ERR_DATASET, "writing '%s' failed: %s", tmp, strerror(errno));
+        fclose(fp);
+        unlink(tmp);
+        return -1;
+    }
+    if (fclose(fp) != 0 || rename(tmp, path) != 0) {
+        SCLogError(SC_ERR_DATASET, "storing '%s' failed: %s", path, strerror(errno));
+        unlink(tmp);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ *  \brief map a compiled dataset file
+ *
+ *  \param type type the set is declared with, the file has to match it
+ *
+ *  \retval ro the table or NULL on error
+ */
+DatasetRo *DatasetRoMap(const char *path, enum DatasetTypes type)
+{
+    DatasetRo *ro = NULL;
+    void *mem = MAP_FAILED;
+    struct stat st;
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        SCLogError(SC_ERR_DATASET, "open '%s' failed: %s", path, strerror(errno));
+        return NULL;
+    }
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(DatasetRoHeader)) {
+        SCLogError(SC_ERR_DATASET, "'%s' is not a compiled dataset", path);
+        goto error;
+    }
+
+    mem = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    if (mem == MAP_FAILED) {
+        SCLogError(SC_ERR_DATASET, "mmap '%s' failed: %s", path, strerror(errno));
+        goto error;
+    }
+
+    const DatasetRoHeader *hdr = mem;
+    if (memcmp(hdr->magic, DATASET_RO_MAGIC, sizeof(hdr->magic)) != 0 ||
+            hdr->version != DATASET_RO_VERSION ||
+            hdr->byte_order != DATASET_RO_BYTE_ORDER) {
+        SCLogError(SC_ERR_DATASET, "'%s' is not a compiled dataset of a version "
+                "and byte order this build supports", path);
+        goto error;
+    }
+    if (hdr->type != (uint32_t)type) {
+        SCLogError(SC_ERR_DATASET, "'%s' holds a dataset of another type", path);
+        goto error;
+    }
+    if (hdr->slots < 16 || hdr->slots > ((uint64_t)1 << 32) ||
+            (hdr->slots & (hdr->slots - 1)) != 0 || hdr->cnt >= hdr->slots ||
+            hdr->data_size > (uint64_t)st.st_size ||
+            DatasetRoSize(hdr) != (uint64_t)st.st_size) {
+        SCLogError(SC_ERR_DATASET, "compiled dataset '%s' is damaged", path);
+        goto error;
+    }
+
+    ro = SCCalloc(1, sizeof(*ro));
+    if (unlikely(ro == NULL))
+        goto error;
+    ro->mem = mem;
+    ro->map_size = (size_t)st.st_size;
+    ro->hdr = hdr;
+    ro->slots = (const DatasetRoSlot *)((const uint8_t *)mem + sizeof(DatasetRoHeader));
+    ro->data = (const uint8_t *)ro->slots + hdr->slots * sizeof(DatasetRoSlot);
+    ro->data_size = hdr->data_size;
+    ro->mask = (uint32_t)(hdr->slots - 1);
+    close(fd);
+    return ro;
+
+error:
+    if (mem != MAP_FAILED)
+        munmap(mem, (size_t)st.st_size);
+    close(fd);
+    return NULL;
+}
+
+uint64_t DatasetRoCount(const DatasetRo *ro)
+{
+    return ro ? ro->hdr->cnt : 0;
+}
+
+/**
+ *  \brief look up data in the table, without locking
+ *
+ *  \param rep if not NULL, set to the reputation value of the entry
+ *
+ *  \retval 1 found
+ *  \retval 0 not found
+ */
+int DatasetRoLookup(const DatasetRo *ro, const uint8_t *data, const uint32_t data_len,
+        DataRepType *rep)
+{
+    if (ro == NULL)
+        return 0;
+
+    const uint32_t hash = DatasetRoHash(data, data_len);
+    uint32_t i = hash & ro->mask;
+    /* a mapped file is not trusted to have an empty slot */
+    for (uint64_t n = 0; n <= ro->mask; n++, i = (i + 1) & ro->mask) {
+        const DatasetRoSlot *s = &ro->slots[i];
+        if (s->offset == 0)
+            return 0;
+        if (s->hash != hash)
+            continue;
+
+        const uint64_t offset = (uint64_t)(s->offset - 1) * DATASET_RO_ALIGN;
+        if (unlikely(offset + sizeof(DatasetRoEntry) + data_len > ro->data_size))
+            continue;
+        const DatasetRoEntry *e = DatasetRoSlotEntry(ro->data, s);
+        if (e->len == data_len && SCMemcmp(e->data, data, data_len) == 0) {
+            if (rep != NULL)
+                rep->value = e->rep;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+#ifdef UNITTESTS
+static int DatasetRoTest01(void)
+{
+    DatasetRoBuilder *b = DatasetRoBuilderNew(DATASET_TYPE_STRING);
+    FAIL_IF_NULL(b);
+
+    char str[32];
+    for (int i = 0; i < 1000; i++) {
+        DataRepType rep = { .value = (uint16_t)i };
+        snprintf(str, sizeof(str), "entry-%d", i);
+        FAIL_IF(DatasetRoBuilderAdd(b, (const uint8_t *)str, strlen(str), &rep) != 1);
+    }
+    /* duplicate, first one is kept */
+    DataRepType dup = { .value = 12345 };
+    FAIL_IF(DatasetRoBuilderAdd(b, (const uint8_t *)"entry-7", 7, &dup) != 1);
+    /* empty string */
+    FAIL_IF(DatasetRoBuilderAdd(b, (const uint8_t *)"", 0, NULL) != 1);
+
+    DatasetRo *ro = DatasetRoBuild(b);
+    FAIL_IF_NULL(ro);
+    FAIL_IF(DatasetRoCount(ro) != 1001);
+
+    for (int i = 0; i < 1000; i++) {
+        DataRepType rep = { .value = 0 };
+        snprintf(str, sizeof(str), "entry-%d", i);
+        FAIL_IF(DatasetRoLookup(ro, (const uint8_t *)str, strlen(str), &rep) != 1);
+        FAIL_IF(rep.value != i);
+    }
+    FAIL_IF(DatasetRoLookup(ro, (const uint8_t *)"", 0, NULL) != 1);
+    FAIL_IF(DatasetRoLookup(ro, (const uint8_t *)"entry-1000", 10, NULL) != 0);
+    FAIL_IF(DatasetRoLookup(ro, (const uint8_t *)"entry-", 6, NULL) != 0);
+
+    DatasetRoFree(ro);
+    PASS;
+}
+
+static int DatasetRoTest02(void)
+{
+    uint8_t sha[32] = { 0 };
+
+    DatasetRoBuilder *b = DatasetRoBuilderNew(DATASET_TYPE_SHA256);
+    FAIL_IF_NULL(b);
+    FAIL_IF(DatasetRoBuilderAdd(b, sha, 16, NULL) != -2);
+    FAIL_IF(DatasetRoBuilderAdd(b, sha, 32, NULL) != 1);
+
+    DatasetRo *ro = DatasetRoBuild(b);
+    FAIL_IF_NULL(ro);
+    FAIL_IF(DatasetRoLookup(ro, sha, 32, NULL) != 1);
+    sha[31] = 1;
+    FAIL_IF(DatasetRoLookup(ro, sha, 32, NULL) != 0);
+    DatasetRoFree(ro);
+
+    /* empty set */
+    ro = DatasetRoBuild(DatasetRoBuilderNew(DATASET_TYPE_MD5));
+    FAIL_IF_NULL(ro);
+    FAIL_IF(DatasetRoCount(ro) != 0);
+    FAIL_IF(DatasetRoLookup(ro, sha, 16, NULL) != 0);
+    DatasetRoFree(ro);
+    PASS;
+}
+
+/** \test save, map and reject damaged files */
+static int DatasetRoTest03(void)
+{
+    char path[] = "/tmp/suricata-dsro-XXXXXX";
+    int fd = mkstemp(path);
+    FAIL_IF(fd < 0);
+    close(fd);
+
+    DatasetRoBuilder *b = DatasetRoBuilderNew(DATASET_TYPE_STRING);
+    FAIL_IF_NULL(b);
+    char str[32];
+    for (int i = 0; i < 100; i++) {
+        DataRepType rep = { .value = (uint16_t)i };
+        snprintf(str, sizeof(str), "entry-%d", i);
+        FAIL_IF(DatasetRoBuilderAdd(b, (const uint8_t *)str, strlen(str), &rep) != 1);
+    }
+    DatasetRo *ro = DatasetRoBuild(b);
+    FAIL_IF_NULL(ro);
+    FAIL_IF(DatasetRoSave(ro, path) != 0);
+    DatasetRoFree(ro);
+
+    FAIL_IF(DatasetRoIsCompiled(path) != 1);
+    FAIL_IF_NOT_NULL(DatasetRoMap(path, DATASET_TYPE_MD5));
+    ro = DatasetRoMap(path, DATASET_TYPE_STRING);
+    FAIL_IF_NULL(ro);
+    FAIL_IF(DatasetRoCount(ro) != 100);
+    for (int i = 0; i < 100; i++) {
+        DataRepType rep = { .value = 0 };
+        snprintf(str, sizeof(str), "entry-%d", i);
+        FAIL_IF(DatasetRoLookup(ro, (const uint8_t *)str, strlen(str), &rep) != 1);
+        FAIL_IF(rep.value != i);
+    }
+    FAIL_IF(DatasetRoLookup(ro, (const uint8_t *)"entry-100", 9, NULL) != 0);
+    DatasetRoFree(ro);
+
+    /* truncated file */
+    FAIL_IF(truncate(path, sizeof(DatasetRoHeader) + 8) != 0);
+    FAIL_IF_NOT_NULL(DatasetRoMap(path, DATASET_TYPE_STRING));
+
+    /* text file */
+    FILE *fp = fopen(path, "w");
+    FAIL_IF_NULL(fp);
+    fputs("ZW50cnktMQ==\n", fp);
+    fclose(fp);
+    FAIL_IF(DatasetRoIsCompiled(path) != 0);
+    FAIL_IF_NOT_NULL(DatasetRoMap(path, DATASET_TYPE_STRING));
+
+    unlink(path);
+    PASS;
+}
+#endif /* UNITTESTS */
+
+void DatasetRoRegisterTests(void)
+{
+#ifdef UNITTESTS
+    UtRegisterTest("DatasetRoTest01", DatasetRoTest01);
+    UtRegisterTest("DatasetRoTest02", DatasetRoTest02);
+    UtRegisterTest("DatasetRoTest03", DatasetRoTest03);
+#endif
+}
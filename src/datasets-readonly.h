@@ -0,0 +1,50 @@
+/* Copyright (C) 2020 Open Information Security Foundation
+ *
+ * You can copy, redistribute or modify this Program under the terms of
+ * the GNU General Public License version 2 as published by the Free
+ * Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * version 2 along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/**
+ * \file
+ *
+ * Immutable open addressing table for read-only datasets.
+ */
+
+#ifndef __DATASETS_READONLY_H__
+#define __DATASETS_READONLY_H__
+
+#include "datasets.h"
+#include "datasets-reputation.h"
+
+typedef struct DatasetRo_ DatasetRo;
+typedef struct DatasetRoBuilder_ DatasetRoBuilder;
+
+DatasetRoBuilder *DatasetRoBuilderNew(enum DatasetTypes type);
+int DatasetRoBuilderAdd(DatasetRoBuilder *b, const uint8_t *data, const uint32_t data_len,
+        const DataRepType *rep);
+void DatasetRoBuilderFree(DatasetRoBuilder *b);
+DatasetRo *DatasetRoBuild(DatasetRoBuilder *b);
+
+void DatasetRoFree(DatasetRo *ro);
+uint64_t DatasetRoCount(const DatasetRo *ro);
+int DatasetRoLookup(const DatasetRo *ro, const uint8_t *data, const uint32_t data_len,
+        DataRepType *rep);
+
+int DatasetRoIsCompiled(const char *path);
+int DatasetRoSave(const DatasetRo *ro, const char *path);
+DatasetRo *DatasetRoMap(const char *path, enum DatasetTypes type);
+
+void DatasetRoRegisterTests(void);
+
+#endif /* __DATASETS_READONLY_H__ */
@@ -28,6 +28,7 @@
 #include "datasets-md5.h"
 #include "datasets-sha256.h"
 #include "datasets-reputation.h"
+#include "datasets-readonly.h"
 #include "util-thash.h"
 #include "util-print.h"
 #include "util-crypt.h"     // encode base64
@@ -39,6 +40,14 @@ static Dataset *sets = NULL;
 static uint32_t set_ids = 0;
 static bool experimental_warning = false;
 
+/** read-only tables replaced on a reload, freed once the detect threads
+ *  moved to the new detect engine */
+typedef struct DatasetRoRetired_ {
+    DatasetRo *ro;
+    struct DatasetRoRetired_ *next;
+} DatasetRoRetired;
+static DatasetRoRetired *ro_retired = NULL;
+
 static int DatasetAddwRep(Dataset *set, const uint8_t *data, const uint32_t data_len,
         DataRepType *rep);
 
@@ -361,6 +370,125 @@ static int DatasetLoadString(Dataset *set)
     return 0;
 }
 
+/**
+ *  \brief load a read-only set into a new table
+ *
+ *  A compiled file is mapped as is. Otherwise the regular loaders are
+ *  used, with DatasetAdd() and DatasetAddwRep() feeding the table builder
+ *  instead of the hash.
+ *
+ *  \retval ro the table or NULL on error
+ */
+static DatasetRo *DatasetLoadReadOnly(Dataset *set)
+{
+    struct stat st;
+    if (stat(set->load, &st) != 0) {
+        SCLogError(SC_ERR_DATASET, "dataset %s: stat '%s' failed: %s",
+                set->name, set->load, strerror(errno));
+        return NULL;
+    }
+
+    if (DatasetRoIsCompiled(set->load)) {
+        DatasetRo *ro = DatasetRoMap(set->load, set->type);
+        if (ro == NULL)
+            return NULL;
+        set->load_mtime = st.st_mtime;
+        set->load_size = st.st_size;
+        SCLogConfig("dataset: %s mapped from compiled file '%s', %"PRIu64" unique records",
+                set->name, set->load, DatasetRoCount(ro));
+        return ro;
+    }
+
+    set->ro_builder = DatasetRoBuilderNew(set->type);
+    if (set->ro_builder == NULL)
+        return NULL;
+
+    int r = -1;
+    switch (set->type) {
+        case DATASET_TYPE_MD5:
+            r = DatasetLoadMd5(set);
+            break;
+        case DATASET_TYPE_STRING:
+            r = DatasetLoadString(set);
+            break;
+        case DATASET_TYPE_SHA256:
+            r = DatasetLoadSha256(set);
+            break;
+    }
+    DatasetRoBuilder *b = set->ro_builder;
+    set->ro_builder = NULL;
+    if (r < 0) {
+        DatasetRoBuilderFree(b);
+        return NULL;
+    }
+
+    DatasetRo *ro = DatasetRoBuild(b);
+    if (ro == NULL)
+        return NULL;
+
+    set->load_mtime = st.st_mtime;
+    set->load_size = st.st_size;
+    SCLogConfig("dataset: %s is read-only, %"PRIu64" unique records",
+            set->name, DatasetRoCount(ro));
+    return ro;
+}
+
+/**
+ *  \brief reload a read-only set if its file changed since it was loaded
+ *
+ *  Called with sets_lock held when a rule load finds the existing set.
+ *  Lookups switch to the new table right away. The old one is freed by
+ *  DatasetsReloadComplete().
+ */
+static void DatasetReloadReadOnly(Dataset *set)
+{
+    struct stat st;
+    if (stat(set->load, &st) != 0 ||
+            (st.st_mtime == set->load_mtime && st.st_size == set->load_size))
+        return;
+
+    SCLogConfig("dataset: %s changed on disk, reloading", set->name);
+    DatasetRo *ro = DatasetLoadReadOnly(set);
+    if (ro == NULL) {
+        SCLogWarning(SC_ERR_DATASET, "dataset: %s reload failed, "
+                "keeping current data", set->name);
+        return;
+    }
+
+    DatasetRoRetired *r = SCCalloc(1, sizeof(*r));
+    if (unlikely(r == NULL)) {
+        /* can't free the old table safely, so don't swap */
+        DatasetRoFree(ro);
+        return;
+    }
+    r->ro = SC_ATOMIC_GET(set->ro);
+    r->next = ro_retired;
+    ro_retired = r;
+    SC_ATOMIC_SET(set->ro, ro);
+}
+
+static void DatasetFreeRetired(void)
+{
+    while (ro_retired != NULL) {
+        DatasetRoRetired *next = ro_retired->next;
+        DatasetRoFree(ro_retired->ro);
+        SCFree(ro_retired);
+        ro_retired = next;
+    }
+}
+
+/** \brief free the read-only tables replaced during a reload
+ *
+ *  Called when all detect threads use the new detect engine, so none
+ *  of them can be in a lookup on an old table.
+ */
+void DatasetsReloadComplete(void)
+{
+    SCMutexLock(&sets_lock);
+    DatasetFreeRetired();
+    SCMutexUnlock(&sets_lock);
+}
+
 extern bool g_system;
 
 enum DatasetGetPathType {
@@ -415,8 +543,8 @@ Dataset *DatasetFind(const char *name, enum DatasetTypes type)
     return set;
 }
 
-Dataset *DatasetGet(const char *name, enum DatasetTypes type,
-        const char *save, const char *load)
+static Dataset *DatasetGetInternal(const char *name, enum DatasetTypes type,
+        const char *save, const char *load, bool read_only)
 {
     if (strlen(name) > DATASET_NAME_MAX_LEN) {
         return NULL;
@@ -458,6 +586,10 @@ Dataset *DatasetGet(const char *name, enum DatasetTypes type,
             }
         }
 
+        if (set->read_only) {
+            DatasetReloadReadOnly(set);
+        }
+
         SCMutexUnlock(&sets_lock);
         return set;
     } else {
@@ -483,6 +615,26 @@ Dataset *DatasetGet(const char *name, enum DatasetTypes type,
         SCLogDebug("set \'%s\' loading \'%s\' from \'%s\'", set->name, load, set->load);
     }
 
+    /* compiled files can only be used as read-only sets */
+    if (strlen(set->load) > 0 && DatasetRoIsCompiled(set->load)) {
+        if (strlen(set->save) > 0) {
+            SCLogError(SC_ERR_DATASET, "dataset %s: compiled file '%s' can't be "
+                    "used with 'save' or 'state'", set->name, set->load);
+            goto out_err;
+        }
+        read_only = true;
+    }
+
+    if (read_only) {
+        set->read_only = true;
+        SC_ATOMIC_INITPTR(set->ro);
+        DatasetRo *ro = DatasetLoadReadOnly(set);
+        if (ro == NULL)
+            goto out_err;
+        SC_ATOMIC_SET(set->ro, ro);
+        goto done;
+    }
+
     char cnf_name[128];
     snprintf(cnf_name, sizeof(cnf_name), "datasets.%s.hash", name);
 
@@ -513,6 +665,7 @@ Dataset *DatasetGet(const char *name, enum DatasetTypes type,
             break;
     }
 
+done:
     SCLogDebug("set %p/%s type %u save %s load %s",
             set, set->name, set->type, set->save, set->load);
 
@@ -532,6 +685,53 @@ out_err:
     return NULL;
 }
 
+Dataset *DatasetGet(const char *name, enum DatasetTypes type,
+        const char *save, const char *load)
+{
+    return DatasetGetInternal(name, type, save, load, false);
+}
+
+/**
+ *  \brief compile a dataset file for fast loading
+ *
+ *  Loads 'in' like a read-only set would be loaded and writes the
+ *  resulting table to 'out'. Used by 'suricata --dataset-compile'.
+ *
+ *  \param type set type: string, md5 or sha256
+ *
+ *  \retval 0 ok
+ *  \retval -1 error
+ */
+int DatasetCompile(const char *type, const char *in, const char *out)
+{
+    enum DatasetTypes t = DatasetGetTypeFromString(type);
+    if (t == DATASET_TYPE_NOTSET) {
+        SCLogError(SC_ERR_DATASET, "unknown dataset type '%s'", type);
+        return -1;
+    }
+
+    Dataset *set = SCCalloc(1, sizeof(*set));
+    if (unlikely(set == NULL))
+        return -1;
+    strlcpy(set->name, "compile", sizeof(set->name));
+    set->type = t;
+    set->read_only = true;
+    strlcpy(set->load, in, sizeof(set->load));
+
+    int r = -1;
+    DatasetRo *ro = DatasetLoadReadOnly(set);
+    if (ro != NULL) {
+        r = DatasetRoSave(ro, out);
+        if (r == 0) {
+            SCLogNotice("dataset: compiled '%s' into '%s', %"PRIu64" unique records",
+                    in, out, DatasetRoCount(ro));
+        }
+        DatasetRoFree(ro);
+    }
+    SCFree(set);
+    return r;
+}
+
 int DatasetsInit(void)
 {
     SCLogDebug("datasets start");
@@ -575,27 +775,41 @@ int DatasetsInit(void)
                 }
             }
 
+            bool read_only = false;
+            const char *ro_str = ConfNodeLookupChildValue(iter, "read-only");
+            if (ro_str != NULL && ConfValIsTrue(ro_str)) {
+                if (set_save != NULL || strlen(load) == 0) {
+                    FatalError(SC_ERR_INVALID_ARGUMENT, "read-only dataset %s "
+                            "needs a 'load' file and can't have a 'state' file",
+                            set_name);
+                }
+                read_only = true;
+            }
+
             char conf_str[1024];
             snprintf(conf_str, sizeof(conf_str), "datasets.%d.%s", list_pos, set_name);
 
             SCLogDebug("(%d) set %s type %s. Conf %s", n, set_name, set_type->val, conf_str);
 
             if (strcmp(set_type->val, "md5") == 0) {
-                Dataset *dset = DatasetGet(set_name, DATASET_TYPE_MD5, save, load);
+                Dataset *dset = DatasetGetInternal(set_name, DATASET_TYPE_MD5, save, load,
+                        read_only);
                 if (dset == NULL)
                     FatalError(SC_ERR_FATAL, "failed to setup dataset for %s", set_name);
                 SCLogDebug("dataset %s: id %d type %s", set_name, n, set_type->val);
                 n++;
 
             } else if (strcmp(set_type->val, "sha256") == 0) {
-                Dataset *dset = DatasetGet(set_name, DATASET_TYPE_SHA256, save, load);
+                Dataset *dset = DatasetGetInternal(set_name, DATASET_TYPE_SHA256, save, load,
+                        read_only);
                 if (dset == NULL)
                     FatalError(SC_ERR_FATAL, "failed to setup dataset for %s", set_name);
                 SCLogDebug("dataset %s: id %d type %s", set_name, n, set_type->val);
                 n++;
 
             } else if (strcmp(set_type->val, "string") == 0) {
-                Dataset *dset = DatasetGet(set_name, DATASET_TYPE_STRING, save, load);
+                Dataset *dset = DatasetGetInternal(set_name, DATASET_TYPE_STRING, save, load,
+                        read_only);
                 if (dset == NULL)
                     FatalError(SC_ERR_FATAL, "failed to setup dataset for %s", set_name);
                 SCLogDebug("dataset %s: id %d type %s", set_name, n, set_type->val);
@@ -617,11 +831,16 @@ void DatasetsDestroy(void)
     while (set) {
         SCLogDebug("destroying set %s", set->name);
         Dataset *next = set->next;
-        THashShutdown(set->hash);
+        if (set->read_only) {
+            DatasetRoFree(SC_ATOMIC_GET(set->ro));
+        } else {
+            THashShutdown(set->hash);
+        }
         SCFree(set);
         set = next;
     }
     sets = NULL;
+    DatasetFreeRetired();
     SCMutexUnlock(&sets_lock);
     SCLogDebug("destroying datasets done: %p", sets);
 }
@@ -670,7 +889,7 @@ void DatasetsSave(void)
     SCMutexLock(&sets_lock);
     Dataset *set = sets;
     while (set) {
-        if (strlen(set->save) == 0)
+        if (strlen(set->save) == 0 || set->read_only)
             goto next;
 
         FILE *fp = fopen(set->save, "w");
@@ -831,6 +1050,9 @@ int DatasetLookup(Dataset *set, const uint8_t *data, const uint32_t data_len)
     if (set == NULL)
         return -1;
 
+    if (set->read_only)
+        return DatasetRoLookup(SC_ATOMIC_GET(set->ro), data, data_len, NULL);
+
     switch (set->type) {
         case DATASET_TYPE_STRING:
             return DatasetLookupString(set, data, data_len);
@@ -849,6 +1071,11 @@ DataRepResultType DatasetLookupwRep(Dataset *set, const uint8_t *data, const uin
     if (set == NULL)
         return rrep;
 
+    if (set->read_only) {
+        rrep.found = DatasetRoLookup(SC_ATOMIC_GET(set->ro), data, data_len, &rrep.rep) == 1;
+        return rrep;
+    }
+
     switch (set->type) {
         case DATASET_TYPE_STRING:
             return DatasetLookupStringwRep(set, data, data_len, rep);
@@ -980,6 +1207,10 @@ int DatasetAdd(Dataset *set, const uint8_t *data, const uint32_t data_len)
     if (set == NULL)
         return -1;
 
+    /* read-only sets only take data while being loaded */
+    if (set->read_only)
+        return DatasetRoBuilderAdd(set->ro_builder, data, data_len, NULL);
+
     switch (set->type) {
         case DATASET_TYPE_STRING:
             return DatasetAddString(set, data, data_len);
@@ -997,6 +1228,9 @@ static int DatasetAddwRep(Dataset *set, const uint8_t *data, const uint32_t data
     if (set == NULL)
         return -1;
 
+    if (set->read_only)
+        return DatasetRoBuilderAdd(set->ro_builder, data, data_len, rep);
+
     switch (set->type) {
         case DATASET_TYPE_STRING:
             return DatasetAddStringwRep(set, data, data_len, rep);
@@ -1016,7 +1250,7 @@ static int DatasetAddwRep(Dataset *set, const uint8_t *data, const uint32_t data
  */
 int DatasetAddSerialized(Dataset *set, const char *string)
 {
-    if (set == NULL)
+    if (set == NULL || set->read_only)
         return -1;
 
     switch (set->type) {
@@ -1098,7 +1332,7 @@ static int DatasetRemoveSha256(Dataset *set, const uint8_t *data, const uint32_t
  *  \retval int -2 DATA error */
 int DatasetRemoveSerialized(Dataset *set, const char *string)
 {
-    if (set == NULL)
+    if (set == NULL || set->read_only)
         return -1;
 
     switch (set->type) {
@@ -24,6 +24,7 @@
 int DatasetsInit(void);
 void DatasetsDestroy(void);
 void DatasetsSave(void);
+void DatasetsReloadComplete(void);
 
 enum DatasetTypes {
 #define DATASET_TYPE_NOTSET 0
@@ -40,6 +41,14 @@ typedef struct Dataset {
 
     THashTableContext *hash;
 
+    /* read-only sets use an immutable table instead of the hash. It is
+     * swapped atomically if the load file changed on a rule reload. */
+    bool read_only;
+    SC_ATOMIC_DECLARE(struct DatasetRo_ *, ro);
+    struct DatasetRoBuilder_ *ro_builder;   /**< set while loading */
+    time_t load_mtime;
+    off_t load_size;
+
     char load[PATH_MAX];
     char save[PATH_MAX];
 
@@ -50,6 +59,7 @@ enum DatasetTypes DatasetGetTypeFromString(const char *s);
 Dataset *DatasetFind(const char *name, enum DatasetTypes type);
 Dataset *DatasetGet(const char *name, enum DatasetTypes type,
         const char *save, const char *load);
+int DatasetCompile(const char *type, const char *in, const char *out);
 int DatasetAdd(Dataset *set, const uint8_t *data, const uint32_t data_len);
 int DatasetLookup(Dataset *set, const uint8_t *data, const uint32_t data_len);
 DataRepResultType DatasetLookupwRep(Dataset *set, const uint8_t *data, const uint32_t data_len,
@@ -61,6 +61,7 @@
 #include "util-print.h"
 #include "tmqh-packetpool.h"
 #include "util-profiling.h"
+#include "util-numa.h"
 #include "pkt-var.h"
 #include "util-mpm-ac.h"
 #include "util-hash-string.h"
@@ -508,6 +509,9 @@ void DecodeRegisterPerfCounters(DecodeThreadVars *dtv, ThreadVars *tv)
     dtv->counter_max_pkt_size = StatsRegisterMaxCounter("decoder.max_pkt_size", tv);
     dtv->counter_erspan = StatsRegisterMaxCounter("decoder.erspan", tv);
     dtv->counter_flow_memcap = StatsRegisterCounter("flow.memcap", tv);
+    if (NumaEnabled()) {
+        dtv->counter_flow_numa_remote = StatsRegisterCounter("flow.numa_remote", tv);
+    }
 
     dtv->counter_flow_tcp = StatsRegisterCounter("flow.tcp", tv);
     dtv->counter_flow_udp = StatsRegisterCounter("flow.udp", tv);
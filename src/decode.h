@@ -670,6 +670,9 @@ typedef struct DecodeThreadVars_
     uint16_t counter_defrag_max_hit;
 
     uint16_t counter_flow_memcap;
+    /** flows handed out that live on another NUMA node. Only registered
+     *  in NUMA aware mode. */
+    uint16_t counter_flow_numa_remote;
 
     uint16_t counter_flow_tcp;
     uint16_t counter_flow_udp;
@@ -682,6 +685,9 @@ typedef struct DecodeThreadVars_
      * flow recycle during lookups */
     void *output_flow_thread_data;
 
+    /** thread owned flow hash in "flow.thread-local" mode, NULL otherwise */
+    struct FlowThreadHash_ *flow_thread_hash;
+
 } DecodeThreadVars;
 
 typedef struct CaptureStats_ {
@@ -24,6 +24,7 @@
 #include "util-byte.h"
 #include "util-misc.h"
 #include "util-hash-lookup3.h"
+#include "util-hugepage.h"
 
 /** defrag tracker hash table */
 DefragTrackerHashRow *defragtracker_hash;
@@ -234,12 +235,11 @@ void DefragInitConfig(char quiet)
                 (uintmax_t)sizeof(DefragTrackerHashRow));
         exit(EXIT_FAILURE);
     }
-    defragtracker_hash = SCCalloc(defrag_config.hash_size, sizeof(DefragTrackerHashRow));
+    defragtracker_hash = HugePageAlloc(defrag_config.hash_size * sizeof(DefragTrackerHashRow));
     if (unlikely(defragtracker_hash == NULL)) {
         SCLogError(SC_ERR_FATAL, "Fatal error encountered in DefragTrackerInitConfig. Exiting...");
         exit(EXIT_FAILURE);
     }
-    memset(defragtracker_hash, 0, defrag_config.hash_size * sizeof(DefragTrackerHashRow));
 
     uint32_t i = 0;
     for (i = 0; i < defrag_config.hash_size; i++) {
@@ -323,7 +323,7 @@ void DefragHashShutdown(void)
 
             DRLOCK_DESTROY(&defragtracker_hash[u]);
         }
-        SCFree(defragtracker_hash);
+        HugePageFree(defragtracker_hash);
         defragtracker_hash = NULL;
     }
     (void) SC_ATOMIC_SUB(defrag_memuse, defrag_config.hash_size * sizeof(DefragTrackerHashRow));
@@ -377,6 +377,11 @@ int DetectDatasetSetup (DetectEngineCtx *de_ctx, Signature *s, const char *rawst
                 "failed to set up dataset '%s'.", name);
         return -1;
     }
+    if (cmd == DETECT_DATASET_CMD_SET && set->read_only) {
+        SCLogError(SC_ERR_INVALID_SIGNATURE,
+                "dataset '%s' is read-only, can't use 'set' on it.", name);
+        return -1;
+    }
 
     cd = SCCalloc(1, sizeof(DetectDatasetData));
     if (unlikely(cd == NULL))
@@ -23,6 +23,7 @@
 #include "detect-engine-address.h"
 #include "detect-engine-analyzer.h"
 #include "detect-engine-iponly.h"
+#include "detect-engine-content-inspection.h"
 #include "detect-engine-mpm.h"
 #include "detect-engine-siggroup.h"
 #include "detect-engine-port.h"
@@ -1783,6 +1784,9 @@ int SigAddressPrepareStage4(DetectEngineCtx *de_ctx)
     }
     SCLogPerf("Unique rule groups: %u", cnt);
 
+    if (MpmStoreBuildAll(de_ctx) != 0) {
+        SCReturnInt(-1);
+    }
     MpmStoreReportStats(de_ctx);
 
     if (de_ctx->decoder_event_sgh != NULL) {
@@ -1840,6 +1844,8 @@ static int SigMatchPrepare(DetectEngineCtx *de_ctx)
         }
         /* set up the pkt inspection engines */
         DetectEnginePktInspectionSetup(s);
+        /* compile the content inspection lists */
+        DetectEngineContentInspectionPrepare(de_ctx, s);
 
         if (rule_engine_analysis_set) {
             EngineAnalysisRules2(de_ctx, s);
@@ -1920,6 +1926,12 @@ int SigGroupBuild(DetectEngineCtx *de_ctx)
         SCLogError(SC_ERR_DETECT_PREPARE, "initializing the detection engine failed");
         exit(EXIT_FAILURE);
     }
+    PrefilterMultiBufferPrepare(de_ctx);
+
+    if (DetectEngineTransformCachePrepare(de_ctx) != 0) {
+        SCLogError(SC_ERR_DETECT_PREPARE, "initializing the detection engine failed");
+        exit(EXIT_FAILURE);
+    }
 
     if (SigMatchPrepare(de_ctx) != 0) {
         SCLogError(SC_ERR_DETECT_PREPARE, "initializing the detection engine failed");
@@ -62,6 +62,587 @@
 #include "util-lua.h"
 #endif
 
+/**
+ * \internal
+ * \brief Get the part of the buffer a content is searched in.
+ *
+ * \param prev_buffer_offset buffer offset before the content, for relative
+ *                           matching
+ * \param prev_offset        start of the search for the next occurrence, 0
+ *                           for the first search
+ *
+ * \retval false the content can't match, regardless of negation
+ */
+static inline bool DetectContentGetWindow(const DetectEngineThreadCtx *det_ctx,
+        const DetectContentData *cd, const uint32_t prev_buffer_offset,
+        const uint32_t prev_offset, const uint32_t buffer_len,
+        const uint32_t stream_start_offset, uint32_t *offset_out,
+        uint32_t *depth_out)
+{
+    uint32_t offset = 0;
+    uint32_t depth = buffer_len;
+
+    if ((cd->flags & DETECT_CONTENT_DISTANCE) ||
+        (cd->flags & DETECT_CONTENT_WITHIN)) {
+        SCLogDebug("det_ctx->buffer_offset %"PRIu32, det_ctx->buffer_offset);
+
+        offset = prev_buffer_offset;
+        depth = buffer_len;
+
+        int distance = cd->distance;
+        if (cd->flags & DETECT_CONTENT_DISTANCE) {
+            if (cd->flags & DETECT_CONTENT_DISTANCE_BE) {
+                distance = det_ctx->bj_values[cd->distance];
+            }
+            if (distance < 0 && (uint32_t)(abs(distance)) > offset)
+                offset = 0;
+            else
+                offset += distance;
+
+            SCLogDebug("cd->distance %"PRIi32", offset %"PRIu32", depth %"PRIu32,
+                       distance, offset, depth);
+        }
+
+        if (cd->flags & DETECT_CONTENT_WITHIN) {
+            if (cd->flags & DETECT_CONTENT_WITHIN_BE) {
+                if ((int32_t)depth > (int32_t)(prev_buffer_offset + det_ctx->bj_values[cd->within] + distance)) {
+                    depth = prev_buffer_offset + det_ctx->bj_values[cd->within] + distance;
+                }
+            } else {
+                if ((int32_t)depth > (int32_t)(prev_buffer_offset + cd->within + distance)) {
+                    depth = prev_buffer_offset + cd->within + distance;
+                }
+
+                SCLogDebug("cd->within %"PRIi32", det_ctx->buffer_offset %"PRIu32", depth %"PRIu32,
+                           cd->within, prev_buffer_offset, depth);
+            }
+
+            if (stream_start_offset != 0 && prev_buffer_offset == 0) {
+                if (depth <= stream_start_offset) {
+                    return false;
+                } else if (depth >= (stream_start_offset + buffer_len)) {
+                    ;
+                } else {
+                    depth = depth - stream_start_offset;
+                }
+            }
+        }
+
+        if (cd->flags & DETECT_CONTENT_DEPTH_BE) {
+            if ((det_ctx->bj_values[cd->depth] + prev_buffer_offset) < depth) {
+                depth = prev_buffer_offset + det_ctx->bj_values[cd->depth];
+            }
+        } else {
+            if (cd->depth != 0) {
+                if ((cd->depth + prev_buffer_offset) < depth) {
+                    depth = prev_buffer_offset + cd->depth;
+                }
+
+                SCLogDebug("cd->depth %"PRIu32", depth %"PRIu32, cd->depth, depth);
+            }
+        }
+
+        if (cd->flags & DETECT_CONTENT_OFFSET_BE) {
+            if (det_ctx->bj_values[cd->offset] > offset)
+                offset = det_ctx->bj_values[cd->offset];
+        } else {
+            if (cd->offset > offset) {
+                offset = cd->offset;
+                SCLogDebug("setting offset %"PRIu32, offset);
+            }
+        }
+    } else { /* implied no relative matches */
+        /* set depth */
+        if (cd->flags & DETECT_CONTENT_DEPTH_BE) {
+            depth = det_ctx->bj_values[cd->depth];
+        } else {
+            if (cd->depth != 0) {
+                depth = cd->depth;
+            }
+        }
+
+        if (stream_start_offset != 0 && cd->flags & DETECT_CONTENT_DEPTH) {
+            if (depth <= stream_start_offset) {
+                return false;
+            } else if (depth >= (stream_start_offset + buffer_len)) {
+                ;
+            } else {
+                depth = depth - stream_start_offset;
+            }
+        }
+
+        /* set offset */
+        if (cd->flags & DETECT_CONTENT_OFFSET_BE)
+            offset = det_ctx->bj_values[cd->offset];
+        else
+            offset = cd->offset;
+    }
+
+    /* If the value came from a variable, make sure to adjust the depth so it's relative
+     * to the offset value.
+     */
+    if (cd->flags & (DETECT_CONTENT_DISTANCE_BE|DETECT_CONTENT_OFFSET_BE|DETECT_CONTENT_DEPTH_BE)) {
+         depth += offset;
+    }
+
+    /* update offset with prev_offset if we're searching for
+     * matches after the first occurrence. */
+    SCLogDebug("offset %"PRIu32", prev_offset %"PRIu32, offset, prev_offset);
+    if (prev_offset != 0)
+        offset = prev_offset;
+
+    if (depth > buffer_len)
+        depth = buffer_len;
+
+    *offset_out = offset;
+    *depth_out = depth;
+    return true;
+}
+
+/**
+ * \internal
+ * \brief Search a content in the window from DetectContentGetWindow().
+ *
+ * \retval found start of the match or NULL
+ */
+static inline const uint8_t *DetectContentScan(DetectEngineThreadCtx *det_ctx,
+        const DetectContentData *cd, const uint8_t *buffer,
+        const uint32_t buffer_len, const uint32_t offset, const uint32_t depth)
+{
+    const uint8_t *sbuffer = buffer + offset;
+    uint32_t sbuffer_len = depth - offset;
+    SCLogDebug("sbuffer_len %"PRIu32, sbuffer_len);
+#ifdef DEBUG
+    BUG_ON(sbuffer_len > buffer_len);
+#endif
+    if (cd->flags & DETECT_CONTENT_ENDS_WITH && depth < buffer_len) {
+        SCLogDebug("depth < buffer_len while DETECT_CONTENT_ENDS_WITH is set. Can't possibly match.");
+        return NULL;
+    } else if (cd->content_len > sbuffer_len) {
+        return NULL;
+    }
+    /* do the actual search */
+    return SpmScan(cd->spm_ctx, det_ctx->spm_thread_ctx, sbuffer,
+            sbuffer_len);
+}
+
+/**
+ * \internal
+ * \brief Inspect a keyword that doesn't look for more matches if the
+ *        keywords after it don't match.
+ *
+ * \retval 1 match
+ * \retval 0 no match
+ * \retval -1 not such a keyword
+ */
+static int DetectEngineInspectKeyword(DetectEngineThreadCtx *det_ctx,
+        const Signature *s, const SigMatchData *smd,
+        const uint8_t *buffer, const uint32_t buffer_len,
+        const uint32_t stream_start_offset, const uint8_t flags)
+{
+    switch (smd->type) {
+        case DETECT_ISDATAAT: {
+            SCLogDebug("inspecting isdataat");
+
+            const DetectIsdataatData *id = (DetectIsdataatData *)smd->ctx;
+            uint32_t dataat = id->dataat;
+            if (id->flags & ISDATAAT_OFFSET_BE) {
+                uint64_t be_value = det_ctx->bj_values[dataat];
+                if (be_value >= 100000000) {
+                    if ((id->flags & ISDATAAT_NEGATED) == 0) {
+                        SCLogDebug("extracted value %"PRIu64" very big: no match", be_value);
+                        return 0;
+                    }
+                    SCLogDebug("extracted value way %"PRIu64" very big: match", be_value);
+                    return 1;
+                }
+                dataat = (uint32_t)be_value;
+                SCLogDebug("isdataat: using value %u from byte_extract local_id %u", dataat, id->dataat);
+            }
+
+            if (id->flags & ISDATAAT_RELATIVE) {
+                if (det_ctx->buffer_offset + dataat > buffer_len) {
+                    SCLogDebug("det_ctx->buffer_offset + dataat %"PRIu32" > %"PRIu32, det_ctx->buffer_offset + dataat, buffer_len);
+                    return (id->flags & ISDATAAT_NEGATED) ? 1 : 0;
+                } else {
+                    SCLogDebug("relative isdataat match");
+                    return (id->flags & ISDATAAT_NEGATED) ? 0 : 1;
+                }
+            } else {
+                if (dataat < buffer_len) {
+                    SCLogDebug("absolute isdataat match");
+                    return (id->flags & ISDATAAT_NEGATED) ? 0 : 1;
+                } else {
+                    SCLogDebug("absolute isdataat mismatch, id->isdataat %"PRIu32", buffer_len %"PRIu32"", dataat, buffer_len);
+                    return (id->flags & ISDATAAT_NEGATED) ? 1 : 0;
+                }
+            }
+        }
+        case DETECT_BYTETEST: {
+            DetectBytetestData *btd = (DetectBytetestData *)smd->ctx;
+            uint8_t btflags = btd->flags;
+            int32_t offset = btd->offset;
+            uint64_t value = btd->value;
+            if (btflags & DETECT_BYTETEST_OFFSET_BE) {
+                offset = det_ctx->bj_values[offset];
+            }
+            if (btflags & DETECT_BYTETEST_VALUE_BE) {
+                value = det_ctx->bj_values[value];
+            }
+
+            /* if we have dce enabled we will have to use the endianness
+             * specified by the dce header */
+            if (btflags & DETECT_BYTETEST_DCE) {
+                /* enable the endianness flag temporarily.  once we are done
+                 * processing we reset the flags to the original value*/
+                btflags |= ((flags & DETECT_CI_FLAGS_DCE_LE) ?
+                          DETECT_BYTETEST_LITTLE: 0);
+            }
+
+            return (DetectBytetestDoMatch(det_ctx, s, smd->ctx, buffer, buffer_len, btflags,
+                                          offset, value) == 1);
+        }
+        case DETECT_BYTEJUMP: {
+            DetectBytejumpData *bjd = (DetectBytejumpData *)smd->ctx;
+            uint8_t bjflags = bjd->flags;
+            int32_t offset = bjd->offset;
+
+            if (bjflags & DETECT_BYTEJUMP_OFFSET_BE) {
+                offset = det_ctx->bj_values[offset];
+            }
+
+            /* if we have dce enabled we will have to use the endianness
+             * specified by the dce header */
+            if (bjflags & DETECT_BYTEJUMP_DCE) {
+                /* enable the endianness flag temporarily.  once we are done
+                 * processing we reset the flags to the original value*/
+                bjflags |= ((flags & DETECT_CI_FLAGS_DCE_LE) ?
+                          DETECT_BYTEJUMP_LITTLE: 0);
+            }
+
+            return (DetectBytejumpDoMatch(det_ctx, s, smd->ctx, buffer, buffer_len,
+                                          bjflags, offset) == 1);
+        }
+        case DETECT_BYTE_EXTRACT: {
+            DetectByteExtractData *bed = (DetectByteExtractData *)smd->ctx;
+            uint8_t endian = bed->endian;
+
+            /* if we have dce enabled we will have to use the endianness
+             * specified by the dce header */
+            if ((bed->flags & DETECT_BYTE_EXTRACT_FLAG_ENDIAN) &&
+                endian == DETECT_BYTE_EXTRACT_ENDIAN_DCE &&
+                flags & (DETECT_CI_FLAGS_DCE_LE|DETECT_CI_FLAGS_DCE_BE)) {
+
+                /* enable the endianness flag temporarily.  once we are done
+                 * processing we reset the flags to the original value*/
+                endian |= ((flags & DETECT_CI_FLAGS_DCE_LE) ?
+                           DETECT_BYTE_EXTRACT_ENDIAN_LITTLE : DETECT_BYTE_EXTRACT_ENDIAN_BIG);
+            }
+
+            return (DetectByteExtractDoMatch(det_ctx, smd, s, buffer,
+                                             buffer_len,
+                                             &det_ctx->bj_values[bed->local_id],
+                                             endian) == 1);
+        }
+        case DETECT_BSIZE: {
+            bool eof = (flags & DETECT_CI_FLAGS_END);
+            const uint64_t data_size = buffer_len + stream_start_offset;
+            int r = DetectBsizeMatch(smd->ctx, data_size, eof);
+            if (r < 0) {
+                det_ctx->discontinue_matching = 1;
+                return 0;
+            }
+            return (r != 0);
+        }
+        case DETECT_DATASET: {
+            //PrintRawDataFp(stdout, buffer, buffer_len);
+            const DetectDatasetData *sd = (const DetectDatasetData *) smd->ctx;
+            int r = DetectDatasetBufferMatch(det_ctx, sd, buffer, buffer_len); //TODO buffer offset?
+            if (r == 1) {
+                return 1;
+            }
+            det_ctx->discontinue_matching = 1;
+            return 0;
+        }
+        case DETECT_DATAREP: {
+            //PrintRawDataFp(stdout, buffer, buffer_len);
+            const DetectDatarepData *sd = (const DetectDatarepData *) smd->ctx;
+            int r = DetectDatarepBufferMatch(det_ctx, sd, buffer, buffer_len); //TODO buffer offset?
+            if (r == 1) {
+                return 1;
+            }
+            det_ctx->discontinue_matching = 1;
+            return 0;
+        }
+        case DETECT_AL_URILEN: {
+            SCLogDebug("inspecting uri len");
+
+            int r = 0;
+            DetectUrilenData *urilend = (DetectUrilenData *) smd->ctx;
+
+            switch (urilend->mode) {
+                case DETECT_URILEN_EQ:
+                    if (buffer_len == urilend->urilen1)
+                        r = 1;
+                    break;
+                case DETECT_URILEN_LT:
+                    if (buffer_len < urilend->urilen1)
+                        r = 1;
+                    break;
+                case DETECT_URILEN_GT:
+                    if (buffer_len > urilend->urilen1)
+                        r = 1;
+                    break;
+                case DETECT_URILEN_RA:
+                    if (buffer_len > urilend->urilen1 &&
+                        buffer_len < urilend->urilen2) {
+                        r = 1;
+                    }
+                    break;
+            }
+
+            if (r == 1) {
+                return 1;
+            }
+
+            det_ctx->discontinue_matching = 0;
+            return 0;
+        }
+        default:
+            return -1;
+    }
+}
+
+/** max number of sigmatches in a compiled list, longer lists are
+ *  inspected by DetectEngineContentInspection() directly */
+#define DETECT_CI_PROG_MAX_OPS  64
+
+enum DetectCiOpType {
+    DETECT_CI_OP_CONTENT = 0,
+    DETECT_CI_OP_PCRE,
+    DETECT_CI_OP_KEYWORD,
+};
+
+typedef struct DetectCiOp_ {
+    uint8_t type;       /**< DETECT_CI_OP_* */
+    uint8_t retry;      /**< look for another match if the ops after this
+                         *   one don't match */
+    uint8_t is_last;
+    const SigMatchData *smd;
+} DetectCiOp;
+
+typedef struct DetectCiProgram_ {
+    uint16_t cnt;
+    DetectCiOp ops[];
+} DetectCiProgram;
+
+/** state of an op that may be retried, kept while the ops after it run */
+typedef struct DetectCiFrame_ {
+    uint16_t pc;
+    uint32_t prev_offset;           /**< content: start of the next search,
+                                     *   pcre: pcre_match_start_offset */
+    uint32_t prev_buffer_offset;    /**< buffer_offset when entering the op */
+} DetectCiFrame;
+
+/** result of running a single op */
+enum {
+    DETECT_CI_FAIL = 0,
+    DETECT_CI_NEXT,     /**< continue with the next op */
+    DETECT_CI_CALL,     /**< continue with the next op, retry this op if
+                         *   that fails */
+    DETECT_CI_MATCH,    /**< the list matched */
+};
+
+static int DetectCiOpContent(DetectEngineThreadCtx *det_ctx, const DetectCiOp *op,
+        DetectCiFrame *fr, const uint8_t *buffer, const uint32_t buffer_len,
+        const uint32_t stream_start_offset, const uint8_t inspection_mode)
+{
+    KEYWORD_PROFILING_START;
+    DetectContentData *cd = (DetectContentData *)op->smd->ctx;
+
+    do {
+        uint32_t offset = 0;
+        uint32_t depth = buffer_len;
+        if (!DetectContentGetWindow(det_ctx, cd, fr->prev_buffer_offset, fr->prev_offset,
+                    buffer_len, stream_start_offset, &offset, &depth)) {
+            goto no_match;
+        }
+        if (offset > depth || depth == 0) {
+            if (cd->flags & DETECT_CONTENT_NEGATED) {
+                goto match;
+            }
+            goto no_match;
+        }
+
+        const uint8_t *found = DetectContentScan(det_ctx, cd, buffer, buffer_len,
+                offset, depth);
+        if (found == NULL) {
+            if (cd->flags & DETECT_CONTENT_NEGATED) {
+                goto match;
+            }
+            if ((cd->flags & (DETECT_CONTENT_DISTANCE|DETECT_CONTENT_WITHIN)) == 0) {
+                /* independent match from previous matches, so failure is fatal */
+                det_ctx->discontinue_matching = 1;
+            }
+            goto no_match;
+        } else if (cd->flags & DETECT_CONTENT_NEGATED) {
+            if (DETECT_CONTENT_IS_SINGLE(cd))
+                det_ctx->discontinue_matching = 1;
+            goto no_match;
+        }
+
+        const uint32_t match_offset = (uint32_t)((found - buffer) + cd->content_len);
+        SCLogDebug("content %"PRIu32" matched at offset %"PRIu32"", cd->id, match_offset);
+        det_ctx->buffer_offset = match_offset;
+        /* on a retry, search from the start of this match + 1 */
+        fr->prev_offset = (match_offset - (cd->content_len - 1));
+
+        if ((cd->flags & DETECT_CONTENT_ENDS_WITH) == 0 || match_offset == buffer_len) {
+            if (cd->flags & DETECT_CONTENT_REPLACE) {
+                if (inspection_mode == DETECT_ENGINE_CONTENT_INSPECTION_MODE_PAYLOAD) {
+                    det_ctx->replist = DetectReplaceAddToList(det_ctx->replist, (uint8_t *)found, cd);
+                } else {
+                    SCLogWarning(SC_ERR_INVALID_VALUE, "Can't modify payload without packet");
+                }
+            }
+            KEYWORD_PROFILING_END(det_ctx, DETECT_CONTENT, 1);
+            return op->is_last ? DETECT_CI_MATCH : DETECT_CI_CALL;
+        }
+    } while (1);
+
+no_match:
+    KEYWORD_PROFILING_END(det_ctx, DETECT_CONTENT, 0);
+    return DETECT_CI_FAIL;
+match:
+    KEYWORD_PROFILING_END(det_ctx, DETECT_CONTENT, 1);
+    return DETECT_CI_NEXT;
+}
+
+static int DetectCiOpPcre(DetectEngineThreadCtx *det_ctx, const Signature *s,
+        const DetectCiOp *op, DetectCiFrame *fr, Packet *p, Flow *f,
+        const uint8_t *buffer, const uint32_t buffer_len)
+{
+    KEYWORD_PROFILING_START;
+    if (DetectPcrePayloadMatch(det_ctx, s, op->smd, p, f, buffer, buffer_len) == 0) {
+        KEYWORD_PROFILING_END(det_ctx, DETECT_PCRE, 0);
+        return DETECT_CI_FAIL;
+    }
+    KEYWORD_PROFILING_END(det_ctx, DETECT_PCRE, 1);
+    if (!op->retry)
+        return DETECT_CI_NEXT;
+
+    fr->prev_offset = det_ctx->pcre_match_start_offset;
+    return DETECT_CI_CALL;
+}
+
+static int DetectCiOpKeyword(DetectEngineThreadCtx *det_ctx, const Signature *s,
+        const DetectCiOp *op, const uint8_t *buffer, const uint32_t buffer_len,
+        const uint32_t stream_start_offset, const uint8_t flags)
+{
+    KEYWORD_PROFILING_START;
+    const int r = DetectEngineInspectKeyword(det_ctx, s, op->smd, buffer, buffer_len,
+            stream_start_offset, flags);
+    KEYWORD_PROFILING_END(det_ctx, op->smd->type, (r == 1));
+    return (r == 1) ? DETECT_CI_NEXT : DETECT_CI_FAIL;
+}
+
+/**
+ * \internal
+ * \brief Run a compiled sm list
+ *
+ * Does what DetectEngineContentInspection() does for the list, but
+ * instead of recursing into the next sigmatch, the ops that may have
+ * to look for another match are kept on a stack. Steps are counted
+ * against the recursion limit the same way.
+ */
+static int DetectCiProgramRun(DetectEngineCtx *de_ctx, DetectEngineThreadCtx *det_ctx,
+        const Signature *s, const DetectCiProgram *prog, Packet *p, Flow *f,
+        const uint8_t *buffer, const uint32_t buffer_len,
+        const uint32_t stream_start_offset, const uint8_t flags,
+        const uint8_t inspection_mode)
+{
+    DetectCiFrame stack[DETECT_CI_PROG_MAX_OPS];
+    uint32_t sp = 0;
+    uint16_t pc = 0;
+
+    while (1) {
+        /* enter op 'pc' */
+        det_ctx->inspection_recursion_counter++;
+        if (det_ctx->inspection_recursion_counter == de_ctx->inspection_recursion_limit) {
+            det_ctx->discontinue_matching = 1;
+            goto fail;
+        }
+        if (buffer_len == 0)
+            goto fail;
+
+        DetectCiFrame *fr = &stack[sp];
+        fr->pc = pc;
+        fr->prev_offset = 0;
+        fr->prev_buffer_offset = det_ctx->buffer_offset;
+        if (prog->ops[pc].type == DETECT_CI_OP_PCRE)
+            det_ctx->pcre_match_start_offset = 0;
+run:
+        {
+            const DetectCiOp *op = &prog->ops[pc];
+            int r;
+            switch (op->type) {
+                case DETECT_CI_OP_CONTENT:
+                    r = DetectCiOpContent(det_ctx, op, &stack[sp], buffer, buffer_len,
+                            stream_start_offset, inspection_mode);
+                    break;
+                case DETECT_CI_OP_PCRE:
+                    r = DetectCiOpPcre(det_ctx, s, op, &stack[sp], p, f,
+                            buffer, buffer_len);
+                    break;
+                default:
+                    r = DetectCiOpKeyword(det_ctx, s, op, buffer, buffer_len,
+                            stream_start_offset, flags);
+                    break;
+            }
+
+            switch (r) {
+                case DETECT_CI_MATCH:
+                    return 1;
+                case DETECT_CI_NEXT:
+                    if (op->is_last)
+                        return 1;
+                    pc++;
+                    continue;
+                case DETECT_CI_CALL:
+                    sp++;
+                    pc++;
+                    continue;
+                default:
+                    break;
+            }
+        }
+fail:
+        /* resume the last op that can look for another match */
+        while (sp > 0) {
+            sp--;
+            DetectCiFrame *rfr = &stack[sp];
+            const DetectCiOp *rop = &prog->ops[rfr->pc];
+
+            if (det_ctx->discontinue_matching)
+                continue;
+
+            if (rop->type == DETECT_CI_OP_CONTENT) {
+                /* no match and no reason to look for another instance */
+                if (!rop->retry) {
+                    det_ctx->discontinue_matching = 1;
+                    continue;
+                }
+            } else {
+                det_ctx->buffer_offset = rfr->prev_buffer_offset;
+                det_ctx->pcre_match_start_offset = rfr->prev_offset;
+            }
+            pc = rfr->pc;
+            goto run;
+        }
+        return 0;
+    }
+}
+
 /**
  * \brief Run the actual payload match functions
  *
@@ -108,6 +689,13 @@ int DetectEngineContentInspection(DetectEngineCtx *de_ctx, DetectEngineThreadCtx
                                   uint8_t inspection_mode)
 {
     SCEnter();
+
+    if (smd != NULL && smd->ci_prog != 0) {
+        int r = DetectCiProgramRun(de_ctx, det_ctx, s, de_ctx->ci_progs[smd->ci_prog - 1],
+                p, f, buffer, buffer_len, stream_start_offset, flags, inspection_mode);
+        SCReturnInt(r);
+    }
+
     KEYWORD_PROFILING_START;
 
     det_ctx->inspection_recursion_counter++;
@@ -150,121 +738,12 @@ int DetectEngineContentInspection(DetectEngineCtx *de_ctx, DetectEngineThreadCtx
         uint32_t prev_buffer_offset = det_ctx->buffer_offset;
 
         do {
-            if ((cd->flags & DETECT_CONTENT_DISTANCE) ||
-                (cd->flags & DETECT_CONTENT_WITHIN)) {
-                SCLogDebug("det_ctx->buffer_offset %"PRIu32, det_ctx->buffer_offset);
-
-                offset = prev_buffer_offset;
-                depth = buffer_len;
-
-                int distance = cd->distance;
-                if (cd->flags & DETECT_CONTENT_DISTANCE) {
-                    if (cd->flags & DETECT_CONTENT_DISTANCE_BE) {
-                        distance = det_ctx->bj_values[cd->distance];
-                    }
-                    if (distance < 0 && (uint32_t)(abs(distance)) > offset)
-                        offset = 0;
-                    else
-                        offset += distance;
-
-                    SCLogDebug("cd->distance %"PRIi32", offset %"PRIu32", depth %"PRIu32,
-                               distance, offset, depth);
-                }
-
-                if (cd->flags & DETECT_CONTENT_WITHIN) {
-                    if (cd->flags & DETECT_CONTENT_WITHIN_BE) {
-                        if ((int32_t)depth > (int32_t)(prev_buffer_offset + det_ctx->bj_values[cd->within] + distance)) {
-                            depth = prev_buffer_offset + det_ctx->bj_values[cd->within] + distance;
-                        }
-                    } else {
-                        if ((int32_t)depth > (int32_t)(prev_buffer_offset + cd->within + distance)) {
-                            depth = prev_buffer_offset + cd->within + distance;
-                        }
-
-                        SCLogDebug("cd->within %"PRIi32", det_ctx->buffer_offset %"PRIu32", depth %"PRIu32,
-                                   cd->within, prev_buffer_offset, depth);
-                    }
-
-                    if (stream_start_offset != 0 && prev_buffer_offset == 0) {
-                        if (depth <= stream_start_offset) {
-                            goto no_match;
-                        } else if (depth >= (stream_start_offset + buffer_len)) {
-                            ;
-                        } else {
-                            depth = depth - stream_start_offset;
-                        }
-                    }
-                }
-
-                if (cd->flags & DETECT_CONTENT_DEPTH_BE) {
-                    if ((det_ctx->bj_values[cd->depth] + prev_buffer_offset) < depth) {
-                        depth = prev_buffer_offset + det_ctx->bj_values[cd->depth];
-                    }
-                } else {
-                    if (cd->depth != 0) {
-                        if ((cd->depth + prev_buffer_offset) < depth) {
-                            depth = prev_buffer_offset + cd->depth;
-                        }
-
-                        SCLogDebug("cd->depth %"PRIu32", depth %"PRIu32, cd->depth, depth);
-                    }
-                }
-
-                if (cd->flags & DETECT_CONTENT_OFFSET_BE) {
-                    if (det_ctx->bj_values[cd->offset] > offset)
-                        offset = det_ctx->bj_values[cd->offset];
-                } else {
-                    if (cd->offset > offset) {
-                        offset = cd->offset;
-                        SCLogDebug("setting offset %"PRIu32, offset);
-                    }
-                }
-            } else { /* implied no relative matches */
-                /* set depth */
-                if (cd->flags & DETECT_CONTENT_DEPTH_BE) {
-                    depth = det_ctx->bj_values[cd->depth];
-                } else {
-                    if (cd->depth != 0) {
-                        depth = cd->depth;
-                    }
-                }
-
-                if (stream_start_offset != 0 && cd->flags & DETECT_CONTENT_DEPTH) {
-                    if (depth <= stream_start_offset) {
-                        goto no_match;
-                    } else if (depth >= (stream_start_offset + buffer_len)) {
-                        ;
-                    } else {
-                        depth = depth - stream_start_offset;
-                    }
-                }
-
-                /* set offset */
-                if (cd->flags & DETECT_CONTENT_OFFSET_BE)
-                    offset = det_ctx->bj_values[cd->offset];
-                else
-                    offset = cd->offset;
-                prev_buffer_offset = 0;
-            }
-
-            /* If the value came from a variable, make sure to adjust the depth so it's relative
-             * to the offset value.
-             */
-            if (cd->flags & (DETECT_CONTENT_DISTANCE_BE|DETECT_CONTENT_OFFSET_BE|DETECT_CONTENT_DEPTH_BE)) {
-                 depth += offset;
+            if (!DetectContentGetWindow(det_ctx, cd, prev_buffer_offset, prev_offset,
+                        buffer_len, stream_start_offset, &offset, &depth)) {
+                goto no_match;
             }
-
-            /* update offset with prev_offset if we're searching for
-             * matches after the first occurrence. */
-            SCLogDebug("offset %"PRIu32", prev_offset %"PRIu32, offset, prev_offset);
-            if (prev_offset != 0)
-                offset = prev_offset;
-
             SCLogDebug("offset %"PRIu32", depth %"PRIu32, offset, depth);
 
-            if (depth > buffer_len)
-                depth = buffer_len;
-
             /* if offset is bigger than depth we can never match on a pattern.
              * We can however, "match" on a negated pattern. */
             if (offset > depth || depth == 0) {
@@ -275,23 +754,8 @@ int DetectEngineContentInspection(DetectEngineCtx *de_ctx, DetectEngineThreadCtx
                 }
             }
 
-            const uint8_t *sbuffer = buffer + offset;
-            uint32_t sbuffer_len = depth - offset;
             uint32_t match_offset = 0;
-            SCLogDebug("sbuffer_len %"PRIu32, sbuffer_len);
-#ifdef DEBUG
-            BUG_ON(sbuffer_len > buffer_len);
-#endif
-            if (cd->flags & DETECT_CONTENT_ENDS_WITH && depth < buffer_len) {
-                SCLogDebug("depth < buffer_len while DETECT_CONTENT_ENDS_WITH is set. Can't possibly match.");
-                found = NULL;
-            } else if (cd->content_len > sbuffer_len) {
-                found = NULL;
-            } else {
-                /* do the actual search */
-                found = SpmScan(cd->spm_ctx, det_ctx->spm_thread_ctx, sbuffer,
-                        sbuffer_len);
-            }
+            found = DetectContentScan(det_ctx, cd, buffer, buffer_len, offset, depth);
 
             /* next we evaluate the result in combination with the
              * negation flag. */
@@ -370,51 +834,6 @@ int DetectEngineContentInspection(DetectEngineCtx *de_ctx, DetectEngineThreadCtx
 
         } while(1);
 
-    } else if (smd->type == DETECT_ISDATAAT) {
-        SCLogDebug("inspecting isdataat");
-
-        const DetectIsdataatData *id = (DetectIsdataatData *)smd->ctx;
-        uint32_t dataat = id->dataat;
-        if (id->flags & ISDATAAT_OFFSET_BE) {
-            uint64_t be_value = det_ctx->bj_values[dataat];
-            if (be_value >= 100000000) {
-                if ((id->flags & ISDATAAT_NEGATED) == 0) {
-                    SCLogDebug("extracted value %"PRIu64" very big: no match", be_value);
-                    goto no_match;
-                }
-                SCLogDebug("extracted value way %"PRIu64" very big: match", be_value);
-                goto match;
-            }
-            dataat = (uint32_t)be_value;
-            SCLogDebug("isdataat: using value %u from byte_extract local_id %u", dataat, id->dataat);
-        }
-
-        if (id->flags & ISDATAAT_RELATIVE) {
-            if (det_ctx->buffer_offset + dataat > buffer_len) {
-                SCLogDebug("det_ctx->buffer_offset + dataat %"PRIu32" > %"PRIu32, det_ctx->buffer_offset + dataat, buffer_len);
-                if (id->flags & ISDATAAT_NEGATED)
-                    goto match;
-                goto no_match;
-            } else {
-                SCLogDebug("relative isdataat match");
-                if (id->flags & ISDATAAT_NEGATED)
-                    goto no_match;
-                goto match;
-            }
-        } else {
-            if (dataat < buffer_len) {
-                SCLogDebug("absolute isdataat match");
-                if (id->flags & ISDATAAT_NEGATED)
-                    goto no_match;
-                goto match;
-            } else {
-                SCLogDebug("absolute isdataat mismatch, id->isdataat %"PRIu32", buffer_len %"PRIu32"", dataat, buffer_len);
-                if (id->flags & ISDATAAT_NEGATED)
-                    goto match;
-                goto no_match;
-            }
-        }
-
     } else if (smd->type == DETECT_PCRE) {
         SCLogDebug("inspecting pcre");
         DetectPcreData *pe = (DetectPcreData *)smd->ctx;
@@ -456,155 +875,6 @@ int DetectEngineContentInspection(DetectEngineCtx *de_ctx, DetectEngineThreadCtx
             det_ctx->pcre_match_start_offset = prev_offset;
         } while (1);
 
-    } else if (smd->type == DETECT_BYTETEST) {
-        DetectBytetestData *btd = (DetectBytetestData *)smd->ctx;
-        uint8_t btflags = btd->flags;
-        int32_t offset = btd->offset;
-        uint64_t value = btd->value;
-        if (btflags & DETECT_BYTETEST_OFFSET_BE) {
-            offset = det_ctx->bj_values[offset];
-        }
-        if (btflags & DETECT_BYTETEST_VALUE_BE) {
-            value = det_ctx->bj_values[value];
-        }
-
-        /* if we have dce enabled we will have to use the endianness
-         * specified by the dce header */
-        if (btflags & DETECT_BYTETEST_DCE) {
-            /* enable the endianness flag temporarily.  once we are done
-             * processing we reset the flags to the original value*/
-            btflags |= ((flags & DETECT_CI_FLAGS_DCE_LE) ?
-                      DETECT_BYTETEST_LITTLE: 0);
-        }
-
-        if (DetectBytetestDoMatch(det_ctx, s, smd->ctx, buffer, buffer_len, btflags,
-                                  offset, value) != 1) {
-            goto no_match;
-        }
-
-        goto match;
-
-    } else if (smd->type == DETECT_BYTEJUMP) {
-        DetectBytejumpData *bjd = (DetectBytejumpData *)smd->ctx;
-        uint8_t bjflags = bjd->flags;
-        int32_t offset = bjd->offset;
-
-        if (bjflags & DETECT_BYTEJUMP_OFFSET_BE) {
-            offset = det_ctx->bj_values[offset];
-        }
-
-        /* if we have dce enabled we will have to use the endianness
-         * specified by the dce header */
-        if (bjflags & DETECT_BYTEJUMP_DCE) {
-            /* enable the endianness flag temporarily.  once we are done
-             * processing we reset the flags to the original value*/
-            bjflags |= ((flags & DETECT_CI_FLAGS_DCE_LE) ?
-                      DETECT_BYTEJUMP_LITTLE: 0);
-        }
-
-        if (DetectBytejumpDoMatch(det_ctx, s, smd->ctx, buffer, buffer_len,
-                                  bjflags, offset) != 1) {
-            goto no_match;
-        }
-
-        goto match;
-
-    } else if (smd->type == DETECT_BYTE_EXTRACT) {
-
-        DetectByteExtractData *bed = (DetectByteExtractData *)smd->ctx;
-        uint8_t endian = bed->endian;
-
-        /* if we have dce enabled we will have to use the endianness
-         * specified by the dce header */
-        if ((bed->flags & DETECT_BYTE_EXTRACT_FLAG_ENDIAN) &&
-            endian == DETECT_BYTE_EXTRACT_ENDIAN_DCE &&
-            flags & (DETECT_CI_FLAGS_DCE_LE|DETECT_CI_FLAGS_DCE_BE)) {
-
-            /* enable the endianness flag temporarily.  once we are done
-             * processing we reset the flags to the original value*/
-            endian |= ((flags & DETECT_CI_FLAGS_DCE_LE) ?
-                       DETECT_BYTE_EXTRACT_ENDIAN_LITTLE : DETECT_BYTE_EXTRACT_ENDIAN_BIG);
-        }
-
-        if (DetectByteExtractDoMatch(det_ctx, smd, s, buffer,
-                                     buffer_len,
-                                     &det_ctx->bj_values[bed->local_id],
-                                     endian) != 1) {
-            goto no_match;
-        }
-
-        goto match;
-
-    } else if (smd->type == DETECT_BSIZE) {
-
-        bool eof = (flags & DETECT_CI_FLAGS_END);
-        const uint64_t data_size = buffer_len + stream_start_offset;
-        int r = DetectBsizeMatch(smd->ctx, data_size, eof);
-        if (r < 0) {
-            det_ctx->discontinue_matching = 1;
-            goto no_match;
-
-        } else if (r == 0) {
-            goto no_match;
-        }
-        goto match;
-
-    } else if (smd->type == DETECT_DATASET) {
-
-        //PrintRawDataFp(stdout, buffer, buffer_len);
-        const DetectDatasetData *sd = (const DetectDatasetData *) smd->ctx;
-        int r = DetectDatasetBufferMatch(det_ctx, sd, buffer, buffer_len); //TODO buffer offset?
-        if (r == 1) {
-            goto match;
-        }
-        det_ctx->discontinue_matching = 1;
-        goto no_match;
-
-    } else if (smd->type == DETECT_DATAREP) {
-
-        //PrintRawDataFp(stdout, buffer, buffer_len);
-        const DetectDatarepData *sd = (const DetectDatarepData *) smd->ctx;
-        int r = DetectDatarepBufferMatch(det_ctx, sd, buffer, buffer_len); //TODO buffer offset?
-        if (r == 1) {
-            goto match;
-        }
-        det_ctx->discontinue_matching = 1;
-        goto no_match;
-
-    } else if (smd->type == DETECT_AL_URILEN) {
-        SCLogDebug("inspecting uri len");
-
-        int r = 0;
-        DetectUrilenData *urilend = (DetectUrilenData *) smd->ctx;
-
-        switch (urilend->mode) {
-            case DETECT_URILEN_EQ:
-                if (buffer_len == urilend->urilen1)
-                    r = 1;
-                break;
-            case DETECT_URILEN_LT:
-                if (buffer_len < urilend->urilen1)
-                    r = 1;
-                break;
-            case DETECT_URILEN_GT:
-                if (buffer_len > urilend->urilen1)
-                    r = 1;
-                break;
-            case DETECT_URILEN_RA:
-                if (buffer_len > urilend->urilen1 &&
-                    buffer_len < urilend->urilen2) {
-                    r = 1;
-                }
-                break;
-        }
-
-        if (r == 1) {
-            goto match;
-        }
-
-        det_ctx->discontinue_matching = 0;
-
-        goto no_match;
 #ifdef HAVE_LUA
     }
     else if (smd->type == DETECT_LUA) {
@@ -630,10 +900,16 @@ int DetectEngineContentInspection(DetectEngineCtx *de_ctx, DetectEngineThreadCtx
             }
         }
     } else {
-        SCLogDebug("sm->type %u", smd->type);
+        int r = DetectEngineInspectKeyword(det_ctx, s, smd, buffer, buffer_len,
+                stream_start_offset, flags);
+        if (r == 1) {
+            goto match;
+        } else if (r < 0) {
+            SCLogDebug("sm->type %u", smd->type);
 #ifdef DEBUG
-        BUG_ON(1);
+            BUG_ON(1);
 #endif
+        }
     }
 
 no_match:
@@ -655,6 +931,107 @@ final_match:
     SCReturnInt(1);
 }
 
+/**
+ * \internal
+ * \brief Compile the sm list starting at smd
+ *
+ * Lists with lua or base64_decode are not compiled, nor are lists of
+ * more than DETECT_CI_PROG_MAX_OPS sigmatches.
+ */
+static void DetectCiProgramCompile(DetectEngineCtx *de_ctx, SigMatchData *smd)
+{
+    if (smd == NULL || smd->ci_prog != 0)
+        return;
+
+    uint16_t cnt = 0;
+    for (const SigMatchData *t = smd; ; t++) {
+        switch (t->type) {
+            case DETECT_CONTENT:
+            case DETECT_PCRE:
+            case DETECT_ISDATAAT:
+            case DETECT_BYTETEST:
+            case DETECT_BYTEJUMP:
+            case DETECT_BYTE_EXTRACT:
+            case DETECT_BSIZE:
+            case DETECT_DATASET:
+            case DETECT_DATAREP:
+            case DETECT_AL_URILEN:
+                break;
+            default:
+                return;
+        }
+        if (++cnt > DETECT_CI_PROG_MAX_OPS)
+            return;
+        if (t->is_last)
+            break;
+    }
+
+    if (de_ctx->ci_progs_cnt == de_ctx->ci_progs_size) {
+        uint32_t size = de_ctx->ci_progs_size ? de_ctx->ci_progs_size * 2 : 64;
+        void *ptr = SCRealloc(de_ctx->ci_progs, size * sizeof(DetectCiProgram *));
+        if (ptr == NULL)
+            return;
+        de_ctx->ci_progs = ptr;
+        de_ctx->ci_progs_size = size;
+    }
+
+    DetectCiProgram *prog = SCCalloc(1, sizeof(*prog) + cnt * sizeof(DetectCiOp));
+    if (prog == NULL)
+        return;
+    prog->cnt = cnt;
+
+    for (uint16_t i = 0; i < cnt; i++) {
+        DetectCiOp *op = &prog->ops[i];
+        op->smd = &smd[i];
+        op->is_last = smd[i].is_last;
+
+        if (smd[i].type == DETECT_CONTENT) {
+            const DetectContentData *cd = (const DetectContentData *)smd[i].ctx;
+            op->type = DETECT_CI_OP_CONTENT;
+            op->retry = (cd->flags & DETECT_CONTENT_WITHIN_NEXT) != 0;
+        } else if (smd[i].type == DETECT_PCRE) {
+            const DetectPcreData *pe = (const DetectPcreData *)smd[i].ctx;
+            op->type = DETECT_CI_OP_PCRE;
+            op->retry = (pe->flags & DETECT_PCRE_RELATIVE_NEXT) && !op->is_last;
+        } else {
+            op->type = DETECT_CI_OP_KEYWORD;
+        }
+    }
+
+    de_ctx->ci_progs[de_ctx->ci_progs_cnt++] = prog;
+    smd->ci_prog = de_ctx->ci_progs_cnt;
+}
+
+/**
+ * \brief compile the content inspection lists of a signature
+ *
+ * Called after the sm arrays of the signature are set up.
+ */
+void DetectEngineContentInspectionPrepare(DetectEngineCtx *de_ctx, Signature *s)
+{
+    if (!de_ctx->inspection_vm)
+        return;
+
+    for (DetectEngineAppInspectionEngine *e = s->app_inspect; e != NULL; e = e->next) {
+        DetectCiProgramCompile(de_ctx, e->smd);
+    }
+    for (DetectEnginePktInspectionEngine *e = s->pkt_inspect; e != NULL; e = e->next) {
+        DetectCiProgramCompile(de_ctx, e->smd);
+    }
+    DetectCiProgramCompile(de_ctx, s->sm_arrays[DETECT_SM_LIST_PMATCH]);
+    DetectCiProgramCompile(de_ctx, s->sm_arrays[DETECT_SM_LIST_BASE64_DATA]);
+}
+
+void DetectEngineContentInspectionFreePrograms(DetectEngineCtx *de_ctx)
+{
+    for (uint32_t i = 0; i < de_ctx->ci_progs_cnt; i++) {
+        SCFree(de_ctx->ci_progs[i]);
+    }
+    SCFree(de_ctx->ci_progs);
+    de_ctx->ci_progs = NULL;
+    de_ctx->ci_progs_cnt = de_ctx->ci_progs_size = 0;
+}
+
 #ifdef UNITTESTS
 #include "tests/detect-engine-content-inspection.c"
 #endif
@@ -52,6 +52,9 @@ int DetectEngineContentInspection(DetectEngineCtx *de_ctx, DetectEngineThreadCtx
                                   uint32_t stream_start_offset, uint8_t flags,
                                   uint8_t inspection_mode);
 
+void DetectEngineContentInspectionPrepare(DetectEngineCtx *de_ctx, Signature *s);
+void DetectEngineContentInspectionFreePrograms(DetectEngineCtx *de_ctx);
+
 void DetectEngineContentInspectionRegisterTests(void);
 
 #endif /* __DETECT_ENGINE_CONTENT_INSPECTION_H__ */
@@ -1548,6 +1548,15 @@ void IPOnlyPrepare(DetectEngineCtx *de_ctx)
     SCRadixPrintTree((de_ctx->io_ctx).tree_ipv6dst);
     SCLogDebug("__________________");
     */
+
+    /* compile the trees into lookup tables. If they get too large, at
+     * least let the packets that match no netblock skip the tree walk */
+    SCRadixTree *trees[] = { (de_ctx->io_ctx).tree_ipv4src, (de_ctx->io_ctx).tree_ipv4dst,
+                             (de_ctx->io_ctx).tree_ipv6src, (de_ctx->io_ctx).tree_ipv6dst };
+    for (size_t i = 0; i < ARRAY_SIZE(trees); i++) {
+        if (SCRadixBuildLpm(trees[i]) != 0)
+            (void)SCRadixBuildPrefilter(trees[i]);
+    }
 }
 
 /**
@@ -1273,16 +1273,134 @@ static void MpmStoreSetup(const DetectEngineCtx *de_ctx, MpmStore *ms)
         }
     }
 
+    /* unique contexts are prepared by MpmStoreBuildAll() once all
+     * stores are set up */
     if (ms->mpm_ctx->pattern_cnt == 0) {
         MpmFactoryReClaimMpmCtx(de_ctx, ms->mpm_ctx);
         ms->mpm_ctx = NULL;
-    } else {
-        if (ms->sgh_mpm_context == MPM_CTX_FACTORY_UNIQUE_CONTEXT) {
-            if (mpm_table[ms->mpm_ctx->mpm_type].Prepare != NULL) {
-                mpm_table[ms->mpm_ctx->mpm_type].Prepare(ms->mpm_ctx);
-            }
+    }
+}
+
+typedef struct DetectEngineBuildCtx_ {
+    void **jobs;
+    uint32_t cnt;
+    int (*Build)(void *job);
+    /** next job to run, shared by all build threads */
+    SC_ATOMIC_DECLARE(uint32_t, next);
+    SC_ATOMIC_DECLARE(uint32_t, errors);
+} DetectEngineBuildCtx;
+
+static void *DetectEngineBuildThread(void *data)
+{
+    DetectEngineBuildCtx *bctx = data;
+
+    while (1) {
+        const uint32_t i = SC_ATOMIC_ADD(bctx->next, 1);
+        if (i >= bctx->cnt)
+            break;
+
+        if (bctx->Build(bctx->jobs[i]) != 0) {
+            (void)SC_ATOMIC_ADD(bctx->errors, 1);
+        }
+    }
+    return NULL;
+}
+
+/** \brief run independent build jobs on detect.build-threads threads
+ *
+ *  \param jobs array of jobs, passed to Build one by one
+ *  \param Build callback, returns 0 on success
+ *
+ *  \retval errors number of jobs that failed
+ */
+uint32_t DetectEngineBuildJobs(const DetectEngineCtx *de_ctx, void **jobs,
+        const uint32_t cnt, int (*Build)(void *job))
+{
+    DetectEngineBuildCtx bctx;
+    memset(&bctx, 0, sizeof(bctx));
+    SC_ATOMIC_INIT(bctx.next);
+    SC_ATOMIC_INIT(bctx.errors);
+    bctx.jobs = jobs;
+    bctx.cnt = cnt;
+    bctx.Build = Build;
+
+    uint32_t nthreads = MIN(de_ctx->build_threads, cnt);
+    pthread_t threads[nthreads > 0 ? nthreads : 1];
+    uint32_t started = 0;
+    /* the current thread is one of the build threads */
+    for (uint32_t t = 1; t < nthreads; t++) {
+        if (pthread_create(&threads[started], NULL, DetectEngineBuildThread, &bctx) != 0) {
+            SCLogWarning(SC_ERR_THREAD_CREATE, "failed to create detect build "
+                    "thread, continuing with %u threads", started + 1);
+            break;
         }
+        started++;
+    }
+    SCLogDebug("running %u build jobs with %u threads", cnt, started + 1);
+
+    DetectEngineBuildThread(&bctx);
+    for (uint32_t t = 0; t < started; t++) {
+        pthread_join(threads[t], NULL);
+    }
+    return SC_ATOMIC_GET(bctx.errors);
+}
+
+static int MpmStoreBuild(void *job)
+{
+    MpmCtx *mpm_ctx = ((MpmStore *)job)->mpm_ctx;
+    return mpm_table[mpm_ctx->mpm_type].Prepare(mpm_ctx);
+}
+
+/** \brief prepare the mpm contexts of all stores with a unique context
+ *
+ *  Preparing (compiling) the mpm contexts is the most expensive part
+ *  of building the detection engine. The contexts are independent, so
+ *  they are handed out to detect.build-threads threads.
+ *
+ *  \retval 0 ok
+ *  \retval -1 error
+ */
+int MpmStoreBuildAll(const DetectEngineCtx *de_ctx)
+{
+    HashListTableBucket *htb = NULL;
+
+    uint32_t cnt = 0;
+    for (htb = HashListTableGetListHead(de_ctx->mpm_hash_table);
+            htb != NULL;
+            htb = HashListTableGetListNext(htb))
+    {
+        cnt++;
+    }
+    if (cnt == 0)
+        return 0;
+
+    void **stores = SCCalloc(cnt, sizeof(MpmStore *));
+    if (stores == NULL)
+        return -1;
+
+    uint32_t stores_cnt = 0;
+    for (htb = HashListTableGetListHead(de_ctx->mpm_hash_table);
+            htb != NULL;
+            htb = HashListTableGetListNext(htb))
+    {
+        MpmStore *ms = (MpmStore *)HashListTableGetListData(htb);
+        if (ms == NULL || ms->mpm_ctx == NULL ||
+                ms->sgh_mpm_context != MPM_CTX_FACTORY_UNIQUE_CONTEXT ||
+                mpm_table[ms->mpm_ctx->mpm_type].Prepare == NULL)
+            continue;
+        stores[stores_cnt++] = ms;
     }
+
+    const uint32_t errors = DetectEngineBuildJobs(de_ctx, stores, stores_cnt,
+            MpmStoreBuild);
+    SCFree(stores);
+
+    if (errors != 0) {
+        SCLogError(SC_ERR_INITIALIZATION, "failed to prepare %u mpm contexts",
+                errors);
+        return -1;
+    }
+    return 0;
 }
 
 
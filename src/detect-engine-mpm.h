@@ -68,6 +68,9 @@ int MpmStoreInit(DetectEngineCtx *);
 void MpmStoreFree(DetectEngineCtx *);
 void MpmStoreReportStats(const DetectEngineCtx *de_ctx);
 MpmStore *MpmStorePrepareBuffer(DetectEngineCtx *de_ctx, SigGroupHead *sgh, enum MpmBuiltinBuffers buf);
+uint32_t DetectEngineBuildJobs(const DetectEngineCtx *de_ctx, void **jobs,
+        const uint32_t cnt, int (*Build)(void *job));
+int MpmStoreBuildAll(const DetectEngineCtx *de_ctx);
 
 /**
  * \brief Figured out the FP and their respective content ids for all the
@@ -51,9 +51,12 @@
 struct StreamMpmData {
     DetectEngineThreadCtx *det_ctx;
     const MpmCtx *mpm_ctx;
+    Flow *f;
+    uint8_t flags;
 };
 
-static int StreamMpmFunc(void *cb_data, const uint8_t *data, const uint32_t data_len)
+static int StreamMpmFunc(void *cb_data, const uint8_t *data, const uint32_t data_len,
+        const uint64_t offset)
 {
     struct StreamMpmData *smd = cb_data;
     if (data_len >= smd->mpm_ctx->minlen) {
@@ -61,9 +64,9 @@ static int StreamMpmFunc(void *cb_data, const uint8_t *data, const uint32_t data
         smd->det_ctx->stream_mpm_cnt++;
         smd->det_ctx->stream_mpm_size += data_len;
 #endif
-        (void)mpm_table[smd->mpm_ctx->mpm_type].Search(smd->mpm_ctx,
-                &smd->det_ctx->mtcs, &smd->det_ctx->pmq,
-                data, data_len);
+        PrefilterStreamingSearch(smd->det_ctx, smd->mpm_ctx,
+                &smd->det_ctx->mtcs, smd->f, smd->flags, false, 0,
+                data, data_len, offset);
     }
     return 0;
 }
@@ -79,7 +82,8 @@ static void PrefilterPktStream(DetectEngineThreadCtx *det_ctx,
     if (p->flags & PKT_DETECT_HAS_STREAMDATA) {
         SCLogDebug("PRE det_ctx->raw_stream_progress %"PRIu64,
                 det_ctx->raw_stream_progress);
-        struct StreamMpmData stream_mpm_data = { det_ctx, mpm_ctx };
+        struct StreamMpmData stream_mpm_data = { det_ctx, mpm_ctx, p->flow,
+            PKT_IS_TOSERVER(p) ? STREAM_TOSERVER : STREAM_TOCLIENT };
         StreamReassembleRaw(p->flow->protoctx, p,
                 StreamMpmFunc, &stream_mpm_data,
                 &det_ctx->raw_stream_progress,
@@ -109,6 +113,9 @@ static void PrefilterPktStream(DetectEngineThreadCtx *det_ctx,
 int PrefilterPktStreamRegister(DetectEngineCtx *de_ctx,
         SigGroupHead *sgh, MpmCtx *mpm_ctx)
 {
+    if (de_ctx->prefilter_streaming) {
+        mpm_ctx->flags |= MPMCTX_FLAGS_STREAMING;
+    }
     return PrefilterAppendPayloadEngine(de_ctx, sgh,
             PrefilterPktStream, mpm_ctx, NULL, "stream");
 }
@@ -224,7 +231,8 @@ struct StreamContentInspectData {
     Flow *f;
 };
 
-static int StreamContentInspectFunc(void *cb_data, const uint8_t *data, const uint32_t data_len)
+static int StreamContentInspectFunc(void *cb_data, const uint8_t *data, const uint32_t data_len,
+        const uint64_t offset)
 {
     SCEnter();
     int r = 0;
@@ -282,7 +290,8 @@ struct StreamContentInspectEngineData {
     Flow *f;
 };
 
-static int StreamContentInspectEngineFunc(void *cb_data, const uint8_t *data, const uint32_t data_len)
+static int StreamContentInspectEngineFunc(void *cb_data, const uint8_t *data, const uint32_t data_len,
+        const uint64_t offset)
 {
     SCEnter();
     int r = 0;
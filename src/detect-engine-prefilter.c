@@ -47,16 +47,27 @@
 #include "suricata-common.h"
 #include "suricata.h"
 
+#include "detect-engine.h"
 #include "detect-engine-prefilter.h"
 #include "detect-engine-mpm.h"
 
 #include "app-layer-parser.h"
 #include "app-layer-htp.h"
 
+#include "flow-storage.h"
+
 #include "util-profiling.h"
+#include "util-misc.h"
+#ifdef BUILD_HYPERSCAN
+#include "util-mpm-hs.h"
+#include "util-hashlist.h"
+#endif
 
 static int PrefilterStoreGetId(DetectEngineCtx *de_ctx,
         const char *name, void (*FreeFunc)(void *));
+#ifdef BUILD_HYPERSCAN
+static void PrefilterMultiBufferMerge(DetectEngineCtx *de_ctx, SigGroupHead *sgh);
+#endif
 static const PrefilterStore *PrefilterStoreGetStore(const DetectEngineCtx *de_ctx,
         const uint32_t id);
 
@@ -366,6 +377,12 @@ void PrefilterSetupRuleGroup(DetectEngineCtx *de_ctx, SigGroupHead *sgh)
         }
     }
 
+#ifdef BUILD_HYPERSCAN
+    if (de_ctx->prefilter_multi_buffer) {
+        PrefilterMultiBufferMerge(de_ctx, sgh);
+    }
+#endif
+
     /* we have lists of engines in sgh->init now. Lets setup the
      * match arrays */
     PrefilterEngineList *el;
@@ -630,6 +647,325 @@ int PrefilterGenericMpmRegister(DetectEngineCtx *de_ctx,
     return r;
 }
 
+/* multi buffer mpm: a single Hyperscan scan for the buffers of all
+ * generic mpm engines that run at the same point of a tx */
+
+#ifdef BUILD_HYPERSCAN
+typedef struct PrefilterMpmMultiCtx {
+    uint16_t cnt;
+    int thread_ctx_id;
+    /** engines of the buffers, run one by one if there is no database */
+    PrefilterMpmCtx *engines;
+    SCHSMultiCtx *hs;
+} PrefilterMpmMultiCtx;
+
+/** \brief Multi buffer Mpm prefilter callback
+ *
+ *  Gets the buffers of the tx and scans them with a vectored database. A
+ *  pattern only matches in the buffer of the engine it was added to.
+ */
+static void PrefilterMpmMulti(DetectEngineThreadCtx *det_ctx,
+        const void *pectx,
+        Packet *p, Flow *f, void *txv,
+        const uint64_t idx, const uint8_t flags)
+{
+    SCEnter();
+
+    const PrefilterMpmMultiCtx *ctx = (const PrefilterMpmMultiCtx *)pectx;
+    SCHSMultiThreadCtx *thread_ctx = NULL;
+    if (ctx->hs != NULL) {
+        thread_ctx = DetectThreadCtxGetKeywordThreadCtx(det_ctx, ctx->thread_ctx_id);
+    }
+    if (thread_ctx == NULL) {
+        for (uint16_t i = 0; i < ctx->cnt; i++) {
+            PrefilterMpm(det_ctx, &ctx->engines[i], p, f, txv, idx, flags);
+        }
+        return;
+    }
+
+    const uint8_t *bufs[ctx->cnt];
+    uint32_t lens[ctx->cnt];
+    uint16_t ids[ctx->cnt];
+    uint32_t cnt = 0;
+
+    for (uint16_t i = 0; i < ctx->cnt; i++) {
+        const PrefilterMpmCtx *e = &ctx->engines[i];
+        InspectionBuffer *buffer = e->GetData(det_ctx, e->transforms,
+                f, flags, txv, e->list_id);
+        if (buffer == NULL || buffer->inspect == NULL ||
+                buffer->inspect_len == 0 || buffer->inspect_len < e->mpm_ctx->minlen)
+            continue;
+
+        bufs[cnt] = buffer->inspect;
+        lens[cnt] = buffer->inspect_len;
+        ids[cnt] = i;
+        cnt++;
+    }
+    SCLogDebug("scanning %u of %u buffers", cnt, ctx->cnt);
+
+    if (cnt > 0) {
+        (void)SCHSMultiSearch(ctx->hs, &det_ctx->mtcu, thread_ctx,
+                &det_ctx->pmq, bufs, lens, ids, cnt);
+    }
+}
+
+static void PrefilterMpmMultiFree(void *ptr)
+{
+    PrefilterMpmMultiCtx *ctx = ptr;
+    SCHSMultiFree(ctx->hs);
+    SCFree(ctx->engines);
+    SCFree(ctx);
+}
+
+static void *PrefilterMpmMultiThreadInit(void *data)
+{
+    return SCHSMultiThreadInit(data);
+}
+
+static void PrefilterMpmMultiThreadFree(void *thread_ctx)
+{
+    SCHSMultiThreadFree(thread_ctx);
+}
+
+static inline bool PrefilterMultiBufferMatch(const PrefilterEngineList *a,
+        const PrefilterEngineList *b)
+{
+    return (b->PrefilterTx == PrefilterMpm && a->alproto == b->alproto &&
+            a->tx_min_progress == b->tx_min_progress);
+}
+
+/** \internal
+ *  \brief merge generic mpm engines that run at the same time
+ *
+ *  Generic mpm engines with the same alproto and progress always run
+ *  together, so they are replaced by a single engine. Its database is
+ *  built by PrefilterMultiBufferPrepare(), as the mpm contexts are not
+ *  prepared yet.
+ */
+static void PrefilterMultiBufferMerge(DetectEngineCtx *de_ctx, SigGroupHead *sgh)
+{
+    for (PrefilterEngineList *el = sgh->init->tx_engines; el != NULL; el = el->next) {
+        if (el->PrefilterTx != PrefilterMpm)
+            continue;
+
+        uint16_t cnt = 1;
+        for (PrefilterEngineList *t = el->next; t != NULL; t = t->next) {
+            if (PrefilterMultiBufferMatch(el, t))
+                cnt++;
+        }
+        if (cnt < 2)
+            continue;
+
+        PrefilterMpmMultiCtx *ctx = SCCalloc(1, sizeof(*ctx));
+        if (ctx == NULL)
+            return;
+        ctx->engines = SCCalloc(cnt, sizeof(PrefilterMpmCtx));
+        if (ctx->engines == NULL) {
+            SCFree(ctx);
+            return;
+        }
+        ctx->thread_ctx_id = -1;
+        ctx->engines[ctx->cnt++] = *(const PrefilterMpmCtx *)el->pectx;
+
+        PrefilterEngineList *prev = el;
+        PrefilterEngineList *t = el->next;
+        while (t != NULL) {
+            PrefilterEngineList *next = t->next;
+            if (PrefilterMultiBufferMatch(el, t)) {
+                ctx->engines[ctx->cnt++] = *(const PrefilterMpmCtx *)t->pectx;
+                prev->next = next;
+                PrefilterFreeEngineList(t);
+            } else {
+                prev = t;
+            }
+            t = next;
+        }
+        SCLogDebug("sgh %p: merged %u mpm engines for alproto %u progress %d",
+                sgh, ctx->cnt, el->alproto, el->tx_min_progress);
+
+        el->Free(el->pectx);
+        el->pectx = ctx;
+        el->PrefilterTx = PrefilterMpmMulti;
+        el->Free = PrefilterMpmMultiFree;
+        el->name = "multi-buffer";
+        el->gid = PrefilterStoreGetId(de_ctx, el->name, el->Free);
+    }
+}
+#endif /* BUILD_HYPERSCAN */
+
+#ifdef BUILD_HYPERSCAN
+/** database build of the multi buffer engines with the same mpm contexts */
+typedef struct PrefilterMultiBuildJob_ {
+    /** first engine with these mpm contexts */
+    const PrefilterMpmMultiCtx *ctx;
+    SCHSMultiCtx *hs;
+    int thread_ctx_id;
+} PrefilterMultiBuildJob;
+
+static uint32_t PrefilterMultiBuildJobHash(HashListTable *ht, void *data, uint16_t datalen)
+{
+    const PrefilterMultiBuildJob *job = data;
+    uint32_t hash = job->ctx->cnt;
+    for (uint16_t i = 0; i < job->ctx->cnt; i++) {
+        hash += (uint32_t)(uintptr_t)job->ctx->engines[i].mpm_ctx;
+    }
+    return hash % ht->array_size;
+}
+
+static char PrefilterMultiBuildJobCompare(void *data1, uint16_t len1,
+        void *data2, uint16_t len2)
+{
+    const PrefilterMpmMultiCtx *ctx1 = ((PrefilterMultiBuildJob *)data1)->ctx;
+    const PrefilterMpmMultiCtx *ctx2 = ((PrefilterMultiBuildJob *)data2)->ctx;
+    if (ctx1->cnt != ctx2->cnt)
+        return 0;
+    for (uint16_t i = 0; i < ctx1->cnt; i++) {
+        if (ctx1->engines[i].mpm_ctx != ctx2->engines[i].mpm_ctx)
+            return 0;
+    }
+    return 1;
+}
+
+static void PrefilterMultiBuildJobFree(void *data)
+{
+    SCFree(data);
+}
+
+static int PrefilterMultiBuildJobRun(void *data)
+{
+    PrefilterMultiBuildJob *job = data;
+    const MpmCtx *mpm_ctxs[job->ctx->cnt];
+    for (uint16_t i = 0; i < job->ctx->cnt; i++) {
+        mpm_ctxs[i] = job->ctx->engines[i].mpm_ctx;
+    }
+    job->hs = SCHSMultiBuild(mpm_ctxs, job->ctx->cnt);
+    return job->hs != NULL ? 0 : -1;
+}
+
+static int PrefilterMultiBuildJobCmp(const void *a, const void *b)
+{
+    const SCHSMultiCtx *hs1 = (*(PrefilterMultiBuildJob * const *)a)->hs;
+    const SCHSMultiCtx *hs2 = (*(PrefilterMultiBuildJob * const *)b)->hs;
+    if (hs1 == hs2)
+        return 0;
+    return (uintptr_t)hs1 < (uintptr_t)hs2 ? -1 : 1;
+}
+#endif /* BUILD_HYPERSCAN */
+
+/** \brief build the databases of the multi buffer engines
+ *
+ *  Needs to be called after the mpm contexts are prepared. Engines with the
+ *  same mpm contexts share a database, so each database is built once, on
+ *  the detect.build-threads threads. Engines sharing a database also share
+ *  its thread ctx. If a database can't be built, the engine scans the
+ *  buffers one by one.
+ */
+void PrefilterMultiBufferPrepare(DetectEngineCtx *de_ctx)
+{
+#ifdef BUILD_HYPERSCAN
+    if (!de_ctx->prefilter_multi_buffer)
+        return;
+
+    HashListTable *ht = HashListTableInit(4096, PrefilterMultiBuildJobHash,
+            PrefilterMultiBuildJobCompare, PrefilterMultiBuildJobFree);
+    if (ht == NULL)
+        return;
+
+    /* collect the unique sets of mpm contexts */
+    uint32_t cnt = 0;
+    for (uint32_t idx = 0; idx < de_ctx->sgh_array_cnt; idx++) {
+        const SigGroupHead *sgh = de_ctx->sgh_array[idx];
+        if (sgh == NULL || sgh->tx_engines == NULL)
+            continue;
+
+        for (PrefilterEngine *e = sgh->tx_engines; ; e++) {
+            if (e->cb.PrefilterTx == PrefilterMpmMulti) {
+                PrefilterMultiBuildJob lookup = { .ctx = e->pectx };
+                if (HashListTableLookup(ht, &lookup, 0) == NULL) {
+                    PrefilterMultiBuildJob *job = SCCalloc(1, sizeof(*job));
+                    if (job == NULL)
+                        goto end;
+                    job->ctx = e->pectx;
+                    job->thread_ctx_id = -1;
+                    if (HashListTableAdd(ht, job, 0) != 0) {
+                        SCFree(job);
+                        goto end;
+                    }
+                    cnt++;
+                }
+            }
+            if (e->is_last)
+                break;
+        }
+    }
+    if (cnt == 0)
+        goto end;
+
+    void **jobs = SCCalloc(cnt, sizeof(PrefilterMultiBuildJob *));
+    if (jobs == NULL)
+        goto end;
+    uint32_t n = 0;
+    for (HashListTableBucket *htb = HashListTableGetListHead(ht); htb != NULL;
+            htb = HashListTableGetListNext(htb)) {
+        jobs[n++] = HashListTableGetListData(htb);
+    }
+
+    const uint32_t errors = DetectEngineBuildJobs(de_ctx, jobs, n,
+            PrefilterMultiBuildJobRun);
+    if (errors != 0) {
+        SCLogWarning(SC_ERR_INITIALIZATION, "failed to build %u multi "
+                "buffer databases, scanning their buffers one by one", errors);
+    }
+
+    /* different mpm contexts can share pattern databases and so a multi
+     * buffer database: register one thread ctx per database */
+    qsort(jobs, n, sizeof(PrefilterMultiBuildJob *), PrefilterMultiBuildJobCmp);
+    for (uint32_t i = 0; i < n; i++) {
+        PrefilterMultiBuildJob *job = jobs[i];
+        const PrefilterMultiBuildJob *prev = i > 0 ? jobs[i - 1] : NULL;
+        if (job->hs == NULL)
+            continue;
+        if (prev != NULL && prev->hs == job->hs) {
+            job->thread_ctx_id = prev->thread_ctx_id;
+        } else {
+            job->thread_ctx_id = DetectRegisterThreadCtxFuncs(de_ctx,
+                    "multi-buffer", PrefilterMpmMultiThreadInit, job->hs,
+                    PrefilterMpmMultiThreadFree, 0);
+        }
+    }
+    SCFree(jobs);
+
+    for (uint32_t idx = 0; idx < de_ctx->sgh_array_cnt; idx++) {
+        const SigGroupHead *sgh = de_ctx->sgh_array[idx];
+        if (sgh == NULL || sgh->tx_engines == NULL)
+            continue;
+
+        for (PrefilterEngine *e = sgh->tx_engines; ; e++) {
+            if (e->cb.PrefilterTx == PrefilterMpmMulti) {
+                PrefilterMpmMultiCtx *ctx = e->pectx;
+                PrefilterMultiBuildJob lookup = { .ctx = ctx };
+                const PrefilterMultiBuildJob *job = HashListTableLookup(ht, &lookup, 0);
+                if (job != NULL && job->hs != NULL && job->thread_ctx_id != -1) {
+                    ctx->hs = SCHSMultiRef(job->hs);
+                    ctx->thread_ctx_id = job->thread_ctx_id;
+                }
+            }
+            if (e->is_last)
+                break;
+        }
+    }
+
+end:
+    /* the engines hold their own references */
+    for (HashListTableBucket *htb = HashListTableGetListHead(ht); htb != NULL;
+            htb = HashListTableGetListNext(htb)) {
+        PrefilterMultiBuildJob *job = HashListTableGetListData(htb);
+        SCHSMultiFree(job->hs);
+    }
+    HashListTableFree(ht);
+#endif
+}
+
 /* generic mpm for pkt engines */
 
 typedef struct PrefilterMpmPktCtx {
@@ -698,3 +1034,117 @@ int PrefilterGenericMpmPktRegister(DetectEngineCtx *de_ctx,
     }
     return r;
 }
+
+/* streaming mpm */
+
+/** default for detect.prefilter.streaming-memcap */
+#define PREFILTER_STREAMING_MEMCAP_DEFAULT (64 * 1024 * 1024)
+
+static int g_prefilter_streaming_id = -1;   /**< Flow storage id */
+
+#ifdef BUILD_HYPERSCAN
+/** streaming scan states of a flow */
+typedef struct PrefilterStreamingFlowState_ {
+    SCHSStreamState *stream[2];     /**< raw stream, by direction */
+    SCHSStreamState *body[2];       /**< http body, by direction */
+    uint64_t body_tx_id[2];         /**< tx the body state is for */
+} PrefilterStreamingFlowState;
+
+static void PrefilterStreamingFlowStateFree(void *ptr)
+{
+    PrefilterStreamingFlowState *fs = ptr;
+    for (int i = 0; i < 2; i++) {
+        SCHSStreamStateFree(fs->stream[i]);
+        SCHSStreamStateFree(fs->body[i]);
+    }
+    SCFree(fs);
+}
+#endif
+
+/** \brief setup streaming mpm if enabled in the config
+ *
+ *  Has to be called before StorageFinalize() as it registers the flow
+ *  storage for the scan states.
+ */
+void PrefilterStreamingInit(void)
+{
+#ifdef BUILD_HYPERSCAN
+    int streaming = 0;
+    (void)ConfGetBool("detect.prefilter.streaming", &streaming);
+    if (!streaming)
+        return;
+
+    uint64_t memcap = PREFILTER_STREAMING_MEMCAP_DEFAULT;
+    const char *memcap_str = NULL;
+    if (ConfGet("detect.prefilter.streaming-memcap", &memcap_str) == 1 &&
+            memcap_str != NULL) {
+        if (ParseSizeStringU64(memcap_str, &memcap) < 0) {
+            SCLogError(SC_ERR_SIZE_PARSE, "Error parsing "
+                    "detect.prefilter.streaming-memcap from conf file - %s. "
+                    "Killing engine", memcap_str);
+            exit(EXIT_FAILURE);
+        }
+    }
+    SCHSStreamSetMemcap(memcap);
+
+    g_prefilter_streaming_id = FlowStorageRegister("prefilter_streaming",
+            sizeof(void *), NULL, PrefilterStreamingFlowStateFree);
+    if (g_prefilter_streaming_id == -1) {
+        SCLogError(SC_ERR_FLOW_INIT, "Can't initiate flow storage for "
+                "streaming prefilter");
+        exit(EXIT_FAILURE);
+    }
+#endif
+}
+
+/** \brief check if streaming mpm was setup by PrefilterStreamingInit() */
+bool PrefilterStreamingAvailable(void)
+{
+    return (g_prefilter_streaming_id != -1);
+}
+
+/** \brief mpm search of a window of the raw stream or the http body
+ *
+ *  With streaming mpm the windows of the raw stream of a flow direction,
+ *  or of the http body of a tx, are scanned incrementally: data is only
+ *  scanned the first time it is part of a window. Otherwise, or if the
+ *  mpm context has no streaming database, the window is scanned as is.
+ *
+ *  \param body false for the raw stream, true for the http body of tx_id
+ *  \param offset stream or body offset of data
+ */
+void PrefilterStreamingSearch(DetectEngineThreadCtx *det_ctx,
+        const MpmCtx *mpm_ctx, MpmThreadCtx *mtc, Flow *f, const uint8_t flags,
+        const bool body, const uint64_t tx_id,
+        const uint8_t *data, const uint32_t data_len, const uint64_t offset)
+{
+#ifdef BUILD_HYPERSCAN
+    if (det_ctx->de_ctx->prefilter_streaming && mpm_ctx->mpm_type == MPM_HS &&
+            (mpm_ctx->flags & MPMCTX_FLAGS_STREAMING) && f != NULL) {
+        PrefilterStreamingFlowState *fs = FlowGetStorageById(f, g_prefilter_streaming_id);
+        if (fs == NULL) {
+            fs = SCCalloc(1, sizeof(*fs));
+            if (fs != NULL) {
+                FlowSetStorageById(f, g_prefilter_streaming_id, fs);
+            }
+        }
+        if (fs != NULL) {
+            const int dir = (flags & STREAM_TOSERVER) ? 0 : 1;
+            SCHSStreamState **state = &fs->stream[dir];
+            if (body) {
+                if (fs->body_tx_id[dir] != tx_id) {
+                    SCHSStreamStateFree(fs->body[dir]);
+                    fs->body[dir] = NULL;
+                    fs->body_tx_id[dir] = tx_id;
+                }
+                state = &fs->body[dir];
+            }
+            (void)SCHSStreamSearch(mpm_ctx, mtc, state, &det_ctx->pmq,
+                    data, data_len, offset);
+            return;
+        }
+    }
+#endif
+    (void)mpm_table[mpm_ctx->mpm_type].Search(mpm_ctx, mtc,
+            &det_ctx->pmq, data, data_len);
+}
@@ -63,6 +63,7 @@ void DetectRunPrefilterTx(DetectEngineThreadCtx *det_ctx,
 void PrefilterFreeEnginesList(PrefilterEngineList *list);
 
 void PrefilterSetupRuleGroup(DetectEngineCtx *de_ctx, SigGroupHead *sgh);
+void PrefilterMultiBufferPrepare(DetectEngineCtx *de_ctx);
 void PrefilterCleanupRuleGroup(const DetectEngineCtx *de_ctx, SigGroupHead *sgh);
 
 #ifdef PROFILING
@@ -80,5 +81,12 @@ int PrefilterGenericMpmPktRegister(DetectEngineCtx *de_ctx,
         SigGroupHead *sgh, MpmCtx *mpm_ctx,
         const DetectBufferMpmRegistery *mpm_reg, int list_id);
 
+void PrefilterStreamingInit(void);
+bool PrefilterStreamingAvailable(void);
+void PrefilterStreamingSearch(DetectEngineThreadCtx *det_ctx,
+        const MpmCtx *mpm_ctx, MpmThreadCtx *mtc, Flow *f, const uint8_t flags,
+        const bool body, const uint64_t tx_id,
+        const uint8_t *data, const uint32_t data_len, const uint64_t offset);
+
 
 #endif
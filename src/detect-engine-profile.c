@@ -59,17 +59,15 @@ SCMutex g_rule_dump_write_m = SCMUTEX_INITIALIZER;
 void RulesDumpMatchArray(const DetectEngineThreadCtx *det_ctx,
         const SigGroupHead *sgh, const Packet *p)
 {
-    json_t *js = CreateJSONHeader(p, LOG_DIR_PACKET, "inspectedrules", NULL);
+    JsonBuilder *js = CreateEveHeader(p, LOG_DIR_PACKET, "inspectedrules", NULL);
     if (js == NULL)
         return;
-    json_t *ir = json_object();
-    if (ir == NULL)
-        return;
 
-    json_object_set_new(ir, "rule_group_id", json_integer(sgh->id));
-    json_object_set_new(ir, "rule_cnt", json_integer(det_ctx->match_array_cnt));
+    jb_open_object(js, "inspectedrules");
+    jb_set_uint(js, "rule_group_id", sgh->id);
+    jb_set_uint(js, "rule_cnt", det_ctx->match_array_cnt);
 
-    json_t *js_array = json_array();
+    jb_open_array(js, "rules");
     uint32_t x;
     for (x = 0; x < det_ctx->match_array_cnt; x++)
     {
@@ -77,12 +75,10 @@ void RulesDumpMatchArray(const DetectEngineThreadCtx *det_ctx,
         if (s == NULL)
             continue;
 
-        json_t *js_sig = json_object();
-        if (unlikely(js_sig == NULL))
-            continue;
-        json_object_set_new(js_sig, "sig_id", json_integer(s->id));
+        jb_start_object(js);
+        jb_set_uint(js, "sig_id", s->id);
 #if 0
-        json_object_set_new(js_sig, "mpm", (s->mpm_sm != NULL) ? json_true() : json_false());
+        jb_set_bool(js, "mpm", (s->mpm_sm != NULL));
 
         if (s->mpm_sm != NULL) {
             char orig[256] = "";
@@ -90,52 +86,37 @@ void RulesDumpMatchArray(const DetectEngineThreadCtx *det_ctx,
 
             DumpFp(s->mpm_sm, orig, sizeof(orig), chop, sizeof(chop));
 
-            json_object_set_new(js_sig, "mpm_buffer", json_string(DetectListToHumanString(SigMatchListSMBelongsTo(s, s->mpm_sm))));
-            json_object_set_new(js_sig, "mpm_pattern", json_string(orig));
+            jb_set_string(js, "mpm_buffer", DetectListToHumanString(SigMatchListSMBelongsTo(s, s->mpm_sm)));
+            jb_set_string(js, "mpm_pattern", orig);
 
             if (strlen(chop) > 0) {
-                json_object_set_new(js_sig, "mpm_pattern_chop", json_string(chop));
+                jb_set_string(js, "mpm_pattern_chop", chop);
             }
         }
 #endif
-        json_array_append_new(js_array, js_sig);
+        jb_close(js);
     }
+    jb_close(js);
 
-    json_object_set_new(ir, "rules", js_array);
-    json_object_set_new(js, "inspectedrules", ir);
+    /* Close inspectedrules. */
+    jb_close(js);
+    /* Close the record. */
+    jb_close(js);
 
     const char *filename = "packet_inspected_rules.json";
     const char *log_dir = ConfigGetLogDirectory();
     char log_path[PATH_MAX] = "";
     snprintf(log_path, sizeof(log_path), "%s/%s", log_dir, filename);
 
-    MemBuffer *mbuf = NULL;
-    mbuf = MemBufferCreateNew(4096);
-    BUG_ON(mbuf == NULL);
-
-    OutputJSONMemBufferWrapper wrapper = {
-        .buffer = &mbuf,
-        .expand_by = 4096,
-    };
-
-    int r = json_dump_callback(js, OutputJSONMemBufferCallback, &wrapper,
-            JSON_PRESERVE_ORDER|JSON_COMPACT|JSON_ENSURE_ASCII|
-            JSON_ESCAPE_SLASH);
-    if (r != 0) {
-        SCLogWarning(SC_ERR_SOCKET, "unable to serialize JSON object");
-    } else {
-        MemBufferWriteString(mbuf, "\n");
-        SCMutexLock(&g_rule_dump_write_m);
-        FILE *fp = fopen(log_path, "a");
-        if (fp != NULL) {
-            MemBufferPrintToFPAsString(mbuf, fp);
-            fclose(fp);
-        }
-        SCMutexUnlock(&g_rule_dump_write_m);
+    SCMutexLock(&g_rule_dump_write_m);
+    FILE *fp = fopen(log_path, "a");
+    if (fp != NULL) {
+        fwrite(jb_ptr(js), jb_len(js), 1, fp);
+        fwrite("\n", 1, 1, fp);
+        fclose(fp);
     }
+    SCMutexUnlock(&g_rule_dump_write_m);
 
-    MemBufferFree(mbuf);
-    json_object_clear(js);
-    json_decref(js);
+    jb_free(js);
 }
 #endif /* PROFILING */
@@ -74,12 +74,14 @@
 #include "util-spm.h"
 #include "util-device.h"
 #include "util-var-name.h"
+#include "util-cpu.h"
 #include "util-profiling.h"
 
 #include "tm-threads.h"
 #include "runmodes.h"
 
 #include "reputation.h"
+#include "datasets.h"
 
 #define DETECT_ENGINE_DEFAULT_INSPECTION_RECURSION_LIMIT 3000
 
@@ -1036,6 +1038,9 @@ void InspectionBufferClean(DetectEngineThreadCtx *det_ctx)
         mbuffer->max = 0;
     }
     det_ctx->multi_inspect.to_clear_idx = 0;
+
+    /* shared transform results */
+    det_ctx->transform_cache.cnt = 0;
 }
 
 InspectionBuffer *InspectionBufferGet(DetectEngineThreadCtx *det_ctx, const int list_id)
@@ -1145,19 +1150,194 @@ void InspectionBufferCopy(InspectionBuffer *buffer, uint8_t *buf, uint32_t buf_l
     }
 }
 
-void InspectionBufferApplyTransforms(InspectionBuffer *buffer,
-        const DetectEngineTransforms *transforms)
+/** \internal
+ *  \brief get id of the shared prefix of length 'cnt' of a transform chain
+ *
+ *  Prefixes are shared by the chains of one buffer, so the buffer the
+ *  chain is applied to has to match as well.
+ *
+ *  \retval id index into DetectEngineCtx::transform_prefixes
+ *  \retval -1 prefix is not shared with another chain */
+static int TransformCachePrefixId(const DetectEngineCtx *de_ctx,
+        const DetectEngineTransforms *transforms, const int cnt)
+{
+    for (uint32_t i = 0; i < de_ctx->transform_prefixes_cnt; i++) {
+        const DetectEngineTransforms *p = &de_ctx->transform_prefixes[i];
+        if (p->cnt == cnt && p->parent_id == transforms->parent_id &&
+                memcmp(p->transforms, transforms->transforms, cnt * sizeof(int)) == 0)
+            return (int)i;
+    }
+    return -1;
+}
+
+static const DetectTransformCacheEntry *TransformCacheLookup(
+        const DetectEngineThreadCtx *det_ctx,
+        const uint8_t *input, const uint32_t input_len, const int prefix_id)
+{
+    for (uint32_t i = 0; i < det_ctx->transform_cache.cnt; i++) {
+        const DetectTransformCacheEntry *e = &det_ctx->transform_cache.entries[i];
+        if (e->prefix_id == (uint32_t)prefix_id &&
+                e->input == input && e->input_len == input_len)
+            return e;
+    }
+    return NULL;
+}
+
+static void TransformCacheStore(DetectEngineThreadCtx *det_ctx,
+        const uint8_t *input, const uint32_t input_len, const int prefix_id,
+        const InspectionBuffer *buffer)
+{
+    if (det_ctx->transform_cache.entries == NULL) {
+        det_ctx->transform_cache.entries = SCCalloc(DETECT_TRANSFORM_CACHE_SIZE,
+                sizeof(DetectTransformCacheEntry));
+        if (det_ctx->transform_cache.entries == NULL)
+            return;
+    }
+    if (det_ctx->transform_cache.cnt == DETECT_TRANSFORM_CACHE_SIZE)
+        return;
+
+    DetectTransformCacheEntry *e =
+        &det_ctx->transform_cache.entries[det_ctx->transform_cache.cnt];
+    if (e->size < buffer->inspect_len) {
+        void *ptr = SCRealloc(e->buf, buffer->inspect_len);
+        if (ptr == NULL)
+            return;
+        e->buf = ptr;
+        e->size = buffer->inspect_len;
+    }
+    if (buffer->inspect_len > 0) {
+        memcpy(e->buf, buffer->inspect, buffer->inspect_len);
+    }
+    e->len = buffer->inspect_len;
+    e->input = input;
+    e->input_len = input_len;
+    e->prefix_id = (uint32_t)prefix_id;
+    det_ctx->transform_cache.cnt++;
+}
+
+static void TransformCacheFree(DetectEngineThreadCtx *det_ctx)
+{
+    if (det_ctx->transform_cache.entries == NULL)
+        return;
+
+    for (uint32_t i = 0; i < DETECT_TRANSFORM_CACHE_SIZE; i++) {
+        if (det_ctx->transform_cache.entries[i].buf != NULL)
+            SCFree(det_ctx->transform_cache.entries[i].buf);
+    }
+    SCFree(det_ctx->transform_cache.entries);
+    det_ctx->transform_cache.entries = NULL;
+    det_ctx->transform_cache.cnt = 0;
+}
+
+/** \brief apply the transforms to the buffer
+ *
+ *  If part of the chain is shared with other transformed buffers, the
+ *  result of that part is reused from or added to the per tx cache in
+ *  the det_ctx, so that it's only computed once.
+ */
+void InspectionBufferApplyTransforms(DetectEngineThreadCtx *det_ctx,
+        InspectionBuffer *buffer, const DetectEngineTransforms *transforms)
+{
+    if (transforms == NULL || transforms->cnt == 0)
+        return;
+
+    int prefix_ids[DETECT_TRANSFORMS_MAX];
+    const uint8_t *input = buffer->inspect;
+    const uint32_t input_len = buffer->inspect_len;
+    const bool use_cache = (det_ctx != NULL && det_ctx->de_ctx != NULL &&
+            det_ctx->de_ctx->transform_prefixes_cnt > 0);
+    int start = 0;
+
+    if (use_cache) {
+        for (int i = 0; i < transforms->cnt; i++) {
+            prefix_ids[i] = TransformCachePrefixId(det_ctx->de_ctx, transforms, i + 1);
+        }
+        /* use the longest prefix we already have a result for */
+        for (int i = transforms->cnt - 1; i >= 0; i--) {
+            if (prefix_ids[i] < 0)
+                continue;
+            const DetectTransformCacheEntry *e =
+                TransformCacheLookup(det_ctx, input, input_len, prefix_ids[i]);
+            if (e != NULL) {
+                InspectionBufferCopy(buffer, e->buf, e->len);
+                if (det_ctx->tv != NULL)
+                    StatsIncr(det_ctx->tv, det_ctx->counter_transform_cache_hit);
+                SCLogDebug("reused result of %d transform(s)", i + 1);
+                start = i + 1;
+                break;
+            }
+        }
+    }
+
+    for (int i = start; i < transforms->cnt; i++) {
+        const int id = transforms->transforms[i];
+        BUG_ON(sigmatch_table[id].Transform == NULL);
+        sigmatch_table[id].Transform(buffer);
+        SCLogDebug("applied transform %s", sigmatch_table[id].name);
+
+        if (use_cache && prefix_ids[i] >= 0) {
+            TransformCacheStore(det_ctx, input, input_len, prefix_ids[i], buffer);
+            if (det_ctx->tv != NULL)
+                StatsIncr(det_ctx->tv, det_ctx->counter_transform_cache_miss);
+        }
+    }
+}
+
+/** \internal
+ *  \brief check if two transform chains start with the same 'cnt' transforms */
+static bool TransformsSharePrefix(const DetectEngineTransforms *a,
+        const DetectEngineTransforms *b, const int cnt)
 {
-    if (transforms) {
-        for (int i = 0; i < DETECT_TRANSFORMS_MAX; i++) {
-            const int id = transforms->transforms[i];
-            if (id == 0)
+    return (a->cnt >= cnt && b->cnt >= cnt &&
+            memcmp(a->transforms, b->transforms, cnt * sizeof(int)) == 0);
+}
+
+/** \brief find the transform chain prefixes that are shared by multiple
+ *         transformed buffers of the same base buffer
+ *
+ *  Only the results of these prefixes are cached at runtime.
+ */
+int DetectEngineTransformCachePrepare(DetectEngineCtx *de_ctx)
+{
+    for (uint32_t a = DETECT_SM_LIST_DYNAMIC_START; a < de_ctx->buffer_type_map_elements; a++) {
+        const DetectBufferType *map_a = de_ctx->buffer_type_map[a];
+        if (map_a == NULL || map_a->transforms.cnt == 0)
+            continue;
+
+        for (int cnt = 1; cnt <= map_a->transforms.cnt; cnt++) {
+            if (TransformCachePrefixId(de_ctx, &map_a->transforms, cnt) >= 0)
+                continue;
+
+            bool shared = false;
+            for (uint32_t b = DETECT_SM_LIST_DYNAMIC_START; b < de_ctx->buffer_type_map_elements; b++) {
+                const DetectBufferType *map_b = de_ctx->buffer_type_map[b];
+                if (b == a || map_b == NULL || map_b->parent_id != map_a->parent_id)
+                    continue;
+                if (TransformsSharePrefix(&map_a->transforms, &map_b->transforms, cnt)) {
+                    shared = true;
+                    break;
+                }
+            }
+            if (!shared)
                 break;
-            BUG_ON(sigmatch_table[id].Transform == NULL);
-            sigmatch_table[id].Transform(buffer);
-            SCLogDebug("applied transform %s", sigmatch_table[id].name);
+
+            void *ptr = SCRealloc(de_ctx->transform_prefixes,
+                    (de_ctx->transform_prefixes_cnt + 1) * sizeof(DetectEngineTransforms));
+            if (ptr == NULL)
+                return -1;
+            de_ctx->transform_prefixes = ptr;
+
+            DetectEngineTransforms *p = &de_ctx->transform_prefixes[de_ctx->transform_prefixes_cnt++];
+            memset(p, 0, sizeof(*p));
+            memcpy(p->transforms, map_a->transforms.transforms, cnt * sizeof(int));
+            p->cnt = cnt;
+            p->parent_id = map_a->parent_id;
+            SCLogDebug("buffer %s: result of first %d transform(s) is shared",
+                    map_a->string, cnt);
         }
     }
+    SCLogDebug("%u shared transform prefixes", de_ctx->transform_prefixes_cnt);
+    return 0;
 }
 
 static void DetectBufferTypeSetupDetectEngine(DetectEngineCtx *de_ctx)
@@ -1205,6 +1385,8 @@ static void DetectBufferTypeFreeDetectEngine(DetectEngineCtx *de_ctx)
             SCFree(de_ctx->buffer_type_map);
         if (de_ctx->buffer_type_hash)
             HashListTableFree(de_ctx->buffer_type_hash);
+        if (de_ctx->transform_prefixes)
+            SCFree(de_ctx->transform_prefixes);
 
         DetectEngineAppInspectionEngine *ilist = de_ctx->app_inspect_engines;
         while (ilist) {
@@ -1262,6 +1444,7 @@ int DetectBufferTypeGetByIdTransforms(DetectEngineCtx *de_ctx, const int id,
         t.transforms[i] = transforms[i];
     }
     t.cnt = transform_cnt;
+    t.parent_id = base_map->id;
 
     DetectBufferType lookup_map = { (char *)base_map->string, NULL, 0, 0, 0, 0, false, NULL, NULL, t };
     DetectBufferType *res = HashListTableLookup(de_ctx->buffer_type_hash, &lookup_map, 0);
@@ -1889,6 +2072,7 @@ static int DetectEngineReloadThreads(DetectEngineCtx *new_de_ctx)
     }
 
     SRepReloadComplete();
+    DatasetsReloadComplete();
 
     return 1;
 
@@ -2059,6 +2243,7 @@ void DetectEngineCtxFree(DetectEngineCtx *de_ctx)
     SigCleanSignatures(de_ctx);
     if (de_ctx->sig_array)
         SCFree(de_ctx->sig_array);
+    DetectEngineContentInspectionFreePrograms(de_ctx);
 
     SCClassConfDeInitContext(de_ctx);
     SCRConfDeInitContext(de_ctx);
@@ -2329,6 +2514,12 @@ static int DetectEngineCtxLoadConf(DetectEngineCtx *de_ctx)
     SCLogDebug("de_ctx->inspection_recursion_limit: %d",
                de_ctx->inspection_recursion_limit);
 
+    /* run the content inspection lists as compiled programs */
+    int inspection_vm = 1;
+    (void)ConfGetBool("detect.inspection-vm", &inspection_vm);
+    de_ctx->inspection_vm = (inspection_vm == 1);
+    SCLogDebug("de_ctx->inspection_vm: %s", de_ctx->inspection_vm ? "yes" : "no");
+
     /* parse port grouping whitelisting settings */
 
     const char *ports = NULL;
@@ -2396,6 +2587,34 @@ static int DetectEngineCtxLoadConf(DetectEngineCtx *de_ctx)
             break;
     }
 
+    int multi_buffer = 1;
+    (void)ConfGetBool("detect.prefilter.multi-buffer", &multi_buffer);
+    de_ctx->prefilter_multi_buffer = (multi_buffer && de_ctx->mpm_matcher == MPM_HS);
+    if (de_ctx->prefilter_multi_buffer) {
+        SCLogConfig("prefilter: scanning the buffers of a transaction in one call");
+    }
+
+    de_ctx->prefilter_streaming = (PrefilterStreamingAvailable() &&
+            de_ctx->mpm_matcher == MPM_HS);
+    if (de_ctx->prefilter_streaming) {
+        SCLogConfig("prefilter: scanning streams and http bodies incrementally");
+    }
+
+    /* default to a build thread per cpu */
+    intmax_t build_threads = UtilCpuGetNumProcessorsOnline();
+    const char *bt_setting = NULL;
+    if (ConfGet("detect.build-threads", &bt_setting) == 1 && bt_setting &&
+            strcasecmp(bt_setting, "auto") != 0) {
+        if (ConfGetInt("detect.build-threads", &build_threads) != 1 ||
+                build_threads < 1 || build_threads > UINT16_MAX) {
+            SCLogWarning(SC_ERR_INVALID_YAML_CONF_ENTRY, "invalid value for "
+                    "detect.build-threads: %s, using 1", bt_setting);
+            build_threads = 1;
+        }
+    }
+    de_ctx->build_threads = build_threads > 0 ? (uint16_t)MIN(build_threads, UINT16_MAX) : 1;
+    SCLogConfig("detect engine build threads: %u", de_ctx->build_threads);
+
     return 0;
 }
 
@@ -2765,6 +2984,10 @@ TmEcode DetectEngineThreadCtxInit(ThreadVars *tv, void *initdata, void **data)
 
     /** alert counter setup */
     det_ctx->counter_alerts = StatsRegisterCounter("detect.alert", tv);
+    det_ctx->counter_transform_cache_hit =
+        StatsRegisterCounter("detect.transform_cache_hit", tv);
+    det_ctx->counter_transform_cache_miss =
+        StatsRegisterCounter("detect.transform_cache_miss", tv);
 #ifdef PROFILING
     det_ctx->counter_mpm_list = StatsRegisterAvgCounter("detect.mpm_list", tv);
     det_ctx->counter_nonmpm_list = StatsRegisterAvgCounter("detect.nonmpm_list", tv);
@@ -2823,6 +3046,10 @@ static DetectEngineThreadCtx *DetectEngineThreadCtxInitForReload(
 
     /** alert counter setup */
     det_ctx->counter_alerts = StatsRegisterCounter("detect.alert", tv);
+    det_ctx->counter_transform_cache_hit =
+        StatsRegisterCounter("detect.transform_cache_hit", tv);
+    det_ctx->counter_transform_cache_miss =
+        StatsRegisterCounter("detect.transform_cache_miss", tv);
 #ifdef PROFILING
     uint16_t counter_mpm_list = StatsRegisterAvgCounter("detect.mpm_list", tv);
     uint16_t counter_nonmpm_list = StatsRegisterAvgCounter("detect.nonmpm_list", tv);
@@ -2922,6 +3149,7 @@ static void DetectEngineThreadCtxFree(DetectEngineThreadCtx *det_ctx)
     if (det_ctx->multi_inspect.to_clear_queue) {
         SCFree(det_ctx->multi_inspect.to_clear_queue);
     }
+    TransformCacheFree(det_ctx);
 
     DetectEngineThreadCtxDeinitGlobalKeywords(det_ctx);
     if (det_ctx->de_ctx != NULL) {
@@ -4462,6 +4690,94 @@ static int DetectEngineTest09(void)
     return result;
 }
 
+/** \test result of a transform chain prefix shared by two buffers is cached */
+static int DetectEngineTest10(void)
+{
+    DetectEngineCtx *de_ctx = DetectEngineCtxInit();
+    FAIL_IF_NULL(de_ctx);
+    de_ctx->flags |= DE_QUIET;
+
+    Signature *s = DetectEngineAppendSig(de_ctx, "alert http any any -> any any "
+            "(http.uri; strip_whitespace; to_md5; content:\"abc\"; sid:1;)");
+    FAIL_IF_NULL(s);
+    s = DetectEngineAppendSig(de_ctx, "alert http any any -> any any "
+            "(http.uri; strip_whitespace; to_sha256; content:\"abc\"; sid:2;)");
+    FAIL_IF_NULL(s);
+    s = DetectEngineAppendSig(de_ctx, "alert http any any -> any any "
+            "(http.uri; to_md5; content:\"abc\"; sid:3;)");
+    FAIL_IF_NULL(s);
+    s = DetectEngineAppendSig(de_ctx, "alert http any any -> any any "
+            "(http.host; strip_whitespace; to_md5; content:\"abc\"; sid:4;)");
+    FAIL_IF_NULL(s);
+    FAIL_IF(SigGroupBuild(de_ctx) != 0);
+
+    const int uri_id = DetectBufferTypeGetByName("http_uri");
+    const int host_id = DetectBufferTypeGetByName("http_host");
+    FAIL_IF_NOT(de_ctx->transform_prefixes_cnt == 1);
+    FAIL_IF_NOT(de_ctx->transform_prefixes[0].cnt == 1);
+    FAIL_IF_NOT(de_ctx->transform_prefixes[0].transforms[0] == DETECT_TRANSFORM_STRIP_WHITESPACE);
+    FAIL_IF_NOT(de_ctx->transform_prefixes[0].parent_id == uri_id);
+
+    ThreadVars tv;
+    memset(&tv, 0, sizeof(tv));
+    DetectEngineThreadCtx *det_ctx = NULL;
+    DetectEngineThreadCtxInit(&tv, (void *)de_ctx, (void *)&det_ctx);
+    FAIL_IF_NULL(det_ctx);
+
+    DetectEngineTransforms md5 = { .transforms = { DETECT_TRANSFORM_STRIP_WHITESPACE,
+            DETECT_TRANSFORM_MD5 }, .cnt = 2, .parent_id = uri_id };
+    DetectEngineTransforms sha256 = { .transforms = { DETECT_TRANSFORM_STRIP_WHITESPACE,
+            DETECT_TRANSFORM_SHA256 }, .cnt = 2, .parent_id = uri_id };
+    DetectEngineTransforms host_md5 = { .transforms = { DETECT_TRANSFORM_STRIP_WHITESPACE,
+            DETECT_TRANSFORM_MD5 }, .cnt = 2, .parent_id = host_id };
+    const uint8_t *input = (const uint8_t *)" a b c ";
+    const uint32_t input_len = strlen((char *)input);
+
+    InspectionBuffer buffer1;
+    InspectionBufferInit(&buffer1, 8);
+    InspectionBufferSetup(&buffer1, input, input_len);
+    InspectionBufferApplyTransforms(det_ctx, &buffer1, &md5);
+    FAIL_IF_NOT(buffer1.inspect_len == 16);
+    FAIL_IF_NOT(det_ctx->transform_cache.cnt == 1);
+    FAIL_IF_NOT(det_ctx->transform_cache.entries[0].len == 3);
+    FAIL_IF_NOT(memcmp(det_ctx->transform_cache.entries[0].buf, "abc", 3) == 0);
+
+    /* reuses the stripped data */
+    InspectionBuffer buffer2;
+    InspectionBufferInit(&buffer2, 8);
+    InspectionBufferSetup(&buffer2, input, input_len);
+    InspectionBufferApplyTransforms(det_ctx, &buffer2, &sha256);
+    FAIL_IF_NOT(det_ctx->transform_cache.cnt == 1);
+
+    /* same result as without the cache */
+    InspectionBuffer buffer3;
+    InspectionBufferInit(&buffer3, 8);
+    InspectionBufferSetup(&buffer3, input, input_len);
+    InspectionBufferApplyTransforms(NULL, &buffer3, &sha256);
+    FAIL_IF_NOT(buffer3.inspect_len == 32);
+    FAIL_IF_NOT(buffer2.inspect_len == buffer3.inspect_len);
+    FAIL_IF_NOT(memcmp(buffer2.inspect, buffer3.inspect, buffer3.inspect_len) == 0);
+
+    InspectionBufferClean(det_ctx);
+    FAIL_IF_NOT(det_ctx->transform_cache.cnt == 0);
+
+    /* the prefix is only shared by the http.uri chains */
+    InspectionBuffer buffer4;
+    InspectionBufferInit(&buffer4, 8);
+    InspectionBufferSetup(&buffer4, input, input_len);
+    InspectionBufferApplyTransforms(det_ctx, &buffer4, &host_md5);
+    FAIL_IF_NOT(buffer4.inspect_len == 16);
+    FAIL_IF_NOT(det_ctx->transform_cache.cnt == 0);
+
+    InspectionBufferFree(&buffer1);
+    InspectionBufferFree(&buffer2);
+    InspectionBufferFree(&buffer3);
+    InspectionBufferFree(&buffer4);
+    DetectEngineThreadCtxDeinit(&tv, (void *)det_ctx);
+    DetectEngineCtxFree(de_ctx);
+    PASS;
+}
+
 #endif
 
 void DetectEngineRegisterTests()
@@ -4473,6 +4789,7 @@ void DetectEngineRegisterTests()
     UtRegisterTest("DetectEngineTest04", DetectEngineTest04);
     UtRegisterTest("DetectEngineTest08", DetectEngineTest08);
     UtRegisterTest("DetectEngineTest09", DetectEngineTest09);
+    UtRegisterTest("DetectEngineTest10", DetectEngineTest10);
 #endif
     return;
 }
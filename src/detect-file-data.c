@@ -74,6 +74,9 @@ static int DetectEngineInspectFiledata(
 int PrefilterMpmFiledataRegister(DetectEngineCtx *de_ctx,
         SigGroupHead *sgh, MpmCtx *mpm_ctx,
         const DetectBufferMpmRegistery *mpm_reg, int list_id);
+static int PrefilterMpmHTTPFiledataRegister(DetectEngineCtx *de_ctx,
+        SigGroupHead *sgh, MpmCtx *mpm_ctx,
+        const DetectBufferMpmRegistery *mpm_reg, int list_id);
 
 /**
  * \brief Registration function for keyword: file_data
@@ -94,7 +97,7 @@ void DetectFiledataRegister(void)
             PrefilterMpmFiledataRegister, NULL,
             ALPROTO_SMTP, 0);
     DetectAppLayerMpmRegister2("file_data", SIG_FLAG_TOCLIENT, 2,
-            PrefilterGenericMpmRegister,
+            PrefilterMpmHTTPFiledataRegister,
             HttpServerBodyGetDataCallback,
             ALPROTO_HTTP, HTP_RESPONSE_BODY);
     DetectAppLayerMpmRegister2("file_data", SIG_FLAG_TOSERVER, 2,
@@ -384,7 +387,7 @@ static InspectionBuffer *FiledataGetDataCallback(DetectEngineThreadCtx *det_ctx,
             cur_file->content_inspected);
     InspectionBufferSetup(buffer, data, data_len);
     buffer->inspect_offset = cur_file->content_inspected;
-    InspectionBufferApplyTransforms(buffer, transforms);
+    InspectionBufferApplyTransforms(det_ctx, buffer, transforms);
 
     /* update inspected tracker */
     cur_file->content_inspected = file_size;
@@ -524,6 +527,60 @@ int PrefilterMpmFiledataRegister(DetectEngineCtx *de_ctx,
             pectx, PrefilterMpmFiledataFree, mpm_reg->pname);
 }
 
+/** \brief HTTP server body mpm prefilter callback
+ *
+ *  Like the generic mpm prefilter, but the body is scanned incrementally
+ *  if it wasn't altered by a transform or swf decompression.
+ */
+static void PrefilterTxHTTPFiledata(DetectEngineThreadCtx *det_ctx,
+        const void *pectx,
+        Packet *p, Flow *f, void *txv,
+        const uint64_t idx, const uint8_t flags)
+{
+    SCEnter();
+
+    const PrefilterMpmFiledata *ctx = (const PrefilterMpmFiledata *)pectx;
+    const MpmCtx *mpm_ctx = ctx->mpm_ctx;
+
+    InspectionBuffer *buffer = HttpServerBodyGetDataCallback(det_ctx,
+            ctx->transforms, f, flags, txv, ctx->list_id);
+    if (buffer == NULL || buffer->inspect_len < mpm_ctx->minlen)
+        return;
+
+    if (buffer->inspect == buffer->orig) {
+        PrefilterStreamingSearch(det_ctx, mpm_ctx, &det_ctx->mtcu, f, flags,
+                true, idx, buffer->inspect, buffer->inspect_len,
+                buffer->inspect_offset);
+    } else {
+        (void)mpm_table[mpm_ctx->mpm_type].Search(mpm_ctx,
+                &det_ctx->mtcu, &det_ctx->pmq,
+                buffer->inspect, buffer->inspect_len);
+    }
+}
+
+static int PrefilterMpmHTTPFiledataRegister(DetectEngineCtx *de_ctx,
+        SigGroupHead *sgh, MpmCtx *mpm_ctx,
+        const DetectBufferMpmRegistery *mpm_reg, int list_id)
+{
+    /* transformed bodies are not scanned incrementally, leave them to the
+     * generic engine, which may be merged with other buffers */
+    if (!de_ctx->prefilter_streaming || mpm_reg->transforms.cnt > 0) {
+        return PrefilterGenericMpmRegister(de_ctx, sgh, mpm_ctx, mpm_reg, list_id);
+    }
+
+    PrefilterMpmFiledata *pectx = SCCalloc(1, sizeof(*pectx));
+    if (pectx == NULL)
+        return -1;
+    pectx->list_id = list_id;
+    pectx->mpm_ctx = mpm_ctx;
+    pectx->transforms = &mpm_reg->transforms;
+    mpm_ctx->flags |= MPMCTX_FLAGS_STREAMING;
+
+    return PrefilterAppendTxEngine(de_ctx, sgh, PrefilterTxHTTPFiledata,
+            mpm_reg->app_v2.alproto, mpm_reg->app_v2.tx_min_progress,
+            pectx, PrefilterMpmFiledataFree, mpm_reg->pname);
+}
+
 #ifdef UNITTESTS
 #include "tests/detect-file-data.c"
 #endif
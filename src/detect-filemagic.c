@@ -461,7 +461,7 @@ static InspectionBuffer *FilemagicGetDataCallback(DetectEngineThreadCtx *det_ctx
     uint32_t data_len = (uint32_t)strlen(cur_file->magic);
 
     InspectionBufferSetup(buffer, data, data_len);
-    InspectionBufferApplyTransforms(buffer, transforms);
+    InspectionBufferApplyTransforms(det_ctx, buffer, transforms);
 
     SCReturnPtr(buffer, "InspectionBuffer");
 }
@@ -366,7 +366,7 @@ static InspectionBuffer *FilenameGetDataCallback(DetectEngineThreadCtx *det_ctx,
     uint32_t data_len = cur_file->name_len;
 
     InspectionBufferSetup(buffer, data, data_len);
-    InspectionBufferApplyTransforms(buffer, transforms);
+    InspectionBufferApplyTransforms(det_ctx, buffer, transforms);
 
     SCReturnPtr(buffer, "InspectionBuffer");
 }
@@ -190,7 +190,7 @@ static void PrefilterTxHttpRequestHeaderNames(DetectEngineThreadCtx *det_ctx,
 
         /* setup buffer and apply transforms */
         InspectionBufferSetup(buffer, rawdata, rawdata_len);
-        InspectionBufferApplyTransforms(buffer, ctx->transforms);
+        InspectionBufferApplyTransforms(det_ctx, buffer, ctx->transforms);
     }
 
     const uint32_t data_len = buffer->inspect_len;
@@ -268,7 +268,7 @@ static void PrefilterTxHttpResponseHeaderNames(DetectEngineThreadCtx *det_ctx,
 
         /* setup buffer and apply transforms */
         InspectionBufferSetup(buffer, rawdata, rawdata_len);
-        InspectionBufferApplyTransforms(buffer, ctx->transforms);
+        InspectionBufferApplyTransforms(det_ctx, buffer, ctx->transforms);
     }
 
     const uint32_t data_len = buffer->inspect_len;
@@ -333,7 +333,7 @@ static int InspectEngineHttpHeaderNames(
         }
         /* setup buffer and apply transforms */
         InspectionBufferSetup(buffer, rawdata, rawdata_len);
-        InspectionBufferApplyTransforms(buffer, transforms);
+        InspectionBufferApplyTransforms(det_ctx, buffer, transforms);
     }
 
     const uint32_t data_len = buffer->inspect_len;
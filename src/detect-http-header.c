@@ -177,7 +177,7 @@ static int DetectEngineInspectBufferHttpHeader(
         }
         /* setup buffer and apply transforms */
         InspectionBufferSetup(buffer, rawdata, rawdata_len);
-        InspectionBufferApplyTransforms(buffer, transforms);
+        InspectionBufferApplyTransforms(det_ctx, buffer, transforms);
     }
 
     const uint32_t data_len = buffer->inspect_len;
@@ -244,7 +244,7 @@ static void PrefilterMpmHttpHeader(DetectEngineThreadCtx *det_ctx,
 
         /* setup buffer and apply transforms */
         InspectionBufferSetup(buffer, rawdata, rawdata_len);
-        InspectionBufferApplyTransforms(buffer, ctx->transforms);
+        InspectionBufferApplyTransforms(det_ctx, buffer, ctx->transforms);
     }
 
     const uint32_t data_len = buffer->inspect_len;
@@ -191,7 +191,7 @@ static void PrefilterTxHttpRequestStart(DetectEngineThreadCtx *det_ctx,
 
         /* setup buffer and apply transforms */
         InspectionBufferSetup(buffer, rawdata, rawdata_len);
-        InspectionBufferApplyTransforms(buffer, ctx->transforms);
+        InspectionBufferApplyTransforms(det_ctx, buffer, ctx->transforms);
     }
 
     const uint32_t data_len = buffer->inspect_len;
@@ -265,7 +265,7 @@ static void PrefilterTxHttpResponseStart(DetectEngineThreadCtx *det_ctx,
 
         /* setup buffer and apply transforms */
         InspectionBufferSetup(buffer, rawdata, rawdata_len);
-        InspectionBufferApplyTransforms(buffer, ctx->transforms);
+        InspectionBufferApplyTransforms(det_ctx, buffer, ctx->transforms);
     }
 
     const uint32_t data_len = buffer->inspect_len;
@@ -330,7 +330,7 @@ static int InspectEngineHttpStart(
         }
         /* setup buffer and apply transforms */
         InspectionBufferSetup(buffer, rawdata, rawdata_len);
-        InspectionBufferApplyTransforms(buffer, transforms);
+        InspectionBufferApplyTransforms(det_ctx, buffer, transforms);
     }
 
     const uint32_t data_len = buffer->inspect_len;
@@ -60,6 +60,10 @@
 #include "app-layer-parser.h"
 #include "util-pages.h"
 
+#ifdef BUILD_HYPERSCAN
+#include <hs.h>
+#endif
+
 /* pcre named substring capture supports only 32byte names, A-z0-9 plus _
  * and needs to start with non-numeric. */
 #define PARSE_CAPTURE_REGEX "\\(\\?P\\<([A-z]+)\\_([A-z0-9_]+)\\>"
@@ -74,36 +78,90 @@ static int pcre_match_limit_recursion = 0;
 static DetectParseRegex parse_regex;
 static DetectParseRegex parse_capture_regex;
 
-#ifdef PCRE_HAVE_JIT
-static int pcre_use_jit = 1;
+static int pcre2_use_jit = 1;
+
+/* before 10.30 the depth limit was called the recursion limit */
+#if PCRE2_MAJOR == 10 && PCRE2_MINOR < 30
+#define pcre2_set_depth_limit pcre2_set_recursion_limit
 #endif
 
-#ifdef PCRE_HAVE_JIT_EXEC
 #define PCRE_JIT_MIN_STACK 32*1024
 #define PCRE_JIT_MAX_STACK 512*1024
 
+/* ovector pairs of the per thread match data, enough for the whole match
+ * and DETECT_PCRE_CAPTURE_MAX captures plus the value of a key */
+#define PCRE_MATCH_DATA_PAIRS (DETECT_PCRE_CAPTURE_MAX + 2)
+
+/* per thread context to run the regexes with */
+typedef struct DetectPcreThreadCtx_ {
+    pcre2_match_data *match_data;
+    pcre2_match_context *match_ctx;
+    pcre2_jit_stack *jit_stack;
+} DetectPcreThreadCtx;
+
+#ifdef BUILD_HYPERSCAN
+/* check the buffer with a hyperscan prefilter db before running pcre */
+static int pcre_hs_prefilter = 0;
+
+/* prototype scratch for the prefilter dbs, cloned per thread. Protected
+ * by g_pcre_hs_scratch_proto_mutex. */
+static hs_scratch_t *g_pcre_hs_scratch_proto = NULL;
+static SCMutex g_pcre_hs_scratch_proto_mutex = SCMUTEX_INITIALIZER;
 #endif
 
-/* \brief Helper function for using pcre_exec with/without JIT
+/* \brief Helper function to run the regex with the match data, limits and
+ *         JIT stack of the thread
+ *
+ *  \param ctx thread ctx, NULL if there is none
+ *  \param match_data set to the match data holding the ovector, owned
+ *         by the thread ctx or, without one, by the thread
  */
-static inline int DetectPcreExec(DetectEngineThreadCtx *det_ctx, DetectPcreData *pd, DetectParseRegex *regex,
-        const char *str, const size_t strlen, int start_offset, int options,  int *ovector, int ovector_size)
-{
-#ifdef PCRE_HAVE_JIT_EXEC
-    if (pd->thread_ctx_jit_stack_id != -1) {
-        pcre_jit_stack *jit_stack = (pcre_jit_stack *)
-            DetectThreadCtxGetKeywordThreadCtx(det_ctx, pd->thread_ctx_jit_stack_id);
-        if (jit_stack) {
-            SCLogDebug("Using jit_stack %p", jit_stack);
-            return pcre_jit_exec(regex->regex, regex->study, str, strlen,
-                                start_offset, options, ovector, ovector_size,
-                                jit_stack);
-        }
+static inline int DetectPcreExec(DetectPcreThreadCtx *ctx, const DetectPcreData *pd,
+        const uint8_t *str, const uint32_t strlen, const uint32_t start_offset,
+        pcre2_match_data **match_data)
+{
+    if (ctx != NULL) {
+        pcre2_set_match_limit(ctx->match_ctx, pd->match_limit);
+        pcre2_set_depth_limit(ctx->match_ctx, pd->depth_limit);
+        *match_data = ctx->match_data;
+        return pcre2_match(pd->re, (PCRE2_SPTR8)str, strlen, start_offset, 0,
+                ctx->match_data, ctx->match_ctx);
     }
-#endif
-    /* Fallback if registration during setup failed */
-    return pcre_exec(regex->regex, regex->study, str, strlen,
-                     start_offset, options, ovector, ovector_size);
+
+    /* Fallback if registration during setup failed: the regex's own
+     * match context holds its limits, the match data is kept per thread */
+    static thread_local pcre2_match_data *fallback_match_data = NULL;
+    if (fallback_match_data == NULL) {
+        fallback_match_data = pcre2_match_data_create(PCRE_MATCH_DATA_PAIRS, NULL);
+        if (fallback_match_data == NULL)
+            return PCRE2_ERROR_NOMEMORY;
+    }
+    *match_data = fallback_match_data;
+    return pcre2_match(pd->re, (PCRE2_SPTR8)str, strlen, start_offset, 0,
+            fallback_match_data, pd->match_ctx);
+}
+
+/** \internal
+ *  \brief copy capture n of a match, so that it can be stored in a var
+ *
+ *  \retval len length of the capture, 0 if it is empty or unset
+ */
+static uint32_t DetectPcreGetCapture(const uint8_t *ptr, pcre2_match_data *match_data,
+        const int cnt, const int n, uint8_t **str)
+{
+    const PCRE2_SIZE *ov = pcre2_get_ovector_pointer(match_data);
+
+    *str = NULL;
+    if (n >= cnt || ov[2 * n] == PCRE2_UNSET || ov[2 * n + 1] <= ov[2 * n])
+        return 0;
+
+    const uint32_t len = (uint32_t)(ov[2 * n + 1] - ov[2 * n]);
+    *str = SCMalloc(len + 1);
+    if (unlikely(*str == NULL))
+        return 0;
+    memcpy(*str, ptr + ov[2 * n], len);
+    (*str)[len] = '\0';
+    return len;
 }
 
 static int DetectPcreSetup (DetectEngineCtx *, Signature *, const char *);
@@ -151,22 +209,61 @@ void DetectPcreRegister (void)
         }
     }
 
+#ifdef BUILD_HYPERSCAN
+    if (ConfGetBool("pcre.hyperscan-prefilter", &pcre_hs_prefilter) != 1)
+        pcre_hs_prefilter = 0;
+    SCLogDebug("PCRE hyperscan prefilter %s", pcre_hs_prefilter ? "enabled" : "disabled");
+#endif
+
     DetectSetupParseRegexes(PARSE_REGEX, &parse_regex);
 
     /* setup the capture regex, as it needs PCRE_UNGREEDY we do it manually */
     int opts = PCRE_UNGREEDY; /* pkt_http_ua should be pkt, http_ua, for this reason the UNGREEDY */
     DetectSetupParseRegexesOpts(PARSE_CAPTURE_REGEX, &parse_capture_regex, opts);
 
-#ifdef PCRE_HAVE_JIT
-    if (PageSupportsRWX() == 0) {
+    uint32_t jit = 0;
+    if (pcre2_config(PCRE2_CONFIG_JIT, &jit) < 0 || jit == 0) {
+        SCLogConfig("PCRE2 has no JIT support");
+        pcre2_use_jit = 0;
+    } else if (PageSupportsRWX() == 0) {
         SCLogConfig("PCRE won't use JIT as OS doesn't allow RWX pages");
-        pcre_use_jit = 0;
+        pcre2_use_jit = 0;
     }
-#endif
 
     return;
 }
 
+#ifdef BUILD_HYPERSCAN
+static int DetectPcreHSOnMatch(unsigned int id, unsigned long long from,
+        unsigned long long to, unsigned int flags, void *ctx)
+{
+    *(int *)ctx = 1;
+    /* one match is enough */
+    return 1;
+}
+
+/** \internal
+ *  \brief see if the regex can match the data at all
+ *
+ *  \retval false the regex won't match
+ */
+static inline bool DetectPcreHSPrefilter(DetectEngineThreadCtx *det_ctx,
+        const DetectPcreData *pe, const uint8_t *ptr, uint32_t len)
+{
+    hs_scratch_t *scratch = (hs_scratch_t *)
+        DetectThreadCtxGetKeywordThreadCtx(det_ctx, pe->thread_ctx_hs_scratch_id);
+    if (scratch == NULL)
+        return true;
+
+    int hit = 0;
+    hs_error_t err = hs_scan(pe->hs_db, (const char *)ptr, len, 0, scratch,
+            DetectPcreHSOnMatch, &hit);
+    if (err != HS_SUCCESS && err != HS_SCAN_TERMINATED)
+        return true;
+    return (hit != 0);
+}
+#endif
+
 /**
  * \brief Match a regex on a single payload.
  *
@@ -187,7 +284,6 @@ int DetectPcrePayloadMatch(DetectEngineThreadCtx *det_ctx, const Signature *s,
 {
     SCEnter();
     int ret = 0;
-    int ov[MAX_SUBSTRINGS];
     const uint8_t *ptr = NULL;
     uint16_t len = 0;
     uint16_t capture_len = 0;
@@ -207,11 +303,25 @@ int DetectPcrePayloadMatch(DetectEngineThreadCtx *det_ctx, const Signature *s,
         start_offset = (payload + det_ctx->pcre_match_start_offset - ptr);
     }
 
+#ifdef BUILD_HYPERSCAN
+    /* no need to check again when looking for the next match */
+    if (pe->hs_db != NULL && start_offset == 0 &&
+            !DetectPcreHSPrefilter(det_ctx, pe, ptr, len)) {
+        SCLogDebug("hyperscan prefilter: no match");
+        SCReturnInt(0);
+    }
+#endif
+
     /* run the actual pcre detection */
-    ret = DetectPcreExec(det_ctx, pe, &pe->parse_regex, (char *) ptr, len, start_offset, 0, ov, MAX_SUBSTRINGS);
+    DetectPcreThreadCtx *thread_ctx = NULL;
+    if (pe->thread_ctx_id != -1) {
+        thread_ctx = DetectThreadCtxGetKeywordThreadCtx(det_ctx, pe->thread_ctx_id);
+    }
+    pcre2_match_data *match_data = NULL;
+    ret = DetectPcreExec(thread_ctx, pe, ptr, len, start_offset, &match_data);
     SCLogDebug("ret %d (negating %s)", ret, (pe->flags & DETECT_PCRE_NEGATE) ? "set" : "not set");
 
-    if (ret == PCRE_ERROR_NOMATCH) {
+    if (ret == PCRE2_ERROR_NOMATCH) {
         if (pe->flags & DETECT_PCRE_NEGATE) {
             /* regex didn't match with negate option means we
              * consider it a match */
@@ -232,55 +342,60 @@ int DetectPcrePayloadMatch(DetectEngineThreadCtx *det_ctx, const Signature *s,
 
             /* see if we need to do substring capturing. */
             if (ret > 1 && pe->idx != 0) {
+                const int cnt = ret;
                 uint8_t x;
                 for (x = 0; x < pe->idx; x++) {
                     SCLogDebug("capturing %u", x);
-                    const char *str_ptr = NULL;
-                    ret = pcre_get_substring((char *)ptr, ov, MAX_SUBSTRINGS, x+1, &str_ptr);
-                    if (unlikely(ret == 0)) {
-                        pcre_free_substring(str_ptr);
+                    uint8_t *str_ptr = NULL;
+                    const uint32_t str_len = DetectPcreGetCapture(ptr,
+                            match_data, cnt, x + 1, &str_ptr);
+                    if (unlikely(str_len == 0)) {
+                        SCFree(str_ptr);
                         continue;
                     }
 
                     SCLogDebug("data %p/%u, type %u id %u p %p",
-                            str_ptr, ret, pe->captypes[x], pe->capids[x], p);
+                            str_ptr, str_len, pe->captypes[x], pe->capids[x], p);
 
                     if (pe->captypes[x] == VAR_TYPE_PKT_VAR_KV) {
                         /* get the value, as first capture is the key */
-                        const char *str_ptr2 = NULL;
-                        int ret2 = pcre_get_substring((char *)ptr, ov, MAX_SUBSTRINGS, x+2, &str_ptr2);
-                        if (unlikely(ret2 == 0)) {
-                            pcre_free_substring(str_ptr);
-                            pcre_free_substring(str_ptr2);
+                        uint8_t *str_ptr2 = NULL;
+                        const uint32_t str_len2 = DetectPcreGetCapture(ptr,
+                                match_data, cnt, x + 2, &str_ptr2);
+                        if (unlikely(str_len2 == 0)) {
+                            SCFree(str_ptr);
+                            SCFree(str_ptr2);
                             break;
                         }
                         /* key length is limited to 256 chars */
-                        uint16_t key_len = (ret < 0xff) ? (uint16_t)ret : 0xff;
-                        capture_len = (ret2 < 0xffff) ? (uint16_t)ret2 : 0xffff;
+                        uint16_t key_len = (str_len < 0xff) ? (uint16_t)str_len : 0xff;
+                        capture_len = (str_len2 < 0xffff) ? (uint16_t)str_len2 : 0xffff;
 
                         (void)DetectVarStoreMatchKeyValue(det_ctx,
-                                (uint8_t *)str_ptr, key_len,
-                                (uint8_t *)str_ptr2, capture_len,
+                                str_ptr, key_len, str_ptr2, capture_len,
                                 DETECT_VAR_TYPE_PKT_POSTMATCH);
 
                     } else if (pe->captypes[x] == VAR_TYPE_PKT_VAR) {
                         /* store max 64k. Errors are ignored */
-                        capture_len = (ret < 0xffff) ? (uint16_t)ret : 0xffff;
+                        capture_len = (str_len < 0xffff) ? (uint16_t)str_len : 0xffff;
                         (void)DetectVarStoreMatch(det_ctx, pe->capids[x],
-                                (uint8_t *)str_ptr, capture_len,
+                                str_ptr, capture_len,
                                 DETECT_VAR_TYPE_PKT_POSTMATCH);
 
                     } else if (pe->captypes[x] == VAR_TYPE_FLOW_VAR && f != NULL) {
                         /* store max 64k. Errors are ignored */
-                        capture_len = (ret < 0xffff) ? (uint16_t)ret : 0xffff;
+                        capture_len = (str_len < 0xffff) ? (uint16_t)str_len : 0xffff;
                         (void)DetectVarStoreMatch(det_ctx, pe->capids[x],
-                                (uint8_t *)str_ptr, capture_len,
+                                str_ptr, capture_len,
                                 DETECT_VAR_TYPE_FLOW_POSTMATCH);
+                    } else {
+                        SCFree(str_ptr);
                     }
                 }
             }
 
             /* update offset for pcre RELATIVE */
+            const PCRE2_SIZE *ov = pcre2_get_ovector_pointer(match_data);
             det_ctx->buffer_offset = (ptr + ov[1]) - payload;
             det_ctx->pcre_match_start_offset = (ptr + ov[0] + 1) - payload;
 
@@ -336,14 +451,84 @@ static int DetectPcreHasUpperCase(const char *re)
     return 0;
 }
 
+#ifdef BUILD_HYPERSCAN
+/** \internal
+ *  \brief compile the regex as a hyperscan db in prefilter mode
+ *
+ *  The db matches at least everything the regex matches, so if it doesn't
+ *  match, pcre doesn't need to run. Regexes hyperscan can't compile are
+ *  always run through pcre.
+ */
+static void DetectPcreHSPrefilterSetup(DetectPcreData *pd, const char *re, uint32_t opts)
+{
+    /* a negated regex that hits the match limit doesn't match, so
+     * 'can't match' doesn't give the result for it */
+    if (pd->flags & DETECT_PCRE_NEGATE)
+        return;
+    /* changes the syntax of the regex */
+    if (opts & PCRE2_EXTENDED)
+        return;
+
+    /* anchoring, ungreedy and dollar endonly only make the regex match
+     * less, so they can be left out */
+    unsigned int flags = HS_FLAG_PREFILTER | HS_FLAG_SINGLEMATCH;
+    if (opts & PCRE2_CASELESS)
+        flags |= HS_FLAG_CASELESS;
+    if (opts & PCRE2_MULTILINE)
+        flags |= HS_FLAG_MULTILINE;
+    if (opts & PCRE2_DOTALL)
+        flags |= HS_FLAG_DOTALL;
+
+    hs_database_t *db = NULL;
+    hs_compile_error_t *compile_err = NULL;
+    if (hs_compile(re, flags, HS_MODE_BLOCK, NULL, &db, &compile_err) != HS_SUCCESS) {
+        SCLogDebug("no hyperscan prefilter for \"%s\": %s", re,
+                compile_err ? compile_err->message : "unknown error");
+        hs_free_compile_error(compile_err);
+        return;
+    }
+
+    SCMutexLock(&g_pcre_hs_scratch_proto_mutex);
+    hs_error_t err = hs_alloc_scratch(db, &g_pcre_hs_scratch_proto);
+    SCMutexUnlock(&g_pcre_hs_scratch_proto_mutex);
+    if (err != HS_SUCCESS) {
+        SCLogDebug("failed to allocate scratch for \"%s\"", re);
+        hs_free_database(db);
+        return;
+    }
+    pd->hs_db = db;
+}
+
+static void *DetectPcreHSThreadInit(void *data /*@unused@*/)
+{
+    hs_scratch_t *scratch = NULL;
+
+    SCMutexLock(&g_pcre_hs_scratch_proto_mutex);
+    if (g_pcre_hs_scratch_proto != NULL &&
+            hs_clone_scratch(g_pcre_hs_scratch_proto, &scratch) != HS_SUCCESS) {
+        SCLogWarning(SC_ERR_MEM_ALLOC, "Unable to clone pcre hyperscan scratch; "
+                "will continue without prefilter");
+        scratch = NULL;
+    }
+    SCMutexUnlock(&g_pcre_hs_scratch_proto_mutex);
+
+    return (void *)scratch;
+}
+
+static void DetectPcreHSThreadFree(void *ctx)
+{
+    if (ctx != NULL)
+        hs_free_scratch((hs_scratch_t *)ctx);
+}
+#endif /* BUILD_HYPERSCAN */
+
 static DetectPcreData *DetectPcreParse (DetectEngineCtx *de_ctx,
         const char *regexstr, int *sm_list, char *capture_names,
         size_t capture_names_size, bool negate, AppProto *alproto)
 {
     int ec;
-    const char *eb;
-    int eo;
-    int opts = 0;
+    PCRE2_SIZE eo;
+    uint32_t opts = 0;
     DetectPcreData *pd = NULL;
     char *op = NULL;
     int ret = 0, res = 0;
@@ -430,27 +615,27 @@ static DetectPcreData *DetectPcreParse (DetectEngineCtx *de_ctx,
 
             switch (*op) {
                 case 'A':
-                    opts |= PCRE_ANCHORED;
+                    opts |= PCRE2_ANCHORED;
                     break;
                 case 'E':
-                    opts |= PCRE_DOLLAR_ENDONLY;
+                    opts |= PCRE2_DOLLAR_ENDONLY;
                     break;
                 case 'G':
-                    opts |= PCRE_UNGREEDY;
+                    opts |= PCRE2_UNGREEDY;
                     break;
 
                 case 'i':
-                    opts |= PCRE_CASELESS;
+                    opts |= PCRE2_CASELESS;
                     pd->flags |= DETECT_PCRE_CASELESS;
                     break;
                 case 'm':
-                    opts |= PCRE_MULTILINE;
+                    opts |= PCRE2_MULTILINE;
                     break;
                 case 's':
-                    opts |= PCRE_DOTALL;
+                    opts |= PCRE2_DOTALL;
                     break;
                 case 'x':
-                    opts |= PCRE_EXTENDED;
+                    opts |= PCRE2_EXTENDED;
                     break;
 
                 case 'O':
@@ -621,35 +806,25 @@ static DetectPcreData *DetectPcreParse (DetectEngineCtx *de_ctx,
      * PCRE will let us know.
      */
     if (capture_names == NULL || strlen(capture_names) == 0)
-        opts |= PCRE_NO_AUTO_CAPTURE;
-
-    pd->parse_regex.regex = pcre_compile2(re, opts, &ec, &eb, &eo, NULL);
-    if (pd->parse_regex.regex == NULL && ec == 15) { // reference to non-existent subpattern
-        opts &= ~PCRE_NO_AUTO_CAPTURE;
-        pd->parse_regex.regex = pcre_compile(re, opts, &eb, &eo, NULL);
+        opts |= PCRE2_NO_AUTO_CAPTURE;
+
+    pd->re = pcre2_compile((PCRE2_SPTR8)re, PCRE2_ZERO_TERMINATED, opts,
+            &ec, &eo, NULL);
+    if (pd->re == NULL && ec == 115) { // reference to non-existent subpattern
+        opts &= ~PCRE2_NO_AUTO_CAPTURE;
+        pd->re = pcre2_compile((PCRE2_SPTR8)re, PCRE2_ZERO_TERMINATED, opts,
+                &ec, &eo, NULL);
     }
 
-    if (pd->parse_regex.regex == NULL)  {
+    if (pd->re == NULL)  {
+        PCRE2_UCHAR eb[256];
+        pcre2_get_error_message(ec, eb, sizeof(eb));
         SCLogError(SC_ERR_PCRE_COMPILE, "pcre compile of \"%s\" failed "
-                "at offset %" PRId32 ": %s", regexstr, eo, eb);
-        goto error;
-    }
-
-    int options = 0;
-#ifdef PCRE_HAVE_JIT
-    if (pcre_use_jit)
-        options |= PCRE_STUDY_JIT_COMPILE;
-#endif
-    pd->parse_regex.study = pcre_study(pd->parse_regex.regex, options, &eb);
-    if(eb != NULL)  {
-        SCLogError(SC_ERR_PCRE_STUDY, "pcre study failed : %s", eb);
+                "at offset %" PRIuMAX ": %s", regexstr, (uintmax_t)eo, eb);
         goto error;
     }
 
-#ifdef PCRE_HAVE_JIT
-    int jit = 0;
-    ret = pcre_fullinfo(pd->parse_regex.regex, pd->parse_regex.study, PCRE_INFO_JIT, &jit);
-    if (ret != 0 || jit != 1) {
+    if (pcre2_use_jit && pcre2_jit_compile(pd->re, PCRE2_JIT_COMPLETE) != 0) {
         /* warning, so we won't print the sig after this. Adding
          * file and line to the message so the admin can figure
          * out what sig this is about */
@@ -658,34 +833,28 @@ static DetectPcreData *DetectPcreParse (DetectEngineCtx *de_ctx,
                 regexstr, de_ctx->rule_file, de_ctx->rule_line);
     }
 
-#endif /*PCRE_HAVE_JIT*/
-
-    if (pd->parse_regex.study == NULL)
-        pd->parse_regex.study = (pcre_extra *) SCCalloc(1,sizeof(pcre_extra));
-
-    if (pd->parse_regex.study) {
-        if(pd->flags & DETECT_PCRE_MATCH_LIMIT) {
-            if(pcre_match_limit >= -1)    {
-                pd->parse_regex.study->match_limit = pcre_match_limit;
-                pd->parse_regex.study->flags |= PCRE_EXTRA_MATCH_LIMIT;
-            }
-#ifndef NO_PCRE_MATCH_RLIMIT
-            if(pcre_match_limit_recursion >= -1)    {
-                pd->parse_regex.study->match_limit_recursion = pcre_match_limit_recursion;
-                pd->parse_regex.study->flags |= PCRE_EXTRA_MATCH_LIMIT_RECURSION;
-            }
-#endif /* NO_PCRE_MATCH_RLIMIT */
-        } else {
-            pd->parse_regex.study->match_limit = SC_MATCH_LIMIT_DEFAULT;
-            pd->parse_regex.study->flags |= PCRE_EXTRA_MATCH_LIMIT;
-#ifndef NO_PCRE_MATCH_RLIMIT
-            pd->parse_regex.study->match_limit_recursion = SC_MATCH_LIMIT_RECURSION_DEFAULT;
-            pd->parse_regex.study->flags |= PCRE_EXTRA_MATCH_LIMIT_RECURSION;
-#endif /* NO_PCRE_MATCH_RLIMIT */
-        }
+    if (pd->flags & DETECT_PCRE_MATCH_LIMIT) {
+        pd->match_limit = pcre_match_limit > 0 ?
+            (uint32_t)pcre_match_limit : UINT32_MAX;
+        pd->depth_limit = pcre_match_limit_recursion > 0 ?
+            (uint32_t)pcre_match_limit_recursion : UINT32_MAX;
     } else {
+        pd->match_limit = SC_MATCH_LIMIT_DEFAULT;
+        pd->depth_limit = SC_MATCH_LIMIT_RECURSION_DEFAULT;
+    }
+
+    pd->match_ctx = pcre2_match_context_create(NULL);
+    if (pd->match_ctx == NULL) {
+        SCLogError(SC_ERR_MEM_ALLOC, "pcre2 match context allocation failed");
         goto error;
     }
+    pcre2_set_match_limit(pd->match_ctx, pd->match_limit);
+    pcre2_set_depth_limit(pd->match_ctx, pd->depth_limit);
+
+#ifdef BUILD_HYPERSCAN
+    if (pcre_hs_prefilter)
+        DetectPcreHSPrefilterSetup(pd, re, opts);
+#endif
     return pd;
 
 error:
@@ -706,18 +875,18 @@ static int DetectPcreParseCapture(const char *regexstr, DetectEngineCtx *de_ctx,
     const char *orig_right_edge = regexstr + strlen(regexstr);
     char *name_array[DETECT_PCRE_CAPTURE_MAX] = { NULL };
     int name_idx = 0;
-    int capture_cnt = 0;
+    uint32_t capture_cnt = 0;
     int key = 0;
 
     SCLogDebug("regexstr %s, pd %p", regexstr, pd);
 
-    ret = pcre_fullinfo(pd->parse_regex.regex, pd->parse_regex.study, PCRE_INFO_CAPTURECOUNT, &capture_cnt);
-    SCLogDebug("ret %d capture_cnt %d", ret, capture_cnt);
+    ret = pcre2_pattern_info(pd->re, PCRE2_INFO_CAPTURECOUNT, &capture_cnt);
+    SCLogDebug("ret %d capture_cnt %u", ret, capture_cnt);
     if (ret == 0 && capture_cnt && strlen(capture_names) > 0)
     {
         char *ptr = NULL;
         while ((name_array[name_idx] = strtok_r(name_idx == 0 ? capture_names : NULL, " ,", &ptr))){
-            if (name_idx > capture_cnt) {
+            if ((uint32_t)name_idx > capture_cnt) {
                 SCLogError(SC_ERR_VAR_LIMIT, "more pkt/flow "
                         "var capture names than capturing substrings");
                 return -1;
@@ -829,27 +998,48 @@ error:
     return -1;
 }
 
-#ifdef PCRE_HAVE_JIT_EXEC
+static void DetectPcreThreadFree(void *ctx)
+{
+    DetectPcreThreadCtx *t = ctx;
+    if (t == NULL)
+        return;
+
+    SCLogDebug("freeing jit_stack %p", t->jit_stack);
+    if (t->jit_stack != NULL)
+        pcre2_jit_stack_free(t->jit_stack);
+    if (t->match_ctx != NULL)
+        pcre2_match_context_free(t->match_ctx);
+    if (t->match_data != NULL)
+        pcre2_match_data_free(t->match_data);
+    SCFree(t);
+}
+
 static void *DetectPcreThreadInit(void *data /*@unused@*/)
 {
-    pcre_jit_stack *jit_stack = pcre_jit_stack_alloc(PCRE_JIT_MIN_STACK, PCRE_JIT_MAX_STACK);
+    DetectPcreThreadCtx *t = SCCalloc(1, sizeof(*t));
+    if (t == NULL)
+        return NULL;
 
-    if (jit_stack == NULL) {
-        SCLogWarning(SC_WARN_PCRE_JITSTACK, "Unable to allocate PCRE JIT stack; will continue without JIT stack");
+    t->match_data = pcre2_match_data_create(PCRE_MATCH_DATA_PAIRS, NULL);
+    t->match_ctx = pcre2_match_context_create(NULL);
+    if (t->match_data == NULL || t->match_ctx == NULL) {
+        DetectPcreThreadFree(t);
+        return NULL;
     }
-    SCLogDebug("Using jit_stack %p", jit_stack);
 
-    return (void *)jit_stack;
-}
+    if (pcre2_use_jit) {
+        t->jit_stack = pcre2_jit_stack_create(PCRE_JIT_MIN_STACK, PCRE_JIT_MAX_STACK, NULL);
+        if (t->jit_stack == NULL) {
+            SCLogWarning(SC_WARN_PCRE_JITSTACK, "Unable to allocate PCRE JIT stack; will continue without JIT stack");
+        } else {
+            pcre2_jit_stack_assign(t->match_ctx, NULL, t->jit_stack);
+        }
+        SCLogDebug("Using jit_stack %p", t->jit_stack);
+    }
 
-static void DetectPcreThreadFree(void *ctx)
-{
-    SCLogDebug("freeing jit_stack %p", ctx);
-    if (ctx != NULL)
-        pcre_jit_stack_free((pcre_jit_stack *)ctx);
+    return (void *)t;
 }
 
-#endif
 static int DetectPcreSetup (DetectEngineCtx *de_ctx, Signature *s, const char *regexstr)
 {
     SCEnter();
@@ -867,12 +1057,20 @@ static int DetectPcreSetup (DetectEngineCtx *de_ctx, Signature *s, const char *r
     if (DetectPcreParseCapture(regexstr, de_ctx, pd, capture_names) < 0)
         goto error;
 
-#ifdef PCRE_HAVE_JIT_EXEC
     /* Deliberately silent on failures. Not having a context id means
-     * JIT will be bypassed */
-    pd->thread_ctx_jit_stack_id = DetectRegisterThreadCtxFuncs(de_ctx, "pcre",
+     * the match data is allocated per call and JIT will be bypassed */
+    pd->thread_ctx_id = DetectRegisterThreadCtxFuncs(de_ctx, "pcre",
             DetectPcreThreadInit, (void *)pd,
             DetectPcreThreadFree, 1);
+#ifdef BUILD_HYPERSCAN
+    if (pd->hs_db != NULL) {
+        pd->thread_ctx_hs_scratch_id = DetectRegisterThreadCtxFuncs(de_ctx, "pcre_hs",
+                DetectPcreHSThreadInit, NULL, DetectPcreHSThreadFree, 1);
+        if (pd->thread_ctx_hs_scratch_id == -1) {
+            hs_free_database(pd->hs_db);
+            pd->hs_db = NULL;
+        }
+    }
 #endif
 
     int sm_list = -1;
@@ -962,7 +1160,14 @@ static void DetectPcreFree(DetectEngineCtx *de_ctx, void *ptr)
         return;
 
     DetectPcreData *pd = (DetectPcreData *)ptr;
-    DetectParseFreeRegex(&pd->parse_regex);
+    if (pd->re != NULL)
+        pcre2_code_free(pd->re);
+    if (pd->match_ctx != NULL)
+        pcre2_match_context_free(pd->match_ctx);
+#ifdef BUILD_HYPERSCAN
+    if (pd->hs_db != NULL)
+        hs_free_database(pd->hs_db);
+#endif
     SCFree(pd);
 
     return;
@@ -3558,6 +3763,110 @@ static int DetectPcreParseCaptureTest(void)
     PASS;
 }
 
+/** \test regex runs with the match data of the thread and without it */
+static int DetectPcreMatchDataTest01(void)
+{
+    DetectEngineCtx *de_ctx = DetectEngineCtxInit();
+    FAIL_IF_NULL(de_ctx);
+    Signature *s = DetectEngineAppendSig(de_ctx, "alert tcp any any -> any any "
+            "(pcre:\"/a(b+)c/\"; sid:1;)");
+    FAIL_IF_NULL(s);
+    Signature *s2 = DetectEngineAppendSig(de_ctx, "alert tcp any any -> any any "
+            "(pcre:!\"/(a+)+b/\"; sid:2;)");
+    FAIL_IF_NULL(s2);
+    SigGroupBuild(de_ctx);
+
+    const SigMatchData *smd = s->sm_arrays[DETECT_SM_LIST_PMATCH];
+    DetectPcreData *pd = (DetectPcreData *)smd->ctx;
+    FAIL_IF(pd->thread_ctx_id == -1);
+
+    ThreadVars th_v;
+    memset(&th_v, 0, sizeof(th_v));
+    DetectEngineThreadCtx *det_ctx = NULL;
+    DetectEngineThreadCtxInit(&th_v, (void *)de_ctx, (void *)&det_ctx);
+    FAIL_IF_NULL(det_ctx);
+
+    FAIL_IF_NOT(DetectPcrePayloadMatch(det_ctx, s, smd, NULL, NULL,
+                (uint8_t *)"xxabbcxx", 8) == 1);
+    FAIL_IF_NOT(det_ctx->buffer_offset == 6);
+    FAIL_IF_NOT(det_ctx->pcre_match_start_offset == 3);
+
+    /* no thread ctx: per thread match data, the regex's own limits */
+    FAIL_IF_NULL(pd->match_ctx);
+    const int id = pd->thread_ctx_id;
+    pd->thread_ctx_id = -1;
+    det_ctx->buffer_offset = 0;
+    det_ctx->pcre_match_start_offset = 0;
+    FAIL_IF_NOT(DetectPcrePayloadMatch(det_ctx, s, smd, NULL, NULL,
+                (uint8_t *)"xabcxx", 6) == 1);
+    FAIL_IF_NOT(det_ctx->buffer_offset == 4);
+    FAIL_IF_NOT(DetectPcrePayloadMatch(det_ctx, s, smd, NULL, NULL,
+                (uint8_t *)"xacxx", 5) == 0);
+    pd->thread_ctx_id = id;
+
+    /* the match limit is applied without a thread ctx too: hitting it is
+     * an error, not a non-match that the negation would turn into a match */
+    const SigMatchData *smd2 = s2->sm_arrays[DETECT_SM_LIST_PMATCH];
+    DetectPcreData *pd2 = (DetectPcreData *)smd2->ctx;
+    pd2->thread_ctx_id = -1;
+    det_ctx->buffer_offset = 0;
+    det_ctx->pcre_match_start_offset = 0;
+    FAIL_IF_NOT(DetectPcrePayloadMatch(det_ctx, s2, smd2, NULL, NULL,
+                (uint8_t *)"aaaaaaaaaaaaaaaacb", 18) == 0);
+
+    DetectEngineThreadCtxDeinit(&th_v, (void *)det_ctx);
+    DetectEngineCtxFree(de_ctx);
+    PASS;
+}
+
+#ifdef BUILD_HYPERSCAN
+/** \test hyperscan prefilter rejects data before pcre runs */
+static int DetectPcreHSPrefilterTest01(void)
+{
+    const int prefilter = pcre_hs_prefilter;
+    pcre_hs_prefilter = 1;
+
+    DetectEngineCtx *de_ctx = DetectEngineCtxInit();
+    FAIL_IF_NULL(de_ctx);
+    Signature *s = DetectEngineAppendSig(de_ctx, "alert tcp any any -> any any "
+            "(pcre:\"/a(b+)c\\1/i\"; sid:1;)");
+    FAIL_IF_NULL(s);
+    Signature *s2 = DetectEngineAppendSig(de_ctx, "alert tcp any any -> any any "
+            "(pcre:!\"/abc/\"; sid:2;)");
+    FAIL_IF_NULL(s2);
+    Signature *s3 = DetectEngineAppendSig(de_ctx, "alert tcp any any -> any any "
+            "(pcre:\"/a b c/x\"; sid:3;)");
+    FAIL_IF_NULL(s3);
+    pcre_hs_prefilter = prefilter;
+    SigGroupBuild(de_ctx);
+
+    const SigMatchData *smd = s->sm_arrays[DETECT_SM_LIST_PMATCH];
+    FAIL_IF_NULL(((DetectPcreData *)smd->ctx)->hs_db);
+    FAIL_IF_NOT_NULL(((DetectPcreData *)s2->sm_arrays[DETECT_SM_LIST_PMATCH]->ctx)->hs_db);
+    FAIL_IF_NOT_NULL(((DetectPcreData *)s3->sm_arrays[DETECT_SM_LIST_PMATCH]->ctx)->hs_db);
+
+    ThreadVars th_v;
+    memset(&th_v, 0, sizeof(th_v));
+    DetectEngineThreadCtx *det_ctx = NULL;
+    DetectEngineThreadCtxInit(&th_v, (void *)de_ctx, (void *)&det_ctx);
+    FAIL_IF_NULL(det_ctx);
+
+    FAIL_IF_NOT(DetectPcrePayloadMatch(det_ctx, s, smd, NULL, NULL,
+                (uint8_t *)"xxABBCBBxx", 10) == 1);
+    FAIL_IF_NOT(det_ctx->buffer_offset == 8);
+    det_ctx->buffer_offset = 0;
+    det_ctx->pcre_match_start_offset = 0;
+    FAIL_IF_NOT(DetectPcrePayloadMatch(det_ctx, s, smd, NULL, NULL,
+                (uint8_t *)"xxABBCBxx", 9) == 0);
+    FAIL_IF_NOT(DetectPcrePayloadMatch(det_ctx, s, smd, NULL, NULL,
+                (uint8_t *)"xxABBDBBxx", 10) == 0);
+
+    DetectEngineThreadCtxDeinit(&th_v, (void *)det_ctx);
+    DetectEngineCtxFree(de_ctx);
+    PASS;
+}
+#endif /* BUILD_HYPERSCAN */
+
 #endif /* UNITTESTS */
 
 /**
@@ -3646,6 +3955,10 @@ static void DetectPcreRegisterTests(void)
 
     UtRegisterTest("DetectPcreParseHttpHost", DetectPcreParseHttpHost);
     UtRegisterTest("DetectPcreParseCaptureTest", DetectPcreParseCaptureTest);
+    UtRegisterTest("DetectPcreMatchDataTest01", DetectPcreMatchDataTest01);
+#ifdef BUILD_HYPERSCAN
+    UtRegisterTest("DetectPcreHSPrefilterTest01", DetectPcreHSPrefilterTest01);
+#endif
 
 #endif /* UNITTESTS */
 }
@@ -37,12 +37,21 @@
 #define DETECT_PCRE_CAPTURE_MAX         8
 
 typedef struct DetectPcreData_ {
-    /* pcre options */
-    DetectParseRegex parse_regex;
+    /* compiled regex, run with pcre2 */
+    pcre2_code *re;
+    /* match and depth limit, from the 'O' modifier or the defaults */
+    uint32_t match_limit;
+    uint32_t depth_limit;
+    /* match context with the limits, used if there is no thread context */
+    pcre2_match_context *match_ctx;
 
-#ifdef PCRE_HAVE_JIT_EXEC
-    /* JIT stack thread context id */
-    int thread_ctx_jit_stack_id;
+    /* match data and JIT stack thread context id */
+    int thread_ctx_id;
+#ifdef BUILD_HYPERSCAN
+    /* prefilter db, NULL if the regex is always run */
+    struct hs_database *hs_db;
+    /* scratch thread context id */
+    int thread_ctx_hs_scratch_id;
 #endif
     int opts;
     uint16_t flags;
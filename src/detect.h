@@ -327,6 +327,9 @@ typedef struct SigMatch_ {
 typedef struct SigMatchData_ {
     uint8_t type; /**< match type */
     uint8_t is_last; /**< Last element of the list */
+    uint32_t ci_prog; /**< content inspection program for the list starting
+                       *   here, index in DetectEngineCtx::ci_progs + 1,
+                       *   0 if none */
     SigMatchCtx *ctx; /**< plugin specific data */
 } SigMatchData;
 
@@ -369,8 +372,23 @@ typedef struct InspectionBufferMultipleForList {
 typedef struct DetectEngineTransforms {
     int transforms[DETECT_TRANSFORMS_MAX];
     int cnt;
+    /** id of the buffer the transforms are applied to */
+    int parent_id;
 } DetectEngineTransforms;
 
+/** result of a transform chain prefix that is shared by multiple
+ *  transformed buffers. Valid until the next InspectionBufferClean(). */
+typedef struct DetectTransformCacheEntry_ {
+    const uint8_t *input;   /**< data the transforms were applied to */
+    uint32_t input_len;
+    uint32_t prefix_id;     /**< index into DetectEngineCtx::transform_prefixes */
+    uint8_t *buf;
+    uint32_t len;
+    uint32_t size;          /**< size of buf */
+} DetectTransformCacheEntry;
+
+#define DETECT_TRANSFORM_CACHE_SIZE 32
+
 /** callback for getting the buffer we need to prefilter/inspect */
 typedef InspectionBuffer *(*InspectionBufferGetDataPtr)(
         struct DetectEngineThreadCtx_ *det_ctx,
@@ -832,6 +850,18 @@ typedef struct DetectEngineCtx_ {
     /* maximum recursion depth for content inspection */
     int inspection_recursion_limit;
 
+    /** run content inspection of the sm lists as compiled programs */
+    bool inspection_vm;
+    /** compiled content inspection programs, see SigMatchData::ci_prog */
+    struct DetectCiProgram_ **ci_progs;
+    uint32_t ci_progs_cnt;
+    uint32_t ci_progs_size;
+
+    /** transform chain prefixes that are shared by more than one
+     *  transformed buffer. Their results are cached per tx. */
+    DetectEngineTransforms *transform_prefixes;
+    uint32_t transform_prefixes_cnt;
+
     /* conf parameter that limits the length of the http request body inspected */
     int hcbd_buffer_limit;
     /* conf parameter that limits the length of the http response body inspected */
@@ -903,6 +933,13 @@ typedef struct DetectEngineCtx_ {
 
     /** are we using just mpm or also other prefilters */
     enum DetectEnginePrefilterSetting prefilter_setting;
+    /** scan the buffers of a tx in one call, hyperscan only */
+    bool prefilter_multi_buffer;
+    /** scan streams and http bodies incrementally, hyperscan only */
+    bool prefilter_streaming;
+
+    /** number of threads used to prepare the mpm contexts */
+    uint16_t build_threads;
 
     HashListTable *dport_hash_table;
 
@@ -1047,6 +1084,8 @@ typedef struct DetectEngineThreadCtx_ {
     uint16_t counter_fnonmpm_list;
     uint16_t counter_match_list;
 #endif
+    uint16_t counter_transform_cache_hit;
+    uint16_t counter_transform_cache_miss;
 
     int inspect_list; /**< list we're currently inspecting, DETECT_SM_LIST_* */
 
@@ -1066,6 +1105,12 @@ typedef struct DetectEngineThreadCtx_ {
         uint32_t *to_clear_queue;
     } multi_inspect;
 
+    /** results of shared transform chain prefixes for this run */
+    struct {
+        DetectTransformCacheEntry *entries;
+        uint32_t cnt;                       /**< entries in use in this run */
+    } transform_cache;
+
     /* used to discontinue any more matching */
     uint16_t discontinue_matching;
     uint16_t flags;
@@ -40,6 +40,8 @@
 
 #include "util-time.h"
 #include "util-debug.h"
+#include "util-numa.h"
+#include "util-hugepage.h"
 
 #include "util-hash-lookup3.h"
 
@@ -53,7 +55,11 @@ FlowBucket *flow_hash;
 SC_ATOMIC_EXTERN(unsigned int, flow_prune_idx);
 SC_ATOMIC_EXTERN(unsigned int, flow_flags);
 
-static Flow *FlowGetUsedFlow(ThreadVars *tv, DecodeThreadVars *dtv);
+FlowThreadHash *flow_thread_hash_list = NULL;
+static SCMutex flow_thread_hash_list_lock = SCMUTEX_INITIALIZER;
+
+static Flow *FlowGetUsedFlow(ThreadVars *tv, DecodeThreadVars *dtv,
+        const FlowBucket *skip_fb);
 
 /** \brief compare two raw ipv6 addrs
  *
@@ -478,6 +484,33 @@ static inline void FlowUpdateCounter(ThreadVars *tv, DecodeThreadVars *dtv,
 #endif
 }
 
+/** \internal
+ *  \brief get a spare flow, preferring one on the node of our thread
+ *
+ *  In NUMA aware mode a thread bound to a node first uses the spare queue
+ *  of its node. If that is empty it allocates the flow itself, so that it
+ *  is placed on the node, and only then falls back to the global queue.
+ *
+ *  \retval f *UNLOCKED* flow or NULL
+ */
+static Flow *FlowSpareGet(ThreadVars *tv, DecodeThreadVars *dtv)
+{
+    const int node = NumaThreadNode();
+    if (flow_spare_node_q == NULL || node < 0)
+        return FlowDequeue(&flow_spare_q);
+
+    Flow *f = FlowDequeue(&flow_spare_node_q[node]);
+    if (f == NULL) {
+        f = FlowAlloc();
+        if (f == NULL)
+            f = FlowDequeue(&flow_spare_q);
+    }
+    if (f != NULL && f->numa_node != node && tv != NULL && dtv != NULL) {
+        StatsIncr(tv, dtv->counter_flow_numa_remote);
+    }
+    return f;
+}
+
 /**
  *  \brief Get a new flow
  *
@@ -486,10 +519,12 @@ static inline void FlowUpdateCounter(ThreadVars *tv, DecodeThreadVars *dtv,
  *
  *  \param tv thread vars
  *  \param dtv decode thread vars (for flow log api thread data)
+ *  \param fb bucket the caller is working on, never pruned
  *
  *  \retval f *LOCKED* flow on succes, NULL on error.
  */
-static Flow *FlowGetNew(ThreadVars *tv, DecodeThreadVars *dtv, const Packet *p)
+static Flow *FlowGetNew(ThreadVars *tv, DecodeThreadVars *dtv, const Packet *p,
+        const FlowBucket *fb)
 {
     Flow *f = NULL;
 
@@ -498,7 +533,7 @@ static Flow *FlowGetNew(ThreadVars *tv, DecodeThreadVars *dtv, const Packet *p)
     }
 
     /* get a flow from the spare queue */
-    f = FlowDequeue(&flow_spare_q);
+    f = FlowSpareGet(tv, dtv);
     if (f == NULL) {
         /* If we reached the max memcap, we get a used flow */
         if (!(FLOW_CHECK_MEMCAP(sizeof(Flow) + FlowStorageSize()))) {
@@ -514,7 +549,7 @@ static Flow *FlowGetNew(ThreadVars *tv, DecodeThreadVars *dtv, const Packet *p)
                 FlowWakeupFlowManagerThread();
             }
 
-            f = FlowGetUsedFlow(tv, dtv);
+            f = FlowGetUsedFlow(tv, dtv, fb);
             if (f == NULL) {
                 /* max memcap reached, so increments the counter */
                 if (tv != NULL && dtv != NULL) {
@@ -562,7 +597,7 @@ static Flow *TcpReuseReplace(ThreadVars *tv, DecodeThreadVars *dtv,
     FLOWLOCK_UNLOCK(old_f);
 
     /* Get a new flow. It will be either a locked flow or NULL */
-    Flow *f = FlowGetNew(tv, dtv, p);
+    Flow *f = FlowGetNew(tv, dtv, p, fb);
     if (f == NULL) {
         return NULL;
     }
@@ -584,39 +619,24 @@ static Flow *TcpReuseReplace(ThreadVars *tv, DecodeThreadVars *dtv,
     return f;
 }
 
-/** \brief Get Flow for packet
- *
- * Hash retrieval function for flows. Looks up the hash bucket containing the
- * flow pointer. Then compares the packet with the found flow to see if it is
- * the flow we need. If it isn't, walk the list until the right flow is found.
- *
- * If the flow is not found or the bucket was emtpy, a new flow is taken from
- * the queue. FlowDequeue() will alloc new flows as long as we stay within our
- * memcap limit.
- *
- * The p->flow pointer is updated to point to the flow.
+/** \internal
+ *  \brief Get Flow for packet from a hash bucket
  *
- *  \param tv thread vars
- *  \param dtv decode thread vars (for flow log api thread data)
+ *  \note the caller must hold the bucket lock
  *
  *  \retval f *LOCKED* flow or NULL
  */
-Flow *FlowGetFlowFromHash(ThreadVars *tv, DecodeThreadVars *dtv, const Packet *p, Flow **dest)
+static inline Flow *FlowGetFlowFromBucket(ThreadVars *tv, DecodeThreadVars *dtv,
+        const Packet *p, Flow **dest, FlowBucket *fb, const uint32_t hash)
 {
     Flow *f = NULL;
 
-    /* get our hash bucket and lock it */
-    const uint32_t hash = p->flow_hash;
-    FlowBucket *fb = &flow_hash[hash % flow_config.hash_size];
-    FBLOCK_LOCK(fb);
-
     SCLogDebug("fb %p fb->head %p", fb, fb->head);
 
     /* see if the bucket already has a flow */
     if (fb->head == NULL) {
-        f = FlowGetNew(tv, dtv, p);
+        f = FlowGetNew(tv, dtv, p, fb);
         if (f == NULL) {
-            FBLOCK_UNLOCK(fb);
             return NULL;
         }
 
@@ -631,8 +651,6 @@ Flow *FlowGetFlowFromHash(ThreadVars *tv, DecodeThreadVars *dtv, const Packet *p
         FlowUpdateState(f, FLOW_STATE_NEW);
 
         FlowReference(dest, f);
-
-        FBLOCK_UNLOCK(fb);
         return f;
     }
 
@@ -648,9 +666,8 @@ Flow *FlowGetFlowFromHash(ThreadVars *tv, DecodeThreadVars *dtv, const Packet *p
             f = f->hnext;
 
             if (f == NULL) {
-                f = pf->hnext = FlowGetNew(tv, dtv, p);
+                f = pf->hnext = FlowGetNew(tv, dtv, p, fb);
                 if (f == NULL) {
-                    FBLOCK_UNLOCK(fb);
                     return NULL;
                 }
                 fb->tail = f;
@@ -666,8 +683,6 @@ Flow *FlowGetFlowFromHash(ThreadVars *tv, DecodeThreadVars *dtv, const Packet *p
                 FlowUpdateState(f, FLOW_STATE_NEW);
 
                 FlowReference(dest, f);
-
-                FBLOCK_UNLOCK(fb);
                 return f;
             }
 
@@ -694,14 +709,11 @@ Flow *FlowGetFlowFromHash(ThreadVars *tv, DecodeThreadVars *dtv, const Packet *p
                 if (unlikely(TcpSessionPacketSsnReuse(p, f, f->protoctx) == 1)) {
                     f = TcpReuseReplace(tv, dtv, fb, f, hash, p);
                     if (f == NULL) {
-                        FBLOCK_UNLOCK(fb);
                         return NULL;
                     }
                 }
 
                 FlowReference(dest, f);
-
-                FBLOCK_UNLOCK(fb);
                 return f;
             }
         }
@@ -712,12 +724,88 @@ Flow *FlowGetFlowFromHash(ThreadVars *tv, DecodeThreadVars *dtv, const Packet *p
     if (unlikely(TcpSessionPacketSsnReuse(p, f, f->protoctx) == 1)) {
         f = TcpReuseReplace(tv, dtv, fb, f, hash, p);
         if (f == NULL) {
-            FBLOCK_UNLOCK(fb);
             return NULL;
         }
     }
 
     FlowReference(dest, f);
+    return f;
+}
+
+static inline const FlowBucket *FlowGetBucket(const DecodeThreadVars *dtv,
+        const Packet *p)
+{
+    const FlowThreadHash *fth = dtv->flow_thread_hash;
+    if (fth != NULL) {
+        return &fth->array[p->flow_hash % fth->size];
+    }
+    return &flow_hash[p->flow_hash % flow_config.hash_size];
+}
+
+/** \brief prefetch the hash bucket the packet's flow lives in
+ *
+ *  Issued ahead of FlowGetFlowFromHash() so that the cache miss on the
+ *  bucket is overlapped with other work.
+ */
+void FlowPrefetchBucket(const DecodeThreadVars *dtv, const Packet *p)
+{
+    prefetch(FlowGetBucket(dtv, p));
+}
+
+/** \brief prefetch the first flow of the packet's hash bucket
+ *
+ *  Lookups move the flow they find to the head of the bucket, so for
+ *  active flows this is usually the flow of the packet. The head is read
+ *  without the bucket lock, it's only used as a hint. The bucket itself
+ *  should have been prefetched by FlowPrefetchBucket() earlier.
+ */
+void FlowPrefetchFlow(const DecodeThreadVars *dtv, const Packet *p)
+{
+    const Flow *f = FlowGetBucket(dtv, p)->head;
+    if (f != NULL) {
+        prefetch(f);
+    }
+}
+
+/** \brief Get Flow for packet
+ *
+ * Hash retrieval function for flows. Looks up the hash bucket containing the
+ * flow pointer. Then compares the packet with the found flow to see if it is
+ * the flow we need. If it isn't, walk the list until the right flow is found.
+ *
+ * If the flow is not found or the bucket was emtpy, a new flow is taken from
+ * the queue. FlowDequeue() will alloc new flows as long as we stay within our
+ * memcap limit.
+ *
+ * If the thread has its own flow hash ("flow.thread-local" mode) the lookup
+ * is done in that hash. Its bucket lock is only contended if a flow manager
+ * times out flows in that bucket at the same time.
+ *
+ * The p->flow pointer is updated to point to the flow.
+ *
+ *  \param tv thread vars
+ *  \param dtv decode thread vars (for flow log api thread data)
+ *
+ *  \retval f *LOCKED* flow or NULL
+ */
+Flow *FlowGetFlowFromHash(ThreadVars *tv, DecodeThreadVars *dtv, const Packet *p, Flow **dest)
+{
+    const uint32_t hash = p->flow_hash;
+
+    if (dtv != NULL && dtv->flow_thread_hash != NULL) {
+        FlowThreadHash *fth = dtv->flow_thread_hash;
+        FlowBucket *fb = &fth->array[hash % fth->size];
+        FBLOCK_LOCK(fb);
+        Flow *f = FlowGetFlowFromBucket(tv, dtv, p, dest, fb, hash);
+        FBLOCK_UNLOCK(fb);
+        return f;
+    }
+
+    /* get our hash bucket and lock it */
+    FlowBucket *fb = &flow_hash[hash % flow_config.hash_size];
+    FBLOCK_LOCK(fb);
+
+    Flow *f = FlowGetFlowFromBucket(tv, dtv, p, dest, fb, hash);
 
     FBLOCK_UNLOCK(fb);
     return f;
@@ -861,6 +949,114 @@ Flow *FlowGetExistingFlowFromHash(FlowKey *key, const uint32_t hash)
     return f;
 }
 
+/** \internal
+ *  \brief Prepare a flow that was forcefully removed from the hash for reuse
+ *
+ *  \param f *LOCKED* flow, will be unlocked on return
+ */
+static void FlowGetUsedFlowRecycle(ThreadVars *tv, DecodeThreadVars *dtv, Flow *f)
+{
+    int state = SC_ATOMIC_GET(f->flow_state);
+    if (state == FLOW_STATE_NEW)
+        f->flow_end_flags |= FLOW_END_FLAG_STATE_NEW;
+    else if (state == FLOW_STATE_ESTABLISHED)
+        f->flow_end_flags |= FLOW_END_FLAG_STATE_ESTABLISHED;
+    else if (state == FLOW_STATE_CLOSED)
+        f->flow_end_flags |= FLOW_END_FLAG_STATE_CLOSED;
+#ifdef CAPTURE_OFFLOAD
+    else if (state == FLOW_STATE_CAPTURE_BYPASSED)
+        f->flow_end_flags |= FLOW_END_FLAG_STATE_BYPASSED;
+#endif
+    else if (state == FLOW_STATE_LOCAL_BYPASSED)
+        f->flow_end_flags |= FLOW_END_FLAG_STATE_BYPASSED;
+
+    f->flow_end_flags |= FLOW_END_FLAG_FORCED;
+
+    if (SC_ATOMIC_GET(flow_flags) & FLOW_EMERGENCY)
+        f->flow_end_flags |= FLOW_END_FLAG_EMERGENCY;
+
+    /* invoke flow log api */
+    if (dtv && dtv->output_flow_thread_data)
+        (void)OutputFlowLog(tv, dtv->output_flow_thread_data, f);
+
+    FlowClearMemory(f, f->protomap);
+
+    FlowUpdateState(f, FLOW_STATE_NEW);
+
+    FLOWLOCK_UNLOCK(f);
+}
+
+/** \internal
+ *  \brief Get a flow from the thread local hash directly.
+ *
+ *  Thread local version of FlowGetUsedFlow(). Rows the flow managers are
+ *  working on are skipped.
+ *
+ *  \param skip_fb bucket the caller is working on
+ *
+ *  \retval f flow or NULL
+ */
+static Flow *FlowGetUsedFlowFromThreadHash(ThreadVars *tv, DecodeThreadVars *dtv,
+        FlowThreadHash *fth, const FlowBucket *skip_fb)
+{
+    uint32_t idx = fth->prune_idx;
+    uint32_t cnt = fth->size;
+
+    while (cnt--) {
+        if (++idx >= fth->size)
+            idx = 0;
+
+        FlowBucket *fb = &fth->array[idx];
+        if (fb == skip_fb)
+            continue;
+
+        if (FBLOCK_TRYLOCK(fb) != 0)
+            continue;
+
+        Flow *f = fb->tail;
+        if (f == NULL) {
+            FBLOCK_UNLOCK(fb);
+            continue;
+        }
+
+        if (FLOWLOCK_TRYWRLOCK(f) != 0) {
+            FBLOCK_UNLOCK(fb);
+            continue;
+        }
+
+        /** never prune a flow that is used by a packet or stream msg
+         *  we are currently processing */
+        if (SC_ATOMIC_GET(f->use_cnt) > 0) {
+            FBLOCK_UNLOCK(fb);
+            FLOWLOCK_UNLOCK(f);
+            continue;
+        }
+
+        /* remove from the hash */
+        if (f->hprev != NULL)
+            f->hprev->hnext = f->hnext;
+        if (f->hnext != NULL)
+            f->hnext->hprev = f->hprev;
+        if (fb->head == f)
+            fb->head = f->hnext;
+        if (fb->tail == f)
+            fb->tail = f->hprev;
+
+        f->hnext = NULL;
+        f->hprev = NULL;
+        f->fb = NULL;
+        SC_ATOMIC_SET(fb->next_ts, 0);
+        FBLOCK_UNLOCK(fb);
+
+        FlowGetUsedFlowRecycle(tv, dtv, f);
+
+        fth->prune_idx = idx;
+        return f;
+    }
+
+    return NULL;
+}
+
 /** \internal
  *  \brief Get a flow from the hash directly.
  *
@@ -873,11 +1069,18 @@ Flow *FlowGetExistingFlowFromHash(FlowKey *key, const uint32_t hash)
  *
  *  \param tv thread vars
  *  \param dtv decode thread vars (for flow log api thread data)
+ *  \param skip_fb bucket the caller is working on
  *
  *  \retval f flow or NULL
  */
-static Flow *FlowGetUsedFlow(ThreadVars *tv, DecodeThreadVars *dtv)
+static Flow *FlowGetUsedFlow(ThreadVars *tv, DecodeThreadVars *dtv,
+        const FlowBucket *skip_fb)
 {
+    if (dtv != NULL && dtv->flow_thread_hash != NULL) {
+        return FlowGetUsedFlowFromThreadHash(tv, dtv, dtv->flow_thread_hash,
+                skip_fb);
+    }
+
     uint32_t idx = SC_ATOMIC_GET(flow_prune_idx) % flow_config.hash_size;
     uint32_t cnt = flow_config.hash_size;
 
@@ -925,38 +1128,107 @@ static Flow *FlowGetUsedFlow(ThreadVars *tv, DecodeThreadVars *dtv)
         SC_ATOMIC_SET(fb->next_ts, 0);
         FBLOCK_UNLOCK(fb);
 
-        int state = SC_ATOMIC_GET(f->flow_state);
-        if (state == FLOW_STATE_NEW)
-            f->flow_end_flags |= FLOW_END_FLAG_STATE_NEW;
-        else if (state == FLOW_STATE_ESTABLISHED)
-            f->flow_end_flags |= FLOW_END_FLAG_STATE_ESTABLISHED;
-        else if (state == FLOW_STATE_CLOSED)
-            f->flow_end_flags |= FLOW_END_FLAG_STATE_CLOSED;
-#ifdef CAPTURE_OFFLOAD
-        else if (state == FLOW_STATE_CAPTURE_BYPASSED)
-            f->flow_end_flags |= FLOW_END_FLAG_STATE_BYPASSED;
-#endif
-        else if (state == FLOW_STATE_LOCAL_BYPASSED)
-            f->flow_end_flags |= FLOW_END_FLAG_STATE_BYPASSED;
-
-        f->flow_end_flags |= FLOW_END_FLAG_FORCED;
+        FlowGetUsedFlowRecycle(tv, dtv, f);
 
-        if (SC_ATOMIC_GET(flow_flags) & FLOW_EMERGENCY)
-            f->flow_end_flags |= FLOW_END_FLAG_EMERGENCY;
+        (void) SC_ATOMIC_ADD(flow_prune_idx, (flow_config.hash_size - cnt));
+        return f;
+    }
 
-        /* invoke flow log api */
-        if (dtv && dtv->output_flow_thread_data)
-            (void)OutputFlowLog(tv, dtv->output_flow_thread_data, f);
+    return NULL;
+}
 
-        FlowClearMemory(f, f->protomap);
+/** \brief Allocate a flow hash for the calling worker thread
+ *
+ *  Used in "flow.thread-local" mode. The hash has "flow.hash-size" buckets
+ *  and its memory is accounted for in the flow memcap. The table is added
+ *  to a global list so that the flow managers and shutdown code can walk
+ *  it, it is freed in FlowShutdown().
+ *
+ *  \retval fth flow hash or NULL if the memcap was reached or alloc failed
+ */
+FlowThreadHash *FlowThreadHashAlloc(void)
+{
+    const uint64_t hash_size = flow_config.hash_size * sizeof(FlowBucket);
+    if (!(FLOW_CHECK_MEMCAP(hash_size + sizeof(FlowThreadHash)))) {
+        SCLogError(SC_ERR_FLOW_INIT, "allocating thread local flow hash failed: "
+                "max flow memcap reached. Memcap %"PRIu64", Memuse %"PRIu64".",
+                SC_ATOMIC_GET(flow_config.memcap),
+                (uint64_t)SC_ATOMIC_GET(flow_memuse) + hash_size);
+        return NULL;
+    }
 
-        FlowUpdateState(f, FLOW_STATE_NEW);
+    FlowThreadHash *fth = SCCalloc(1, sizeof(*fth));
+    if (unlikely(fth == NULL))
+        return NULL;
 
-        FLOWLOCK_UNLOCK(f);
+    fth->array = HugePageAlloc(hash_size);
+    if (unlikely(fth->array == NULL)) {
+        SCFree(fth);
+        return NULL;
+    }
+    fth->size = flow_config.hash_size;
 
-        (void) SC_ATOMIC_ADD(flow_prune_idx, (flow_config.hash_size - cnt));
-        return f;
+    for (uint32_t u = 0; u < fth->size; u++) {
+        FBLOCK_INIT(&fth->array[u]);
+        SC_ATOMIC_INIT(fth->array[u].next_ts);
     }
+    SC_ATOMIC_INIT(fth->last_sweep_sec);
+    (void) SC_ATOMIC_ADD(flow_memuse, hash_size + sizeof(FlowThreadHash));
 
-    return NULL;
+    SCMutexLock(&flow_thread_hash_list_lock);
+    fth->next = flow_thread_hash_list;
+    flow_thread_hash_list = fth;
+    SCMutexUnlock(&flow_thread_hash_list_lock);
+
+    SCLogDebug("thread local flow hash %p with %u buckets", fth, fth->size);
+    return fth;
+}
+
+/** \brief get the list of thread local flow hashes
+ *
+ *  Tables are only added to the head of the list and are not removed
+ *  until FlowShutdown(), so the returned list can be walked without the
+ *  lock.
+ */
+FlowThreadHash *FlowThreadHashGetList(void)
+{
+    SCMutexLock(&flow_thread_hash_list_lock);
+    FlowThreadHash *fth = flow_thread_hash_list;
+    SCMutexUnlock(&flow_thread_hash_list_lock);
+    return fth;
+}
+
+/** \brief free all thread local flow hashes and the flows they hold
+ *  \warning Not thread safe */
+void FlowThreadHashFreeAll(void)
+{
+    SCMutexLock(&flow_thread_hash_list_lock);
+    FlowThreadHash *fth = flow_thread_hash_list;
+    flow_thread_hash_list = NULL;
+    SCMutexUnlock(&flow_thread_hash_list_lock);
+
+    while (fth != NULL) {
+        FlowThreadHash *next = fth->next;
+
+        for (uint32_t u = 0; u < fth->size; u++) {
+            Flow *f = fth->array[u].head;
+            while (f) {
+#ifdef DEBUG_VALIDATION
+                BUG_ON(SC_ATOMIC_GET(f->use_cnt) != 0);
+#endif
+                Flow *n = f->hnext;
+                uint8_t proto_map = FlowGetProtoMapping(f->proto);
+                FlowClearMemory(f, proto_map);
+                FlowFree(f);
+                f = n;
+            }
+            FBLOCK_DESTROY(&fth->array[u]);
+        }
+        (void) SC_ATOMIC_SUB(flow_memuse,
+                fth->size * sizeof(FlowBucket) + sizeof(FlowThreadHash));
+        HugePageFree(fth->array);
+        SCFree(fth);
+
+        fth = next;
+    }
 }
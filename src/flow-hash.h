@@ -54,6 +54,9 @@ typedef struct FlowBucket_ {
      *  flow state changes. The flow manager sets this to INT_MAX for
      *  empty buckets. */
     SC_ATOMIC_DECLARE(int32_t, next_ts);
+    /** link in the flow manager's list of rows to (re)schedule. Only
+     *  used in "flow.timer-wheel" mode. See FlowManagerMarkRow(). */
+    SC_ATOMIC_DECLARE(uint32_t, wheel_next);
 } __attribute__((aligned(CLS))) FlowBucket;
 
 #ifdef FBLOCK_SPIN
@@ -72,9 +75,36 @@ typedef struct FlowBucket_ {
     #error Enable FBLOCK_SPIN or FBLOCK_MUTEX
 #endif
 
+/** \brief Per thread flow hash, used in "flow.thread-local" mode
+ *
+ *  Only the owning worker thread adds flows to the table. The owner times
+ *  out its flows incrementally while it gets packets, see
+ *  FlowTimeoutThreadHash(). The flow managers time out the flows of tables
+ *  whose owner is idle and of all tables in emergency mode, so the bucket
+ *  locks are still used. They are rarely contended. */
+typedef struct FlowThreadHash_ {
+    FlowBucket *array;
+    uint32_t size;
+
+    /** next row to check in the incremental timeout sweep */
+    uint32_t sweep_idx;
+    /** next row to take a flow from when the memcap is reached */
+    uint32_t prune_idx;
+    /** packet time of the last timeout sweep step */
+    struct timeval last_sweep;
+    /** second of the last timeout sweep step, for the flow managers */
+    SC_ATOMIC_DECLARE(uint64_t, last_sweep_sec);
+
+    /** list of all tables so that the flow managers and shutdown code
+     *  can walk them */
+    struct FlowThreadHash_ *next;
+} FlowThreadHash;
+
 /* prototypes */
 
 Flow *FlowGetFlowFromHash(ThreadVars *tv, DecodeThreadVars *dtv, const Packet *, Flow **);
+void FlowPrefetchBucket(const DecodeThreadVars *dtv, const Packet *p);
+void FlowPrefetchFlow(const DecodeThreadVars *dtv, const Packet *p);
 
 Flow *FlowGetFromFlowKey(FlowKey *key, struct timespec *ttime, const uint32_t hash);
 Flow *FlowGetExistingFlowFromHash(FlowKey * key, uint32_t hash);
@@ -82,5 +112,9 @@ uint32_t FlowKeyGetHash(FlowKey *flow_key);
 
 void FlowDisableTcpReuseHandling(void);
 
+FlowThreadHash *FlowThreadHashAlloc(void);
+FlowThreadHash *FlowThreadHashGetList(void);
+void FlowThreadHashFreeAll(void);
+
 #endif /* __FLOW_HASH_H__ */
 
@@ -32,6 +32,7 @@
 
 #include "util-random.h"
 #include "util-time.h"
+#include "util-timer-wheel.h"
 
 #include "flow.h"
 #include "flow-queue.h"
@@ -75,6 +76,7 @@ extern int run_mode;
 FlowQueue flow_recycle_q;
 
 /* multi flow mananger support */
+#define FLOW_MANAGERS_MAX 1024
 static uint32_t flowmgr_number = 1;
 /* atomic counter for flow managers, to assign instance id */
 SC_ATOMIC_DECLARE(uint32_t, flowmgr_cnt);
@@ -86,6 +88,22 @@ SC_ATOMIC_DECLARE(uint32_t, flowrec_cnt);
 
 SC_ATOMIC_EXTERN(unsigned int, flow_flags);
 
+/** FlowBucket::wheel_next value for a row that is not on a list */
+#define FLOW_WHEEL_NOT_QUEUED   0
+/** FlowBucket::wheel_next value for the last row on a list */
+#define FLOW_WHEEL_LIST_END     UINT32_MAX
+
+/** list of hash rows that have been updated by the workers and need to
+ *  be (re)scheduled by a flow manager in timer wheel mode. The list is
+ *  linked through FlowBucket::wheel_next using 'row idx + 1'. */
+typedef struct FlowWheelList_ {
+    /** first row idx + 1, 0 if the list is empty */
+    SC_ATOMIC_DECLARE(uint32_t, head);
+} __attribute__((aligned(CLS))) FlowWheelList;
+
+/** a list per flow manager, rows are assigned by 'idx % flowmgr_number' */
+static FlowWheelList flow_wheel_lists[FLOW_MANAGERS_MAX];
+
 SCCtrlCondT flow_manager_ctrl_cond;
 SCCtrlMutex flow_manager_ctrl_mutex;
 
@@ -113,6 +131,15 @@ void FlowTimeoutsEmergency(void)
 #define FLOW_EMERG_MODE_UPDATE_DELAY_NSEC 100000
 #define NEW_FLOW_COUNT_COND 10
 
+/* thread local flow hash: check 1/10th of the rows every 0.1 seconds */
+#define FLOW_THREAD_SWEEP_STEPS 10
+#define FLOW_THREAD_SWEEP_STEP_USEC 100000
+/* in emergency mode the owner checks twice as many rows per step */
+#define FLOW_THREAD_SWEEP_EMERG_FACTOR 2
+/* tables that their owner didn't sweep for this many seconds are timed
+ * out by the flow managers */
+#define FLOW_THREAD_IDLE_SEC 2
+
 typedef struct FlowTimeoutCounters_ {
     uint32_t new;
     uint32_t est;
@@ -469,6 +496,7 @@ static uint32_t FlowManagerHashRowTimeout(Flow *f, struct timeval *ts,
 /**
  *  \brief time out flows from the hash
  *
+ *  \param array flow hash: the global one or a thread local one
  *  \param ts timestamp
  *  \param try_cnt number of flows to time out max (0 is unlimited)
  *  \param hash_min min hash index to consider
@@ -477,7 +505,7 @@ static uint32_t FlowManagerHashRowTimeout(Flow *f, struct timeval *ts,
  *
  *  \retval cnt number of timed out flow
  */
-static uint32_t FlowTimeoutHash(struct timeval *ts, uint32_t try_cnt,
+static uint32_t FlowTimeoutHash(FlowBucket *array, struct timeval *ts, uint32_t try_cnt,
         uint32_t hash_min, uint32_t hash_max,
         FlowTimeoutCounters *counters)
 {
@@ -489,7 +517,7 @@ static uint32_t FlowTimeoutHash(struct timeval *ts, uint32_t try_cnt,
         emergency = 1;
 
     for (idx = hash_min; idx < hash_max; idx++) {
-        FlowBucket *fb = &flow_hash[idx];
+        FlowBucket *fb = &array[idx];
 
         counters->rows_checked++;
 
@@ -533,6 +561,187 @@ next:
     return cnt;
 }
 
+/** \brief tell the flow manager that a row of the flow hash was updated
+ *
+ *  Used in timer wheel mode, where the flow manager only looks at rows that
+ *  were updated or that have a flow timing out. Called by the workers after
+ *  resetting the row's next_ts. Rows of the thread local flow hashes are
+ *  ignored, those are handled by the workers themselves.
+ */
+void FlowManagerMarkRow(FlowBucket *fb)
+{
+    if (fb < flow_hash || fb >= flow_hash + flow_config.hash_size)
+        return;
+    const uint32_t idx = (uint32_t)(fb - flow_hash);
+
+    /* claim the row. If this fails it's already on the list. */
+    uint32_t cmp = FLOW_WHEEL_NOT_QUEUED;
+    if (!SC_ATOMIC_CAS(&fb->wheel_next, cmp, FLOW_WHEEL_LIST_END))
+        return;
+
+    FlowWheelList *list = &flow_wheel_lists[idx % flowmgr_number];
+    while (1) {
+        uint32_t head = SC_ATOMIC_GET(list->head);
+        SC_ATOMIC_SET(fb->wheel_next, head ? head : FLOW_WHEEL_LIST_END);
+        if (SC_ATOMIC_CAS(&list->head, head, idx + 1))
+            break;
+    }
+}
+
+/** \internal
+ *  \brief take all rows from a list
+ *  \retval head idx + 1 of the first row or 0 if the list is empty */
+static uint32_t FlowWheelListTake(FlowWheelList *list)
+{
+    while (1) {
+        uint32_t head = SC_ATOMIC_GET(list->head);
+        if (head == 0)
+            return 0;
+        if (SC_ATOMIC_CAS(&list->head, head, 0))
+            return head;
+    }
+}
+
+typedef struct FlowWheelCtx_ {
+    TimerWheel *tw;
+    /** per row time it's scheduled at in the wheel, 0 if not scheduled.
+     *  Indexed by 'row idx / flowmgr_number'. */
+    uint32_t *sched;
+    struct timeval *ts;
+    FlowTimeoutCounters *counters;
+    int emergency;
+    uint32_t cnt;
+} FlowWheelCtx;
+
+/** \internal
+ *  \brief schedule a row to be checked at 'ts'
+ *
+ *  A row has one valid entry in the wheel: the one matching ctx::sched.
+ *  If it is already scheduled earlier, nothing is added.
+ */
+static void FlowWheelSchedule(FlowWheelCtx *ctx, const uint32_t idx, uint32_t ts)
+{
+    uint32_t *sched = &ctx->sched[idx / flowmgr_number];
+    if (ts == 0)
+        ts = 1;
+    if (*sched != 0 && *sched <= ts)
+        return;
+
+    /* on failure the row is picked up again by a later entry, the next
+     * update by a worker or the full scan in emergency mode */
+    if (TimerWheelAdd(ctx->tw, idx, ts) != 0)
+        return;
+    *sched = ts;
+}
+
+/** \internal
+ *  \brief check a row for timed out flows and schedule it at the time
+ *         its next flow can time out */
+static void FlowWheelCheckRow(FlowWheelCtx *ctx, const uint32_t idx)
+{
+    FlowBucket *fb = &flow_hash[idx];
+    const uint32_t now = (uint32_t)ctx->ts->tv_sec;
+
+    ctx->counters->rows_checked++;
+
+    /* before grabbing the row lock, make sure we have at least
+     * 9 packets in the pool */
+    PacketPoolWaitForN(9);
+
+    if (FBLOCK_TRYLOCK(fb) != 0) {
+        ctx->counters->rows_busy++;
+        FlowWheelSchedule(ctx, idx, now + 1);
+        return;
+    }
+
+    if (fb->tail == NULL) {
+        SC_ATOMIC_SET(fb->next_ts, INT_MAX);
+        ctx->counters->rows_empty++;
+        FBLOCK_UNLOCK(fb);
+        return;
+    }
+
+    int32_t next_ts = 0;
+    ctx->cnt += FlowManagerHashRowTimeout(fb->tail, ctx->ts, ctx->emergency,
+            ctx->counters, &next_ts);
+    const bool empty = (fb->tail == NULL);
+    SC_ATOMIC_SET(fb->next_ts, next_ts);
+    FBLOCK_UNLOCK(fb);
+
+    if (empty)
+        return;
+    /* next_ts 0 means flows are still in use, retry soon */
+    FlowWheelSchedule(ctx, idx, next_ts > 0 ? (uint32_t)next_ts : now + 1);
+}
+
+/** \internal
+ *  \brief timer wheel callback */
+static void FlowWheelExpire(uint32_t idx, uint32_t ts, void *data)
+{
+    FlowWheelCtx *ctx = data;
+    uint32_t *sched = &ctx->sched[idx / flowmgr_number];
+
+    /* stale entry, the row was rescheduled */
+    if (*sched != ts)
+        return;
+    *sched = 0;
+
+    int32_t check_ts = SC_ATOMIC_GET(flow_hash[idx].next_ts);
+    if (check_ts == INT_MAX) {
+        /* empty, will be handed to us again when a flow is added */
+        ctx->counters->rows_skipped++;
+        return;
+    }
+    if (check_ts > (int32_t)ctx->ts->tv_sec) {
+        ctx->counters->rows_skipped++;
+        FlowWheelSchedule(ctx, idx, (uint32_t)check_ts);
+        return;
+    }
+    FlowWheelCheckRow(ctx, idx);
+}
+
+/**
+ *  \internal
+ *
+ *  \brief time out flows using the timer wheel
+ *
+ *  Instead of walking all rows, only rows that have a flow that may time
+ *  out and rows that were updated by the workers are checked.
+ *
+ *  \param ts timestamp
+ *  \param instance flow manager instance
+ *  \param tw timer wheel of the flow manager
+ *  \param sched per row scheduled time
+ *  \param counters ptr to FlowTimeoutCounters structure
+ *
+ *  \retval cnt number of timed out flows
+ */
+static uint32_t FlowTimeoutWheel(struct timeval *ts, const uint32_t instance,
+        TimerWheel *tw, uint32_t *sched, FlowTimeoutCounters *counters)
+{
+    FlowWheelCtx ctx = { tw, sched, ts, counters, 0, 0 };
+
+    if (SC_ATOMIC_GET(flow_flags) & FLOW_EMERGENCY)
+        ctx.emergency = 1;
+
+    /* rows that are due */
+    TimerWheelExpire(tw, (uint32_t)ts->tv_sec, FlowWheelExpire, &ctx);
+
+    /* rows updated by the workers since our last run */
+    uint32_t cur = FlowWheelListTake(&flow_wheel_lists[instance]);
+    while (cur != 0 && cur != FLOW_WHEEL_LIST_END) {
+        const uint32_t idx = cur - 1;
+        FlowBucket *fb = &flow_hash[idx];
+
+        cur = SC_ATOMIC_GET(fb->wheel_next);
+        /* from here on the workers can add it to the list again */
+        SC_ATOMIC_SET(fb->wheel_next, FLOW_WHEEL_NOT_QUEUED);
+
+        FlowWheelCheckRow(&ctx, idx);
+    }
+    return ctx.cnt;
+}
+
 /**
  *  \internal
  *
@@ -594,12 +803,12 @@ static uint32_t FlowManagerHashRowCleanup(Flow *f)
  *
  *  \retval cnt number of removes out flows
  */
-static uint32_t FlowCleanupHash(void)
+static uint32_t FlowCleanupHash(FlowBucket *array, const uint32_t size)
 {
     uint32_t cnt = 0;
 
-    for (uint32_t idx = 0; idx < flow_config.hash_size; idx++) {
-        FlowBucket *fb = &flow_hash[idx];
+    for (uint32_t idx = 0; idx < size; idx++) {
+        FlowBucket *fb = &array[idx];
 
         FBLOCK_LOCK(fb);
 
@@ -614,6 +823,102 @@ static uint32_t FlowCleanupHash(void)
     return cnt;
 }
 
+/** \brief time out flows from a thread local flow hash
+ *
+ *  Used in "flow.thread-local" mode by the worker thread owning the hash.
+ *  Instead of checking the whole table at once each step checks a slice of
+ *  the rows. The steps are spaced so that the table is covered once per
+ *  second of packet time. In emergency mode the slices are larger, but the
+ *  full table is left to the flow managers, see FlowTimeoutThreadHashes().
+ *
+ *  Timed out flows are handed to the flow recycler like the flow manager
+ *  does.
+ *
+ *  \param fth thread local flow hash
+ *  \param ts packet time
+ *
+ *  \retval cnt number of timed out flows
+ */
+uint32_t FlowTimeoutThreadHash(FlowThreadHash *fth, struct timeval *ts)
+{
+    struct timeval diff;
+    timersub(ts, &fth->last_sweep, &diff);
+    if (diff.tv_sec == 0 && diff.tv_usec < FLOW_THREAD_SWEEP_STEP_USEC)
+        return 0;
+    fth->last_sweep = *ts;
+    SC_ATOMIC_SET(fth->last_sweep_sec, (uint64_t)ts->tv_sec);
+
+    int emergency = 0;
+    uint32_t rows = (fth->size / FLOW_THREAD_SWEEP_STEPS) + 1;
+    if (SC_ATOMIC_GET(flow_flags) & FLOW_EMERGENCY) {
+        emergency = 1;
+        rows = MIN(rows * FLOW_THREAD_SWEEP_EMERG_FACTOR, fth->size);
+    }
+
+    FlowTimeoutCounters counters;
+    memset(&counters, 0, sizeof(counters));
+    uint32_t cnt = 0;
+    uint32_t idx = fth->sweep_idx;
+
+    while (rows--) {
+        if (idx >= fth->size)
+            idx = 0;
+        FlowBucket *fb = &fth->array[idx++];
+
+        int32_t check_ts = SC_ATOMIC_GET(fb->next_ts);
+        if (check_ts > (int32_t)ts->tv_sec)
+            continue;
+
+        /* a flow manager is working on this row */
+        if (FBLOCK_TRYLOCK(fb) != 0)
+            continue;
+
+        if (fb->tail == NULL) {
+            SC_ATOMIC_SET(fb->next_ts, INT_MAX);
+            FBLOCK_UNLOCK(fb);
+            continue;
+        }
+
+        int32_t next_ts = 0;
+        cnt += FlowManagerHashRowTimeout(fb->tail, ts, emergency, &counters, &next_ts);
+        SC_ATOMIC_SET(fb->next_ts, next_ts);
+        FBLOCK_UNLOCK(fb);
+    }
+    fth->sweep_idx = idx;
+
+    return cnt;
+}
+
+/** \internal
+ *  \brief time out flows from the thread local flow hashes
+ *
+ *  Called by the flow managers. Tables are skipped while their owner
+ *  sweeps them, see FlowTimeoutThreadHash(). A worker that gets no
+ *  more packets doesn't, so then the flow managers take over. In
+ *  emergency mode all tables are checked, so that enough flows are
+ *  freed to leave it.
+ *
+ *  All tables have flow_config.hash_size rows, so each flow manager
+ *  checks the same range of rows as in the global hash.
+ *
+ *  \retval cnt number of timed out flows
+ */
+static uint32_t FlowTimeoutThreadHashes(struct timeval *ts, const int emergency,
+        uint32_t hash_min, uint32_t hash_max, FlowTimeoutCounters *counters)
+{
+    uint32_t cnt = 0;
+
+    for (FlowThreadHash *fth = FlowThreadHashGetList(); fth != NULL; fth = fth->next) {
+        if (!emergency && SC_ATOMIC_GET(fth->last_sweep_sec) + FLOW_THREAD_IDLE_SEC >
+                (uint64_t)ts->tv_sec)
+            continue;
+
+        cnt += FlowTimeoutHash(fth->array, ts, 0 /* check all */,
+                MIN(hash_min, fth->size), MIN(hash_max, fth->size), counters);
+    }
+    return cnt;
+}
+
 extern int g_detect_disabled;
 
 typedef struct FlowManagerThreadData_ {
@@ -621,6 +926,10 @@ typedef struct FlowManagerThreadData_ {
     uint32_t min;
     uint32_t max;
 
+    /* timer wheel mode */
+    TimerWheel *tw;
+    uint32_t *tw_sched;
+
     uint16_t flow_mgr_cnt_clo;
     uint16_t flow_mgr_cnt_new;
     uint16_t flow_mgr_cnt_est;
@@ -673,6 +982,20 @@ static TmEcode FlowManagerThreadInit(ThreadVars *t, const void *initdata, void *
 
     SCLogDebug("instance %u hash range %u %u", ftd->instance, ftd->min, ftd->max);
 
+    if (flow_config.timer_wheel) {
+        ftd->tw = SCMalloc(sizeof(TimerWheel));
+        /* one slot per row this instance owns */
+        ftd->tw_sched = SCCalloc(flow_config.hash_size / flowmgr_number + 1,
+                sizeof(uint32_t));
+        if (ftd->tw == NULL || ftd->tw_sched == NULL) {
+            SCFree(ftd->tw);
+            SCFree(ftd->tw_sched);
+            SCFree(ftd);
+            return TM_ECODE_FAILED;
+        }
+        TimerWheelInit(ftd->tw, 0);
+    }
+
     /* pass thread data back to caller */
     *data = ftd;
 
@@ -707,7 +1030,15 @@ static TmEcode FlowManagerThreadInit(ThreadVars *t, const void *initdata, void *
 
 static TmEcode FlowManagerThreadDeinit(ThreadVars *t, void *data)
 {
+    FlowManagerThreadData *ftd = data;
+
     PacketPoolDestroy();
+    if (ftd->tw != NULL) {
+        TimerWheelDestroy(ftd->tw);
+        SCFree(ftd->tw);
+    }
+    if (ftd->tw_sched != NULL)
+        SCFree(ftd->tw_sched);
     SCFree(data);
     return TM_ECODE_OK;
 }
@@ -774,7 +1105,16 @@ static TmEcode FlowManager(ThreadVars *th_v, void *thread_data)
 
         /* try to time out flows */
         FlowTimeoutCounters counters = { 0, 0, 0, 0, 0,0,0,0,0,0,0,0,0,0,0,0,0,0};
-        FlowTimeoutHash(&ts, 0 /* check all */, ftd->min, ftd->max, &counters);
+        if (ftd->tw != NULL) {
+            /* the wheel is filled using the normal timeouts, so in
+             * emergency mode fall back to checking all rows */
+            if (emerg == TRUE)
+                FlowTimeoutHash(flow_hash, &ts, 0 /* check all */, ftd->min, ftd->max, &counters);
+            FlowTimeoutWheel(&ts, ftd->instance, ftd->tw, ftd->tw_sched, &counters);
+        } else {
+            FlowTimeoutHash(flow_hash, &ts, 0 /* check all */, ftd->min, ftd->max, &counters);
+        }
+        FlowTimeoutThreadHashes(&ts, emerg == TRUE, ftd->min, ftd->max, &counters);
 
 
         if (ftd->instance == 0) {
@@ -879,13 +1219,19 @@ void FlowManagerThreadSpawn()
     intmax_t setting = 1;
     (void)ConfGetInt("flow.managers", &setting);
 
-    if (setting < 1 || setting > 1024) {
+    if (setting < 1 || setting > FLOW_MANAGERS_MAX) {
         FatalError(SC_ERR_INVALID_ARGUMENTS,
                 "invalid flow.managers setting %"PRIdMAX, setting);
     }
     flowmgr_number = (uint32_t)setting;
 
     SCLogConfig("using %u flow manager threads", flowmgr_number);
+    if (flow_config.timer_wheel) {
+        SCLogConfig("flow managers use a timer wheel to time out flows");
+        for (uint32_t u = 0; u < flowmgr_number; u++) {
+            SC_ATOMIC_SET(flow_wheel_lists[u].head, 0);
+        }
+    }
     SCCtrlCondInit(&flow_manager_ctrl_cond, NULL);
     SCCtrlMutexInit(&flow_manager_ctrl_mutex, NULL);
 
@@ -1071,7 +1417,10 @@ void FlowDisableFlowRecyclerThread(void)
     int cnt = 0;
 
     /* move all flows still in the hash to the recycler queue */
-    FlowCleanupHash();
+    FlowCleanupHash(flow_hash, flow_config.hash_size);
+    for (FlowThreadHash *fth = flow_thread_hash_list; fth != NULL; fth = fth->next) {
+        FlowCleanupHash(fth->array, fth->size);
+    }
 
     /* make sure all flows are processed */
     do {
@@ -1409,7 +1758,7 @@ static int FlowMgrTest05 (void)
     TimeGet(&ts);
     /* try to time out flows */
     FlowTimeoutCounters counters = { 0, 0, 0, 0, 0,0,0,0,0,0,0,0,0,0,0,0,0,0};
-    FlowTimeoutHash(&ts, 0 /* check all */, 0, flow_config.hash_size, &counters);
+    FlowTimeoutHash(flow_hash, &ts, 0 /* check all */, 0, flow_config.hash_size, &counters);
 
     if (flow_recycle_q.len > 0) {
         result = 1;
@@ -1419,6 +1768,165 @@ static int FlowMgrTest05 (void)
     FlowShutdown();
     return result;
 }
+
+/**
+ *  \test   Test flow lookup and timeout using a thread local flow hash
+ */
+static int FlowMgrTest06 (void)
+{
+    FlowInitConfig(FLOW_QUIET);
+    flow_config.thread_local_hash = true;
+
+    FlowThreadHash *fth = FlowThreadHashAlloc();
+    FAIL_IF_NULL(fth);
+
+    DecodeThreadVars dtv;
+    memset(&dtv, 0, sizeof(dtv));
+    dtv.flow_thread_hash = fth;
+
+    uint8_t payload[] = "Payload";
+    Packet *p = UTHBuildPacket(payload, sizeof(payload), IPPROTO_TCP);
+    FAIL_IF_NULL(p);
+
+    FlowHandlePacket(NULL, &dtv, p);
+    FAIL_IF_NULL(p->flow);
+    Flow *f = p->flow;
+    /* flow should be in the thread hash, not in the global one */
+    FAIL_IF_NOT(f->fb == &fth->array[p->flow_hash % fth->size]);
+    FAIL_IF_NOT_NULL(flow_hash[p->flow_hash % flow_config.hash_size].head);
+    FLOWLOCK_UNLOCK(f);
+    FlowDeReference(&p->flow);
+
+    /* lookup again, should get the same flow */
+    FlowHandlePacket(NULL, &dtv, p);
+    FAIL_IF_NOT(p->flow == f);
+    FLOWLOCK_UNLOCK(f);
+    FlowDeReference(&p->flow);
+    UTHFreePacket(p);
+
+    /* let the flow time out */
+    TimeSetIncrementTime(2000);
+    struct timeval ts;
+    TimeGet(&ts);
+
+    uint32_t cnt = 0;
+    for (int i = 0; i < FLOW_THREAD_SWEEP_STEPS; i++) {
+        ts.tv_sec++;
+        cnt += FlowTimeoutThreadHash(fth, &ts);
+    }
+    FAIL_IF_NOT(cnt == 1);
+    FAIL_IF_NOT(flow_recycle_q.len == 1);
+    FAIL_IF_NOT_NULL(f->fb->head);
+
+    FlowShutdown();
+    PASS;
+}
+
+/**
+ *  \test  Test the timer wheel mode of the flow manager
+ */
+static int FlowMgrTest07 (void)
+{
+    FlowInitConfig(FLOW_QUIET);
+    flow_config.timer_wheel = true;
+    SC_ATOMIC_SET(flow_wheel_lists[0].head, 0);
+
+    TimerWheel tw;
+    TimerWheelInit(&tw, 0);
+    uint32_t *sched = SCCalloc(flow_config.hash_size, sizeof(uint32_t));
+    FAIL_IF_NULL(sched);
+
+    DecodeThreadVars dtv;
+    memset(&dtv, 0, sizeof(dtv));
+
+    uint8_t payload[] = "Payload";
+    Packet *p = UTHBuildPacket(payload, sizeof(payload), IPPROTO_TCP);
+    FAIL_IF_NULL(p);
+    struct timeval ts = p->ts;
+
+    FlowHandlePacket(NULL, &dtv, p);
+    FAIL_IF_NULL(p->flow);
+    Flow *f = p->flow;
+    FlowBucket *fb = f->fb;
+    /* new flow should have put the row on the list */
+    FAIL_IF_NOT(SC_ATOMIC_GET(flow_wheel_lists[0].head) == (uint32_t)(fb - flow_hash) + 1);
+    FLOWLOCK_UNLOCK(f);
+    FlowDeReference(&p->flow);
+    UTHFreePacket(p);
+
+    /* row is checked and scheduled */
+    FlowTimeoutCounters counters = { 0, 0, 0, 0, 0,0,0,0,0,0,0,0,0,0,0,0,0,0};
+    FAIL_IF_NOT(FlowTimeoutWheel(&ts, 0, &tw, sched, &counters) == 0);
+    FAIL_IF_NOT(counters.rows_checked == 1);
+    FAIL_IF_NOT(SC_ATOMIC_GET(flow_wheel_lists[0].head) == 0);
+    FAIL_IF_NOT(tw.cnt == 1);
+
+    /* nothing to do in the next second */
+    ts.tv_sec++;
+    memset(&counters, 0, sizeof(counters));
+    FAIL_IF_NOT(FlowTimeoutWheel(&ts, 0, &tw, sched, &counters) == 0);
+    FAIL_IF_NOT(counters.rows_checked == 0);
+
+    /* let the flow time out */
+    ts.tv_sec += 3600;
+    FAIL_IF_NOT(FlowTimeoutWheel(&ts, 0, &tw, sched, &counters) == 1);
+    FAIL_IF_NOT(flow_recycle_q.len == 1);
+    FAIL_IF_NOT_NULL(fb->head);
+    FAIL_IF_NOT(tw.cnt == 0);
+
+    TimerWheelDestroy(&tw);
+    SCFree(sched);
+    FlowShutdown();
+    PASS;
+}
+
+/**
+ *  \test  Flows of a thread local flow hash whose owner gets no more
+ *         packets are timed out by the flow manager
+ */
+static int FlowMgrTest08 (void)
+{
+    FlowInitConfig(FLOW_QUIET);
+    flow_config.thread_local_hash = true;
+
+    FlowThreadHash *fth = FlowThreadHashAlloc();
+    FAIL_IF_NULL(fth);
+
+    DecodeThreadVars dtv;
+    memset(&dtv, 0, sizeof(dtv));
+    dtv.flow_thread_hash = fth;
+
+    uint8_t payload[] = "Payload";
+    Packet *p = UTHBuildPacket(payload, sizeof(payload), IPPROTO_TCP);
+    FAIL_IF_NULL(p);
+
+    FlowHandlePacket(NULL, &dtv, p);
+    FAIL_IF_NULL(p->flow);
+    FlowBucket *fb = &fth->array[p->flow_hash % fth->size];
+    FAIL_IF_NOT(fb->head == p->flow);
+    FLOWLOCK_UNLOCK(p->flow);
+    FlowDeReference(&p->flow);
+    UTHFreePacket(p);
+
+    struct timeval ts;
+    TimeGet(&ts);
+
+    /* the owner is active: the table is left to it */
+    FAIL_IF_NOT(FlowTimeoutThreadHash(fth, &ts) == 0);
+    ts.tv_sec++;
+    FlowTimeoutCounters counters = { 0, 0, 0, 0, 0,0,0,0,0,0,0,0,0,0,0,0,0,0};
+    FAIL_IF_NOT(FlowTimeoutThreadHashes(&ts, 0, 0, flow_config.hash_size, &counters) == 0);
+    FAIL_IF_NULL(fb->head);
+
+    /* the owner got no packets since then */
+    ts.tv_sec += 3600;
+    FAIL_IF_NOT(FlowTimeoutThreadHashes(&ts, 0, 0, flow_config.hash_size, &counters) == 1);
+    FAIL_IF_NOT(flow_recycle_q.len == 1);
+    FAIL_IF_NOT_NULL(fb->head);
+
+    FlowShutdown();
+    PASS;
+}
 #endif /* UNITTESTS */
 
 /**
@@ -1437,5 +1945,10 @@ void FlowMgrRegisterTests (void)
                    FlowMgrTest04);
     UtRegisterTest("FlowMgrTest05 -- Test flow Allocations when it reach memcap",
                    FlowMgrTest05);
+    UtRegisterTest("FlowMgrTest06 -- Thread local flow hash lookup and timeout",
+                   FlowMgrTest06);
+    UtRegisterTest("FlowMgrTest07 -- Timer wheel flow timeout", FlowMgrTest07);
+    UtRegisterTest("FlowMgrTest08 -- Thread local flow hash of an idle worker",
+                   FlowMgrTest08);
 #endif /* UNITTESTS */
 }
@@ -35,6 +35,8 @@ extern SCCtrlMutex flow_manager_ctrl_mutex;
 
 void FlowManagerThreadSpawn(void);
 void FlowDisableFlowManagerThread(void);
+uint32_t FlowTimeoutThreadHash(struct FlowThreadHash_ *fth, struct timeval *ts);
+void FlowManagerMarkRow(struct FlowBucket_ *fb);
 void FlowMgrRegisterTests (void);
 
 /** flow recycler scheduling condition */
@@ -89,11 +89,16 @@ extern FlowProtoFreeFunc flow_freefuncs[FLOW_PROTO_MAX];
 
 /** spare/unused/prealloced flows live here */
 extern FlowQueue flow_spare_q;
+/** per NUMA node spare queues when "threading.numa-aware" is enabled,
+ *  NULL otherwise */
+extern FlowQueue *flow_spare_node_q;
 
 /** queue to pass flows to cleanup/log thread(s) */
 extern FlowQueue flow_recycle_q;
 
 extern FlowBucket *flow_hash;
+/** per worker flow hashes in "flow.thread-local" mode */
+extern FlowThreadHash *flow_thread_hash_list;
 extern FlowConfig flow_config;
 
 /** flow memuse counter (atomic), for enforcing memcap limit */
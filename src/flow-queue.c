@@ -142,27 +142,32 @@ Flow *FlowDequeue (FlowQueue *q)
  *  \param q the source queue, where the flow will be removed. This queue is locked.
  *
  *  \note spare queue needs locking
+ *  \note in NUMA aware mode the flow goes to the spare queue of its node
  */
 void FlowMoveToSpare(Flow *f)
 {
+    FlowQueue *q = &flow_spare_q;
+    if (flow_spare_node_q != NULL && f->numa_node >= 0)
+        q = &flow_spare_node_q[f->numa_node];
+
     /* now put it in spare */
-    FQLOCK_LOCK(&flow_spare_q);
+    FQLOCK_LOCK(q);
 
     /* add to new queue (append) */
-    f->lprev = flow_spare_q.bot;
+    f->lprev = q->bot;
     if (f->lprev != NULL)
         f->lprev->lnext = f;
     f->lnext = NULL;
-    flow_spare_q.bot = f;
-    if (flow_spare_q.top == NULL)
-        flow_spare_q.top = f;
+    q->bot = f;
+    if (q->top == NULL)
+        q->top = f;
 
-    flow_spare_q.len++;
+    q->len++;
 #ifdef DBG_PERF
-    if (flow_spare_q.len > flow_spare_q.dbg_maxlen)
-        flow_spare_q.dbg_maxlen = flow_spare_q.len;
+    if (q->len > q->dbg_maxlen)
+        q->dbg_maxlen = q->len;
 #endif /* DBG_PERF */
 
-    FQLOCK_UNLOCK(&flow_spare_q);
+    FQLOCK_UNLOCK(q);
 }
 
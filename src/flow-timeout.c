@@ -420,10 +420,10 @@ done:
  *
  * \param q The queue to process flows from.
  */
-static inline void FlowForceReassemblyForHash(void)
+static inline void FlowForceReassemblyForHash(FlowBucket *array, const uint32_t size)
 {
-    for (uint32_t idx = 0; idx < flow_config.hash_size; idx++) {
-        FlowBucket *fb = &flow_hash[idx];
+    for (uint32_t idx = 0; idx < size; idx++) {
+        FlowBucket *fb = &array[idx];
 
         PacketPoolWaitForN(9);
         FBLOCK_LOCK(fb);
@@ -468,6 +468,12 @@ static inline void FlowForceReassemblyForHash(void)
 void FlowForceReassembly(void)
 {
     /* Carry out flow reassembly for unattended flows */
-    FlowForceReassemblyForHash();
+    FlowForceReassemblyForHash(flow_hash, flow_config.hash_size);
+
+    /* the worker threads are in their flow loop at this point, so they
+     * no longer modify their thread local flow hashes */
+    for (FlowThreadHash *fth = flow_thread_hash_list; fth != NULL; fth = fth->next) {
+        FlowForceReassemblyForHash(fth->array, fth->size);
+    }
     return;
 }
@@ -43,8 +43,12 @@
 #include "app-layer-parser.h"
 
 #include "util-validate.h"
+#include "util-numa.h"
+#include "tmqh-packetpool.h"
 
 #include "flow-util.h"
+#include "flow-private.h"
+#include "flow-manager.h"
 
 typedef DetectEngineThreadCtx *DetectEngineThreadCtxPtr;
 
@@ -65,6 +69,12 @@ typedef struct FlowWorkerThreadData_ {
     uint16_t both_bypass_pkts;
     uint16_t both_bypass_bytes;
 
+    uint16_t local_flows_pruned;
+
+    /** NUMA node of this thread and packets from a pool on another node */
+    int numa_node;
+    uint16_t numa_remote_pkts;
+
     PacketQueueNoLock pq;
 
 } FlowWorkerThreadData;
@@ -116,6 +126,22 @@ static TmEcode FlowWorkerThreadInit(ThreadVars *tv, const void *initdata, void *
         return TM_ECODE_FAILED;
     }
 
+    /* setup our own flow hash. It's owned by the flow engine, which frees
+     * it at shutdown. */
+    if (flow_config.thread_local_hash) {
+        fw->dtv->flow_thread_hash = FlowThreadHashAlloc();
+        if (fw->dtv->flow_thread_hash == NULL) {
+            FlowWorkerThreadDeinit(tv, fw);
+            return TM_ECODE_FAILED;
+        }
+        fw->local_flows_pruned = StatsRegisterCounter("flow.local_pruned", tv);
+    }
+
+    fw->numa_node = NumaThreadNode();
+    if (fw->numa_node >= 0) {
+        fw->numa_remote_pkts = StatsRegisterCounter("flow.numa_remote_pkts", tv);
+    }
+
     /* setup TCP */
     if (StreamTcpThreadInit(tv, NULL, &fw->stream_thread_ptr) != TM_ECODE_OK) {
         FlowWorkerThreadDeinit(tv, fw);
@@ -196,6 +222,20 @@ static TmEcode FlowWorker(ThreadVars *tv, Packet *p, void *data)
     /* update time */
     if (!(PKT_IS_PSEUDOPKT(p))) {
         TimeSetByThread(tv->id, &p->ts);
+
+        /* packet was allocated on another node, e.g. by a capture
+         * thread on the other socket in autofp mode */
+        if (fw->numa_node >= 0 && p->pool != NULL &&
+                p->pool->numa_node != fw->numa_node) {
+            StatsIncr(tv, fw->numa_remote_pkts);
+        }
+
+        /* time out flows in our own flow hash */
+        if (fw->dtv->flow_thread_hash != NULL) {
+            uint32_t pruned = FlowTimeoutThreadHash(fw->dtv->flow_thread_hash, &p->ts);
+            if (pruned > 0)
+                StatsAddUI64(tv, fw->local_flows_pruned, (uint64_t)pruned);
+        }
     }
 
     /* handle Flow */
@@ -324,6 +364,40 @@ void *FlowWorkerGetDetectCtxPtr(void *flow_worker)
     return SC_ATOMIC_GET(fw->detect_thread);
 }
 
+/** number of packets ahead in a batch for which the flow hash bucket and
+ *  the first flow in the bucket are prefetched */
+#define FLOW_WORKER_PREFETCH_BUCKET 4
+#define FLOW_WORKER_PREFETCH_FLOW   2
+
+/** \brief prefetch flow data for packets later in a batch
+ *
+ *  Called before packet 'idx' of a batch is passed to FlowWorker(). The
+ *  bucket is prefetched a few packets ahead, the flow in it a bit later
+ *  when the bucket has arrived, so both cache misses overlap with the
+ *  processing of the packets in between. */
+void FlowWorkerPrefetch(void *flow_worker, Packet **pkts, const uint32_t cnt,
+        const uint32_t idx)
+{
+    FlowWorkerThreadData *fw = flow_worker;
+
+    if (idx == 0) {
+        for (uint32_t i = 0; i < cnt && i < FLOW_WORKER_PREFETCH_BUCKET; i++) {
+            if (pkts[i]->flags & PKT_WANTS_FLOW)
+                FlowPrefetchBucket(fw->dtv, pkts[i]);
+        }
+    }
+    if (idx + FLOW_WORKER_PREFETCH_BUCKET < cnt) {
+        const Packet *p = pkts[idx + FLOW_WORKER_PREFETCH_BUCKET];
+        if (p->flags & PKT_WANTS_FLOW)
+            FlowPrefetchBucket(fw->dtv, p);
+    }
+    if (idx + FLOW_WORKER_PREFETCH_FLOW < cnt) {
+        const Packet *p = pkts[idx + FLOW_WORKER_PREFETCH_FLOW];
+        if (p->flags & PKT_WANTS_FLOW)
+            FlowPrefetchFlow(fw->dtv, p);
+    }
+}
+
 const char *ProfileFlowWorkerIdToString(enum ProfileFlowWorkerId fwi)
 {
     switch (fwi) {
@@ -30,6 +30,8 @@ const char *ProfileFlowWorkerIdToString(enum ProfileFlowWorkerId fwi);
 
 void FlowWorkerReplaceDetectCtx(void *flow_worker, void *detect_ctx);
 void *FlowWorkerGetDetectCtxPtr(void *flow_worker);
+void FlowWorkerPrefetch(void *flow_worker, struct Packet_ **pkts, const uint32_t cnt,
+        const uint32_t idx);
 
 void TmModuleFlowWorkerRegister (void);
 
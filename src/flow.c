@@ -56,6 +56,8 @@
 
 #include "util-debug.h"
 #include "util-privs.h"
+#include "util-numa.h"
+#include "util-hugepage.h"
 
 #include "detect.h"
 #include "detect-engine-state.h"
@@ -92,6 +94,8 @@ FlowProtoFreeFunc flow_freefuncs[FLOW_PROTO_MAX];
 
 /** spare/unused/prealloced flows live here */
 FlowQueue flow_spare_q;
+/** spare flows per NUMA node, indexed by Flow::numa_node */
+FlowQueue *flow_spare_node_q = NULL;
 
 FlowConfig flow_config;
 
@@ -190,6 +194,27 @@ int FlowUpdateSpareFlows(void)
         }
     }
 
+    /* node queues are filled by the flow recycler and by the workers
+     * allocating flows themselves. Only keep them from growing past
+     * prealloc. */
+    if (flow_spare_node_q != NULL) {
+        for (int n = 0; n < NumaNodeCount(); n++) {
+            FlowQueue *q = &flow_spare_node_q[n];
+
+            FQLOCK_LOCK(q);
+            len = q->len;
+            FQLOCK_UNLOCK(q);
+
+            for ( ; len > flow_config.prealloc; len--) {
+                Flow *f = FlowDequeue(q);
+                if (f == NULL)
+                    break;
+
+                FlowFree(f);
+            }
+        }
+    }
+
     return 1;
 }
 
@@ -539,6 +564,17 @@ void FlowInitConfig(char quiet)
     FlowQueueInit(&flow_spare_q);
     FlowQueueInit(&flow_recycle_q);
 
+    if (NumaEnabled()) {
+        flow_spare_node_q = SCCalloc(NumaNodeCount(), sizeof(FlowQueue));
+        if (flow_spare_node_q == NULL) {
+            SCLogError(SC_ERR_FLOW_INIT, "allocating per node spare queues failed");
+            exit(EXIT_FAILURE);
+        }
+        for (int n = 0; n < NumaNodeCount(); n++) {
+            FlowQueueInit(&flow_spare_node_q[n]);
+        }
+    }
+
     /* set defaults */
     flow_config.hash_rand   = (uint32_t)RandomGet();
     flow_config.hash_size   = FLOW_DEFAULT_HASHSIZE;
@@ -560,6 +596,17 @@ void FlowInitConfig(char quiet)
         flow_config.emergency_recovery = FLOW_DEFAULT_EMERGENCY_RECOVERY;
     }
 
+    int thread_local_hash = 0;
+    if (ConfGetBool("flow.thread-local", &thread_local_hash) == 1 &&
+            thread_local_hash == 1) {
+        flow_config.thread_local_hash = true;
+    }
+
+    int timer_wheel = 0;
+    if (ConfGetBool("flow.timer-wheel", &timer_wheel) == 1 && timer_wheel == 1) {
+        flow_config.timer_wheel = true;
+    }
+
     /* Check if we have memcap and hash_size defined at config */
     const char *conf_val;
     uint32_t configval = 0;
@@ -621,17 +668,17 @@ void FlowInitConfig(char quiet)
                 (uintmax_t)sizeof(FlowBucket));
         exit(EXIT_FAILURE);
     }
-    flow_hash = SCMallocAligned(flow_config.hash_size * sizeof(FlowBucket), CLS);
+    flow_hash = HugePageAlloc(flow_config.hash_size * sizeof(FlowBucket));
     if (unlikely(flow_hash == NULL)) {
         SCLogError(SC_ERR_FATAL, "Fatal error encountered in FlowInitConfig. Exiting...");
         exit(EXIT_FAILURE);
     }
-    memset(flow_hash, 0, flow_config.hash_size * sizeof(FlowBucket));
 
     uint32_t i = 0;
     for (i = 0; i < flow_config.hash_size; i++) {
         FBLOCK_INIT(&flow_hash[i]);
         SC_ATOMIC_INIT(flow_hash[i].next_ts);
+        SC_ATOMIC_INIT(flow_hash[i].wheel_next);
     }
     (void) SC_ATOMIC_ADD(flow_memuse, (flow_config.hash_size * sizeof(FlowBucket)));
 
@@ -640,6 +687,11 @@ void FlowInitConfig(char quiet)
                   "%" PRIu32 " buckets of size %" PRIuMAX "",
                   SC_ATOMIC_GET(flow_memuse), flow_config.hash_size,
                   (uintmax_t)sizeof(FlowBucket));
+        if (flow_config.thread_local_hash) {
+            SCLogConfig("flow.thread-local enabled: each worker thread will "
+                    "allocate its own flow hash of %"PRIu32" buckets",
+                    flow_config.hash_size);
+        }
     }
 
     /* pre allocate flows */
@@ -696,6 +748,16 @@ void FlowShutdown(void)
     while((f = FlowDequeue(&flow_recycle_q))) {
         FlowFree(f);
     }
+    if (flow_spare_node_q != NULL) {
+        for (int n = 0; n < NumaNodeCount(); n++) {
+            while((f = FlowDequeue(&flow_spare_node_q[n]))) {
+                FlowFree(f);
+            }
+            FlowQueueDestroy(&flow_spare_node_q[n]);
+        }
+        SCFree(flow_spare_node_q);
+        flow_spare_node_q = NULL;
+    }
 
     /* clear and free the hash */
     if (flow_hash != NULL) {
@@ -715,10 +777,11 @@ void FlowShutdown(void)
 
             FBLOCK_DESTROY(&flow_hash[u]);
         }
-        SCFreeAligned(flow_hash);
+        HugePageFree(flow_hash);
         flow_hash = NULL;
     }
     (void) SC_ATOMIC_SUB(flow_memuse, flow_config.hash_size * sizeof(FlowBucket));
+    FlowThreadHashFreeAll();
     FlowQueueDestroy(&flow_spare_q);
     FlowQueueDestroy(&flow_recycle_q);
     return;
@@ -1123,6 +1186,8 @@ void FlowUpdateState(Flow *f, enum FlowState s)
         /* and reset the flow buckup next_ts value so that the flow manager
          * has to revisit this row */
         SC_ATOMIC_SET(f->fb->next_ts, 0);
+        if (flow_config.timer_wheel)
+            FlowManagerMarkRow(f->fb);
     }
 }
 
@@ -289,6 +289,11 @@ typedef struct FlowCnf_
     uint32_t emerg_timeout_est;
     uint32_t emergency_recovery;
 
+    /** flow.thread-local: each worker uses its own flow hash */
+    bool thread_local_hash;
+    /** flow.timer-wheel: flow manager schedules rows in a timer wheel */
+    bool timer_wheel;
+
     SC_ATOMIC_DECLARE(uint64_t, memcap);
 } FlowConfig;
 
@@ -363,6 +368,10 @@ typedef struct Flow_
     uint16_t vlan_id[2];
     uint8_t vlan_idx;
 
+    /** NUMA node the flow memory lives on, NUMA_NODE_NONE if unknown.
+     *  Static after alloc, survives recycling. */
+    int8_t numa_node;
+
     /** Incoming interface */
     struct LiveDevice_ *livedev;
 
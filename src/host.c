@@ -42,6 +42,7 @@
 #include "detect-engine-threshold.h"
 
 #include "util-hash-lookup3.h"
+#include "util-hugepage.h"
 
 static Host *HostGetUsedHost(void);
 
@@ -239,12 +240,11 @@ void HostInitConfig(char quiet)
                 (uintmax_t)sizeof(HostHashRow));
         exit(EXIT_FAILURE);
     }
-    host_hash = SCMallocAligned(host_config.hash_size * sizeof(HostHashRow), CLS);
+    host_hash = HugePageAlloc(host_config.hash_size * sizeof(HostHashRow));
     if (unlikely(host_hash == NULL)) {
         SCLogError(SC_ERR_FATAL, "Fatal error encountered in HostInitConfig. Exiting...");
         exit(EXIT_FAILURE);
     }
-    memset(host_hash, 0, host_config.hash_size * sizeof(HostHashRow));
 
     uint32_t i = 0;
     for (i = 0; i < host_config.hash_size; i++) {
@@ -327,7 +327,7 @@ void HostShutdown(void)
 
             HRLOCK_DESTROY(&host_hash[u]);
         }
-        SCFreeAligned(host_hash);
+        HugePageFree(host_hash);
         host_hash = NULL;
     }
     (void) SC_ATOMIC_SUB(host_memuse, host_config.hash_size * sizeof(HostHashRow));
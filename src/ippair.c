@@ -41,6 +41,7 @@
 #include "detect-engine-threshold.h"
 
 #include "util-hash-lookup3.h"
+#include "util-hugepage.h"
 
 static IPPair *IPPairGetUsedIPPair(void);
 
@@ -234,12 +235,11 @@ void IPPairInitConfig(char quiet)
                 (uintmax_t)sizeof(IPPairHashRow));
         exit(EXIT_FAILURE);
     }
-    ippair_hash = SCMallocAligned(ippair_config.hash_size * sizeof(IPPairHashRow), CLS);
+    ippair_hash = HugePageAlloc(ippair_config.hash_size * sizeof(IPPairHashRow));
     if (unlikely(ippair_hash == NULL)) {
         SCLogError(SC_ERR_FATAL, "Fatal error encountered in IPPairInitConfig. Exiting...");
         exit(EXIT_FAILURE);
     }
-    memset(ippair_hash, 0, ippair_config.hash_size * sizeof(IPPairHashRow));
 
     uint32_t i = 0;
     for (i = 0; i < ippair_config.hash_size; i++) {
@@ -322,7 +322,7 @@ void IPPairShutdown(void)
 
             HRLOCK_DESTROY(&ippair_hash[u]);
         }
-        SCFreeAligned(ippair_hash);
+        HugePageFree(ippair_hash);
         ippair_hash = NULL;
     }
     (void) SC_ATOMIC_SUB(ippair_memuse, ippair_config.hash_size * sizeof(IPPairHashRow));
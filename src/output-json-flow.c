@@ -116,7 +116,7 @@ static JsonBuilder *CreateEveHeaderFromFlow(const Flow *f, const char *event_typ
 #if 0 // TODO
     /* sensor id */
     if (sensor_id >= 0)
-        json_object_set_new(js, "sensor_id", json_integer(sensor_id));
+        jb_set_uint(jb, "sensor_id", sensor_id);
 #endif
 
     /* input interface */
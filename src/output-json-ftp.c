@@ -60,41 +60,27 @@ typedef struct LogFTPLogThread_ {
     MemBuffer          *buffer;
 } LogFTPLogThread;
 
-static json_t *JsonFTPLogCommand(Flow *f, FTPTransaction *tx)
+static void JsonFTPLogCommand(Flow *f, FTPTransaction *tx, JsonBuilder *jb)
 {
-    json_t *cjs = json_object();
-    if (!cjs) {
-        return cjs;
-    }
-
-    /* Preallocate array objects to simplify failure case */
-    json_t *js_resplist = NULL;
-    json_t *js_respcode_list = NULL;
-    if (!TAILQ_EMPTY(&tx->response_list)) {
-        js_resplist = json_array();
-        js_respcode_list = json_array();
-
-        if (unlikely(js_resplist == NULL || js_respcode_list == NULL)) {
-            if (js_resplist) {
-                json_decref(js_resplist);
-            } else {
-                json_decref(js_respcode_list);
-            }
-            return cjs;
-        }
-    }
-
-    json_object_set_new(cjs, "command", json_string(tx->command_descriptor->command_name));
+    jb_set_string(jb, "command", tx->command_descriptor->command_name);
     uint32_t min_length = tx->command_descriptor->command_length + 1; /* command + space */
     if (tx->request_length > min_length) {
-        json_object_set_new(cjs, "command_data",
-                            JsonAddStringN((const char *)tx->request + min_length,
-                                           tx->request_length - min_length));
+        jb_set_string_from_bytes(jb, "command_data",
+                (const uint8_t *)tx->request + min_length,
+                tx->request_length - min_length);
     } else {
-        json_object_set_new(cjs, "command_data", json_string(NULL));
+        jb_set_null(jb, "command_data");
     }
 
     if (!TAILQ_EMPTY(&tx->response_list)) {
+        /* the completion codes are collected into a separate builder
+         * so they can be gathered in the same pass as the replies */
+        JsonBuilder *js_respcode_list = jb_new_array();
+        if (unlikely(js_respcode_list == NULL)) {
+            return;
+        }
+        jb_open_array(jb, "reply");
+
         FTPString *response;
         TAILQ_FOREACH(response, &tx->response_list, next) {
             /* handle multiple lines within the response, \r\n delimited */
@@ -107,15 +93,15 @@ static json_t *JsonFTPLogCommand(Flow *f, FTPTransaction *tx)
                 if (pos >= 3)  {
                     /* Gather the completion code if present */
                     if (isdigit(where[0]) && isdigit(where[1]) && isdigit(where[2])) {
-                        json_array_append_new(js_respcode_list,
-                                              JsonAddStringN((const char *)where, 3));
+                        jb_append_string_from_bytes(js_respcode_list,
+                                (const uint8_t *)where, 3);
                         offset = 4;
                     }
                 }
                 /* move past 3 character completion code */
                 if (pos >= offset) {
-                    json_array_append_new(js_resplist,
-                                          JsonAddStringN((const char *)where + offset, pos - offset));
+                    jb_append_string_from_bytes(jb,
+                            (const uint8_t *)where + offset, pos - offset);
                 }
 
                 where += pos;
@@ -123,24 +109,22 @@ static json_t *JsonFTPLogCommand(Flow *f, FTPTransaction *tx)
             }
         }
 
-        json_object_set_new(cjs, "reply", js_resplist);
-        json_object_set_new(cjs, "completion_code", js_respcode_list);
+        jb_close(jb);
+        jb_close(js_respcode_list);
+        jb_set_object(jb, "completion_code", js_respcode_list);
+        jb_free(js_respcode_list);
     }
 
     if (tx->dyn_port) {
-        json_object_set_new(cjs, "dynamic_port", json_integer(tx->dyn_port));
+        jb_set_uint(jb, "dynamic_port", tx->dyn_port);
     }
 
     if (tx->command_descriptor->command == FTP_COMMAND_PORT ||
         tx->command_descriptor->command == FTP_COMMAND_EPRT) {
-        json_object_set_new(cjs, "mode",
-                json_string((char *)(tx->active ? "active" : "passive")));
+        jb_set_string(jb, "mode", (char *)(tx->active ? "active" : "passive"));
     }
 
-    json_object_set_new(cjs, "reply_received",
-            json_string((char *)(tx->done ? "yes" : "no")));
-
-    return cjs;
+    jb_set_string(jb, "reply_received", (char *)(tx->done ? "yes" : "no"));
 }
 
 
@@ -159,25 +143,27 @@ static int JsonFTPLogger(ThreadVars *tv, void *thread_data,
     LogFTPLogThread *thread = thread_data;
     LogFTPFileCtx *ftp_ctx = thread->ftplog_ctx;
 
-    json_t *js = CreateJSONHeaderWithTxId(p, LOG_DIR_FLOW, event_type, tx_id);
-    if (likely(js)) {
-        JsonAddCommonOptions(&ftp_ctx->cfg, p, f, js);
-        json_t *cjs = NULL;
+    JsonBuilder *jb = CreateEveHeaderWithTxId(p, LOG_DIR_FLOW, event_type, NULL, tx_id);
+    if (likely(jb)) {
+        EveAddCommonOptions(&ftp_ctx->cfg, p, f, jb);
+        JsonBuilderMark mark = { 0, 0, 0 };
+        jb_get_mark(jb, &mark);
+        jb_open_object(jb, event_type);
         if (f->alproto == ALPROTO_FTPDATA) {
-            cjs = JsonFTPDataAddMetadata(f);
+            if (!EveFTPDataAddMetadata(f, jb)) {
+                jb_restore_mark(jb, &mark);
+            } else {
+                jb_close(jb);
+            }
         } else {
-            cjs = JsonFTPLogCommand(f, tx);
-        }
-
-        if (cjs) {
-            json_object_set_new(js, event_type, cjs);
+            JsonFTPLogCommand(f, tx, jb);
+            jb_close(jb);
         }
 
         MemBufferReset(thread->buffer);
-        OutputJSONBuffer(js, thread->ftplog_ctx->file_ctx, &thread->buffer);
+        OutputJsonBuilderBuffer(jb, thread->ftplog_ctx->file_ctx, &thread->buffer);
 
-        json_object_clear(js);
-        json_decref(js);
+        jb_free(jb);
     }
     return TM_ECODE_OK;
 }
@@ -72,21 +72,18 @@ static int JsonTemplateLogger(ThreadVars *tv, void *thread_data,
 
     SCLogNotice("Logging template transaction %"PRIu64".", templatetx->tx_id);
 
-    json_t *js = CreateJSONHeader(p, LOG_DIR_PACKET, "template", NULL);
+    JsonBuilder *js = CreateEveHeader(p, LOG_DIR_PACKET, "template", NULL);
     if (unlikely(js == NULL)) {
         return TM_ECODE_FAILED;
     }
 
-    json_t *templatejs = json_object();
-    if (unlikely(templatejs == NULL)) {
-        goto error;
-    }
+    jb_open_object(js, "template");
 
     /* Convert the request buffer to a string then log. */
     char *request_buffer = BytesToString(templatetx->request_buffer,
         templatetx->request_buffer_len);
     if (request_buffer != NULL) {
-        json_object_set_new(templatejs, "request", json_string(request_buffer));
+        jb_set_string(js, "request", request_buffer);
         SCFree(request_buffer);
     }
 
@@ -94,22 +91,18 @@ static int JsonTemplateLogger(ThreadVars *tv, void *thread_data,
     char *response_buffer = BytesToString(templatetx->response_buffer,
         templatetx->response_buffer_len);
     if (response_buffer != NULL) {
-        json_object_set_new(templatejs, "response",
-            json_string(response_buffer));
+        jb_set_string(js, "response", response_buffer);
         SCFree(response_buffer);
     }
 
-    json_object_set_new(js, "template", templatejs);
+    /* Close template. */
+    jb_close(js);
 
     MemBufferReset(thread->buffer);
-    OutputJSONBuffer(js, thread->templatelog_ctx->file_ctx, &thread->buffer);
+    OutputJsonBuilderBuffer(js, thread->templatelog_ctx->file_ctx, &thread->buffer);
 
-    json_decref(js);
+    jb_free(js);
     return TM_ECODE_OK;
-    
-error:
-    json_decref(js);
-    return TM_ECODE_FAILED;
 }
 
 static void OutputTemplateLogDeInitCtxSub(OutputCtx *output_ctx)
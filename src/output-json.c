@@ -75,7 +75,6 @@
 #define MAX_JSON_SIZE 2048
 
 static void OutputJsonDeInitCtx(OutputCtx *);
-static void CreateJSONCommunityFlowId(json_t *js, const Flow *f, const uint16_t seed);
 static void CreateEveCommunityFlowId(JsonBuilder *js, const Flow *f, const uint16_t seed);
 
 static const char *TRAFFIC_ID_PREFIX = "traffic/id/";
@@ -135,77 +134,6 @@ json_t *SCJsonString(const char *val)
 /* Default Sensor ID value */
 static int64_t sensor_id = -1; /* -1 = not defined */
 
-/**
- * \brief Create a JSON string from a character sequence
- *
- * \param Pointer to character sequence
- * \param Number of characters to use from the sequence
- * \retval JSON object for the character sequence
- */
-json_t *JsonAddStringN(const char *string, size_t size)
-{
-    char tmpbuf[size + 1];
-
-    memcpy(tmpbuf, string, size);
-    tmpbuf[size] = '\0';
-
-    return SCJsonString(tmpbuf);
-}
-
-static void JsonAddPacketvars(const Packet *p, json_t *js_vars)
-{
-    if (p == NULL || p->pktvar == NULL) {
-        return;
-    }
-    json_t *js_pktvars = NULL;
-    PktVar *pv = p->pktvar;
-    while (pv != NULL) {
-        if (pv->key || pv->id > 0) {
-            if (js_pktvars == NULL) {
-                js_pktvars = json_array();
-                if (js_pktvars == NULL)
-                    break;
-            }
-            json_t *js_pair = json_object();
-            if (js_pair == NULL) {
-                break;
-            }
-
-            if (pv->key != NULL) {
-                uint32_t offset = 0;
-                uint8_t keybuf[pv->key_len + 1];
-                PrintStringsToBuffer(keybuf, &offset,
-                        sizeof(keybuf),
-                        pv->key, pv->key_len);
-                uint32_t len = pv->value_len;
-                uint8_t printable_buf[len + 1];
-                offset = 0;
-                PrintStringsToBuffer(printable_buf, &offset,
-                        sizeof(printable_buf),
-                        pv->value, pv->value_len);
-                json_object_set_new(js_pair, (char *)keybuf,
-                        json_string((char *)printable_buf));
-            } else {
-                const char *varname = VarNameStoreLookupById(pv->id, VAR_TYPE_PKT_VAR);
-                uint32_t len = pv->value_len;
-                uint8_t printable_buf[len + 1];
-                uint32_t offset = 0;
-                PrintStringsToBuffer(printable_buf, &offset,
-                        sizeof(printable_buf),
-                        pv->value, pv->value_len);
-
-                json_object_set_new(js_pair, varname,
-                        json_string((char *)printable_buf));
-            }
-            json_array_append_new(js_pktvars, js_pair);
-        }
-        pv = pv->next;
-    }
-    if (js_pktvars) {
-        json_object_set_new(js_vars, "pktvars", js_pktvars);
-    }
-}
-
 static void EveAddPacketVars(const Packet *p, JsonBuilder *js_vars)
 {
     if (p == NULL || p->pktvar == NULL) {
@@ -275,145 +203,6 @@ static bool SCStringHasPrefix(const char *s, const char *prefix)
  * Adds "flowvars" (map), "flowints" (map) and "flowbits" (array) to
  * the json object provided as js_root.
  */
-static void JsonAddFlowVars(const Flow *f, json_t *js_root, json_t **js_traffic)
-{
-    if (f == NULL || f->flowvar == NULL) {
-        return;
-    }
-    json_t *js_flowvars = NULL;
-    json_t *js_traffic_id = NULL;
-    json_t *js_traffic_label = NULL;
-    json_t *js_flowints = NULL;
-    json_t *js_flowbits = NULL;
-    GenericVar *gv = f->flowvar;
-    while (gv != NULL) {
-        if (gv->type == DETECT_FLOWVAR || gv->type == DETECT_FLOWINT) {
-            FlowVar *fv = (FlowVar *)gv;
-            if (fv->datatype == FLOWVAR_TYPE_STR && fv->key == NULL) {
-                const char *varname = VarNameStoreLookupById(fv->idx,
-                        VAR_TYPE_FLOW_VAR);
-                if (varname) {
-                    if (js_flowvars == NULL) {
-                        js_flowvars = json_array();
-                        if (js_flowvars == NULL)
-                            break;
-                    }
-
-                    uint32_t len = fv->data.fv_str.value_len;
-                    uint8_t printable_buf[len + 1];
-                    uint32_t offset = 0;
-                    PrintStringsToBuffer(printable_buf, &offset,
-                            sizeof(printable_buf),
-                            fv->data.fv_str.value, fv->data.fv_str.value_len);
-
-                    json_t *js_flowvar = json_object();
-                    if (unlikely(js_flowvar == NULL)) {
-                        break;
-                    }
-                    json_object_set_new(js_flowvar, varname,
-                            json_string((char *)printable_buf));
-                    json_array_append_new(js_flowvars, js_flowvar);
-                }
-            } else if (fv->datatype == FLOWVAR_TYPE_STR && fv->key != NULL) {
-                if (js_flowvars == NULL) {
-                    js_flowvars = json_array();
-                    if (js_flowvars == NULL)
-                        break;
-                }
-
-                uint8_t keybuf[fv->keylen + 1];
-                uint32_t offset = 0;
-                PrintStringsToBuffer(keybuf, &offset,
-                        sizeof(keybuf),
-                        fv->key, fv->keylen);
-
-                uint32_t len = fv->data.fv_str.value_len;
-                uint8_t printable_buf[len + 1];
-                offset = 0;
-                PrintStringsToBuffer(printable_buf, &offset,
-                        sizeof(printable_buf),
-                        fv->data.fv_str.value, fv->data.fv_str.value_len);
-
-                json_t *js_flowvar = json_object();
-                if (unlikely(js_flowvar == NULL)) {
-                    break;
-                }
-                json_object_set_new(js_flowvar, (const char *)keybuf,
-                        json_string((char *)printable_buf));
-                json_array_append_new(js_flowvars, js_flowvar);
-            } else if (fv->datatype == FLOWVAR_TYPE_INT) {
-                const char *varname = VarNameStoreLookupById(fv->idx,
-                        VAR_TYPE_FLOW_INT);
-                if (varname) {
-                    if (js_flowints == NULL) {
-                        js_flowints = json_object();
-                        if (js_flowints == NULL)
-                            break;
-                    }
-
-                    json_object_set_new(js_flowints, varname,
-                            json_integer(fv->data.fv_int.value));
-                }
-
-            }
-        } else if (gv->type == DETECT_FLOWBITS) {
-            FlowBit *fb = (FlowBit *)gv;
-            const char *varname = VarNameStoreLookupById(fb->idx,
-                    VAR_TYPE_FLOW_BIT);
-            if (varname) {
-                if (SCStringHasPrefix(varname, TRAFFIC_ID_PREFIX)) {
-                    if (js_traffic_id == NULL) {
-                        js_traffic_id = json_array();
-                        if (unlikely(js_traffic_id == NULL)) {
-                            break;
-                        }
-                    }
-                    json_array_append_new(js_traffic_id,
-                            json_string(&varname[traffic_id_prefix_len]));
-                } else if (SCStringHasPrefix(varname, TRAFFIC_LABEL_PREFIX)) {
-                    if (js_traffic_label == NULL) {
-                        js_traffic_label = json_array();
-                        if (unlikely(js_traffic_label == NULL)) {
-                            break;
-                        }
-                    }
-                    json_array_append_new(js_traffic_label,
-                            json_string(&varname[traffic_label_prefix_len]));
-                } else {
-                    if (js_flowbits == NULL) {
-                        js_flowbits = json_array();
-                        if (unlikely(js_flowbits == NULL))
-                            break;
-                    }
-                    json_array_append_new(js_flowbits, json_string(varname));
-                }
-            }
-        }
-        gv = gv->next;
-    }
-    if (js_flowbits) {
-        json_object_set_new(js_root, "flowbits", js_flowbits);
-    }
-    if (js_flowints) {
-        json_object_set_new(js_root, "flowints", js_flowints);
-    }
-    if (js_flowvars) {
-        json_object_set_new(js_root, "flowvars", js_flowvars);
-    }
-
-    if (js_traffic_id != NULL || js_traffic_label != NULL) {
-        *js_traffic = json_object();
-        if (likely(*js_traffic != NULL)) {
-            if (js_traffic_id != NULL) {
-                json_object_set_new(*js_traffic, "id", js_traffic_id);
-            }
-            if (js_traffic_label != NULL) {
-                json_object_set_new(*js_traffic, "label", js_traffic_label);
-            }
-        }
-    }
-}
-
 static void EveAddFlowVars(const Flow *f, JsonBuilder *js_root, JsonBuilder **js_traffic)
 {
     if (f == NULL || f->flowvar == NULL) {
@@ -555,27 +344,6 @@ static void EveAddFlowVars(const Flow *f, JsonBuilder *js_root, JsonBuilder **js
 /**
  * \brief Add top-level metadata to the eve json object.
  */
-static void JsonAddMetadata(const Packet *p, const Flow *f, json_t *js)
-{
-    if ((p && p->pktvar) || (f && f->flowvar)) {
-        json_t *js_vars = json_object();
-        json_t *js_traffic = NULL;
-        if (js_vars) {
-            if (f && f->flowvar) {
-                JsonAddFlowVars(f, js_vars, &js_traffic);
-                if (js_traffic != NULL) {
-                    json_object_set_new(js, "traffic", js_traffic);
-                }
-            }
-            if (p && p->pktvar) {
-                JsonAddPacketvars(p, js_vars);
-            }
-
-            json_object_set_new(js, "metadata", js_vars);
-        }
-    }
-}
-
 static void EveAddMetadata(const Packet *p, const Flow *f, JsonBuilder *js)
 {
     if ((p && p->pktvar) || (f && f->flowvar)) {
@@ -599,17 +367,6 @@ static void EveAddMetadata(const Packet *p, const Flow *f, JsonBuilder *js)
     }
 }
 
-void JsonAddCommonOptions(const OutputJsonCommonSettings *cfg,
-        const Packet *p, const Flow *f, json_t *js)
-{
-    if (cfg->include_metadata) {
-        JsonAddMetadata(p, f, js);
-    }
-    if (cfg->include_community_id && f != NULL) {
-        CreateJSONCommunityFlowId(js, f, cfg->community_id_seed);
-    }
-}
-
 void EveAddCommonOptions(const OutputJsonCommonSettings *cfg,
         const Packet *p, const Flow *f, JsonBuilder *js)
 {
@@ -621,31 +378,6 @@ void EveAddCommonOptions(const OutputJsonCommonSettings *cfg,
     }
 }
 
-/**
- * \brief Jsonify a packet
- *
- * \param p Packet
- * \param js JSON object
- * \param max_length If non-zero, restricts the number of packet data bytes handled.
- */
-void JsonPacket(const Packet *p, json_t *js, unsigned long max_length)
-{
-    unsigned long max_len = max_length == 0 ? GET_PKT_LEN(p) : max_length;
-    unsigned long len = 2 * max_len;
-    uint8_t encoded_packet[len];
-    if (Base64Encode((unsigned char*) GET_PKT_DATA(p), max_len, encoded_packet, &len) == SC_BASE64_OK) {
-        json_object_set_new(js, "packet", json_string((char *)encoded_packet));
-    }
-
-    /* Create packet info. */
-    json_t *packetinfo_js = json_object();
-    if (unlikely(packetinfo_js == NULL)) {
-        return;
-    }
-    json_object_set_new(packetinfo_js, "linktype", json_integer(p->datalink));
-    json_object_set_new(js, "packet_info", packetinfo_js);
-}
-
 /**
  * \brief Jsonify a packet
  *
@@ -671,29 +403,6 @@ void EvePacket(const Packet *p, JsonBuilder *js, unsigned long max_length)
     jb_close(js);
 }
 
-/** \brief jsonify tcp flags field
- *  Only add 'true' fields in an attempt to keep things reasonably compact.
- */
-void JsonTcpFlags(uint8_t flags, json_t *js)
-{
-    if (flags & TH_SYN)
-        json_object_set_new(js, "syn", json_true());
-    if (flags & TH_FIN)
-        json_object_set_new(js, "fin", json_true());
-    if (flags & TH_RST)
-        json_object_set_new(js, "rst", json_true());
-    if (flags & TH_PUSH)
-        json_object_set_new(js, "psh", json_true());
-    if (flags & TH_ACK)
-        json_object_set_new(js, "ack", json_true());
-    if (flags & TH_URG)
-        json_object_set_new(js, "urg", json_true());
-    if (flags & TH_ECN)
-        json_object_set_new(js, "ecn", json_true());
-    if (flags & TH_CWR)
-        json_object_set_new(js, "cwr", json_true());
-}
-
 /** \brief jsonify tcp flags field
  *  Only add 'true' fields in an attempt to keep things reasonably compact.
  */
@@ -843,139 +552,6 @@ void JsonAddrInfoInit(const Packet *p, enum OutputJsonLogDirection dir, JsonAddr
     strlcpy(addr->proto, proto, JSON_PROTO_LEN);
 }
 
-/**
- * \brief Add five tuple from packet to JSON object
- *
- * \param p Packet
- * \param dir log direction (packet or flow)
- * \param js JSON object
- */
-void JsonFiveTuple(const Packet *p, enum OutputJsonLogDirection dir, json_t *js)
-{
-    char srcip[46] = {0}, dstip[46] = {0};
-    Port sp, dp;
-    char proto[16];
-
-    switch (dir) {
-        case LOG_DIR_PACKET:
-            if (PKT_IS_IPV4(p)) {
-                PrintInet(AF_INET, (const void *)GET_IPV4_SRC_ADDR_PTR(p),
-                        srcip, sizeof(srcip));
-                PrintInet(AF_INET, (const void *)GET_IPV4_DST_ADDR_PTR(p),
-                        dstip, sizeof(dstip));
-            } else if (PKT_IS_IPV6(p)) {
-                PrintInet(AF_INET6, (const void *)GET_IPV6_SRC_ADDR(p),
-                        srcip, sizeof(srcip));
-                PrintInet(AF_INET6, (const void *)GET_IPV6_DST_ADDR(p),
-                        dstip, sizeof(dstip));
-            } else {
-                /* Not an IP packet so don't do anything */
-                return;
-            }
-            sp = p->sp;
-            dp = p->dp;
-            break;
-        case LOG_DIR_FLOW:
-        case LOG_DIR_FLOW_TOSERVER:
-            if ((PKT_IS_TOSERVER(p))) {
-                if (PKT_IS_IPV4(p)) {
-                    PrintInet(AF_INET, (const void *)GET_IPV4_SRC_ADDR_PTR(p),
-                            srcip, sizeof(srcip));
-                    PrintInet(AF_INET, (const void *)GET_IPV4_DST_ADDR_PTR(p),
-                            dstip, sizeof(dstip));
-                } else if (PKT_IS_IPV6(p)) {
-                    PrintInet(AF_INET6, (const void *)GET_IPV6_SRC_ADDR(p),
-                            srcip, sizeof(srcip));
-                    PrintInet(AF_INET6, (const void *)GET_IPV6_DST_ADDR(p),
-                            dstip, sizeof(dstip));
-                }
-                sp = p->sp;
-                dp = p->dp;
-            } else {
-                if (PKT_IS_IPV4(p)) {
-                    PrintInet(AF_INET, (const void *)GET_IPV4_DST_ADDR_PTR(p),
-                            srcip, sizeof(srcip));
-                    PrintInet(AF_INET, (const void *)GET_IPV4_SRC_ADDR_PTR(p),
-                            dstip, sizeof(dstip));
-                } else if (PKT_IS_IPV6(p)) {
-                    PrintInet(AF_INET6, (const void *)GET_IPV6_DST_ADDR(p),
-                            srcip, sizeof(srcip));
-                    PrintInet(AF_INET6, (const void *)GET_IPV6_SRC_ADDR(p),
-                            dstip, sizeof(dstip));
-                }
-                sp = p->dp;
-                dp = p->sp;
-            }
-            break;
-        case LOG_DIR_FLOW_TOCLIENT:
-            if ((PKT_IS_TOCLIENT(p))) {
-                if (PKT_IS_IPV4(p)) {
-                    PrintInet(AF_INET, (const void *)GET_IPV4_SRC_ADDR_PTR(p),
-                            srcip, sizeof(srcip));
-                    PrintInet(AF_INET, (const void *)GET_IPV4_DST_ADDR_PTR(p),
-                            dstip, sizeof(dstip));
-                } else if (PKT_IS_IPV6(p)) {
-                    PrintInet(AF_INET6, (const void *)GET_IPV6_SRC_ADDR(p),
-                            srcip, sizeof(srcip));
-                    PrintInet(AF_INET6, (const void *)GET_IPV6_DST_ADDR(p),
-                            dstip, sizeof(dstip));
-                }
-                sp = p->sp;
-                dp = p->dp;
-            } else {
-                if (PKT_IS_IPV4(p)) {
-                    PrintInet(AF_INET, (const void *)GET_IPV4_DST_ADDR_PTR(p),
-                            srcip, sizeof(srcip));
-                    PrintInet(AF_INET, (const void *)GET_IPV4_SRC_ADDR_PTR(p),
-                            dstip, sizeof(dstip));
-                } else if (PKT_IS_IPV6(p)) {
-                    PrintInet(AF_INET6, (const void *)GET_IPV6_DST_ADDR(p),
-                            srcip, sizeof(srcip));
-                    PrintInet(AF_INET6, (const void *)GET_IPV6_SRC_ADDR(p),
-                            dstip, sizeof(dstip));
-                }
-                sp = p->dp;
-                dp = p->sp;
-            }
-            break;
-        default:
-            DEBUG_VALIDATE_BUG_ON(1);
-            return;
-    }
-
-    if (SCProtoNameValid(IP_GET_IPPROTO(p)) == TRUE) {
-        strlcpy(proto, known_proto[IP_GET_IPPROTO(p)], sizeof(proto));
-    } else {
-        snprintf(proto, sizeof(proto), "%03" PRIu32, IP_GET_IPPROTO(p));
-    }
-
-    json_object_set_new(js, "src_ip", json_string(srcip));
-
-    switch(p->proto) {
-        case IPPROTO_ICMP:
-            break;
-        case IPPROTO_UDP:
-        case IPPROTO_TCP:
-        case IPPROTO_SCTP:
-            json_object_set_new(js, "src_port", json_integer(sp));
-            break;
-    }
-
-    json_object_set_new(js, "dest_ip", json_string(dstip));
-
-    switch(p->proto) {
-        case IPPROTO_ICMP:
-            break;
-        case IPPROTO_UDP:
-        case IPPROTO_TCP:
-        case IPPROTO_SCTP:
-            json_object_set_new(js, "dest_port", json_integer(dp));
-            break;
-    }
-
-    json_object_set_new(js, "proto", json_string(proto));
-}
-
 #define COMMUNITY_ID_BUF_SIZE 64
 
 static bool CalculateCommunityFlowIdv4(const Flow *f,
@@ -1090,20 +666,6 @@ static bool CalculateCommunityFlowIdv6(const Flow *f,
     return false;
 }
 
-static void CreateJSONCommunityFlowId(json_t *js, const Flow *f, const uint16_t seed)
-{
-    unsigned char buf[COMMUNITY_ID_BUF_SIZE];
-    if (f->flags & FLOW_IPV4) {
-        if (CalculateCommunityFlowIdv4(f, seed, buf)) {
-            json_object_set_new(js, "community_id", json_string((const char *)buf));
-        }
-    } else if (f->flags & FLOW_IPV6) {
-        if (CalculateCommunityFlowIdv6(f, seed, buf)) {
-            json_object_set_new(js, "community_id", json_string((const char *)buf));
-        }
-    }
-}
-
 static void CreateEveCommunityFlowId(JsonBuilder *js, const Flow *f, const uint16_t seed)
 {
     unsigned char buf[COMMUNITY_ID_BUF_SIZE];
@@ -1118,17 +680,6 @@ static void CreateEveCommunityFlowId(JsonBuilder *js, const Flow *f, const uint1
     }
 }
 
-void CreateJSONFlowId(json_t *js, const Flow *f)
-{
-    if (f == NULL)
-        return;
-    int64_t flow_id = FlowGetId(f);
-    json_object_set_new(js, "flow_id", json_integer(flow_id));
-    if (f->parent_id) {
-        json_object_set_new(js, "parent_id", json_integer(f->parent_id));
-    }
-}
-
 void CreateEveFlowId(JsonBuilder *js, const Flow *f)
 {
     if (f == NULL) {
@@ -1141,88 +692,6 @@ void CreateEveFlowId(JsonBuilder *js, const Flow *f)
     }
 }
 
-json_t *CreateJSONHeader(const Packet *p, enum OutputJsonLogDirection dir,
-                         const char *event_type, JsonAddrInfo *addr)
-{
-    char timebuf[64];
-    const Flow *f = (const Flow *)p->flow;
-
-    json_t *js = json_object();
-    if (unlikely(js == NULL))
-        return NULL;
-
-    CreateIsoTimeString(&p->ts, timebuf, sizeof(timebuf));
-
-    /* time & tx */
-    json_object_set_new(js, "timestamp", json_string(timebuf));
-
-    CreateJSONFlowId(js, f);
-
-    /* sensor id */
-    if (sensor_id >= 0)
-        json_object_set_new(js, "sensor_id", json_integer(sensor_id));
-
-    /* input interface */
-    if (p->livedev) {
-        json_object_set_new(js, "in_iface", json_string(p->livedev->dev));
-    }
-
-    /* pcap_cnt */
-    if (p->pcap_cnt != 0) {
-        json_object_set_new(js, "pcap_cnt", json_integer(p->pcap_cnt));
-    }
-
-    if (event_type) {
-        json_object_set_new(js, "event_type", json_string(event_type));
-    }
-
-    /* vlan */
-    if (p->vlan_idx > 0) {
-        json_t *js_vlan = json_array();
-        if (js_vlan) {
-            json_array_append_new(js_vlan, json_integer(p->vlan_id[0]));
-            if (p->vlan_idx > 1) {
-                json_array_append_new(js_vlan, json_integer(p->vlan_id[1]));
-            }
-            json_object_set_new(js, "vlan", js_vlan);
-        }
-    }
-
-    /* 5-tuple */
-    JsonAddrInfo addr_info = json_addr_info_zero;
-    if (addr == NULL) {
-        JsonAddrInfoInit(p, dir, &addr_info);
-        addr = &addr_info;
-    }
-    json_object_set_new(js, "src_ip", json_string(addr->src_ip));
-    json_object_set_new(js, "src_port", json_integer(addr->sp));
-    json_object_set_new(js, "dest_ip", json_string(addr->dst_ip));
-    json_object_set_new(js, "dest_port", json_integer(addr->dp));
-    json_object_set_new(js, "proto", json_string(addr->proto));
-
-    /* icmp */
-    switch (p->proto) {
-        case IPPROTO_ICMP:
-            if (p->icmpv4h) {
-                json_object_set_new(js, "icmp_type",
-                                    json_integer(p->icmpv4h->type));
-                json_object_set_new(js, "icmp_code",
-                                    json_integer(p->icmpv4h->code));
-            }
-            break;
-        case IPPROTO_ICMPV6:
-            if (p->icmpv6h) {
-                json_object_set_new(js, "icmp_type",
-                                    json_integer(p->icmpv6h->type));
-                json_object_set_new(js, "icmp_code",
-                                    json_integer(p->icmpv6h->code));
-            }
-            break;
-    }
-
-    return js;
-}
-
 JsonBuilder *CreateEveHeader(const Packet *p, enum OutputJsonLogDirection dir,
         const char *event_type, JsonAddrInfo *addr)
 {
@@ -1300,19 +769,6 @@ JsonBuilder *CreateEveHeader(const Packet *p, enum OutputJsonLogDirection dir,
     return js;
 }
 
-json_t *CreateJSONHeaderWithTxId(const Packet *p, enum OutputJsonLogDirection dir,
-                                 const char *event_type, uint64_t tx_id)
-{
-    json_t *js = CreateJSONHeader(p, dir, event_type, NULL);
-    if (unlikely(js == NULL))
-        return NULL;
-
-    /* tx id for correlation with other events */
-    json_object_set_new(js, "tx_id", json_integer(tx_id));
-
-    return js;
-}
-
 JsonBuilder *CreateEveHeaderWithTxId(const Packet *p, enum OutputJsonLogDirection dir,
                                  const char *event_type, JsonAddrInfo *addr, uint64_t tx_id)
 {
@@ -69,21 +69,12 @@ typedef struct OutputJSONMemBufferWrapper_ {
 
 int OutputJSONMemBufferCallback(const char *str, size_t size, void *data);
 
-void CreateJSONFlowId(json_t *js, const Flow *f);
 void CreateEveFlowId(JsonBuilder *js, const Flow *f);
-void JsonTcpFlags(uint8_t flags, json_t *js);
 void EveTcpFlags(uint8_t flags, JsonBuilder *js);
-void JsonPacket(const Packet *p, json_t *js, unsigned long max_length);
 void EvePacket(const Packet *p, JsonBuilder *js, unsigned long max_length);
-void JsonFiveTuple(const Packet *, enum OutputJsonLogDirection, json_t *);
-json_t *CreateJSONHeader(const Packet *p,
-        enum OutputJsonLogDirection dir, const char *event_type,
-        JsonAddrInfo *addr);
 JsonBuilder *CreateEveHeader(const Packet *p,
         enum OutputJsonLogDirection dir, const char *event_type,
         JsonAddrInfo *addr);
-json_t *CreateJSONHeaderWithTxId(const Packet *p,
-        enum OutputJsonLogDirection dir, const char *event_type, uint64_t tx_id);
 JsonBuilder *CreateEveHeaderWithTxId(const Packet *p,
         enum OutputJsonLogDirection dir, const char *event_type, JsonAddrInfo *addr,
         uint64_t tx_id);
@@ -118,11 +109,8 @@ typedef struct OutputJsonThreadCtx_ {
 
 json_t *SCJsonBool(int val);
 json_t *SCJsonString(const char *val);
-json_t *JsonAddStringN(const char *string, size_t size);
 void SCJsonDecref(json_t *js);
 
-void JsonAddCommonOptions(const OutputJsonCommonSettings *cfg,
-        const Packet *p, const Flow *f, json_t *js);
 void EveAddCommonOptions(const OutputJsonCommonSettings *cfg,
         const Packet *p, const Flow *f, JsonBuilder *js);
 
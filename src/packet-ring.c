@@ -0,0 +1,178 @@
+/* Copyright (C) 2020 Open Information Security Foundation
+ *
+ * You can copy, redistribute or modify this Program under the terms of
+ * the GNU General Public License version 2 as published by the Free
+ * Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * version 2 along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/**
+ * \file
+ *
+ * Lock free packet ring, used to hand packets from one thread to another.
+ */
+
+#include "suricata-common.h"
+#include "decode.h"
+#include "packet-ring.h"
+#include "util-atomic.h"
+#include "util-unittest.h"
+
+/** number of packets the consumer reads before giving the slots back */
+#define PACKET_RING_BATCH 32
+
+/**
+ *  \brief allocate a ring
+ *  \param size minimal number of slots, rounded up to a power of 2
+ */
+PacketRing *PacketRingAlloc(uint32_t size)
+{
+    uint32_t rsize = PACKET_RING_BATCH;
+    while (rsize < size && rsize < (1U << 30))
+        rsize <<= 1;
+
+    PacketRing *r = SCMallocAligned(sizeof(*r), CLS);
+    if (unlikely(r == NULL))
+        return NULL;
+    memset(r, 0, sizeof(*r));
+
+    r->slots = SCCalloc(rsize, sizeof(Packet *));
+    if (unlikely(r->slots == NULL)) {
+        SCFreeAligned(r);
+        return NULL;
+    }
+    r->size = rsize;
+    r->mask = rsize - 1;
+    SC_ATOMIC_INIT(r->prod.head);
+    SC_ATOMIC_INIT(r->cons.tail);
+    return r;
+}
+
+void PacketRingFree(PacketRing *r)
+{
+    if (r == NULL)
+        return;
+    SCFree(r->slots);
+    SCFreeAligned(r);
+}
+
+/**
+ *  \brief add a packet to the ring. Producer side.
+ *  \retval true packet added
+ *  \retval false ring is full
+ */
+bool PacketRingEnqueue(PacketRing *r, Packet *p)
+{
+    const uint64_t head = r->prod.next;
+    if (head - r->prod.cached_tail >= r->size) {
+        r->prod.cached_tail = SC_ATOMIC_GET(r->cons.tail);
+        if (head - r->prod.cached_tail >= r->size)
+            return false;
+    }
+    r->slots[head & r->mask] = p;
+    r->prod.next = head + 1;
+    /* publish the packet to the consumer */
+    SC_ATOMIC_SET(r->prod.head, head + 1);
+    return true;
+}
+
+/**
+ *  \brief get the next packet from the ring. Consumer side.
+ *  \retval p packet or NULL if the ring is empty
+ */
+Packet *PacketRingDequeue(PacketRing *r)
+{
+    if (r->cons.next == r->cons.cached_head) {
+        /* caught up: give back all slots and check for new packets */
+        SC_ATOMIC_SET(r->cons.tail, r->cons.next);
+        r->cons.cached_head = SC_ATOMIC_GET(r->prod.head);
+        if (r->cons.next == r->cons.cached_head)
+            return NULL;
+    }
+
+    Packet *p = r->slots[r->cons.next & r->mask];
+    r->cons.next++;
+    if ((r->cons.next & (PACKET_RING_BATCH - 1)) == 0) {
+        SC_ATOMIC_SET(r->cons.tail, r->cons.next);
+    }
+    return p;
+}
+
+/**
+ *  \brief number of packets in the ring, including the ones the consumer
+ *         read but didn't give back yet
+ */
+uint64_t PacketRingLen(PacketRing *r)
+{
+    const uint64_t tail = SC_ATOMIC_GET(r->cons.tail);
+    return SC_ATOMIC_GET(r->prod.head) - tail;
+}
+
+#ifdef UNITTESTS
+/** \test fill, drain and wrap around */
+static int PacketRingTest01(void)
+{
+    Packet pkts[8];
+    PacketRing *r = PacketRingAlloc(10);
+    FAIL_IF_NULL(r);
+    FAIL_IF_NOT(r->size == PACKET_RING_BATCH);
+    FAIL_IF_NOT(PacketRingDequeue(r) == NULL);
+
+    for (int round = 0; round < 20; round++) {
+        for (int i = 0; i < 8; i++) {
+            FAIL_IF_NOT(PacketRingEnqueue(r, &pkts[i]));
+        }
+        FAIL_IF_NOT(PacketRingLen(r) == 8);
+        for (int i = 0; i < 8; i++) {
+            FAIL_IF_NOT(PacketRingDequeue(r) == &pkts[i]);
+        }
+        FAIL_IF_NOT(PacketRingDequeue(r) == NULL);
+        FAIL_IF_NOT(PacketRingLen(r) == 0);
+    }
+
+    PacketRingFree(r);
+    PASS;
+}
+
+/** \test full ring */
+static int PacketRingTest02(void)
+{
+    Packet p;
+    PacketRing *r = PacketRingAlloc(PACKET_RING_BATCH);
+    FAIL_IF_NULL(r);
+
+    for (uint32_t i = 0; i < r->size; i++) {
+        FAIL_IF_NOT(PacketRingEnqueue(r, &p));
+    }
+    FAIL_IF(PacketRingEnqueue(r, &p));
+
+    /* a slot read by the consumer is given back once it catches up */
+    FAIL_IF_NOT(PacketRingDequeue(r) == &p);
+    FAIL_IF(PacketRingEnqueue(r, &p));
+    for (uint32_t i = 1; i < r->size; i++) {
+        FAIL_IF_NOT(PacketRingDequeue(r) == &p);
+    }
+    FAIL_IF_NOT(PacketRingDequeue(r) == NULL);
+    FAIL_IF_NOT(PacketRingEnqueue(r, &p));
+
+    PacketRingFree(r);
+    PASS;
+}
+#endif /* UNITTESTS */
+
+void PacketRingRegisterTests(void)
+{
+#ifdef UNITTESTS
+    UtRegisterTest("PacketRingTest01", PacketRingTest01);
+    UtRegisterTest("PacketRingTest02", PacketRingTest02);
+#endif
+}
@@ -0,0 +1,59 @@
+/* Copyright (C) 2020 Open Information Security Foundation
+ *
+ * You can copy, redistribute or modify this Program under the terms of
+ * the GNU General Public License version 2 as published by the Free
+ * Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * version 2 along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/**
+ * \file
+ */
+
+#ifndef __PACKET_RING_H__
+#define __PACKET_RING_H__
+
+/** \brief bounded lock free single producer, single consumer packet ring
+ *
+ *  The producer and consumer each keep a cached copy of the other side's
+ *  index, so the shared indexes are only read when the cached copy says
+ *  the ring is full or empty. The consumer gives the slots back in
+ *  batches.
+ */
+typedef struct PacketRing_ {
+    struct {
+        SC_ATOMIC_DECLARE(uint64_t, head);
+        uint64_t next;
+        uint64_t cached_tail;
+    } __attribute__((aligned(CLS))) prod;
+
+    struct {
+        SC_ATOMIC_DECLARE(uint64_t, tail);
+        uint64_t next;
+        uint64_t cached_head;
+    } __attribute__((aligned(CLS))) cons;
+
+    uint32_t size;
+    uint32_t mask;
+    struct Packet_ **slots;
+} PacketRing;
+
+PacketRing *PacketRingAlloc(uint32_t size);
+void PacketRingFree(PacketRing *r);
+
+bool PacketRingEnqueue(PacketRing *r, struct Packet_ *p);
+struct Packet_ *PacketRingDequeue(PacketRing *r);
+uint64_t PacketRingLen(PacketRing *r);
+
+void PacketRingRegisterTests(void);
+
+#endif /* __PACKET_RING_H__ */
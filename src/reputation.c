@@ -646,6 +646,17 @@ int SRepInit(DetectEngineCtx *de_ctx)
         }
     }
 
+    /* compile the trees into lookup tables. If they get too large, at
+     * least let lookups of ips that are not on any list skip the tree walk */
+    for (i = 0; i < SREP_MAX_CATS; i++) {
+        if (cidr_ctx->srepIPV4_tree[i] != NULL &&
+                SCRadixBuildLpm(cidr_ctx->srepIPV4_tree[i]) != 0)
+            (void)SCRadixBuildPrefilter(cidr_ctx->srepIPV4_tree[i]);
+        if (cidr_ctx->srepIPV6_tree[i] != NULL &&
+                SCRadixBuildLpm(cidr_ctx->srepIPV6_tree[i]) != 0)
+            (void)SCRadixBuildPrefilter(cidr_ctx->srepIPV6_tree[i]);
+    }
+
     /* Set effective rep version.
      * On live reload we will handle this after de_ctx has been swapped */
     if (init) {
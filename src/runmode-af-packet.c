@@ -45,6 +45,7 @@
 #include "alert-debuglog.h"
 
 #include "flow-bypass.h"
+#include "flow-private.h"
 
 #include "util-debug.h"
 #include "util-time.h"
@@ -236,6 +237,13 @@ static void *ParseAFPConfig(const char *iface)
                     SCLogConfig("Enabling tpacket v3 capture on iface %s",
                             aconf->iface);
                     aconf->flags |= AFP_TPACKET_V3;
+
+                    if (ConfGetChildValueBoolWithDefault(if_root, if_default,
+                                "batch", (int *)&boolval) == 1 && boolval) {
+                        SCLogConfig("Enabling batched packet processing on iface %s",
+                                aconf->iface);
+                        aconf->flags |= AFP_BATCH;
+                    }
 #else
                     SCLogNotice("System too old for tpacket v3 switching to v2");
                     aconf->flags &= ~AFP_TPACKET_V3;
@@ -479,6 +487,13 @@ static void *ParseAFPConfig(const char *iface)
             aconf->flags |= AFP_XDPBYPASS;
             /* if maps are pinned we need to read them at start */
             if (aconf->ebpf_t_config.flags & EBPF_PINNED_MAPS) {
+                /* the flows read from the maps are added to the global flow
+                 * hash, where the workers don't look them up */
+                if (flow_config.thread_local_hash) {
+                    FatalError(SC_ERR_INVALID_ARGUMENTS,
+                            "XDP bypass with pinned maps can't be used with "
+                            "flow.thread-local (iface %s)", aconf->iface);
+                }
                 RunModeEnablesBypassManager();
                 struct ebpf_timeout_config *ebt = SCCalloc(1, sizeof(struct ebpf_timeout_config));
                 if (ebt == NULL) {
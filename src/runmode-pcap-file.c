@@ -20,6 +20,7 @@
 #include "conf.h"
 #include "runmodes.h"
 #include "runmode-pcap-file.h"
+#include "runmode-unix-socket.h"
 #include "output.h"
 
 #include "detect-engine.h"
@@ -49,6 +50,11 @@ void RunModeFilePcapRegister(void)
                               "the same flow can be processed by any detect "
                               "thread",
                               RunModeFilePcapAutoFp);
+    RunModeRegisterNewRunMode(RUNMODE_PCAP_FILE, "workers",
+                              "Workers pcap file mode, each thread reads "
+                              "the file(s) and processes its share of the "
+                              "flows",
+                              RunModeFilePcapWorkers);
 
     return;
 }
@@ -249,3 +255,91 @@ int RunModeFilePcapAutoFp(void)
 
     return 0;
 }
+
+/**
+ * \brief RunModeFilePcapWorkers sets up a number of worker threads that
+ *        each read all the pcap file(s), but only process the packets of
+ *        the flows that hash to the thread. This removes the single
+ *        reader as a bottleneck, while the packets of a flow are still
+ *        processed in order by a single thread.
+ *
+ * \retval 0 If all goes well. (If any problem is detected the engine will
+ *           exit()).
+ */
+int RunModeFilePcapWorkers(void)
+{
+    SCEnter();
+    char tname[TM_THREAD_NAME_MAX];
+
+    RunModeInitialize();
+
+    const char *file = NULL;
+    if (ConfGet("pcap-file.file", &file) == 0) {
+        SCLogError(SC_ERR_RUNMODE, "Failed retrieving pcap-file from Conf");
+        exit(EXIT_FAILURE);
+    }
+    SCLogDebug("file %s", file);
+
+    TimeModeSetOffline();
+
+    PcapFileGlobalInit();
+
+    int thread_max = TmThreadGetNbThreads(WORKER_CPU_SET);
+    if (thread_max == 0)
+        thread_max = UtilCpuGetNumProcessorsOnline() * threading_detect_ratio;
+    if (thread_max < 1)
+        thread_max = 1;
+    if (thread_max > 1024)
+        thread_max = 1024;
+    /* the unix socket expects a single reader to report back */
+    if (RunModeUnixSocketIsActive() && thread_max > 1) {
+        SCLogWarning(SC_ERR_RUNMODE, "pcap-file workers runmode uses a single "
+                "thread in unix socket mode");
+        thread_max = 1;
+    }
+    PcapFileSetShardCount((uint16_t)thread_max);
+    SCLogInfo("using %d pcap file reader threads", thread_max);
+
+    for (int thread = 0; thread < thread_max; thread++) {
+        snprintf(tname, sizeof(tname), "%s#%02d", thread_name_workers, thread + 1);
+
+        ThreadVars *tv = TmThreadCreatePacketHandler(tname,
+                                                     "packetpool", "packetpool",
+                                                     "packetpool", "packetpool",
+                                                     "pktacqloop");
+        if (tv == NULL) {
+            SCLogError(SC_ERR_RUNMODE, "threading setup failed");
+            exit(EXIT_FAILURE);
+        }
+
+        TmModule *tm_module = TmModuleGetByName("ReceivePcapFile");
+        if (tm_module == NULL) {
+            SCLogError(SC_ERR_RUNMODE, "TmModuleGetByName failed for ReceivePcap");
+            exit(EXIT_FAILURE);
+        }
+        TmSlotSetFuncAppend(tv, tm_module, file);
+
+        tm_module = TmModuleGetByName("DecodePcapFile");
+        if (tm_module == NULL) {
+            SCLogError(SC_ERR_RUNMODE, "TmModuleGetByName DecodePcap failed");
+            exit(EXIT_FAILURE);
+        }
+        TmSlotSetFuncAppend(tv, tm_module, NULL);
+
+        tm_module = TmModuleGetByName("FlowWorker");
+        if (tm_module == NULL) {
+            SCLogError(SC_ERR_RUNMODE, "TmModuleGetByName for FlowWorker failed");
+            exit(EXIT_FAILURE);
+        }
+        TmSlotSetFuncAppend(tv, tm_module, NULL);
+
+        TmThreadSetCPU(tv, WORKER_CPU_SET);
+
+        if (TmThreadSpawn(tv) != TM_ECODE_OK) {
+            SCLogError(SC_ERR_RUNMODE, "TmThreadSpawn failed");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    return 0;
+}
@@ -68,6 +68,7 @@
 
 #include "util-action.h"
 #include "util-radix-tree.h"
+#include "util-radix-lpm.h"
 #include "util-host-os-info.h"
 #include "util-cidr.h"
 #include "util-unittest-helper.h"
@@ -80,9 +81,12 @@
 #include "util-magic.h"
 #include "util-memcmp.h"
 #include "util-misc.h"
+#include "util-log-async.h"
+#include "util-hugepage.h"
 #include "util-signal.h"
 
 #include "reputation.h"
+#include "datasets-readonly.h"
 #include "util-atomic.h"
 #include "util-spm.h"
 #include "util-hash.h"
@@ -102,10 +106,12 @@
 #include "conf.h"
 #include "conf-yaml-loader.h"
 #include "tmqh-flow.h"
+#include "packet-ring.h"
 #include "defrag.h"
 #include "detect-engine-siggroup.h"
 
 #include "util-streaming-buffer.h"
+#include "util-timer-wheel.h"
 #include "util-lua.h"
 
 #ifdef OS_WIN32
@@ -132,6 +138,7 @@ static void RegisterUnittests(void)
     StreamTcpRegisterTests();
     SigRegisterTests();
     SCReputationRegisterTests();
+    DatasetRoRegisterTests();
     TmModuleRegisterTests();
     SigTableRegisterTests();
     HashTableRegisterTests();
@@ -165,11 +172,13 @@ static void RegisterUnittests(void)
     ConfRegisterTests();
     ConfYamlRegisterTests();
     TmqhFlowRegisterTests();
+    PacketRingRegisterTests();
     FlowRegisterTests();
     HostRegisterUnittests();
     IPPairRegisterUnittests();
     SCSigRegisterSignatureOrderingTests();
     SCRadixRegisterTests();
+    SCRadixLpmRegisterTests();
     DefragRegisterTests();
     SigGroupHeadRegisterTests();
     SCHInfoRegisterTests();
@@ -193,6 +202,8 @@ static void RegisterUnittests(void)
     SCLogRegisterTests();
     MagicRegisterTests();
     UtilMiscRegisterTests();
+    LogAsyncRegisterTests();
+    HugePageRegisterTests();
     DetectAddressTests();
     DetectProtoTests();
     DetectPortTests();
@@ -201,6 +212,7 @@ static void RegisterUnittests(void)
     AppLayerUnittestsRegister();
     MimeDecRegisterTests();
     StreamingBufferRegisterTests();
+    TimerWheelRegisterTests();
 #ifdef OS_WIN32
     Win32SyscallRegisterTests();
 #endif
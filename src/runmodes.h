@@ -57,6 +57,7 @@ enum RunModes {
     RUNMODE_CHANGE_SERVICE_PARAMS,
 #endif
     RUNMODE_DUMP_FEATURES,
+    RUNMODE_DATASET_COMPILE,
     RUNMODE_MAX,
 };
 
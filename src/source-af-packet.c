@@ -249,6 +249,10 @@ typedef struct AFPThreadVars_
     /* IPS peer */
     AFPPeer *mpeer;
 
+    /* packets of a tpacket v3 block waiting to be processed as a batch */
+    Packet *batch[TM_BATCH_SIZE_MAX];
+    uint32_t batch_cnt;
+
     /* no mmap mode */
     uint8_t *data; /** Per function and thread data */
     int datalen; /** Length of per function and thread data */
@@ -894,6 +898,11 @@ static int AFPReadFromRing(AFPThreadVars *ptv)
             }
         }
 
+        /* get the packet data and the next frame on their way */
+        prefetch((uint8_t *)h.raw + h.h2->tp_mac);
+        prefetch(((union thdr **)ptv->ring.v2)[(ptv->frame_offset + 1) %
+                ptv->req.v2.tp_frame_nr]);
+
         read_pkts++;
         loop_start = -1;
 
@@ -1038,6 +1047,20 @@ static inline void AFPFlushBlock(struct tpacket_block_desc *pbd)
     pbd->hdr.bh1.block_status = TP_STATUS_KERNEL;
 }
 
+/** \brief pass the batched packets to the rest of the pipeline */
+static inline int AFPProcessBatch(AFPThreadVars *ptv)
+{
+    const uint32_t cnt = ptv->batch_cnt;
+    if (cnt == 0)
+        SCReturnInt(AFP_READ_OK);
+
+    ptv->batch_cnt = 0;
+    if (TmThreadsSlotProcessPktBatch(ptv->tv, ptv->slot, ptv->batch, cnt) != TM_ECODE_OK) {
+        SCReturnInt(AFP_SURI_FAILURE);
+    }
+    SCReturnInt(AFP_READ_OK);
+}
+
 static inline int AFPParsePacketV3(AFPThreadVars *ptv, struct tpacket_block_desc *pbd, struct tpacket3_hdr *ppd)
 {
     Packet *p = PacketGetFromQueueOrAlloc();
@@ -1115,6 +1138,14 @@ static inline int AFPParsePacketV3(AFPThreadVars *ptv, struct tpacket_block_desc
         }
     }
 
+    if (ptv->flags & AFP_BATCH) {
+        ptv->batch[ptv->batch_cnt++] = p;
+        if (ptv->batch_cnt == TM_BATCH_SIZE_MAX) {
+            SCReturnInt(AFPProcessBatch(ptv));
+        }
+        SCReturnInt(AFP_READ_OK);
+    }
+
     if (TmThreadsSlotProcessPkt(ptv->tv, ptv->slot, p) != TM_ECODE_OK) {
         SCReturnInt(AFP_SURI_FAILURE);
     }
@@ -1130,6 +1161,10 @@ static inline int AFPWalkBlock(AFPThreadVars *ptv, struct tpacket_block_desc *pb
 
     ppd = (uint8_t *)pbd + pbd->hdr.bh1.offset_to_first_pkt;
     for (i = 0; i < num_pkts; ++i) {
+        /* get the next packet on its way while this one is handled */
+        if (i + 1 < num_pkts) {
+            prefetch(ppd + ((struct tpacket3_hdr *)ppd)->tp_next_offset);
+        }
         ret = AFPParsePacketV3(ptv, pbd,
                                (struct tpacket3_hdr *)ppd);
         switch (ret) {
@@ -1140,13 +1175,19 @@ static inline int AFPWalkBlock(AFPThreadVars *ptv, struct tpacket_block_desc *pb
                  * treat thenext packet */
                 break;
             case AFP_READ_FAILURE:
+                (void)AFPProcessBatch(ptv);
                 SCReturnInt(AFP_READ_FAILURE);
             default:
+                (void)AFPProcessBatch(ptv);
                 SCReturnInt(ret);
         }
         ppd = ppd + ((struct tpacket3_hdr *)ppd)->tp_next_offset;
     }
 
+    /* the block is handed back to the kernel after this, so the
+     * packets referring to it have to be processed now */
+    (void)AFPProcessBatch(ptv);
+
     SCReturnInt(AFP_READ_OK);
 }
 #endif /* HAVE_TPACKET_V3 */
@@ -26,6 +26,10 @@
 #include "source-pcap-file-helper.h"
 #include "util-checksum.h"
 #include "util-profiling.h"
+#include "util-byte.h"
+#include "util-hash-lookup3.h"
+#include "util-time.h"
+#include "util-unittest.h"
 #include "source-pcap-file.h"
 
 extern int max_pending_packets;
@@ -40,6 +44,10 @@ void CleanupPcapFileFileVars(PcapFileFileVars *pfv)
             pcap_close(pfv->pcap_handle);
             pfv->pcap_handle = NULL;
         }
+        if (pfv->map != NULL) {
+            munmap(pfv->map, pfv->map_size);
+            pfv->map = NULL;
+        }
         if (pfv->filename != NULL) {
             if (pfv->shared != NULL && pfv->shared->should_delete) {
                 SCLogDebug("Deleting pcap file %s", pfv->filename);
@@ -56,11 +64,112 @@ void CleanupPcapFileFileVars(PcapFileFileVars *pfv)
     }
 }
 
+static uint32_t PcapFileShardHashIP(const uint8_t *pkt, uint32_t len)
+{
+    if (len < 1)
+        return 0;
+
+    uint32_t a, b;
+    if ((pkt[0] >> 4) == 4) {
+        if (len < 20)
+            return 0;
+        memcpy(&a, pkt + 12, sizeof(a));
+        memcpy(&b, pkt + 16, sizeof(b));
+    } else if ((pkt[0] >> 4) == 6) {
+        if (len < 40)
+            return 0;
+        uint32_t addr[8];
+        memcpy(addr, pkt + 8, sizeof(addr));
+        a = addr[0] ^ addr[1] ^ addr[2] ^ addr[3];
+        b = addr[4] ^ addr[5] ^ addr[6] ^ addr[7];
+    } else {
+        return 0;
+    }
+
+    /* order the addresses so both directions get the same hash */
+    uint32_t key[2] = { MIN(a, b), MAX(a, b) };
+    return hashword(key, 2, 0);
+}
+
+uint32_t PcapFileShardHash(int datalink, const uint8_t *pkt, uint32_t len)
+{
+    switch (datalink) {
+        case LINKTYPE_ETHERNET: {
+            uint32_t offset = 12;
+            uint16_t type = 0;
+            /* skip over vlan tags */
+            do {
+                if (len < offset + 2)
+                    return 0;
+                type = (uint16_t)(pkt[offset] << 8 | pkt[offset + 1]);
+                offset += 2;
+                if (type == ETHERNET_TYPE_8021Q || type == ETHERNET_TYPE_8021AD ||
+                        type == ETHERNET_TYPE_8021QINQ)
+                    offset += 2;
+                else
+                    break;
+            } while (1);
+
+            if (type != ETHERNET_TYPE_IP && type != ETHERNET_TYPE_IPV6)
+                return 0;
+            return PcapFileShardHashIP(pkt + offset, len - offset);
+        }
+        case LINKTYPE_LINUX_SLL:
+            if (len < SLL_HEADER_LEN)
+                return 0;
+            return PcapFileShardHashIP(pkt + SLL_HEADER_LEN, len - SLL_HEADER_LEN);
+        case LINKTYPE_NULL:
+            /* 4 byte address family header */
+            if (len < 4)
+                return 0;
+            return PcapFileShardHashIP(pkt + 4, len - 4);
+        case LINKTYPE_IPV4:
+        case LINKTYPE_RAW:
+        case LINKTYPE_RAW2:
+        case LINKTYPE_GRE_OVER_IP:
+            return PcapFileShardHashIP(pkt, len);
+        default:
+            return 0;
+    }
+}
+
+/** \internal
+ *  \brief check if a packet is for this reader's shard
+ *
+ *  Packets for other shards still move this thread's clock forward, so
+ *  that a reader that has nothing to do for a while doesn't hold back
+ *  the time of the engine.
+ */
+static bool PcapFileShardCheck(PcapFileFileVars *ptv, const struct pcap_pkthdr *h,
+        const u_char *pkt)
+{
+    PcapFileSharedVars *shared = ptv->shared;
+
+    shared->shard_pkt_cnt++;
+    if (shared->shard_id == 0)
+        SC_ATOMIC_SET(pcap_g.cnt, shared->shard_pkt_cnt);
+
+    if (PcapFileShardHash(ptv->datalink, pkt, h->caplen) % shared->shard_cnt ==
+            shared->shard_id)
+        return true;
+
+    if (h->ts.tv_sec != shared->shard_last_sec) {
+        struct timeval ts = { h->ts.tv_sec, h->ts.tv_usec };
+        shared->shard_last_sec = h->ts.tv_sec;
+        TimeSetByThread(shared->tv->id, &ts);
+    }
+    return false;
+}
+
 void PcapFileCallbackLoop(char *user, struct pcap_pkthdr *h, u_char *pkt)
 {
     SCEnter();
 
     PcapFileFileVars *ptv = (PcapFileFileVars *)user;
+    if (ptv->shared->shard_cnt > 1 && !PcapFileShardCheck(ptv, h, pkt)) {
+        SCReturn;
+    }
+
     Packet *p = PacketGetFromQueueOrAlloc();
 
     if (unlikely(p == NULL)) {
@@ -73,13 +182,20 @@ void PcapFileCallbackLoop(char *user, struct pcap_pkthdr *h, u_char *pkt)
     p->ts.tv_usec = h->ts.tv_usec;
     SCLogDebug("p->ts.tv_sec %"PRIuMAX"", (uintmax_t)p->ts.tv_sec);
     p->datalink = ptv->datalink;
-    p->pcap_cnt = ++pcap_g.cnt;
+    if (ptv->shared->shard_cnt > 1)
+        p->pcap_cnt = ptv->shared->shard_pkt_cnt;
+    else
+        p->pcap_cnt = SC_ATOMIC_ADD(pcap_g.cnt, 1) + 1;
 
     p->pcap_v.tenant_id = ptv->shared->tenant_id;
     ptv->shared->pkts++;
     ptv->shared->bytes += h->caplen;
 
-    if (unlikely(PacketCopyData(p, pkt, h->caplen))) {
+    /* the mmap reader's data stays mapped until the file is done, which
+     * in the sharded runmode is after this thread processed the packet */
+    int r = (ptv->map != NULL) ? PacketSetData(p, pkt, h->caplen) :
+        PacketCopyData(p, pkt, h->caplen);
+    if (unlikely(r != 0)) {
         TmqhOutputPacketpool(ptv->shared->tv, p);
         PACKET_PROFILING_TMM_END(p, TMM_RECEIVEPCAPFILE);
         SCReturn;
@@ -99,7 +215,8 @@ void PcapFileCallbackLoop(char *user, struct pcap_pkthdr *h, u_char *pkt)
     PACKET_PROFILING_TMM_END(p, TMM_RECEIVEPCAPFILE);
 
     if (TmThreadsSlotProcessPkt(ptv->shared->tv, ptv->shared->slot, p) != TM_ECODE_OK) {
-        pcap_breakloop(ptv->pcap_handle);
+        if (ptv->pcap_handle != NULL)
+            pcap_breakloop(ptv->pcap_handle);
         ptv->shared->cb_result = TM_ECODE_FAILED;
     }
 
@@ -113,6 +230,172 @@ const char *PcapFileGetFilename(void)
     return pcap_filename;
 }
 
+/** \internal
+ *  \brief set up the time for a new file
+ *
+ *  When sharding all readers see the same first packet, so each only
+ *  sets its own clock. The engine's time is the minimum of all threads.
+ */
+static void PcapFileInitTimestamp(PcapFileFileVars *ptv)
+{
+    if (ptv->shared->shard_cnt > 1) {
+        TimeSetByThread(ptv->shared->tv->id, &ptv->first_pkt_ts);
+        ptv->shared->shard_last_sec = ptv->first_pkt_ts.tv_sec;
+    } else {
+        TmThreadsInitThreadsTimestamp(&ptv->first_pkt_ts);
+    }
+}
+
+#define PCAP_MAGIC          0xa1b2c3d4
+#define PCAP_MAGIC_NSEC     0xa1b23c4d
+#define PCAP_FILE_HDR_LEN   24
+#define PCAP_REC_HDR_LEN    16
+
+static inline uint32_t PcapFileMmapGet32(const PcapFileFileVars *pfv, const uint8_t *ptr)
+{
+    uint32_t v;
+    memcpy(&v, ptr, sizeof(v));
+    return pfv->map_swapped ? SCByteSwap32(v) : v;
+}
+
+/** \internal
+ *  \brief read the next record from the mapped file
+ *  \retval 1 record read
+ *  \retval 0 end of file
+ *  \retval -1 truncated or corrupt record
+ */
+static int PcapFileMmapNext(PcapFileFileVars *pfv, struct pcap_pkthdr *h,
+        const uint8_t **data)
+{
+    if (pfv->map_offset == pfv->map_size)
+        return 0;
+    if (pfv->map_size - pfv->map_offset < PCAP_REC_HDR_LEN)
+        return -1;
+
+    const uint8_t *rec = pfv->map + pfv->map_offset;
+    h->ts.tv_sec = PcapFileMmapGet32(pfv, rec);
+    h->ts.tv_usec = PcapFileMmapGet32(pfv, rec + 4);
+    if (pfv->map_nsec)
+        h->ts.tv_usec /= 1000;
+    h->caplen = PcapFileMmapGet32(pfv, rec + 8);
+    h->len = PcapFileMmapGet32(pfv, rec + 12);
+
+    if (h->caplen > pfv->map_size - pfv->map_offset - PCAP_REC_HDR_LEN)
+        return -1;
+
+    *data = rec + PCAP_REC_HDR_LEN;
+    pfv->map_offset += PCAP_REC_HDR_LEN + h->caplen;
+    return 1;
+}
+
+/** \internal
+ *  \brief map a classic pcap file into memory
+ *
+ *  Only used when sharding: every reader walks the whole file, so reading
+ *  it from the page cache directly is much cheaper than each reader
+ *  copying it through libpcap. Other formats, like pcapng, and files that
+ *  need a bpf filter are read with libpcap.
+ *
+ *  \retval bool true if the file is mapped and ready to be read
+ */
+static bool PcapFileMmapOpen(PcapFileFileVars *pfv)
+{
+    int fd = open(pfv->filename, O_RDONLY);
+    if (fd == -1)
+        return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < PCAP_FILE_HDR_LEN) {
+        close(fd);
+        return false;
+    }
+
+    /* private writable mapping as the decoders may touch the data */
+    void *map = mmap(NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+        return false;
+#ifdef MADV_SEQUENTIAL
+    (void)madvise(map, (size_t)st.st_size, MADV_SEQUENTIAL);
+#endif
+    pfv->map = map;
+    pfv->map_size = (size_t)st.st_size;
+
+    uint32_t magic;
+    memcpy(&magic, pfv->map, sizeof(magic));
+    if (magic == PCAP_MAGIC || magic == PCAP_MAGIC_NSEC) {
+        pfv->map_swapped = false;
+    } else if (SCByteSwap32(magic) == PCAP_MAGIC || SCByteSwap32(magic) == PCAP_MAGIC_NSEC) {
+        pfv->map_swapped = true;
+        magic = SCByteSwap32(magic);
+    } else {
+        goto error;
+    }
+    pfv->map_nsec = (magic == PCAP_MAGIC_NSEC);
+    /* upper bits of the link type hold FCS info */
+    pfv->datalink = (int)(PcapFileMmapGet32(pfv, pfv->map + 20) & 0x03ffffff);
+    pfv->map_offset = PCAP_FILE_HDR_LEN;
+
+    struct pcap_pkthdr h;
+    const uint8_t *data;
+    if (PcapFileMmapNext(pfv, &h, &data) != 1) {
+        SCLogError(SC_ERR_PCAP_OPEN_OFFLINE,
+                "failed to get first packet timestamp for %s", pfv->filename);
+        goto error;
+    }
+    pfv->first_pkt_ts.tv_sec = h.ts.tv_sec;
+    pfv->first_pkt_ts.tv_usec = h.ts.tv_usec;
+    pfv->map_offset = PCAP_FILE_HDR_LEN;
+    return true;
+
+error:
+    munmap(pfv->map, pfv->map_size);
+    pfv->map = NULL;
+    pfv->map_size = 0;
+    return false;
+}
+
+static TmEcode PcapFileMmapDispatch(PcapFileFileVars *ptv)
+{
+    PcapFileInitTimestamp(ptv);
+
+    TmEcode loop_result = TM_ECODE_OK;
+    while (loop_result == TM_ECODE_OK) {
+        if (suricata_ctl_flags & SURICATA_STOP) {
+            SCReturnInt(TM_ECODE_OK);
+        }
+
+        PacketPoolWait();
+
+        /* same batching as with pcap_dispatch */
+        for (int i = 0; i < 64; i++) {
+            struct pcap_pkthdr h;
+            const uint8_t *data;
+            int r = PcapFileMmapNext(ptv, &h, &data);
+            if (unlikely(r == -1)) {
+                SCLogError(SC_ERR_PCAP_DISPATCH, "truncated packet record at offset "
+                        "%"PRIuMAX" in %s", (uintmax_t)ptv->map_offset, ptv->filename);
+                loop_result = TM_ECODE_DONE;
+                break;
+            } else if (r == 0) {
+                SCLogInfo("pcap file %s end of file reached", ptv->filename);
+                ptv->shared->files++;
+                loop_result = TM_ECODE_DONE;
+                break;
+            }
+            PcapFileCallbackLoop((char *)ptv, &h, (u_char *)data);
+            if (ptv->shared->cb_result == TM_ECODE_FAILED) {
+                SCLogError(SC_ERR_PCAP_DISPATCH,
+                        "Pcap callback PcapFileCallbackLoop failed for %s", ptv->filename);
+                SCReturnInt(TM_ECODE_FAILED);
+            }
+        }
+        StatsSyncCountersIfSignalled(ptv->shared->tv);
+    }
+
+    SCReturnInt(loop_result);
+}
+
 /**
  *  \brief Main PCAP file reading Loop function
  */
@@ -120,9 +403,15 @@ TmEcode PcapFileDispatch(PcapFileFileVars *ptv)
 {
     SCEnter();
 
+    strlcpy(pcap_filename, ptv->filename, sizeof(pcap_filename));
+
+    if (ptv->map != NULL) {
+        SCReturnInt(PcapFileMmapDispatch(ptv));
+    }
+
     /* initialize all the thread's initial timestamp */
     if (likely(ptv->first_pkt_hdr != NULL)) {
-        TmThreadsInitThreadsTimestamp(&ptv->first_pkt_ts);
+        PcapFileInitTimestamp(ptv);
         PcapFileCallbackLoop((char *)ptv, ptv->first_pkt_hdr,
                 (u_char *)ptv->first_pkt_data);
         ptv->first_pkt_hdr = NULL;
@@ -131,7 +420,6 @@ TmEcode PcapFileDispatch(PcapFileFileVars *ptv)
 
     int packet_q_len = 64;
     TmEcode loop_result = TM_ECODE_OK;
-    strlcpy(pcap_filename, ptv->filename, sizeof(pcap_filename));
 
     while (loop_result == TM_ECODE_OK) {
         if (suricata_ctl_flags & SURICATA_STOP) {
@@ -197,6 +485,13 @@ TmEcode InitPcapFile(PcapFileFileVars *pfv)
         SCReturnInt(TM_ECODE_FAILED);
     }
 
+    if (pfv->shared != NULL && pfv->shared->shard_cnt > 1 &&
+            pfv->shared->bpf_string == NULL && PcapFileMmapOpen(pfv)) {
+        SCLogDebug("%s: using mmap reader, datalink %d", pfv->filename, pfv->datalink);
+        DecoderFunc UnusedFnPtr;
+        SCReturnInt(ValidateLinkType(pfv->datalink, &UnusedFnPtr));
+    }
+
     pfv->pcap_handle = pcap_open_offline(pfv->filename, errbuf);
     if (pfv->pcap_handle == NULL) {
         SCLogError(SC_ERR_FOPEN, "%s", errbuf);
@@ -266,3 +561,66 @@ TmEcode ValidateLinkType(int datalink, DecoderFunc *DecoderFn)
 
     SCReturnInt(TM_ECODE_OK);
 }
+
+#ifdef UNITTESTS
+/** \test shard hash is the same for both directions and ignores ports */
+static int SourcePcapFileHelperTest01(void)
+{
+    /* ethernet, vlan 100, ipv4 10.0.0.1:1024 -> 10.0.0.2:80 tcp */
+    uint8_t pkt[] = {
+        0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x00, 0x01, 0x02, 0x03, 0x04, 0x06,
+        0x81, 0x00, 0x00, 0x64, 0x08, 0x00,
+        0x45, 0x00, 0x00, 0x28, 0x00, 0x00, 0x40, 0x00, 0x40, 0x06, 0x00, 0x00,
+        0x0a, 0x00, 0x00, 0x01, 0x0a, 0x00, 0x00, 0x02,
+        0x04, 0x00, 0x00, 0x50,
+    };
+    uint8_t rev[sizeof(pkt)];
+    memcpy(rev, pkt, sizeof(pkt));
+    /* swap the addresses and ports */
+    memcpy(rev + 30, pkt + 34, 4);
+    memcpy(rev + 34, pkt + 30, 4);
+    memcpy(rev + 38, pkt + 40, 2);
+    memcpy(rev + 40, pkt + 38, 2);
+
+    uint32_t h = PcapFileShardHash(LINKTYPE_ETHERNET, pkt, sizeof(pkt));
+    FAIL_IF(h == 0);
+    FAIL_IF(h != PcapFileShardHash(LINKTYPE_ETHERNET, rev, sizeof(rev)));
+    /* raw ip gives the same result as the ethernet frame */
+    FAIL_IF(h != PcapFileShardHash(LINKTYPE_RAW, pkt + 18, sizeof(pkt) - 18));
+
+    /* truncated and non-ip packets go to shard 0 */
+    FAIL_IF(PcapFileShardHash(LINKTYPE_ETHERNET, pkt, 20) != 0);
+    pkt[16] = 0x08;
+    pkt[17] = 0x06;
+    FAIL_IF(PcapFileShardHash(LINKTYPE_ETHERNET, pkt, sizeof(pkt)) != 0);
+    FAIL_IF(PcapFileShardHash(LINKTYPE_PPP, pkt, sizeof(pkt)) != 0);
+    PASS;
+}
+
+/** \test ipv6 shard hash */
+static int SourcePcapFileHelperTest02(void)
+{
+    uint8_t pkt[40] = { 0x60, 0x00, 0x00, 0x00, 0x00, 0x00, 0x11, 0x40 };
+    pkt[8] = 0x20; pkt[9] = 0x01; pkt[23] = 0x01;
+    pkt[24] = 0x20; pkt[25] = 0x01; pkt[39] = 0x02;
+
+    uint8_t rev[sizeof(pkt)];
+    memcpy(rev, pkt, 8);
+    memcpy(rev + 8, pkt + 24, 16);
+    memcpy(rev + 24, pkt + 8, 16);
+
+    uint32_t h = PcapFileShardHash(LINKTYPE_RAW, pkt, sizeof(pkt));
+    FAIL_IF(h == 0);
+    FAIL_IF(h != PcapFileShardHash(LINKTYPE_RAW, rev, sizeof(rev)));
+    FAIL_IF(PcapFileShardHash(LINKTYPE_RAW, pkt, 39) != 0);
+    PASS;
+}
+#endif /* UNITTESTS */
+
+void SourcePcapFileHelperRegisterTests(void)
+{
+#ifdef UNITTESTS
+    UtRegisterTest("SourcePcapFileHelperTest01", SourcePcapFileHelperTest01);
+    UtRegisterTest("SourcePcapFileHelperTest02", SourcePcapFileHelperTest02);
+#endif
+}
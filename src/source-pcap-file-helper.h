@@ -28,10 +28,15 @@
 #define __SOURCE_PCAP_FILE_HELPER_H__
 
 typedef struct PcapFileGlobalVars_ {
-    uint64_t cnt; /** packet counter */
+    /** packet counter, set by shard 0 while the other shards read it */
+    SC_ATOMIC_DECLARE(uint64_t, cnt);
     ChecksumValidationMode conf_checksum_mode;
     ChecksumValidationMode checksum_mode;
     SC_ATOMIC_DECLARE(unsigned int, invalid_checksums);
+    /** number of reader threads that haven't finished yet */
+    SC_ATOMIC_DECLARE(uint32_t, readers);
+    /** number of reader threads sharding the packets by flow */
+    uint16_t shard_cnt;
 } PcapFileGlobalVars;
 
 /**
@@ -60,6 +65,15 @@ typedef struct PcapFileSharedVars_
 
     /** callback result -- set if one of the thread module failed. */
     int cb_result;
+
+    /* flow sharding: with shard_cnt > 1 every reader reads all packets,
+     * but only processes the ones that hash to its shard_id. */
+    uint16_t shard_id;
+    uint16_t shard_cnt;
+    /** records seen by this reader, including other shards' */
+    uint64_t shard_pkt_cnt;
+    /** last second this reader updated its clock for */
+    time_t shard_last_sec;
 } PcapFileSharedVars;
 
 /**
@@ -80,6 +94,13 @@ typedef struct PcapFileFileVars_
     const u_char *first_pkt_data;
     struct pcap_pkthdr *first_pkt_hdr;
     struct timeval first_pkt_ts;
+
+    /* mmap reader, used for classic pcap files when sharding */
+    uint8_t *map;
+    size_t map_size;
+    size_t map_offset;
+    bool map_swapped;
+    bool map_nsec;
 } PcapFileFileVars;
 
 /**
@@ -112,4 +133,17 @@ void CleanupPcapFileFileVars(PcapFileFileVars *pfv);
  */
 TmEcode ValidateLinkType(int datalink, DecoderFunc *decoder);
 
+/**
+ * Get the flow shard of a raw packet. The shard is based on the IP
+ * addresses only, so that it is the same for both directions and for all
+ * fragments. Packets that can't be parsed are all in shard 0.
+ * @param datalink Datalink type of the packet
+ * @param pkt Packet data
+ * @param len Length of the packet data
+ * @return hash value to map to a shard
+ */
+uint32_t PcapFileShardHash(int datalink, const uint8_t *pkt, uint32_t len);
+
+void SourcePcapFileHelperRegisterTests(void);
+
 #endif /* __SOURCE_PCAP_FILE_HELPER_H__ */
@@ -118,7 +118,7 @@ void TmModuleReceivePcapFileRegister (void)
     tmm_modules[TMM_RECEIVEPCAPFILE].PktAcqBreakLoop = NULL;
     tmm_modules[TMM_RECEIVEPCAPFILE].ThreadExitPrintStats = ReceivePcapFileThreadExitStats;
     tmm_modules[TMM_RECEIVEPCAPFILE].ThreadDeinit = ReceivePcapFileThreadDeinit;
-    tmm_modules[TMM_RECEIVEPCAPFILE].RegisterTests = NULL;
+    tmm_modules[TMM_RECEIVEPCAPFILE].RegisterTests = SourcePcapFileHelperRegisterTests;
     tmm_modules[TMM_RECEIVEPCAPFILE].cap_flags = 0;
     tmm_modules[TMM_RECEIVEPCAPFILE].flags = TM_FLAG_RECEIVE_TM;
 }
@@ -138,7 +138,22 @@ void TmModuleDecodePcapFileRegister (void)
 void PcapFileGlobalInit()
 {
     memset(&pcap_g, 0x00, sizeof(pcap_g));
+    SC_ATOMIC_INIT(pcap_g.cnt);
     SC_ATOMIC_INIT(pcap_g.invalid_checksums);
+    SC_ATOMIC_INIT(pcap_g.readers);
+    pcap_g.shard_cnt = 1;
+}
+
+/**
+ * \brief set the number of reader threads that split the packets by flow
+ *
+ * Each of the readers reads all the files, but only processes the packets
+ * of its own share of the flows. Must be called before the threads are
+ * created.
+ */
+void PcapFileSetShardCount(uint16_t cnt)
+{
+    pcap_g.shard_cnt = cnt > 0 ? cnt : 1;
 }
 
 TmEcode PcapFileExit(TmEcode status, struct timespec *last_processed)
@@ -147,7 +162,10 @@ TmEcode PcapFileExit(TmEcode status, struct timespec *last_processed)
         status = UnixSocketPcapFile(status, last_processed);
         SCReturnInt(status);
     } else {
-        EngineStop();
+        /* with multiple readers, the last one to finish stops the engine */
+        if (SC_ATOMIC_SUB(pcap_g.readers, 1) <= 1) {
+            EngineStop();
+        }
         SCReturnInt(status);
     }
 }
@@ -195,6 +213,10 @@ TmEcode ReceivePcapFileThreadInit(ThreadVars *tv, const void *initdata, void **d
     const char *tmpstring = NULL;
     const char *tmp_bpf_string = NULL;
 
+    /* register the reader before anything can fail, as PcapFileExit is
+     * called from the loop in any case */
+    const uint32_t reader_id = SC_ATOMIC_ADD(pcap_g.readers, 1);
+
     if (initdata == NULL) {
         SCLogError(SC_ERR_INVALID_ARGUMENT, "error: initdata == NULL");
 
@@ -231,11 +253,21 @@ TmEcode ReceivePcapFileThreadInit(ThreadVars *tv, const void *initdata, void **d
         }
     }
 
+    ptv->shared.shard_cnt = pcap_g.shard_cnt;
+    ptv->shared.shard_id = (uint16_t)(reader_id % pcap_g.shard_cnt);
+
     int should_delete = 0;
     ptv->shared.should_delete = false;
     if (ConfGetBool("pcap-file.delete-when-done", &should_delete) == 1) {
         ptv->shared.should_delete = should_delete == 1;
     }
+    if (ptv->shared.should_delete && ptv->shared.shard_cnt > 1) {
+        if (ptv->shared.shard_id == 0) {
+            SCLogWarning(SC_ERR_INVALID_ARGUMENT, "pcap-file.delete-when-done is not "
+                    "supported with multiple readers, files will not be deleted");
+        }
+        ptv->shared.should_delete = false;
+    }
 
     DIR *directory = NULL;
     SCLogDebug("checking file or directory %s", (char*)initdata);
@@ -354,10 +386,11 @@ void ReceivePcapFileThreadExitStats(ThreadVars *tv, void *data)
     if(data != NULL) {
         PcapFileThreadVars *ptv = (PcapFileThreadVars *)data;
 
+        const uint64_t pkt_cnt = SC_ATOMIC_GET(pcap_g.cnt);
         if (pcap_g.conf_checksum_mode == CHECKSUM_VALIDATION_AUTO &&
-            pcap_g.cnt < CHECKSUM_SAMPLE_COUNT &&
+            pkt_cnt < CHECKSUM_SAMPLE_COUNT &&
             SC_ATOMIC_GET(pcap_g.invalid_checksums)) {
-            uint64_t chrate = pcap_g.cnt / SC_ATOMIC_GET(pcap_g.invalid_checksums);
+            uint64_t chrate = pkt_cnt / SC_ATOMIC_GET(pcap_g.invalid_checksums);
             if (chrate < CHECKSUM_INVALID_RATIO)
                 SCLogWarning(SC_ERR_INVALID_CHECKSUM,
                          "1/%" PRIu64 "th of packets have an invalid checksum,"
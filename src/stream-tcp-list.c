@@ -149,6 +149,24 @@ static inline bool CheckOverlap(struct TCPSEG *tree, TcpSegment *seg)
     return false;
 }
 
+/** \internal
+ *  \brief append a segment after the last segment of the tree
+ *
+ *  The last segment never has a right child, so the new segment is
+ *  linked in there directly instead of walking the tree from the root.
+ *  Only the rebalancing is left to do.
+ */
+static inline void TcpSegmentTreeAppend(TcpStream *stream, TcpSegment *seg)
+{
+    TcpSegment *last = stream->seg_tree_last;
+    DEBUG_VALIDATE_BUG_ON(last != RB_MAX(TCPSEG, &stream->seg_tree));
+
+    RB_SET(seg, last, rb);
+    RB_RIGHT(last, rb) = seg;
+    TCPSEG_RB_INSERT_COLOR(&stream->seg_tree, seg);
+    stream->seg_tree_last = seg;
+}
+
 /** \internal
  *  \brief insert the segment into the proper place in the tree
  *         don't worry about the data or overlaps
@@ -176,6 +194,17 @@ static int DoInsertSegment (TcpStream *stream, TcpSegment *seg, TcpSegment **dup
                    "len %" PRIu32 "", seg, seg->seq, TCP_SEG_LEN(seg));
         TCPSEG_RB_INSERT(&stream->seg_tree, seg);
         stream->segs_right_edge = SEG_SEQ_RIGHT_EDGE(seg);
+        stream->seg_tree_last = seg;
+        return 0;
+    }
+
+    /* fast track for in order data: the segment starts at or after the
+     * right edge of all segments, so it can't overlap and goes last. */
+    if (stream->seg_tree_last != NULL && SEQ_GEQ(seg->seq, stream->segs_right_edge)) {
+        SCLogDebug("in order, appending seg %p seq %" PRIu32 ", "
+                   "len %" PRIu32 "", seg, seg->seq, TCP_SEG_LEN(seg));
+        TcpSegmentTreeAppend(stream, seg);
+        stream->segs_right_edge = SEG_SEQ_RIGHT_EDGE(seg);
         return 0;
     }
 
@@ -190,6 +219,10 @@ static int DoInsertSegment (TcpStream *stream, TcpSegment *seg, TcpSegment **dup
     } else {
         if (SEQ_GT(SEG_SEQ_RIGHT_EDGE(seg), stream->segs_right_edge))
             stream->segs_right_edge = SEG_SEQ_RIGHT_EDGE(seg);
+        if (stream->seg_tree_last == NULL)
+            stream->seg_tree_last = RB_MAX(TCPSEG, &stream->seg_tree);
+        else if (TcpSegmentCompare(seg, stream->seg_tree_last) > 0)
+            stream->seg_tree_last = seg;
 
         /* insert succeeded, now check if we overlap with someone */
         if (CheckOverlap(&stream->seg_tree, seg) == true) {
@@ -786,6 +819,8 @@ static inline uint64_t GetLeftEdge(TcpSession *ssn, TcpStream *stream)
 
 static void StreamTcpRemoveSegmentFromStream(TcpStream *stream, TcpSegment *seg)
 {
+    if (seg == stream->seg_tree_last)
+        stream->seg_tree_last = TCPSEG_RB_PREV(seg);
     RB_REMOVE(TCPSEG, &stream->seg_tree, seg);
 }
 
@@ -319,6 +319,7 @@ void StreamTcpReturnStreamSegments (TcpStream *stream)
         RB_REMOVE(TCPSEG, &stream->seg_tree, seg);
         StreamTcpSegmentReturntoPool(seg);
     }
+    stream->seg_tree_last = NULL;
 }
 
 #ifdef UNITTESTS
@@ -580,6 +581,91 @@ static uint32_t StreamTcpReassembleCheckDepth(TcpSession *ssn, TcpStream *stream
     SCReturnUInt(0);
 }
 
+static uint8_t StreamGetAppLayerFlags(TcpSession *ssn, TcpStream *stream,
+                                      Packet *p);
+
+/** \internal
+ *  \brief check if the packet's data can be handed to the app-layer
+ *         directly, without adding it to the stream first
+ *
+ *  Only in inline mode the app-layer is updated with the data of the
+ *  current packet. The stream must have no data left: everything before
+ *  this packet is consumed and released. Raw reassembly and the
+ *  streaming loggers work from the stream, so they must be off.
+ */
+static inline bool StreamTcpReassembleZeroCopyCheck(const TcpSession *ssn,
+        const TcpStream *stream, const Packet *p)
+{
+    if (!(stream_config.flags & STREAMTCP_INIT_FLAG_ZERO_COPY))
+        return false;
+    if (StreamTcpInlineMode() == FALSE || (p->flags & PKT_PSEUDO_STREAM_END))
+        return false;
+    /* TFO data in a SYN starts at seq + 1 */
+    if (p->tcph->th_flags & (TH_SYN|TH_RST))
+        return false;
+    if (ssn->flags & STREAMTCP_FLAG_APP_LAYER_DISABLED)
+        return false;
+    if (!(stream->flags & STREAMTCP_STREAM_FLAG_DISABLE_RAW) ||
+        (stream->flags & STREAMTCP_STREAM_FLAG_GAP) ||
+        !(StreamTcpIsSetStreamFlagAppProtoDetectionCompleted(stream)))
+        return false;
+    /* protocol detection needs to be able to look at the data again */
+    if (FlowChangeProto(p->flow))
+        return false;
+    if (stream_config.streaming_log_api)
+        return false;
+    if (!RB_EMPTY(&stream->seg_tree) || !RB_EMPTY(&stream->sb.sbb_tree) ||
+        stream->sb.buf_offset != 0 || stream->app_progress_rel != 0 ||
+        stream->data_required != 0)
+        return false;
+    return (TCP_GET_SEQ(p) == stream->base_seq);
+}
+
+/** \internal
+ *  \brief update the app-layer straight from the packet payload
+ *
+ *  The stream is moved forward past the data the app-layer consumed.
+ *  As the streaming buffer is empty only its offset is updated.
+ *
+ *  \retval consumed number of bytes the app-layer consumed. The rest
+ *          has to be added to the stream by the caller.
+ */
+static uint32_t StreamTcpReassembleZeroCopy(ThreadVars *tv,
+        TcpReassemblyThreadCtx *ra_ctx, TcpSession *ssn, TcpStream *stream,
+        Packet *p)
+{
+    TcpStream *app_stream = stream;
+    (void)AppLayerHandleTCPData(tv, ra_ctx, p, p->flow, ssn, &app_stream,
+            p->payload, p->payload_len,
+            StreamGetAppLayerFlags(ssn, stream, p));
+    AppLayerProfilingStore(ra_ctx->app_tctx, p);
+
+    const uint32_t consumed = MIN(stream->app_progress_rel, (uint32_t)p->payload_len);
+    SCLogDebug("ssn %p: zero copy, app-layer consumed %u of %u", ssn,
+            consumed, p->payload_len);
+    if (consumed == 0)
+        return 0;
+
+    stream->sb.stream_offset += consumed;
+    stream->base_seq += consumed;
+    stream->app_progress_rel -= consumed;
+    if (consumed <= stream->raw_progress_rel) {
+        stream->raw_progress_rel -= consumed;
+    } else {
+        stream->raw_progress_rel = 0;
+    }
+    if (consumed <= stream->log_progress_rel) {
+        stream->log_progress_rel -= consumed;
+    } else {
+        stream->log_progress_rel = 0;
+    }
+    if (SEQ_GT(stream->base_seq, stream->segs_right_edge))
+        stream->segs_right_edge = stream->base_seq;
+
+    StatsIncr(tv, ra_ctx->counter_tcp_reass_zero_copy);
+    return consumed;
+}
+
 /**
  *  \brief Insert a packets TCP data into the stream reassembly engine.
  *
@@ -632,6 +718,17 @@ int StreamTcpReassembleHandleSegmentHandleData(ThreadVars *tv, TcpReassemblyThre
     if (size > p->payload_len)
         size = p->payload_len;
 
+    /* in order data that the app-layer consumes right away doesn't
+     * need to be copied into the stream */
+    uint32_t consumed = 0;
+    if (size == p->payload_len && StreamTcpReassembleZeroCopyCheck(ssn, stream, p)) {
+        consumed = StreamTcpReassembleZeroCopy(tv, ra_ctx, ssn, stream, p);
+        if (consumed == size) {
+            SCReturnInt(0);
+        }
+        size -= consumed;
+    }
+
     TcpSegment *seg = StreamTcpGetSegment(tv, ra_ctx);
     if (seg == NULL) {
         SCLogDebug("segment_pool is empty");
@@ -640,7 +737,7 @@ int StreamTcpReassembleHandleSegmentHandleData(ThreadVars *tv, TcpReassemblyThre
     }
 
     TCP_SEG_LEN(seg) = size;
-    seg->seq = TCP_GET_SEQ(p);
+    seg->seq = TCP_GET_SEQ(p) + consumed;
 
     /* HACK: for TFO SYN packets the seq for data starts at + 1 */
     if (TCP_HAS_TFO(p) && p->payload_len && p->tcph->th_flags == TH_SYN)
@@ -654,7 +751,8 @@ int StreamTcpReassembleHandleSegmentHandleData(ThreadVars *tv, TcpReassemblyThre
                 APPLAYER_PROTO_DETECTION_SKIPPED);
     }
 
-    if (StreamTcpReassembleInsertSegment(tv, ra_ctx, stream, seg, p, TCP_GET_SEQ(p), p->payload, p->payload_len) != 0) {
+    if (StreamTcpReassembleInsertSegment(tv, ra_ctx, stream, seg, p, TCP_GET_SEQ(p) + consumed,
+                p->payload + consumed, p->payload_len - consumed) != 0) {
         SCLogDebug("StreamTcpReassembleInsertSegment failed");
         SCReturnInt(-1);
     }
@@ -1484,7 +1582,7 @@ static int StreamReassembleRawInline(TcpSession *ssn, const Packet *p,
     }
 
     /* run the callback */
-    r = Callback(cb_data, mydata, mydata_len);
+    r = Callback(cb_data, mydata, mydata_len, mydata_offset);
     BUG_ON(r < 0);
 
     if (return_progress) {
@@ -1646,7 +1744,7 @@ static int StreamReassembleRawDo(TcpSession *ssn, TcpStream *stream,
         SCLogDebug("data %p len %u", mydata, mydata_len);
 
         /* we have data. */
-        r = Callback(cb_data, mydata, mydata_len);
+        r = Callback(cb_data, mydata, mydata_len, mydata_offset);
         BUG_ON(r < 0);
 
         if (mydata_offset == progress) {
@@ -3497,6 +3595,74 @@ end:
     return ret;
 }
 
+/** \test in order data handed to the app-layer without copying it
+ *        into the stream
+ */
+static int StreamTcpReassembleInlineTest11(void)
+{
+    TcpReassemblyThreadCtx *ra_ctx = NULL;
+    ThreadVars tv;
+    TcpSession ssn;
+
+    memset(&tv, 0x00, sizeof(tv));
+
+    StreamTcpUTInit(&ra_ctx);
+    StreamTcpUTInitInline();
+    stream_config.flags |= STREAMTCP_INIT_FLAG_ZERO_COPY;
+    StreamTcpUTSetupSession(&ssn);
+    StreamTcpUTSetupStream(&ssn.server, 1);
+    StreamTcpUTSetupStream(&ssn.client, 1);
+    ssn.data_first_seen_dir = STREAM_TOSERVER;
+    ssn.client.flags |= STREAMTCP_STREAM_FLAG_DISABLE_RAW;
+    StreamTcpSetStreamFlagAppProtoDetectionCompleted(&ssn.client);
+
+    Flow *f = UTHBuildFlow(AF_INET, "1.1.1.1", "2.2.2.2", 1024, 80);
+    FAIL_IF_NULL(f);
+    f->protoctx = &ssn;
+    f->proto = IPPROTO_TCP;
+    f->alproto = f->alproto_ts = f->alproto_tc = ALPROTO_HTTP;
+
+    uint8_t payload[] = "GET / HTTP/1.0\r\n\r\n";
+    uint16_t payload_len = (uint16_t)(sizeof(payload) - 1);
+    Packet *p = UTHBuildPacketReal(payload, payload_len, IPPROTO_TCP,
+            "1.1.1.1", "2.2.2.2", 1024, 80);
+    FAIL_IF_NULL(p);
+    p->tcph->th_seq = htonl(2);
+    p->tcph->th_flags = TH_ACK|TH_PUSH;
+    p->flow = f;
+    p->flowflags = FLOW_PKT_TOSERVER;
+
+    FLOWLOCK_WRLOCK(f);
+    FAIL_IF_NOT(StreamTcpReassembleZeroCopyCheck(&ssn, &ssn.client, p));
+    FAIL_IF(StreamTcpReassembleHandleSegmentHandleData(&tv, ra_ctx, &ssn, &ssn.client, p) != 0);
+
+    /* data went to the app-layer, nothing was added to the stream */
+    FAIL_IF_NOT(RB_EMPTY(&ssn.client.seg_tree));
+    FAIL_IF_NOT(ssn.client.sb.buf_offset == 0);
+    FAIL_IF_NOT(STREAM_APP_PROGRESS(&ssn.client) == payload_len);
+    FAIL_IF_NOT(ssn.client.base_seq == 2U + payload_len);
+    FAIL_IF_NOT(ssn.client.segs_right_edge == 2U + payload_len);
+    FAIL_IF_NULL(f->alstate);
+
+    /* out of order data goes into the stream */
+    p->tcph->th_seq = htonl(2 + payload_len + 10);
+    FAIL_IF(StreamTcpReassembleZeroCopyCheck(&ssn, &ssn.client, p));
+    FAIL_IF(StreamTcpReassembleHandleSegmentHandleData(&tv, ra_ctx, &ssn, &ssn.client, p) != 0);
+    FAIL_IF(RB_EMPTY(&ssn.client.seg_tree));
+
+    /* with segments in the stream the next in order packet is copied too */
+    p->tcph->th_seq = htonl(2 + payload_len);
+    FAIL_IF(StreamTcpReassembleZeroCopyCheck(&ssn, &ssn.client, p));
+
+    FLOWLOCK_UNLOCK(f);
+    UTHFreePacket(p);
+    StreamTcpUTClearSession(&ssn);
+    stream_config.flags &= ~STREAMTCP_INIT_FLAG_ZERO_COPY;
+    StreamTcpUTDeinit(ra_ctx);
+    UTHFreeFlow(f);
+    PASS;
+}
+
 /** \test test insert with overlap
  */
 static int StreamTcpReassembleInsertTest01(void)
@@ -3674,6 +3840,8 @@ void StreamTcpReassembleRegisterTests(void)
 
     UtRegisterTest("StreamTcpReassembleInlineTest10 -- inline APP ra 10",
                    StreamTcpReassembleInlineTest10);
+    UtRegisterTest("StreamTcpReassembleInlineTest11 -- inline APP zero copy",
+                   StreamTcpReassembleInlineTest11);
 
     UtRegisterTest("StreamTcpReassembleInsertTest01 -- insert with overlap",
                    StreamTcpReassembleInsertTest01);
@@ -68,6 +68,8 @@ typedef struct TcpReassemblyThreadCtx_ {
     uint16_t counter_tcp_stream_depth;
     /** count number of streams with a unrecoverable stream gap (missing pkts) */
     uint16_t counter_tcp_reass_gap;
+    /** count packets passed to the app-layer without copying them into the stream */
+    uint16_t counter_tcp_reass_zero_copy;
 
     /** count packet data overlaps */
     uint16_t counter_tcp_reass_overlap;
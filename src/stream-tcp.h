@@ -37,6 +37,7 @@
 #define STREAMTCP_INIT_FLAG_DROP_INVALID           BIT_U8(1)
 #define STREAMTCP_INIT_FLAG_BYPASS                 BIT_U8(2)
 #define STREAMTCP_INIT_FLAG_INLINE                 BIT_U8(3)
+#define STREAMTCP_INIT_FLAG_ZERO_COPY              BIT_U8(4)
 
 /*global flow data*/
 typedef struct TcpStreamCnf_ {
@@ -127,7 +128,9 @@ int StreamTcpSegmentForEach(const Packet *p, uint8_t flag,
 void StreamTcpReassembleConfigEnableOverlapCheck(void);
 void TcpSessionSetReassemblyDepth(TcpSession *ssn, uint32_t size);
 
-typedef int (*StreamReassembleRawFunc)(void *data, const uint8_t *input, const uint32_t input_len);
+/** raw reassembly callback, offset is the stream offset of the start of input */
+typedef int (*StreamReassembleRawFunc)(void *data, const uint8_t *input, const uint32_t input_len,
+        const uint64_t offset);
 
 int StreamReassembleLog(TcpSession *ssn, TcpStream *stream,
         StreamReassembleRawFunc Callback, void *cb_data,
@@ -140,6 +140,10 @@ typedef unsigned char u_char
 
 #include <pcre.h>
 
+/* the pcre keyword runs its regexes with pcre2 */
+#define PCRE2_CODE_UNIT_WIDTH 8
+#include <pcre2.h>
+
 #ifdef HAVE_SYSLOG_H
 #include <syslog.h>
 #else
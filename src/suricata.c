@@ -64,6 +64,7 @@
 #include "detect-engine-address.h"
 #include "detect-engine-port.h"
 #include "detect-engine-mpm.h"
+#include "detect-engine-prefilter.h"
 
 #include "tm-queuehandlers.h"
 #include "tm-queues.h"
@@ -170,6 +171,8 @@
 #include "util-proto-name.h"
 #include "util-mpm-hs.h"
 #include "util-storage.h"
+#include "util-numa.h"
+#include "util-hugepage.h"
 #include "host-storage.h"
 
 #include "util-lua.h"
@@ -597,6 +600,7 @@ static void PrintUsage(const char *progname)
     printf("\t--dump-config                        : show the running configuration\n");
     printf("\t--dump-features                      : display provided features\n");
     printf("\t--build-info                         : display build information\n");
+    printf("\t--dataset-compile <type>,<in>,<out>  : compile dataset file <in> into <out> for fast loading\n");
     printf("\t--pcap[=<dev>]                       : run in pcap mode, no value select interfaces from suricata.yaml\n");
     printf("\t--pcap-file-continuous               : when running in pcap mode with a directory, continue checking directory for pcaps until interrupted\n");
     printf("\t--pcap-file-delete                   : when running in replay mode (-r with directory or file), will delete pcap files that have been processed when done\n");
@@ -994,6 +998,7 @@ static void SCInstanceInit(SCInstance *suri, const char *progname)
     suri->regex_arg = NULL;
 
     suri->keyword_info = NULL;
+    suri->dataset_compile_arg = NULL;
     suri->runmode_custom_mode = NULL;
 #ifndef OS_WIN32
     suri->user_name = NULL;
@@ -1225,6 +1230,7 @@ static TmEcode ParseCommandLine(int argc, char** argv, SCInstance *suri)
         {"dag", required_argument, 0, 0},
         {"napatech", 0, 0, 0},
         {"build-info", 0, &build_info, 1},
+        {"dataset-compile", required_argument, 0, 0},
         {"data-dir", required_argument, 0, 0},
 #ifdef WINDIVERT
         {"windivert", required_argument, 0, 0},
@@ -1486,6 +1492,11 @@ static TmEcode ParseCommandLine(int argc, char** argv, SCInstance *suri)
                 suri->run_mode = RUNMODE_PRINT_BUILDINFO;
                 return TM_ECODE_OK;
             }
+            else if (strcmp((long_opts[option_index]).name, "dataset-compile") == 0) {
+                suri->run_mode = RUNMODE_DATASET_COMPILE;
+                suri->dataset_compile_arg = optarg;
+                return TM_ECODE_OK;
+            }
             else if(strcmp((long_opts[option_index]).name, "windivert-forward") == 0) {
 #ifdef WINDIVERT
                 if (suri->run_mode == RUNMODE_UNKNOWN) {
@@ -2056,6 +2067,25 @@ void PostRunDeinit(const int runmode, struct timeval *start_time)
 }
 
 
+/** \brief handle --dataset-compile <type>,<in>,<out>
+ *
+ *  Type is split off at the first comma and the output file at the last
+ *  one, so the input file name may contain commas.
+ */
+static int DatasetCompileArg(char *arg)
+{
+    char *in = strchr(arg, ',');
+    char *out = strrchr(arg, ',');
+    if (in == NULL || out == NULL || in == out) {
+        SCLogError(SC_ERR_INVALID_ARGUMENT, "--dataset-compile expects "
+                "<type>,<input file>,<output file>");
+        return -1;
+    }
+    *in++ = '\0';
+    *out++ = '\0';
+    return DatasetCompile(arg, in, out);
+}
+
 static int StartInternalRunMode(SCInstance *suri, int argc, char **argv)
 {
     /* Treat internal running mode */
@@ -2078,6 +2108,9 @@ static int StartInternalRunMode(SCInstance *suri, int argc, char **argv)
         case RUNMODE_LIST_RUNMODES:
             RunModeListRunmodes();
             return TM_ECODE_DONE;
+        case RUNMODE_DATASET_COMPILE:
+            return DatasetCompileArg(suri->dataset_compile_arg) == 0 ?
+                TM_ECODE_DONE : TM_ECODE_FAILED;
         case RUNMODE_LIST_UNITTEST:
             RunUnittests(1, suri->regex_arg);
         case RUNMODE_UNITTEST:
@@ -2501,6 +2534,7 @@ int PostConfLoadedSetup(SCInstance *suri)
     ThresholdInit();
     HostBitInitCtx();
     IPPairBitInitCtx();
+    PrefilterStreamingInit();
 
     if (DetectAddressTestConfVars() < 0) {
         SCLogError(SC_ERR_INVALID_YAML_CONF_ENTRY,
@@ -2562,11 +2596,17 @@ int PostConfLoadedSetup(SCInstance *suri)
         (void)ConfSetFinal("stream.reassembly.raw", "false");
     }
 
+    /* before any of the hash tables is allocated */
+    HugePageSetupFromConfig();
+
     HostInitConfig(HOST_VERBOSE);
     SCAsn1LoadConfig();
 
     CoredumpLoadConfig();
 
+    /* before the flow engine preallocates its per node queues */
+    NumaSetupFromConfig();
+
     DecodeGlobalConfig();
 
     LiveDeviceFinalize();
@@ -131,6 +131,7 @@ typedef struct SCInstance_ {
     char *regex_arg;
 
     char *keyword_info;
+    char *dataset_compile_arg;
     char *runmode_custom_mode;
 #ifndef OS_WIN32
     const char *user_name;
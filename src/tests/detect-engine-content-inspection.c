@@ -52,6 +52,20 @@
                 DETECT_ENGINE_CONTENT_INSPECTION_MODE_PAYLOAD);                             \
     FAIL_IF_NOT(r == (match));                                                              \
     FAIL_IF_NOT(det_ctx->inspection_recursion_counter == (steps));                          \
+    /* run again without the compiled program */                                           \
+    SigMatchData *smd = s->sm_arrays[DETECT_SM_LIST_PMATCH];                                \
+    const uint32_t ci_prog = smd->ci_prog;                                                  \
+    smd->ci_prog = 0;                                                                       \
+    det_ctx->inspection_recursion_counter = 0;                                              \
+    det_ctx->discontinue_matching = 0;                                                      \
+    det_ctx->buffer_offset = 0;                                                             \
+    r = DetectEngineContentInspection(de_ctx, det_ctx,                                      \
+                s, smd, NULL, &f,                                                           \
+                (uint8_t *)(buf), (buflen), 0, DETECT_CI_FLAGS_SINGLE,                      \
+                DETECT_ENGINE_CONTENT_INSPECTION_MODE_PAYLOAD);                             \
+    smd->ci_prog = ci_prog;                                                                 \
+    FAIL_IF_NOT(r == (match));                                                              \
+    FAIL_IF_NOT(det_ctx->inspection_recursion_counter == (steps));                          \
     DetectEngineThreadCtxDeinit(&tv, det_ctx);                                              \
     DetectEngineCtxFree(de_ctx);                                                            \
 }
@@ -263,6 +277,43 @@ static int DetectEngineContentInspectionTest13(void) {
     TEST_FOOTER;
 }
 
+/** \test lists are compiled, except the ones with lua or base64_decode */
+static int DetectEngineContentInspectionTest14(void)
+{
+    DetectEngineCtx *de_ctx = DetectEngineCtxInit();
+    FAIL_IF_NULL(de_ctx);
+    FAIL_IF_NOT(de_ctx->inspection_vm);
+
+    Signature *s = DetectEngineAppendSig(de_ctx, "alert tcp any any -> any any "
+            "(content:\"a\"; byte_extract:1,0,len,relative,string; "
+            "content:\"b\"; distance:0; pcre:\"/c/R\"; isdataat:len,relative; sid:1;)");
+    FAIL_IF_NULL(s);
+    Signature *s2 = DetectEngineAppendSig(de_ctx, "alert tcp any any -> any any "
+            "(content:\"a\"; base64_decode:relative; base64_data; content:\"b\"; sid:2;)");
+    FAIL_IF_NULL(s2);
+    SigGroupBuild(de_ctx);
+
+    FAIL_IF(s->sm_arrays[DETECT_SM_LIST_PMATCH]->ci_prog == 0);
+    FAIL_IF(s2->sm_arrays[DETECT_SM_LIST_PMATCH]->ci_prog != 0);
+    FAIL_IF(s2->sm_arrays[DETECT_SM_LIST_BASE64_DATA]->ci_prog == 0);
+
+    DetectEngineCtxFree(de_ctx);
+    PASS;
+}
+
+/** \test backtracking over several relative keywords */
+static int DetectEngineContentInspectionTest15(void) {
+    TEST_HEADER;
+    TEST_RUN("a1xa2xya1xyz", 12, "content:\"a\"; byte_extract:1,0,len,relative,string; "
+            "content:\"x\"; distance:0; within:1; isdataat:len,relative; "
+            "content:\"yz\"; distance:0; within:2; endswith;", true, 13);
+    TEST_RUN("a1xa2xya3xy", 11, "content:\"a\"; byte_extract:1,0,len,relative,string; "
+            "content:\"x\"; distance:0; within:1; isdataat:len,relative; "
+            "content:\"yz\"; distance:0; within:2; endswith;", false, 12);
+    TEST_RUN("abcabcabd", 9, "content:\"a\"; pcre:\"/^b/R\"; pcre:\"/^d/R\";", true, 7);
+    TEST_FOOTER;
+}
+
 void DetectEngineContentInspectionRegisterTests(void)
 {
     UtRegisterTest("DetectEngineContentInspectionTest01",
@@ -291,6 +342,10 @@ void DetectEngineContentInspectionRegisterTests(void)
                    DetectEngineContentInspectionTest12);
     UtRegisterTest("DetectEngineContentInspectionTest13 mix startswith/endswith",
                    DetectEngineContentInspectionTest13);
+    UtRegisterTest("DetectEngineContentInspectionTest14 compiled lists",
+                   DetectEngineContentInspectionTest14);
+    UtRegisterTest("DetectEngineContentInspectionTest15 backtracking",
+                   DetectEngineContentInspectionTest15);
 }
 
 #undef TEST_HEADER
@@ -708,6 +708,40 @@ static int StreamTcpReassembleTest32(void)
     OVERLAP_END;
 }
 
+/** \test in order segments are appended, out of order ones inserted */
+static int StreamTcpReassembleTest33(void)
+{
+    OVERLAP_START(0, OS_POLICY_BSD);
+    OVERLAP_STEP(1, "AAA", 3, "AAA", 3);
+    FAIL_IF_NOT(stream->seg_tree_last == RB_MAX(TCPSEG, &stream->seg_tree));
+    OVERLAP_STEP(4, "BBB", 3, "AAABBB", 6);
+    FAIL_IF_NOT(stream->seg_tree_last == RB_MAX(TCPSEG, &stream->seg_tree));
+    OVERLAP_STEP(10, "DDD", 3, "AAABBB\0\0\0DDD", 12);
+    FAIL_IF_NOT(stream->seg_tree_last == RB_MAX(TCPSEG, &stream->seg_tree));
+    /* fill the gap, not the last segment */
+    OVERLAP_STEP(7, "CCC", 3, "AAABBBCCCDDD", 12);
+    FAIL_IF_NOT(stream->seg_tree_last == RB_MAX(TCPSEG, &stream->seg_tree));
+    FAIL_IF_NOT(stream->seg_tree_last->seq == stream->isn + 10);
+    OVERLAP_STEP(13, "EEE", 3, "AAABBBCCCDDDEEE", 15);
+    FAIL_IF_NOT(stream->seg_tree_last == RB_MAX(TCPSEG, &stream->seg_tree));
+    FAIL_IF_NOT(stream->seg_tree_last->seq == stream->isn + 13);
+
+    /* segments are in seq order */
+    uint32_t seq = 0;
+    int cnt = 0;
+    TcpSegment *seg;
+    RB_FOREACH(seg, TCPSEG, &stream->seg_tree) {
+        FAIL_IF(cnt > 0 && SEQ_LEQ(seg->seq, seq));
+        seq = seg->seq;
+        cnt++;
+    }
+    FAIL_IF_NOT(cnt == 5);
+
+    StreamTcpReturnStreamSegments(stream);
+    FAIL_IF_NOT_NULL(stream->seg_tree_last);
+    OVERLAP_END;
+}
+
 void StreamTcpListRegisterTests(void)
 {
     UtRegisterTest("StreamTcpReassembleTest01 -- BSD policy",
@@ -729,5 +763,7 @@ void StreamTcpListRegisterTests(void)
             StreamTcpReassembleTest31);
     UtRegisterTest("StreamTcpReassembleTest32",
             StreamTcpReassembleTest32);
+    UtRegisterTest("StreamTcpReassembleTest33 -- in order append",
+            StreamTcpReassembleTest33);
 
 }
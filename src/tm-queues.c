@@ -43,6 +43,9 @@ Tmq *TmqCreateQueue(const char *name)
         FatalError(SC_ERR_MEM_ALLOC, "SCStrdup failed");
 
     q->id = tmq_id++;
+    SC_ATOMIC_INIT(q->rings_waiting);
+    SC_ATOMIC_INIT(q->rings_writers_waiting);
+    SCCondInit(&q->rings_cond, NULL);
     q->is_packet_pool = (strcmp(q->name, "packetpool") == 0);
     if (!q->is_packet_pool) {
         q->pq = PacketQueueAlloc();
@@ -66,6 +69,37 @@ Tmq *TmqGetQueueByName(const char *name)
     return NULL;
 }
 
+/**
+ * \brief add a ring for a new writer of the queue
+ *
+ * Must be called before the threads start processing packets.
+ */
+PacketRing *TmqAddRing(Tmq *q, uint32_t size)
+{
+    PacketRing **rings = SCRealloc(q->rings, (q->rings_cnt + 1) * sizeof(PacketRing *));
+    if (rings == NULL)
+        return NULL;
+    q->rings = rings;
+
+    PacketRing *r = PacketRingAlloc(size);
+    if (r == NULL)
+        return NULL;
+    q->rings[q->rings_cnt++] = r;
+    return r;
+}
+
+/**
+ * \brief number of packets in the rings of the queue
+ */
+uint64_t TmqRingsLen(Tmq *q)
+{
+    uint64_t len = 0;
+    for (uint16_t i = 0; i < q->rings_cnt; i++) {
+        len += PacketRingLen(q->rings[i]);
+    }
+    return len;
+}
+
 void TmqDebugList(void)
 {
     Tmq *tmq = NULL;
@@ -89,6 +123,13 @@ void TmqResetQueues(void)
         if (tmq->pq) {
             PacketQueueFree(tmq->pq);
         }
+        for (uint16_t i = 0; i < tmq->rings_cnt; i++) {
+            PacketRingFree(tmq->rings[i]);
+        }
+        if (tmq->rings) {
+            SCFree(tmq->rings);
+        }
+        SCCondDestroy(&tmq->rings_cond);
         SCFree(tmq);
     }
     tmq_id = 0;
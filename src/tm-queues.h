@@ -25,6 +25,7 @@
 #define __TM_QUEUES_H__
 
 #include "packet-queue.h"
+#include "packet-ring.h"
 
 typedef struct Tmq_ {
     char *name;
@@ -33,11 +34,26 @@ typedef struct Tmq_ {
     uint16_t reader_cnt;
     uint16_t writer_cnt;
     PacketQueue *pq;
+
+    /* lock free rings, one per writer. Packets injected by other threads,
+     * like flow timeout packets, still go through 'pq'. */
+    PacketRing **rings;
+    uint16_t rings_cnt;
+    /** ring the reader looks at first */
+    uint16_t rings_next;
+    /** reader is (about to be) waiting on the pq cond */
+    SC_ATOMIC_DECLARE(int, rings_waiting);
+    /** writers waiting on 'rings_cond' for room in their full ring */
+    SC_ATOMIC_DECLARE(int, rings_writers_waiting);
+    SCCondT rings_cond;
+
     TAILQ_ENTRY(Tmq_) next;
 } Tmq;
 
 Tmq* TmqCreateQueue(const char *name);
 Tmq* TmqGetQueueByName(const char *name);
+PacketRing *TmqAddRing(Tmq *q, uint32_t size);
+uint64_t TmqRingsLen(Tmq *q);
 
 void TmqDebugList(void);
 void TmqResetQueues(void);
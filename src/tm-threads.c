@@ -41,7 +41,9 @@
 #include "util-optimize.h"
 #include "util-profiling.h"
 #include "util-signal.h"
+#include "util-numa.h"
 #include "queue.h"
+#include "flow-worker.h"
 
 #ifdef PROFILE_LOCKING
 thread_local uint64_t mutex_lock_contention;
@@ -145,6 +147,62 @@ TmEcode TmThreadsSlotVarRun(ThreadVars *tv, Packet *p, TmSlot *slot)
     return TM_ECODE_OK;
 }
 
+/** \brief run a batch of packets through the slots
+ *
+ *  Each slot processes all packets of the batch before the next slot is
+ *  run, so the code and data of a slot stay in cache for the whole batch.
+ *  Packets created by a slot (e.g. tunnel or defrag packets) are run
+ *  through the rest of the slots right away, like TmThreadsSlotVarRun()
+ *  does.
+ *
+ *  The packets are not passed to the output queue handler, the caller
+ *  does that.
+ */
+TmEcode TmThreadsSlotVarRunBatch(ThreadVars *tv, Packet **pkts, const uint32_t cnt,
+        TmSlot *slot)
+{
+    for (TmSlot *s = slot; s != NULL; s = s->slot_next) {
+        void *slot_data = SC_ATOMIC_GET(s->slot_data);
+        const bool flowworker = (s == tv->tm_flowworker);
+
+        for (uint32_t i = 0; i < cnt; i++) {
+            Packet *p = pkts[i];
+
+            /* decode has set the flow hashes of all packets by now,
+             * get the flow data of the next packets on their way */
+            if (flowworker) {
+                FlowWorkerPrefetch(slot_data, pkts, cnt, i);
+            }
+
+            PACKET_PROFILING_TMM_START(p, s->tm_id);
+            TmEcode r = s->SlotFunc(tv, p, slot_data);
+            PACKET_PROFILING_TMM_END(p, s->tm_id);
+
+            if (unlikely(r == TM_ECODE_FAILED)) {
+                TmThreadsSlotProcessPktFail(tv, s, NULL);
+                return TM_ECODE_FAILED;
+            }
+
+            while (tv->decode_pq.top != NULL) {
+                Packet *extra_p = PacketDequeueNoLock(&tv->decode_pq);
+                if (unlikely(extra_p == NULL))
+                    continue;
+
+                if (s->slot_next != NULL) {
+                    r = TmThreadsSlotVarRun(tv, extra_p, s->slot_next);
+                    if (unlikely(r == TM_ECODE_FAILED)) {
+                        TmThreadsSlotProcessPktFail(tv, s, extra_p);
+                        return TM_ECODE_FAILED;
+                    }
+                }
+                tv->tmqh_out(tv, extra_p);
+            }
+        }
+    }
+
+    return TM_ECODE_OK;
+}
+
 /** \internal
  *
  *  \brief Process flow timeout packets
@@ -890,6 +948,9 @@ TmEcode TmThreadSetupOptions(ThreadVars *tv)
     }
 #endif
 
+    /* prefer memory of the node we're pinned to */
+    NumaThreadBind();
+
     return TM_ECODE_OK;
 }
 
@@ -1198,6 +1259,9 @@ static bool ThreadStillHasPackets(ThreadVars *tv)
         if (len != 0) {
             return true;
         }
+        if (tv->inq->rings_cnt > 0 && TmqRingsLen(tv->inq) != 0) {
+            return true;
+        }
     }
 
     if (tv->stream_pq != NULL) {
@@ -45,6 +45,10 @@ static inline void SleepUsec(uint64_t usec)
 #endif
 
 #define TM_QUEUE_NAME_MAX 16
+
+/** max number of packets a capture source passes to
+ *  TmThreadsSlotProcessPktBatch() at once */
+#define TM_BATCH_SIZE_MAX 64
 #define TM_THREAD_NAME_MAX 16
 
 typedef TmEcode (*TmSlotFunc)(ThreadVars *, Packet *, void *);
@@ -121,6 +125,8 @@ void TmThreadsUnsetFlag(ThreadVars *, uint32_t);
 void TmThreadWaitForFlag(ThreadVars *, uint32_t);
 
 TmEcode TmThreadsSlotVarRun (ThreadVars *tv, Packet *p, TmSlot *slot);
+TmEcode TmThreadsSlotVarRunBatch(ThreadVars *tv, Packet **pkts, const uint32_t cnt,
+        TmSlot *slot);
 
 ThreadVars *TmThreadsGetTVContainingSlot(TmSlot *);
 void TmThreadDisablePacketThreads(void);
@@ -202,6 +208,33 @@ static inline TmEcode TmThreadsSlotProcessPkt(ThreadVars *tv, TmSlot *s, Packet
     return TM_ECODE_OK;
 }
 
+/** \brief Process a batch of packets from a capture source
+ *
+ *  Like TmThreadsSlotProcessPkt(), but each slot handles all packets
+ *  before the next slot runs. See TmThreadsSlotVarRunBatch().
+ */
+static inline TmEcode TmThreadsSlotProcessPktBatch(ThreadVars *tv, TmSlot *s,
+        Packet **pkts, const uint32_t cnt)
+{
+    if (s != NULL) {
+        TmEcode r = TmThreadsSlotVarRunBatch(tv, pkts, cnt, s);
+        if (unlikely(r == TM_ECODE_FAILED)) {
+            for (uint32_t i = 0; i < cnt; i++) {
+                TmqhOutputPacketpool(tv, pkts[i]);
+            }
+            return TM_ECODE_FAILED;
+        }
+    }
+
+    for (uint32_t i = 0; i < cnt; i++) {
+        tv->tmqh_out(tv, pkts[i]);
+    }
+
+    TmThreadsHandleInjectedPackets(tv);
+
+    return TM_ECODE_OK;
+}
+
 /** \brief inject packet if THV_CAPTURE_INJECT_PKT is set
  *  Allow caller to supply their own packet
  *
@@ -39,7 +39,19 @@
 #include "conf.h"
 #include "util-unittest.h"
 
+extern int max_pending_packets;
+
+/** use lock free rings instead of the mutex protected queues */
+static bool flow_ring_mode = false;
+
+/** max and min number of times a reader polls the rings before sleeping */
+#define TMQH_FLOW_RING_SPIN_MAX 4096
+#define TMQH_FLOW_RING_SPIN_MIN 16
+/** check the regular queue after this many packets from the rings */
+#define TMQH_FLOW_RING_PQ_CHECK 64
+
 Packet *TmqhInputFlow(ThreadVars *t);
+static Packet *TmqhInputFlowRing(ThreadVars *tv);
 void TmqhOutputFlowHash(ThreadVars *t, Packet *p);
 void TmqhOutputFlowIPPair(ThreadVars *t, Packet *p);
 void *TmqhOutputFlowSetupCtx(const char *queue_str);
@@ -76,6 +88,19 @@ void TmqhFlowRegister(void)
         tmqh_table[TMQH_FLOW].OutHandler = TmqhOutputFlowHash;
     }
 
+    const char *queue_type = NULL;
+    if (ConfGet("autofp-queue", &queue_type) == 1) {
+        if (strcasecmp(queue_type, "ring") == 0) {
+            flow_ring_mode = true;
+            tmqh_table[TMQH_FLOW].InHandler = TmqhInputFlowRing;
+        } else if (strcasecmp(queue_type, "mutex") != 0) {
+            SCLogError(SC_ERR_INVALID_YAML_CONF_ENTRY, "Invalid entry \"%s\" "
+                       "for autofp-queue in conf.  Killing engine.",
+                       queue_type);
+            exit(EXIT_FAILURE);
+        }
+    }
+
     return;
 }
 
@@ -89,6 +114,9 @@ void TmqhFlowPrintAutofpHandler(void)
     PRINT_IF_FUNC(TmqhOutputFlowIPPair, "IPPair");
 
 #undef PRINT_IF_FUNC
+
+    if (flow_ring_mode)
+        SCLogConfig("AutoFP mode using lock free rings");
 }
 
 /* same as 'simple' */
@@ -115,6 +143,108 @@ Packet *TmqhInputFlow(ThreadVars *tv)
     }
 }
 
+/** \internal
+ *  \brief get a packet from the rings, starting with the one after the ring
+ *         the last packet came from, so a busy writer can't starve others */
+static inline Packet *TmqhFlowRingDequeue(Tmq *q)
+{
+    for (uint16_t i = 0; i < q->rings_cnt; i++) {
+        uint16_t idx = q->rings_next++;
+        if (q->rings_next >= q->rings_cnt)
+            q->rings_next = 0;
+        Packet *p = PacketRingDequeue(q->rings[idx]);
+        if (p != NULL)
+            return p;
+    }
+    return NULL;
+}
+
+/** \internal
+ *  \brief get a packet from the rings and wake the writers waiting for
+ *         room in theirs. Must be called without the pq lock held. */
+static inline Packet *TmqhFlowRingGet(Tmq *q)
+{
+    Packet *p = TmqhFlowRingDequeue(q);
+    if (p != NULL && unlikely(SC_ATOMIC_GET(q->rings_writers_waiting))) {
+        SCMutexLock(&q->pq->mutex_q);
+        pthread_cond_broadcast(&q->rings_cond);
+        SCMutexUnlock(&q->pq->mutex_q);
+    }
+    return p;
+}
+
+static inline Packet *TmqhFlowPQDequeue(PacketQueue *pq)
+{
+    Packet *p = NULL;
+    SCMutexLock(&pq->mutex_q);
+    if (pq->len > 0)
+        p = PacketDequeue(pq);
+    SCMutexUnlock(&pq->mutex_q);
+    return p;
+}
+
+/** \brief ring mode input handler
+ *
+ *  Polls the writers' rings, spinning for a while when they are empty
+ *  before going to sleep on the queue's condition. The number of spins
+ *  adapts: it grows when spinning found packets and shrinks when the
+ *  thread had to sleep anyway. Packets injected into the regular queue
+ *  by other threads are checked regularly.
+ */
+static Packet *TmqhInputFlowRing(ThreadVars *tv)
+{
+    /* per thread, as each reader thread has its own queue */
+    static thread_local uint32_t spin_max = TMQH_FLOW_RING_SPIN_MAX;
+    static thread_local uint32_t ring_cnt = 0;
+
+    Tmq *q = tv->inq;
+    PacketQueue *pq = q->pq;
+    Packet *p;
+
+    StatsSyncCountersIfSignalled(tv);
+
+    if (++ring_cnt < TMQH_FLOW_RING_PQ_CHECK) {
+        p = TmqhFlowRingGet(q);
+        if (p != NULL)
+            return p;
+    }
+    ring_cnt = 0;
+    if ((p = TmqhFlowPQDequeue(pq)) != NULL)
+        return p;
+
+    for (uint32_t spins = 0; spins < spin_max; spins++) {
+        p = TmqhFlowRingGet(q);
+        if (p != NULL) {
+            if (spins > 0 && spin_max < TMQH_FLOW_RING_SPIN_MAX)
+                spin_max *= 2;
+            return p;
+        }
+    }
+    if (spin_max > TMQH_FLOW_RING_SPIN_MIN)
+        spin_max /= 2;
+
+    SCMutexLock(&pq->mutex_q);
+    /* announce we'll sleep, then check again: a writer either sees the
+     * flag and signals us, or we see its packet */
+    SC_ATOMIC_SET(q->rings_waiting, 1);
+    p = TmqhFlowRingDequeue(q);
+    /* writers set their flag under this lock, so none is missed here */
+    if (SC_ATOMIC_GET(q->rings_writers_waiting))
+        pthread_cond_broadcast(&q->rings_cond);
+    if (p == NULL && pq->len == 0) {
+        SCCondWait(&pq->cond_q, &pq->mutex_q);
+    }
+    SC_ATOMIC_SET(q->rings_waiting, 0);
+    if (p == NULL && pq->len > 0)
+        p = PacketDequeue(pq);
+    SCMutexUnlock(&pq->mutex_q);
+
+    if (p == NULL)
+        p = TmqhFlowRingGet(q);
+    /* may return NULL on signals */
+    return p;
+}
+
 static int StoreQueueId(TmqhFlowCtx *ctx, char *name)
 {
     void *ptmp;
@@ -147,6 +277,15 @@ static int StoreQueueId(TmqhFlowCtx *ctx, char *name)
     }
     ctx->queues[ctx->size - 1].q = tmq->pq;
 
+    if (flow_ring_mode) {
+        /* each packet can be in at most one ring, so a ring the size of
+         * the packet pool can hold all packets of its writer */
+        PacketRing *r = TmqAddRing(tmq, (uint32_t)max_pending_packets);
+        if (r == NULL)
+            return -1;
+        ctx->queues[ctx->size - 1].tmq = tmq;
+        ctx->queues[ctx->size - 1].ring = r;
+    }
     return 0;
 }
 
@@ -218,6 +357,38 @@ void TmqhOutputFlowFreeCtx(void *ctx)
     return;
 }
 
+static inline void TmqhFlowEnqueue(TmqhFlowMode *m, Packet *p)
+{
+    if (m->ring == NULL) {
+        PacketQueue *q = m->q;
+        SCMutexLock(&q->mutex_q);
+        PacketEnqueue(q, p);
+        SCCondSignal(&q->cond_q);
+        SCMutexUnlock(&q->mutex_q);
+        return;
+    }
+
+    if (!PacketRingEnqueue(m->ring, p)) {
+        /* only when packets were allocated outside of the pool. Wait for
+         * the reader to make room, as skipping the ring would reorder
+         * packets. Announce the wait under the lock, then try again: the
+         * reader either sees the flag and wakes us, or we see the room. */
+        SCMutexLock(&m->q->mutex_q);
+        (void)SC_ATOMIC_ADD(m->tmq->rings_writers_waiting, 1);
+        while (!PacketRingEnqueue(m->ring, p)) {
+            SCCondSignal(&m->q->cond_q);
+            SCCondWait(&m->tmq->rings_cond, &m->q->mutex_q);
+        }
+        (void)SC_ATOMIC_SUB(m->tmq->rings_writers_waiting, 1);
+        SCMutexUnlock(&m->q->mutex_q);
+    }
+    if (SC_ATOMIC_GET(m->tmq->rings_waiting)) {
+        SCMutexLock(&m->q->mutex_q);
+        SCCondSignal(&m->q->cond_q);
+        SCMutexUnlock(&m->q->mutex_q);
+    }
+}
+
 void TmqhOutputFlowHash(ThreadVars *tv, Packet *p)
 {
     int16_t qid = 0;
@@ -234,12 +405,7 @@ void TmqhOutputFlowHash(ThreadVars *tv, Packet *p)
             ctx->last = 0;
     }
 
-    PacketQueue *q = ctx->queues[qid].q;
-    SCMutexLock(&q->mutex_q);
-    PacketEnqueue(q, p);
-    SCCondSignal(&q->cond_q);
-    SCMutexUnlock(&q->mutex_q);
-
+    TmqhFlowEnqueue(&ctx->queues[qid], p);
     return;
 }
 
@@ -269,12 +435,7 @@ void TmqhOutputFlowIPPair(ThreadVars *tv, Packet *p)
      * ctx->size will be lesser than 2 ** 31 for sure */
     qid = addr_hash % ctx->size;
 
-    PacketQueue *q = ctx->queues[qid].q;
-    SCMutexLock(&q->mutex_q);
-    PacketEnqueue(q, p);
-    SCCondSignal(&q->cond_q);
-    SCMutexUnlock(&q->mutex_q);
-
+    TmqhFlowEnqueue(&ctx->queues[qid], p);
     return;
 }
 
@@ -376,6 +537,57 @@ static int TmqhOutputFlowSetupCtxTest03(void)
     PASS;
 }
 
+/** \test ring mode: a ring per writer, packets pass through in order */
+static int TmqhOutputFlowRingTest01(void)
+{
+    TmqResetQueues();
+    flow_ring_mode = true;
+
+    Tmq *tmq1 = TmqCreateQueue("queue1");
+    FAIL_IF_NULL(tmq1);
+    Tmq *tmq2 = TmqCreateQueue("queue2");
+    FAIL_IF_NULL(tmq2);
+
+    TmqhFlowCtx *fctx1 = TmqhOutputFlowSetupCtx("queue1,queue2");
+    FAIL_IF_NULL(fctx1);
+    TmqhFlowCtx *fctx2 = TmqhOutputFlowSetupCtx("queue1");
+    FAIL_IF_NULL(fctx2);
+    flow_ring_mode = false;
+
+    FAIL_IF_NOT(tmq1->rings_cnt == 2);
+    FAIL_IF_NOT(tmq2->rings_cnt == 1);
+    FAIL_IF_NOT(fctx1->queues[0].ring == tmq1->rings[0]);
+    FAIL_IF_NOT(fctx2->queues[0].ring == tmq1->rings[1]);
+
+    Packet *p1 = PacketGetFromAlloc();
+    FAIL_IF_NULL(p1);
+    Packet *p2 = PacketGetFromAlloc();
+    FAIL_IF_NULL(p2);
+    Packet *p3 = PacketGetFromAlloc();
+    FAIL_IF_NULL(p3);
+
+    TmqhFlowEnqueue(&fctx1->queues[0], p1);
+    TmqhFlowEnqueue(&fctx1->queues[0], p2);
+    TmqhFlowEnqueue(&fctx2->queues[0], p3);
+    FAIL_IF_NOT(TmqRingsLen(tmq1) == 3);
+    FAIL_IF_NOT(TmqRingsLen(tmq2) == 0);
+
+    /* readers alternate between the writers' rings */
+    FAIL_IF_NOT(TmqhFlowRingDequeue(tmq1) == p1);
+    FAIL_IF_NOT(TmqhFlowRingDequeue(tmq1) == p3);
+    FAIL_IF_NOT(TmqhFlowRingDequeue(tmq1) == p2);
+    FAIL_IF_NOT(TmqhFlowRingDequeue(tmq1) == NULL);
+    FAIL_IF_NOT(TmqRingsLen(tmq1) == 0);
+
+    PacketFree(p1);
+    PacketFree(p2);
+    PacketFree(p3);
+    TmqhOutputFlowFreeCtx(fctx1);
+    TmqhOutputFlowFreeCtx(fctx2);
+    TmqResetQueues();
+    PASS;
+}
+
 #endif /* UNITTESTS */
 
 void TmqhFlowRegisterTests(void)
@@ -387,6 +599,8 @@ void TmqhFlowRegisterTests(void)
                    TmqhOutputFlowSetupCtxTest02);
     UtRegisterTest("TmqhOutputFlowSetupCtxTest03",
                    TmqhOutputFlowSetupCtxTest03);
+    UtRegisterTest("TmqhOutputFlowRingTest01",
+                   TmqhOutputFlowRingTest01);
 #endif
 
     return;
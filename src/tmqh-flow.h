@@ -26,6 +26,9 @@
 
 typedef struct TmqhFlowMode_ {
     PacketQueue *q;
+    /* ring mode: this writer's ring into 'tmq' */
+    Tmq *tmq;
+    PacketRing *ring;
 } TmqhFlowMode;
 
 /** \brief Ctx for the flow queue handler
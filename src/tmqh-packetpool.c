@@ -49,6 +49,7 @@
 #include "util-error.h"
 #include "util-profiling.h"
 #include "util-device.h"
+#include "util-numa.h"
 
 /* Number of freed packet to save for one pool before freeing them. */
 #define MAX_PENDING_RETURN_PACKETS 32
@@ -75,21 +76,69 @@ void TmqhPacketpoolRegister (void)
 static int PacketPoolIsEmpty(PktPool *pool)
 {
     /* Check local stack first. */
-    if (pool->head || pool->return_stack.head)
+    if (pool->head || SC_ATOMIC_GET(pool->return_stack.head))
         return 0;
 
     return 1;
 }
 
+/** \internal
+ *  \brief push a list of packets onto a pool's return stack
+ *
+ *  Lock free, as the owner only ever takes the whole stack there is no
+ *  ABA problem. The owner is only signalled if it waits for packets.
+ */
+static void PacketPoolReturnStackPush(PktPool *pool, Packet *head, Packet *tail)
+{
+    Packet *old;
+    do {
+        old = SC_ATOMIC_GET(pool->return_stack.head);
+        tail->next = old;
+    } while (!SC_ATOMIC_CAS(&pool->return_stack.head, old, head));
+
+    if (SC_ATOMIC_GET(pool->return_stack.sync_now)) {
+        SCMutexLock(&pool->return_stack.mutex);
+        SC_ATOMIC_RESET(pool->return_stack.sync_now);
+        SCCondSignal(&pool->return_stack.cond);
+        SCMutexUnlock(&pool->return_stack.mutex);
+    }
+}
+
+/** \internal
+ *  \brief take all packets from the return stack
+ */
+static Packet *PacketPoolReturnStackTake(PktPool *pool)
+{
+    Packet *head;
+    do {
+        head = SC_ATOMIC_GET(pool->return_stack.head);
+    } while (head != NULL && !SC_ATOMIC_CAS(&pool->return_stack.head, head, NULL));
+    return head;
+}
+
+/** \internal
+ *  \brief wait for other threads to return packets to our pool
+ *
+ *  Announce the wait first and then check again, so that a thread
+ *  returning packets either sees the flag or we see its packets.
+ */
+static void PacketPoolReturnStackWait(PktPool *pool)
+{
+    SCMutexLock(&pool->return_stack.mutex);
+    SC_ATOMIC_SET(pool->return_stack.sync_now, 1);
+    if (SC_ATOMIC_GET(pool->return_stack.head) == NULL) {
+        SCCondWait(&pool->return_stack.cond, &pool->return_stack.mutex);
+    }
+    SC_ATOMIC_RESET(pool->return_stack.sync_now);
+    SCMutexUnlock(&pool->return_stack.mutex);
+}
+
 void PacketPoolWait(void)
 {
     PktPool *my_pool = GetThreadPacketPool();
 
     if (PacketPoolIsEmpty(my_pool)) {
-        SCMutexLock(&my_pool->return_stack.mutex);
-        SC_ATOMIC_ADD(my_pool->return_stack.sync_now, 1);
-        SCCondWait(&my_pool->return_stack.cond, &my_pool->return_stack.mutex);
-        SCMutexUnlock(&my_pool->return_stack.mutex);
+        PacketPoolReturnStackWait(my_pool);
     }
 
     while(PacketPoolIsEmpty(my_pool))
@@ -130,24 +179,18 @@ void PacketPoolWaitForN(int n)
         }
 
         /* check return stack, return to our pool and retry counting */
-        if (my_pool->return_stack.head != NULL) {
-            SCMutexLock(&my_pool->return_stack.mutex);
-            /* Move all the packets from the locked return stack to the local stack. */
+        Packet *returned = PacketPoolReturnStackTake(my_pool);
+        if (returned != NULL) {
+            /* Move all the packets from the return stack to the local stack. */
             if (pp) {
-                pp->next = my_pool->return_stack.head;
+                pp->next = returned;
             } else {
-                my_pool->head = my_pool->return_stack.head;
+                my_pool->head = returned;
             }
-            my_pool->return_stack.head = NULL;
-            SC_ATOMIC_RESET(my_pool->return_stack.sync_now);
-            SCMutexUnlock(&my_pool->return_stack.mutex);
 
         /* or signal that we need packets and wait */
         } else {
-            SCMutexLock(&my_pool->return_stack.mutex);
-            SC_ATOMIC_ADD(my_pool->return_stack.sync_now, 1);
-            SCCondWait(&my_pool->return_stack.cond, &my_pool->return_stack.mutex);
-            SCMutexUnlock(&my_pool->return_stack.mutex);
+            PacketPoolReturnStackWait(my_pool);
         }
     }
 }
@@ -168,11 +211,8 @@ static void PacketPoolStorePacket(Packet *p)
 
 static void PacketPoolGetReturnedPackets(PktPool *pool)
 {
-    SCMutexLock(&pool->return_stack.mutex);
-    /* Move all the packets from the locked return stack to the local stack. */
-    pool->head = pool->return_stack.head;
-    pool->return_stack.head = NULL;
-    SCMutexUnlock(&pool->return_stack.mutex);
+    /* Move all the packets from the return stack to the local stack. */
+    pool->head = PacketPoolReturnStackTake(pool);
 }
 
 /** \brief Get a new packet from the packet pool
@@ -198,8 +238,7 @@ Packet *PacketPoolGetPacket(void)
         return p;
     }
 
-    /* Local Stack is empty, so check the return stack, which requires
-     * locking. */
+    /* Local Stack is empty, so check the return stack. */
     PacketPoolGetReturnedPackets(pool);
 
     /* Try to allocate again. Need to check for not empty again, since the
@@ -260,12 +299,7 @@ void PacketPoolReturnPacket(Packet *p)
             my_pool->pending_count++;
             if (SC_ATOMIC_GET(pool->return_stack.sync_now) || my_pool->pending_count > max_pending_return_packets) {
                 /* Return the entire list of pending packets. */
-                SCMutexLock(&pool->return_stack.mutex);
-                my_pool->pending_tail->next = pool->return_stack.head;
-                pool->return_stack.head = my_pool->pending_head;
-                SC_ATOMIC_RESET(pool->return_stack.sync_now);
-                SCMutexUnlock(&pool->return_stack.mutex);
-                SCCondSignal(&pool->return_stack.cond);
+                PacketPoolReturnStackPush(pool, my_pool->pending_head, my_pool->pending_tail);
                 /* Clear the list of pending packets to return. */
                 my_pool->pending_pool = NULL;
                 my_pool->pending_head = NULL;
@@ -274,12 +308,7 @@ void PacketPoolReturnPacket(Packet *p)
             }
         } else {
             /* Push onto return stack for this pool */
-            SCMutexLock(&pool->return_stack.mutex);
-            p->next = pool->return_stack.head;
-            pool->return_stack.head = p;
-            SC_ATOMIC_RESET(pool->return_stack.sync_now);
-            SCMutexUnlock(&pool->return_stack.mutex);
-            SCCondSignal(&pool->return_stack.cond);
+            PacketPoolReturnStackPush(pool, p, p);
         }
     }
 }
@@ -294,6 +323,9 @@ void PacketPoolInitEmpty(void)
     my_pool->destroyed = 0;
 #endif /* DEBUG_VALIDATION */
 
+    my_pool->numa_node = NumaThreadNode();
+
+    SC_ATOMIC_INITPTR(my_pool->return_stack.head);
     SCMutexInit(&my_pool->return_stack.mutex, NULL);
     SCCondInit(&my_pool->return_stack.cond, NULL);
     SC_ATOMIC_INIT(my_pool->return_stack.sync_now);
@@ -311,6 +343,9 @@ void PacketPoolInit(void)
     my_pool->destroyed = 0;
 #endif /* DEBUG_VALIDATION */
 
+    my_pool->numa_node = NumaThreadNode();
+
+    SC_ATOMIC_INITPTR(my_pool->return_stack.head);
     SCMutexInit(&my_pool->return_stack.mutex, NULL);
     SCCondInit(&my_pool->return_stack.cond, NULL);
     SC_ATOMIC_INIT(my_pool->return_stack.sync_now);
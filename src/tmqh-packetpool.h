@@ -29,13 +29,15 @@
 #include "util-atomic.h"
 
     /* Return stack, onto which other threads free packets. */
-typedef struct PktPoolLockedStack_{
-    /* linked list of free packets. */
+typedef struct PktPoolReturnStack_{
+    /* linked list of free packets. Other threads push onto it lock free,
+     * the owner takes the whole list at once. */
+    SC_ATOMIC_DECLARE(Packet *, head);
+    /* only used when the owner waits for packets to be returned */
     SCMutex mutex;
     SCCondT cond;
     SC_ATOMIC_DECLARE(int, sync_now);
-    Packet *head;
-} __attribute__((aligned(CLS))) PktPoolLockedStack;
+} __attribute__((aligned(CLS))) PktPoolReturnStack;
 
 typedef struct PktPool_ {
     /* link listed of free packets local to this thread.
@@ -52,6 +54,9 @@ typedef struct PktPool_ {
     Packet *pending_tail;
     uint32_t pending_count;
 
+    /* NUMA node of the owning thread, NUMA_NODE_NONE if not bound */
+    int numa_node;
+
 #ifdef DEBUG_VALIDATION
     int initialized;
     int destroyed;
@@ -64,7 +69,7 @@ typedef struct PktPool_ {
     /* Return stack, where other threads put packets that they free that belong
      * to this thread.
      */
-    PktPoolLockedStack return_stack;
+    PktPoolReturnStack return_stack;
 } PktPool;
 
 Packet *TmqhInputPacketpool(ThreadVars *);
@@ -354,6 +354,10 @@ void SCHInfoLoadFromConfig(void)
             }
         }
     }
+
+    /* looked up per flow by the stream engine */
+    if (sc_hinfo_tree != NULL)
+        (void)SCRadixBuildLpm(sc_hinfo_tree);
 }
 
 /*------------------------------------Unit_Tests------------------------------*/
@@ -0,0 +1,238 @@
+/* Copyright (C) 2020 Open Information Security Foundation
+ *
+ * You can copy, redistribute or modify this Program under the terms of
+ * the GNU General Public License version 2 as published by the Free
+ * Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * version 2 along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/**
+ * \file
+ *
+ * Huge page backed memory.
+ *
+ * The hash tables of the flow, defrag, host and ippair engines and the
+ * preallocated stream pools are allocated once and stay around for the
+ * lifetime of the engine. With large memcaps they span many GB, and with
+ * 4k pages the lookups in them cause a lot of TLB misses.
+ *
+ * When 'hugepages.enabled' is set, these allocations are mapped from the
+ * reserved huge pages (MAP_HUGETLB) of the configured size. If none are
+ * available we fall back to a regular mapping with transparent huge pages
+ * requested through madvise, and for small allocations to the heap.
+ *
+ * Every allocation is prefixed with a cache line sized header recording
+ * how it was made, so HugePageFree() doesn't need the size. The memory is
+ * returned zeroed and cache line aligned. Memcap accounting stays with the
+ * callers and is not changed by the rounding up to the page size.
+ */
+
+#include "suricata-common.h"
+#include "conf.h"
+#include "util-debug.h"
+#include "util-misc.h"
+#include "util-hugepage.h"
+#include "util-unittest.h"
+
+#define HUGEPAGE_SIZE_2MB   (2UL * 1024 * 1024)
+#define HUGEPAGE_SIZE_1GB   (1024UL * 1024 * 1024)
+
+/** below this size transparent huge pages are not worth a mapping */
+#define HUGEPAGE_THP_MIN    HUGEPAGE_SIZE_2MB
+
+enum HugePageAllocType {
+    HUGEPAGE_ALLOC_HEAP = 0,
+    HUGEPAGE_ALLOC_HUGETLB,
+    HUGEPAGE_ALLOC_MMAP,
+};
+
+typedef struct HugePageHeader_ {
+    enum HugePageAllocType type;
+    size_t map_size;    /**< size of the mapping, incl this header */
+} __attribute__((aligned(CLS))) HugePageHeader;
+
+static bool hugepage_enabled = false;
+static size_t hugepage_size = HUGEPAGE_SIZE_2MB;
+
+/**
+ *  \brief read the 'hugepages' config section
+ *
+ *  \warning Not thread safe, call before the hash tables are set up.
+ */
+void HugePageSetupFromConfig(void)
+{
+    int enabled = 0;
+    if (ConfGetBool("hugepages.enabled", &enabled) != 1 || enabled == 0)
+        return;
+
+#if defined(MAP_HUGETLB) && defined(MAP_ANONYMOUS)
+    const char *str = NULL;
+    if (ConfGet("hugepages.size", &str) == 1 && str != NULL) {
+        uint64_t size = 0;
+        if (ParseSizeStringU64(str, &size) < 0 ||
+                (size != HUGEPAGE_SIZE_2MB && size != HUGEPAGE_SIZE_1GB)) {
+            SCLogError(SC_ERR_INVALID_ARGUMENT, "hugepages.size must be "
+                    "2mb or 1gb, not \"%s\". Using 2mb.", str);
+        } else {
+            hugepage_size = (size_t)size;
+        }
+    }
+    hugepage_enabled = true;
+    SCLogConfig("using %s huge pages for hash tables and pools",
+            hugepage_size == HUGEPAGE_SIZE_1GB ? "1gb" : "2mb");
+#else
+    SCLogWarning(SC_ERR_NOT_SUPPORTED, "hugepages.enabled is set, but huge "
+            "pages are not supported on this platform.");
+#endif
+}
+
+bool HugePageEnabled(void)
+{
+    return hugepage_enabled;
+}
+
+#if defined(MAP_HUGETLB) && defined(MAP_ANONYMOUS)
+static void *HugePageMap(size_t size, enum HugePageAllocType *type, size_t *map_size)
+{
+    if (size >= hugepage_size / 2) {
+        int flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB;
+#ifdef MAP_HUGE_SHIFT
+        flags |= (hugepage_size == HUGEPAGE_SIZE_1GB ? 30 : 21) << MAP_HUGE_SHIFT;
+#endif
+        size_t len = (size + hugepage_size - 1) & ~(hugepage_size - 1);
+        void *ptr = mmap(NULL, len, PROT_READ | PROT_WRITE, flags, -1, 0);
+        if (ptr != MAP_FAILED) {
+            *type = HUGEPAGE_ALLOC_HUGETLB;
+            *map_size = len;
+            return ptr;
+        }
+        SCLogDebug("no %"PRIuMAX" bytes of huge pages available: %s",
+                (uintmax_t)len, strerror(errno));
+    }
+
+    if (size >= HUGEPAGE_THP_MIN) {
+        size_t len = (size + HUGEPAGE_SIZE_2MB - 1) & ~(HUGEPAGE_SIZE_2MB - 1);
+        void *ptr = mmap(NULL, len, PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (ptr != MAP_FAILED) {
+#ifdef MADV_HUGEPAGE
+            (void)madvise(ptr, len, MADV_HUGEPAGE);
+#endif
+            *type = HUGEPAGE_ALLOC_MMAP;
+            *map_size = len;
+            return ptr;
+        }
+    }
+    return NULL;
+}
+#endif
+
+/**
+ *  \brief allocate zeroed, cache line aligned memory, backed by huge
+ *         pages if enabled and available
+ *
+ *  \param size size in bytes
+ *
+ *  \retval ptr memory to be freed with HugePageFree() or NULL on error
+ */
+void *HugePageAlloc(size_t size)
+{
+    HugePageHeader *h = NULL;
+    enum HugePageAllocType type = HUGEPAGE_ALLOC_HEAP;
+    size_t map_size = 0;
+
+#if defined(MAP_HUGETLB) && defined(MAP_ANONYMOUS)
+    if (hugepage_enabled) {
+        h = HugePageMap(size + sizeof(HugePageHeader), &type, &map_size);
+    }
+#endif
+    if (h == NULL) {
+        h = SCMallocAligned(size + sizeof(HugePageHeader), CLS);
+        if (unlikely(h == NULL))
+            return NULL;
+        memset(h, 0, size + sizeof(HugePageHeader));
+        type = HUGEPAGE_ALLOC_HEAP;
+    }
+
+    h->type = type;
+    h->map_size = map_size;
+    return (uint8_t *)h + sizeof(HugePageHeader);
+}
+
+/**
+ *  \brief free memory allocated with HugePageAlloc()
+ */
+void HugePageFree(void *ptr)
+{
+    if (ptr == NULL)
+        return;
+
+    HugePageHeader *h = (HugePageHeader *)((uint8_t *)ptr - sizeof(HugePageHeader));
+    switch (h->type) {
+        case HUGEPAGE_ALLOC_HUGETLB:
+        case HUGEPAGE_ALLOC_MMAP:
+            munmap(h, h->map_size);
+            break;
+        case HUGEPAGE_ALLOC_HEAP:
+            SCFreeAligned(h);
+            break;
+    }
+}
+
+#ifdef UNITTESTS
+static int HugePageTestAlloc(size_t size)
+{
+    uint8_t *ptr = HugePageAlloc(size);
+    FAIL_IF_NULL(ptr);
+    FAIL_IF((uintptr_t)ptr % CLS);
+    for (size_t u = 0; u < size; u += 4096) {
+        FAIL_IF(ptr[u] != 0);
+    }
+    FAIL_IF(ptr[size - 1] != 0);
+    memset(ptr, 0xff, size);
+    HugePageFree(ptr);
+    PASS;
+}
+
+/** \test heap allocations when huge pages are disabled */
+static int HugePageTest01(void)
+{
+    hugepage_enabled = false;
+    FAIL_IF_NOT(HugePageTestAlloc(100));
+    FAIL_IF_NOT(HugePageTestAlloc(4 * HUGEPAGE_SIZE_2MB + 1));
+    HugePageFree(NULL);
+    PASS;
+}
+
+/** \test huge page allocations, falling back if none are reserved */
+static int HugePageTest02(void)
+{
+#if defined(MAP_HUGETLB) && defined(MAP_ANONYMOUS)
+    hugepage_enabled = true;
+    hugepage_size = HUGEPAGE_SIZE_2MB;
+    int r = HugePageTestAlloc(100) &&
+        HugePageTestAlloc(HUGEPAGE_SIZE_2MB / 2) &&
+        HugePageTestAlloc(4 * HUGEPAGE_SIZE_2MB + 1);
+    hugepage_enabled = false;
+    FAIL_IF_NOT(r);
+#endif
+    PASS;
+}
+#endif /* UNITTESTS */
+
+void HugePageRegisterTests(void)
+{
+#ifdef UNITTESTS
+    UtRegisterTest("HugePageTest01", HugePageTest01);
+    UtRegisterTest("HugePageTest02", HugePageTest02);
+#endif
+}
@@ -0,0 +1,36 @@
+/* Copyright (C) 2020 Open Information Security Foundation
+ *
+ * You can copy, redistribute or modify this Program under the terms of
+ * the GNU General Public License version 2 as published by the Free
+ * Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * version 2 along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/**
+ * \file
+ *
+ * Huge page backed memory for large, long lived allocations such as the
+ * flow, defrag, host and ippair hash tables and the preallocated pools.
+ */
+
+#ifndef __UTIL_HUGEPAGE_H__
+#define __UTIL_HUGEPAGE_H__
+
+void HugePageSetupFromConfig(void);
+bool HugePageEnabled(void);
+
+void *HugePageAlloc(size_t size);
+void HugePageFree(void *ptr);
+
+void HugePageRegisterTests(void);
+
+#endif /* __UTIL_HUGEPAGE_H__ */
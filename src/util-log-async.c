@@ -0,0 +1,538 @@
+/* Copyright (C) 2020 Open Information Security Foundation
+ *
+ * You can copy, redistribute or modify this Program under the terms of
+ * the GNU General Public License version 2 as published by the Free
+ * Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * version 2 along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/**
+ * \file
+ *
+ * Asynchronous writing of regular log files.
+ *
+ * Instead of taking the file lock and calling fwrite for each record, a
+ * thread copies the record into its own single producer, single consumer
+ * ring buffer. A writer thread per file collects the pending data of all
+ * rings and writes it with writev. Records are never split, so the
+ * records of different threads can interleave but never mix.
+ *
+ * When a ring is full the thread either waits for the writer or drops
+ * the record, depending on the configuration. Both are counted in the
+ * logging.async.* stats counters.
+ */
+
+#include "suricata-common.h"
+#include "threads.h"
+#include "conf.h"
+#include "counters.h"
+#include "util-atomic.h"
+#include "util-debug.h"
+#include "util-misc.h"
+#include "util-unittest.h"
+#include "util-logopenfile.h"
+#include "util-log-async.h"
+
+#include <sys/uio.h>
+
+/** default size of the ring of each thread */
+#define LOG_ASYNC_DEFAULT_RING_SIZE (1024 * 1024)
+#define LOG_ASYNC_MIN_RING_SIZE     4096
+/** sleep time of the writer thread when all rings are empty */
+#define LOG_ASYNC_IDLE_USEC         1000
+/** sleep time of a thread waiting for space in its ring */
+#define LOG_ASYNC_FULL_USEC         50
+/** max number of iovecs per writev call */
+#define LOG_ASYNC_MAX_IOV           64
+/** number of per thread ring lookups cached per thread */
+#define LOG_ASYNC_CACHE_SIZE        8
+
+typedef struct LogAsyncRing_ {
+    /** write position, only updated by the owning thread */
+    SC_ATOMIC_DECLARE(uint64_t, head);
+    /** read position, only updated by the writer thread */
+    SC_ATOMIC_DECLARE(uint64_t, tail);
+    pthread_t owner;
+    uint8_t *buf;
+} LogAsyncRing;
+
+typedef struct LogAsyncCtx_ {
+    LogFileCtx *file_ctx;
+    /** unique id, used as key in the thread local ring cache */
+    uint32_t id;
+    /** size of each ring, a power of 2 */
+    uint32_t ring_size;
+    /** drop records instead of waiting if a ring is full */
+    bool drop;
+
+    /** protects the ring array. Only taken on registration of a new
+     *  thread and by the writer thread. */
+    SCMutex rings_mutex;
+    LogAsyncRing **rings;
+    uint32_t rings_cnt;
+    uint32_t rings_size;
+
+    /** ring the next flush starts at, so that all rings get their turn
+     *  when there are more rings than fit in one writev call */
+    uint32_t flush_start;
+
+    pthread_t thread;
+    SC_ATOMIC_DECLARE(int, stop);
+} LogAsyncCtx;
+
+typedef struct LogAsyncRingCache_ {
+    uint32_t id;
+    LogAsyncRing *ring;
+} LogAsyncRingCache;
+
+static thread_local LogAsyncRingCache ring_cache[LOG_ASYNC_CACHE_SIZE];
+
+SC_ATOMIC_DECLARE(uint32_t, log_async_ids);
+SC_ATOMIC_DECLARE(uint64_t, log_async_written);
+SC_ATOMIC_DECLARE(uint64_t, log_async_ring_full);
+SC_ATOMIC_DECLARE(uint64_t, log_async_dropped);
+
+static uint64_t LogAsyncWrittenCounter(void)
+{
+    return SC_ATOMIC_GET(log_async_written);
+}
+
+static uint64_t LogAsyncRingFullCounter(void)
+{
+    return SC_ATOMIC_GET(log_async_ring_full);
+}
+
+static uint64_t LogAsyncDroppedCounter(void)
+{
+    return SC_ATOMIC_GET(log_async_dropped);
+}
+
+static LogAsyncRing *LogAsyncRingNew(LogAsyncCtx *actx)
+{
+    LogAsyncRing *ring = SCCalloc(1, sizeof(*ring));
+    if (unlikely(ring == NULL)) {
+        return NULL;
+    }
+    ring->buf = SCMalloc(actx->ring_size);
+    if (unlikely(ring->buf == NULL)) {
+        SCFree(ring);
+        return NULL;
+    }
+    SC_ATOMIC_INIT(ring->head);
+    SC_ATOMIC_INIT(ring->tail);
+    ring->owner = pthread_self();
+    return ring;
+}
+
+/**
+ * \brief Get the ring of the calling thread, creating it if needed.
+ */
+static LogAsyncRing *LogAsyncGetRing(LogAsyncCtx *actx)
+{
+    LogAsyncRingCache *c = &ring_cache[actx->id % LOG_ASYNC_CACHE_SIZE];
+    if (likely(c->id == actx->id && c->ring != NULL)) {
+        return c->ring;
+    }
+
+    LogAsyncRing *ring = NULL;
+    pthread_t self = pthread_self();
+
+    SCMutexLock(&actx->rings_mutex);
+    /* the cache slot may have been used by another file */
+    for (uint32_t i = 0; i < actx->rings_cnt; i++) {
+        if (pthread_equal(actx->rings[i]->owner, self)) {
+            ring = actx->rings[i];
+            break;
+        }
+    }
+    if (ring == NULL) {
+        if (actx->rings_cnt == actx->rings_size) {
+            uint32_t size = actx->rings_size ? actx->rings_size * 2 : 16;
+            LogAsyncRing **rings = SCRealloc(actx->rings, size * sizeof(*rings));
+            if (unlikely(rings == NULL)) {
+                SCMutexUnlock(&actx->rings_mutex);
+                return NULL;
+            }
+            actx->rings = rings;
+            actx->rings_size = size;
+        }
+        ring = LogAsyncRingNew(actx);
+        if (ring != NULL) {
+            actx->rings[actx->rings_cnt++] = ring;
+        }
+    }
+    SCMutexUnlock(&actx->rings_mutex);
+
+    if (ring != NULL) {
+        c->id = actx->id;
+        c->ring = ring;
+    }
+    return ring;
+}
+
+/**
+ * \brief Write a buffer to the log file, bypassing the rings.
+ */
+static int LogAsyncWriteDirect(LogFileCtx *log_ctx, const struct iovec *iov,
+        int iovcnt)
+{
+    size_t len = 0;
+    for (int i = 0; i < iovcnt; i++) {
+        len += iov[i].iov_len;
+    }
+
+    SCMutexLock(&log_ctx->fp_mutex);
+    LogFileCheckRotation(log_ctx);
+    if (log_ctx->fp == NULL) {
+        SCMutexUnlock(&log_ctx->fp_mutex);
+        return -1;
+    }
+    const int fd = fileno(log_ctx->fp);
+    size_t done = 0;
+    while (done < len) {
+        /* skip the part of the vector that was written already */
+        struct iovec v[LOG_ASYNC_MAX_IOV];
+        int cnt = 0;
+        size_t skip = done;
+        for (int i = 0; i < iovcnt; i++) {
+            if (skip >= iov[i].iov_len) {
+                skip -= iov[i].iov_len;
+                continue;
+            }
+            v[cnt].iov_base = (uint8_t *)iov[i].iov_base + skip;
+            v[cnt].iov_len = iov[i].iov_len - skip;
+            skip = 0;
+            cnt++;
+        }
+        ssize_t w = writev(fd, v, cnt);
+        if (w < 0) {
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+        done += w;
+    }
+    SCMutexUnlock(&log_ctx->fp_mutex);
+
+    SC_ATOMIC_ADD(log_async_written, done);
+    return done == len ? 0 : -1;
+}
+
+/**
+ * \brief Write the pending data of all rings to the file.
+ *
+ * \retval bytes number of bytes that were pending
+ */
+static size_t LogAsyncFlush(LogAsyncCtx *actx)
+{
+    struct iovec iov[LOG_ASYNC_MAX_IOV];
+    LogAsyncRing *rings[LOG_ASYNC_MAX_IOV / 2];
+    uint64_t heads[LOG_ASYNC_MAX_IOV / 2];
+    const uint64_t mask = actx->ring_size - 1;
+    size_t total = 0;
+    int iovcnt = 0;
+    int cnt = 0;
+
+    SCMutexLock(&actx->rings_mutex);
+    uint32_t n = 0;
+    for ( ; n < actx->rings_cnt && cnt < LOG_ASYNC_MAX_IOV / 2; n++) {
+        LogAsyncRing *ring = actx->rings[(actx->flush_start + n) % actx->rings_cnt];
+        const uint64_t head = SC_ATOMIC_GET(ring->head);
+        const uint64_t tail = SC_ATOMIC_GET(ring->tail);
+        if (head == tail)
+            continue;
+
+        /* the pending data wraps around the end of the ring at most once */
+        const uint64_t start = tail & mask;
+        const uint64_t len = head - tail;
+        const uint64_t first = MIN(len, actx->ring_size - start);
+        iov[iovcnt].iov_base = ring->buf + start;
+        iov[iovcnt].iov_len = first;
+        iovcnt++;
+        if (first < len) {
+            iov[iovcnt].iov_base = ring->buf;
+            iov[iovcnt].iov_len = len - first;
+            iovcnt++;
+        }
+        rings[cnt] = ring;
+        heads[cnt] = head;
+        cnt++;
+        total += len;
+    }
+    if (actx->rings_cnt > 0) {
+        actx->flush_start = (actx->flush_start + n) % actx->rings_cnt;
+    }
+    SCMutexUnlock(&actx->rings_mutex);
+
+    if (iovcnt == 0)
+        return 0;
+
+    if (LogAsyncWriteDirect(actx->file_ctx, iov, iovcnt) != 0) {
+        SCLogDebug("failed to write %"PRIuMAX" bytes: %s",
+                (uintmax_t)total, strerror(errno));
+    }
+    for (int i = 0; i < cnt; i++) {
+        SC_ATOMIC_SET(rings[i]->tail, heads[i]);
+    }
+    return total;
+}
+
+static void *LogAsyncWriterThread(void *arg)
+{
+    LogAsyncCtx *actx = arg;
+    (void)SCSetThreadName("LogAsyncWriter");
+
+    while (1) {
+        const int stop = SC_ATOMIC_GET(actx->stop);
+        if (LogAsyncFlush(actx) == 0) {
+            /* all rings were empty. As the threads writing to the file
+             * are done before stop is set, we're done too. */
+            if (stop)
+                break;
+            usleep(LOG_ASYNC_IDLE_USEC);
+        }
+    }
+    return NULL;
+}
+
+/**
+ * \brief Write function of a LogFileCtx in async mode.
+ */
+static int SCLogFileWriteAsync(const char *buffer, int buffer_len,
+        LogFileCtx *log_ctx)
+{
+    LogAsyncCtx *actx = log_ctx->async;
+    const uint64_t len = (uint64_t)buffer_len;
+
+    LogAsyncRing *ring = LogAsyncGetRing(actx);
+    if (unlikely(ring == NULL)) {
+        SC_ATOMIC_ADD(log_async_dropped, 1);
+        return 0;
+    }
+
+    const uint64_t head = SC_ATOMIC_GET(ring->head);
+    bool full = false;
+    while (head - SC_ATOMIC_GET(ring->tail) + len > actx->ring_size) {
+        /* records that would never fit are written directly once the
+         * ring is empty, to preserve the order of the records */
+        if (len > actx->ring_size && head == SC_ATOMIC_GET(ring->tail)) {
+            struct iovec iov = { (void *)buffer, len };
+            return LogAsyncWriteDirect(log_ctx, &iov, 1) == 0 ? 1 : 0;
+        }
+        if (!full) {
+            full = true;
+            SC_ATOMIC_ADD(log_async_ring_full, 1);
+        }
+        if (actx->drop && len <= actx->ring_size) {
+            SC_ATOMIC_ADD(log_async_dropped, 1);
+            return 0;
+        }
+        usleep(LOG_ASYNC_FULL_USEC);
+    }
+
+    const uint64_t start = head & (actx->ring_size - 1);
+    const uint64_t first = MIN(len, actx->ring_size - start);
+    memcpy(ring->buf + start, buffer, first);
+    if (first < len) {
+        memcpy(ring->buf, buffer + first, len - first);
+    }
+    /* publish the record to the writer thread */
+    SC_ATOMIC_SET(ring->head, head + len);
+    return 1;
+}
+
+static LogAsyncCtx *LogAsyncCtxNew(LogFileCtx *log_ctx, uint32_t ring_size,
+        bool drop)
+{
+    LogAsyncCtx *actx = SCCalloc(1, sizeof(*actx));
+    if (unlikely(actx == NULL)) {
+        return NULL;
+    }
+    actx->file_ctx = log_ctx;
+    actx->id = SC_ATOMIC_ADD(log_async_ids, 1) + 1;
+    actx->ring_size = ring_size;
+    actx->drop = drop;
+    SCMutexInit(&actx->rings_mutex, NULL);
+    SC_ATOMIC_INIT(actx->stop);
+    return actx;
+}
+
+static void LogAsyncCtxFree(LogAsyncCtx *actx)
+{
+    for (uint32_t i = 0; i < actx->rings_cnt; i++) {
+        SCFree(actx->rings[i]->buf);
+        SCFree(actx->rings[i]);
+    }
+    if (actx->rings != NULL) {
+        SCFree(actx->rings);
+    }
+    SCMutexDestroy(&actx->rings_mutex);
+    SCFree(actx);
+}
+
+/** \brief set up async writing for a regular log file
+ *  \param conf the "async" node of the output
+ *  \param log_ctx log file context with the file opened
+ *  \retval 0 on success
+ *  \retval -1 on error
+ */
+int SCConfLogOpenAsync(ConfNode *conf, LogFileCtx *log_ctx)
+{
+    uint32_t ring_size = LOG_ASYNC_DEFAULT_RING_SIZE;
+    bool drop = false;
+
+    const char *size_s = ConfNodeLookupChildValue(conf, "buffer-size");
+    if (size_s != NULL) {
+        if (ParseSizeStringU32(size_s, &ring_size) < 0) {
+            SCLogError(SC_ERR_INVALID_ARGUMENT,
+                    "invalid async buffer-size value: %s", size_s);
+            return -1;
+        }
+        if (ring_size < LOG_ASYNC_MIN_RING_SIZE) {
+            ring_size = LOG_ASYNC_MIN_RING_SIZE;
+        }
+    }
+    /* round up to a power of 2 */
+    uint32_t size = LOG_ASYNC_MIN_RING_SIZE;
+    while (size < ring_size && size < (1U << 31)) {
+        size <<= 1;
+    }
+    ring_size = size;
+
+    const char *full_s = ConfNodeLookupChildValue(conf, "full");
+    if (full_s != NULL) {
+        if (strcmp(full_s, "drop") == 0) {
+            drop = true;
+        } else if (strcmp(full_s, "block") != 0) {
+            SCLogError(SC_ERR_INVALID_ARGUMENT,
+                    "invalid async full value: %s, "
+                    "expected \"block\" or \"drop\"", full_s);
+            return -1;
+        }
+    }
+
+    LogAsyncCtx *actx = LogAsyncCtxNew(log_ctx, ring_size, drop);
+    if (actx == NULL) {
+        return -1;
+    }
+    int rc = pthread_create(&actx->thread, NULL, LogAsyncWriterThread, actx);
+    if (rc != 0) {
+        SCLogError(SC_ERR_THREAD_CREATE, "failed to create log writer "
+                "thread: %s", strerror(rc));
+        LogAsyncCtxFree(actx);
+        return -1;
+    }
+
+    log_ctx->async = actx;
+    log_ctx->Write = SCLogFileWriteAsync;
+
+    StatsRegisterGlobalCounter("logging.async.written", LogAsyncWrittenCounter);
+    StatsRegisterGlobalCounter("logging.async.ring_full", LogAsyncRingFullCounter);
+    StatsRegisterGlobalCounter("logging.async.dropped", LogAsyncDroppedCounter);
+
+    SCLogConfig("%s: async writes enabled, %"PRIu32" bytes per thread, %s "
+            "when full", log_ctx->filename ? log_ctx->filename : conf->name,
+            ring_size, drop ? "drop" : "block");
+    return 0;
+}
+
+/** \brief stop async writing, writing out all pending records
+ *
+ *  Must only be called when no thread writes to the file anymore.
+ */
+void LogAsyncFree(LogFileCtx *log_ctx)
+{
+    LogAsyncCtx *actx = log_ctx->async;
+    if (actx == NULL)
+        return;
+
+    SC_ATOMIC_SET(actx->stop, 1);
+    pthread_join(actx->thread, NULL);
+
+    log_ctx->async = NULL;
+    LogAsyncCtxFree(actx);
+}
+
+#ifdef UNITTESTS
+#include "util-unittest-helper.h"
+
+static int LogAsyncTest01(void)
+{
+    char path[] = "/tmp/suricata-log-async-XXXXXX";
+    char big[LOG_ASYNC_MIN_RING_SIZE * 2];
+    char line[64];
+
+    int fd = mkstemp(path);
+    FAIL_IF(fd < 0);
+    LogFileCtx *log_ctx = LogFileNewCtx();
+    FAIL_IF_NULL(log_ctx);
+    log_ctx->fp = fdopen(fd, "w");
+    FAIL_IF_NULL(log_ctx->fp);
+
+    LogAsyncCtx *actx = LogAsyncCtxNew(log_ctx, LOG_ASYNC_MIN_RING_SIZE, false);
+    FAIL_IF_NULL(actx);
+    FAIL_IF(pthread_create(&actx->thread, NULL, LogAsyncWriterThread, actx) != 0);
+    log_ctx->async = actx;
+    log_ctx->Write = SCLogFileWriteAsync;
+
+    /* more data than fits the ring, and a record that never fits */
+    size_t expect = 0;
+    for (int i = 0; i < 1000; i++) {
+        int len = snprintf(line, sizeof(line), "{\"record\":%d}\n", i);
+        FAIL_IF(log_ctx->Write(line, len, log_ctx) != 1);
+        expect += len;
+        if (i == 500) {
+            memset(big, 'a', sizeof(big));
+            big[sizeof(big) - 1] = '\n';
+            FAIL_IF(log_ctx->Write(big, sizeof(big), log_ctx) != 1);
+            expect += sizeof(big);
+        }
+    }
+    LogAsyncFree(log_ctx);
+    FAIL_IF_NOT_NULL(log_ctx->async);
+
+    /* records are written whole and in order */
+    FILE *fp = fopen(path, "r");
+    FAIL_IF_NULL(fp);
+    size_t size = 0;
+    int i = 0;
+    char *rline = NULL;
+    size_t rsize = 0;
+    ssize_t r;
+    while ((r = getline(&rline, &rsize, fp)) > 0) {
+        size += r;
+        if (rline[0] == 'a') {
+            FAIL_IF(i != 501);
+            FAIL_IF(r != (ssize_t)sizeof(big));
+            continue;
+        }
+        snprintf(line, sizeof(line), "{\"record\":%d}\n", i);
+        FAIL_IF(strcmp(line, rline) != 0);
+        i++;
+    }
+    free(rline);
+    fclose(fp);
+    FAIL_IF(i != 1000);
+    FAIL_IF(size != expect);
+
+    LogFileFreeCtx(log_ctx);
+    unlink(path);
+    PASS;
+}
+#endif /* UNITTESTS */
+
+void LogAsyncRegisterTests(void)
+{
+#ifdef UNITTESTS
+    UtRegisterTest("LogAsyncTest01", LogAsyncTest01);
+#endif
+}
@@ -0,0 +1,38 @@
+/* Copyright (C) 2020 Open Information Security Foundation
+ *
+ * You can copy, redistribute or modify this Program under the terms of
+ * the GNU General Public License version 2 as published by the Free
+ * Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * version 2 along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/**
+ * \file
+ *
+ * Asynchronous writing of regular log files. Each thread writing to the
+ * file gets its own ring buffer, which a writer thread drains to the file
+ * in batches.
+ */
+
+#ifndef __UTIL_LOG_ASYNC_H__
+#define __UTIL_LOG_ASYNC_H__
+
+#include "conf.h"            /* ConfNode   */
+
+struct LogFileCtx_;
+
+int SCConfLogOpenAsync(ConfNode *conf, struct LogFileCtx_ *log_ctx);
+void LogAsyncFree(struct LogFileCtx_ *log_ctx);
+
+void LogAsyncRegisterTests(void);
+
+#endif /* __UTIL_LOG_ASYNC_H__ */
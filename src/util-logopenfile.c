@@ -31,6 +31,7 @@
 #include "util-byte.h"
 #include "util-path.h"
 #include "util-logopenfile.h"
+#include "util-log-async.h"
 
 #if defined(HAVE_SYS_UN_H) && defined(HAVE_SYS_SOCKET_H) && defined(HAVE_SYS_TYPES_H)
 #define BUILD_WITH_UNIXSOCKET
@@ -177,6 +178,28 @@ tryagain:
 }
 #endif /* BUILD_WITH_UNIXSOCKET */
 
+/**
+ * \brief Reopen the log file if a rotation was requested or is due.
+ *
+ * Must be called with fp_mutex held.
+ */
+void LogFileCheckRotation(LogFileCtx *log_ctx)
+{
+    /* Check for rotation. */
+    if (log_ctx->rotation_flag) {
+        log_ctx->rotation_flag = 0;
+        SCConfLogReopen(log_ctx);
+    }
+
+    if (log_ctx->flags & LOGFILE_ROTATE_INTERVAL) {
+        time_t now = time(NULL);
+        if (now >= log_ctx->rotate_time) {
+            SCConfLogReopen(log_ctx);
+            log_ctx->rotate_time = now + log_ctx->rotate_interval;
+        }
+    }
+}
+
 /**
  * \brief Write buffer to log file.
  * \retval 0 on failure; otherwise, the return value of fwrite (number of
@@ -193,20 +216,7 @@ static int SCLogFileWrite(const char *buffer, int buffer_len, LogFileCtx *log_ct
     } else
 #endif
     {
-
-        /* Check for rotation. */
-        if (log_ctx->rotation_flag) {
-            log_ctx->rotation_flag = 0;
-            SCConfLogReopen(log_ctx);
-        }
-
-        if (log_ctx->flags & LOGFILE_ROTATE_INTERVAL) {
-            time_t now = time(NULL);
-            if (now >= log_ctx->rotate_time) {
-                SCConfLogReopen(log_ctx);
-                log_ctx->rotate_time = now + log_ctx->rotate_interval;
-            }
-        }
+        LogFileCheckRotation(log_ctx);
 
         if (log_ctx->fp) {
             clearerr(log_ctx->fp);
@@ -440,6 +450,19 @@ SCConfLogOpenGeneric(ConfNode *conf,
         if (rotate) {
             OutputRegisterFileRotationFlag(&log_ctx->rotation_flag);
         }
+
+        ConfNode *async = ConfNodeLookupChild(conf, "async");
+        if (async != NULL && ConfNodeChildValueIsTrue(async, "enabled")) {
+            log_ctx->filename = SCStrdup(log_path);
+            if (unlikely(log_ctx->filename == NULL)) {
+                SCLogError(SC_ERR_MEM_ALLOC,
+                    "Failed to allocate memory for filename");
+                return -1;
+            }
+            if (SCConfLogOpenAsync(async, log_ctx) < 0) {
+                return -1;
+            }
+        }
 #ifdef HAVE_LIBHIREDIS
     } else if (strcasecmp(filetype, "redis") == 0) {
         ConfNode *redis_node = ConfNodeLookupChild(conf, "redis");
@@ -456,7 +479,9 @@ SCConfLogOpenGeneric(ConfNode *conf,
                    "or \"unix_dgram\"",
                    conf->name);
     }
-    log_ctx->filename = SCStrdup(log_path);
+    if (log_ctx->filename == NULL) {
+        log_ctx->filename = SCStrdup(log_path);
+    }
     if (unlikely(log_ctx->filename == NULL)) {
         SCLogError(SC_ERR_MEM_ALLOC,
             "Failed to allocate memory for filename");
@@ -542,6 +567,9 @@ int LogFileFreeCtx(LogFileCtx *lf_ctx)
         SCReturnInt(0);
     }
 
+    /* write out what is still buffered */
+    LogAsyncFree(lf_ctx);
+
     if (lf_ctx->fp != NULL) {
         SCMutexLock(&lf_ctx->fp_mutex);
         lf_ctx->Close(lf_ctx);
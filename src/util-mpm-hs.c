@@ -41,6 +41,7 @@
 #include "util-hash.h"
 #include "util-hash-lookup3.h"
 #include "util-hyperscan.h"
+#include "util-path.h"
 
 #ifdef BUILD_HYPERSCAN
 
@@ -67,6 +68,9 @@ void SCHSRegisterTests(void);
 /* Initial size of the global database hash (used for de-duplication). */
 #define INIT_DB_HASH_SIZE 1000
 
+/* Default directory of the on-disk database cache. */
+#define HS_CACHE_DEFAULT_PATH LOCAL_STATE_DIR "/lib/suricata/cache/sgh"
+
 /* Global prototype scratch, built incrementally as Hyperscan databases are
  * built and then cloned for each thread context. Access is serialised via
  * g_scratch_proto_mutex. */
@@ -78,6 +82,19 @@ static SCMutex g_scratch_proto_mutex = SCMUTEX_INITIALIZER;
 static HashTable *g_db_table = NULL;
 static SCMutex g_db_table_mutex = SCMUTEX_INITIALIZER;
 
+/* Global hash table of multi buffer databases, keyed by the pattern
+ * databases they were built from. Also serialised via g_db_table_mutex. */
+static HashTable *g_multi_db_table = NULL;
+
+/* Streaming databases are built once per pattern database and published
+ * under g_stream_db_mutex. Ids start at 1 so that 0 means no database. */
+static SCMutex g_stream_db_mutex = SCMUTEX_INITIALIZER;
+static uint32_t g_stream_db_id = 0;
+
+/* Memory used by the streaming scan states of all flows, and its limit. */
+SC_ATOMIC_DECLARE(uint64_t, g_stream_memuse);
+static uint64_t g_stream_memcap = 0;
+
 /**
  * \internal
  * \brief Wraps SCMalloc (which is a macro) so that it can be passed to
@@ -455,6 +472,12 @@ typedef struct PatternDatabase_ {
 
     /* Reference count: number of MPM contexts using this pattern database. */
     uint32_t ref_cnt;
+
+    /* streaming database of the same patterns, only built for contexts
+     * with MPMCTX_FLAGS_STREAMING. Streams opened against it remember its
+     * id, as the address may be reused after a rule reload. */
+    hs_database_t *hs_stream_db;
+    uint32_t stream_db_id;
 } PatternDatabase;
 
 static uint32_t SCHSPatternHash(const SCHSPattern *p, uint32_t hash)
@@ -543,6 +566,7 @@ static void PatternDatabaseFree(PatternDatabase *pd)
     }
 
     hs_free_database(pd->hs_db);
+    hs_free_database(pd->hs_stream_db);
 
     SCFree(pd);
 }
@@ -576,6 +600,337 @@ static PatternDatabase *PatternDatabaseAlloc(uint32_t pattern_cnt)
     return pd;
 }
 
+/**
+ * \internal
+ * \brief Get the directory of the on-disk database cache.
+ *
+ * \retval path cache directory, or NULL if caching is disabled
+ */
+static const char *SCHSCachePath(void)
+{
+    int enabled = 0;
+    if (ConfGetBool("detect.sgh-mpm-caching", &enabled) != 1 || !enabled) {
+        return NULL;
+    }
+    const char *path = NULL;
+    if (ConfGet("detect.sgh-mpm-caching-path", &path) != 1 || path == NULL) {
+        path = HS_CACHE_DEFAULT_PATH;
+    }
+    return path;
+}
+
+/**
+ * \internal
+ * \brief Start the cache hash of a database.
+ *
+ * \param mode NULL for block mode databases, otherwise a name for the
+ *             kind of database, so that their files don't collide
+ */
+static void SCHSCacheHashInit(uint32_t h[4], const char *mode)
+{
+    const char *version = hs_version();
+
+    h[0] = 0;
+    h[1] = 0;
+    h[2] = 0x5eed;
+    h[3] = 0xcafe;
+    hashlittle2(version, strlen(version), &h[0], &h[1]);
+    hashlittle2(version, strlen(version), &h[2], &h[3]);
+    if (mode != NULL) {
+        hashlittle2(mode, strlen(mode), &h[0], &h[1]);
+        hashlittle2(mode, strlen(mode), &h[2], &h[3]);
+    }
+}
+
+/**
+ * \internal
+ * \brief Add the patterns of a pattern database to a cache hash.
+ *
+ * The patterns are added in database order, as the index of a pattern
+ * is its match id.
+ */
+static void SCHSCacheHashPatterns(uint32_t h[4], const PatternDatabase *pd)
+{
+    for (uint32_t i = 0; i < pd->pattern_cnt; i++) {
+        const SCHSPattern *p = pd->parray[i];
+        const uint32_t meta[4] = { p->len, p->flags, p->offset, p->depth };
+
+        hashlittle2(meta, sizeof(meta), &h[0], &h[1]);
+        hashlittle2(p->original_pat, p->len, &h[0], &h[1]);
+        hashlittle2(meta, sizeof(meta), &h[2], &h[3]);
+        hashlittle2(p->original_pat, p->len, &h[2], &h[3]);
+    }
+}
+
+/**
+ * \internal
+ * \brief Build the cache file name from the 128 bit hash of a database.
+ */
+static int SCHSCacheFileName(const uint32_t h[4], const char *path,
+                             char *out, size_t out_size)
+{
+    int r = snprintf(out, out_size, "%s/%08x%08x%08x%08x.hs", path,
+                     h[0], h[1], h[2], h[3]);
+    if (r < 0 || (size_t)r >= out_size) {
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * \internal
+ * \brief Load a serialized database from the cache.
+ *
+ * \retval 0 on success
+ * \retval -1 if there is no usable database in the cache
+ */
+static int SCHSCacheLoad(hs_database_t **db, const char *filename)
+{
+    char *buf = NULL;
+    long size = -1;
+
+    FILE *fp = fopen(filename, "rb");
+    if (fp == NULL) {
+        return -1;
+    }
+    if (fseek(fp, 0, SEEK_END) == 0) {
+        size = ftell(fp);
+    }
+    if (size <= 0 || fseek(fp, 0, SEEK_SET) != 0) {
+        goto error;
+    }
+    buf = SCMalloc(size);
+    if (buf == NULL) {
+        goto error;
+    }
+    if (fread(buf, 1, size, fp) != (size_t)size) {
+        goto error;
+    }
+    fclose(fp);
+    fp = NULL;
+
+    hs_error_t err = hs_deserialize_database(buf, size, db);
+    SCFree(buf);
+    if (err != HS_SUCCESS) {
+        /* e.g. written for another platform, we'll recompile */
+        SCLogDebug("failed to deserialize %s: %d", filename, err);
+        *db = NULL;
+        return -1;
+    }
+    SCLogDebug("loaded database from %s", filename);
+    return 0;
+
+error:
+    if (buf != NULL) {
+        SCFree(buf);
+    }
+    if (fp != NULL) {
+        fclose(fp);
+    }
+    return -1;
+}
+
+/**
+ * \internal
+ * \brief Store a compiled database in the cache. Failures are not fatal.
+ *
+ * The file is written under a temporary name and then renamed, so that
+ * other threads or instances never see a partial file.
+ */
+static void SCHSCacheSave(const hs_database_t *db, const char *path,
+                          const char *filename)
+{
+    char *bytes = NULL;
+    size_t len = 0;
+    char tmp[PATH_MAX];
+
+    if (hs_serialize_database(db, &bytes, &len) != HS_SUCCESS) {
+        SCLogWarning(SC_ERR_FATAL, "failed to serialize hyperscan database");
+        return;
+    }
+    if (SCCreateDirectoryTree(path, true) != 0) {
+        SCLogWarning(SC_ERR_CREATE_DIRECTORY, "failed to create hyperscan "
+                     "cache directory %s: %s", path, strerror(errno));
+        goto end;
+    }
+    int r = snprintf(tmp, sizeof(tmp), "%s.XXXXXX", filename);
+    if (r < 0 || (size_t)r >= sizeof(tmp)) {
+        goto end;
+    }
+    int fd = mkstemp(tmp);
+    if (fd < 0) {
+        SCLogWarning(SC_ERR_FOPEN, "failed to open %s: %s", tmp,
+                     strerror(errno));
+        goto end;
+    }
+    ssize_t w = write(fd, bytes, len);
+    close(fd);
+    if (w != (ssize_t)len || rename(tmp, filename) != 0) {
+        SCLogWarning(SC_ERR_FWRITE, "failed to write hyperscan cache file %s",
+                     filename);
+        unlink(tmp);
+        goto end;
+    }
+    SCLogDebug("stored database in %s", filename);
+end:
+    SCHSFree(bytes);
+}
+
+/**
+ * \internal
+ * \brief Compile the patterns of a pattern database into pd->hs_db.
+ */
+static int SCHSCompilePatternDatabase(PatternDatabase *pd, SCHSCompileData *cd)
+{
+    hs_compile_error_t *compile_err = NULL;
+
+    for (uint32_t i = 0; i < pd->pattern_cnt; i++) {
+        const SCHSPattern *p = pd->parray[i];
+
+        cd->ids[i] = i;
+        cd->flags[i] = HS_FLAG_SINGLEMATCH;
+        if (p->flags & MPM_PATTERN_FLAG_NOCASE) {
+            cd->flags[i] |= HS_FLAG_CASELESS;
+        }
+
+        cd->expressions[i] = HSRenderPattern(p->original_pat, p->len);
+
+        if (p->flags & (MPM_PATTERN_FLAG_OFFSET | MPM_PATTERN_FLAG_DEPTH)) {
+            cd->ext[i] = SCMalloc(sizeof(hs_expr_ext_t));
+            if (cd->ext[i] == NULL) {
+                return -1;
+            }
+            memset(cd->ext[i], 0, sizeof(hs_expr_ext_t));
+
+            if (p->flags & MPM_PATTERN_FLAG_OFFSET) {
+                cd->ext[i]->flags |= HS_EXT_FLAG_MIN_OFFSET;
+                cd->ext[i]->min_offset = p->offset + p->len;
+            }
+            if (p->flags & MPM_PATTERN_FLAG_DEPTH) {
+                cd->ext[i]->flags |= HS_EXT_FLAG_MAX_OFFSET;
+                cd->ext[i]->max_offset = p->offset + p->depth;
+            }
+        }
+    }
+
+    hs_error_t err = hs_compile_ext_multi((const char *const *)cd->expressions,
+            cd->flags, cd->ids, (const hs_expr_ext_t *const *)cd->ext,
+            cd->pattern_cnt, HS_MODE_BLOCK, NULL, &pd->hs_db, &compile_err);
+
+    if (err != HS_SUCCESS) {
+        SCLogError(SC_ERR_FATAL, "failed to compile hyperscan database");
+        if (compile_err) {
+            SCLogError(SC_ERR_FATAL, "compile error: %s", compile_err->message);
+        }
+        hs_free_compile_error(compile_err);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * \internal
+ * \brief Build the streaming database of a pattern database.
+ *
+ * Offset and depth are not compiled in, as stream offsets are not those
+ * of the inspected windows. Matches are checked against the window in
+ * SCHSStreamSearch(). On failure the context is scanned in block mode.
+ *
+ * Like SCHSPreparePatterns(), the database is compiled or loaded from the
+ * cache without holding the lock, and only published under it.
+ */
+static void SCHSPrepareStreamDatabase(const MpmCtx *mpm_ctx, PatternDatabase *pd)
+{
+    if (!(mpm_ctx->flags & MPMCTX_FLAGS_STREAMING)) {
+        return;
+    }
+
+    SCMutexLock(&g_stream_db_mutex);
+    const bool built = (pd->hs_stream_db != NULL);
+    SCMutexUnlock(&g_stream_db_mutex);
+    if (built) {
+        return;
+    }
+
+    hs_database_t *db = NULL;
+    SCHSCompileData *cd = SCHSAllocCompileData(pd->pattern_cnt);
+    if (cd == NULL) {
+        goto error;
+    }
+    for (uint32_t i = 0; i < pd->pattern_cnt; i++) {
+        const SCHSPattern *p = pd->parray[i];
+
+        /* no HS_FLAG_SINGLEMATCH: we need the last match of a pattern */
+        cd->ids[i] = i;
+        if (p->flags & MPM_PATTERN_FLAG_NOCASE) {
+            cd->flags[i] |= HS_FLAG_CASELESS;
+        }
+        cd->expressions[i] = HSRenderPattern(p->original_pat, p->len);
+        if (cd->expressions[i] == NULL) {
+            goto error;
+        }
+    }
+
+    char cache_file[PATH_MAX] = "";
+    const char *cache_path = SCHSCachePath();
+    if (cache_path != NULL) {
+        uint32_t h[4];
+        SCHSCacheHashInit(h, "stream");
+        SCHSCacheHashPatterns(h, pd);
+        if (SCHSCacheFileName(h, cache_path, cache_file, sizeof(cache_file)) != 0) {
+            cache_path = NULL;
+        }
+    }
+
+    hs_error_t err;
+    if (cache_path == NULL || SCHSCacheLoad(&db, cache_file) != 0) {
+        hs_compile_error_t *compile_err = NULL;
+        err = hs_compile_ext_multi((const char *const *)cd->expressions,
+                cd->flags, cd->ids, NULL, cd->pattern_cnt, HS_MODE_STREAM, NULL,
+                &db, &compile_err);
+        if (err != HS_SUCCESS) {
+            if (compile_err) {
+                SCLogWarning(SC_ERR_INITIALIZATION, "hyperscan stream compile "
+                        "error: %s", compile_err->message);
+            }
+            hs_free_compile_error(compile_err);
+            db = NULL;
+            goto error;
+        }
+        if (cache_path != NULL) {
+            SCHSCacheSave(db, cache_path, cache_file);
+        }
+    }
+
+    SCMutexLock(&g_scratch_proto_mutex);
+    err = hs_alloc_scratch(db, &g_scratch_proto);
+    SCMutexUnlock(&g_scratch_proto_mutex);
+    if (err != HS_SUCCESS) {
+        goto error;
+    }
+    SCHSFreeCompileData(cd);
+
+    SCMutexLock(&g_stream_db_mutex);
+    /* another thread may have built it in the meantime */
+    if (pd->hs_stream_db != NULL) {
+        SCMutexUnlock(&g_stream_db_mutex);
+        hs_free_database(db);
+        return;
+    }
+    pd->hs_stream_db = db;
+    pd->stream_db_id = ++g_stream_db_id;
+    SCMutexUnlock(&g_stream_db_mutex);
+    return;
+
+error:
+    if (db != NULL) {
+        hs_free_database(db);
+    }
+    SCHSFreeCompileData(cd);
+    SCLogWarning(SC_ERR_INITIALIZATION, "failed to build hyperscan streaming "
+            "database, using block mode");
+}
+
 /**
  * \brief Process the patterns added to the mpm, and create the internal tables.
  *
@@ -591,7 +946,6 @@ int SCHSPreparePatterns(MpmCtx *mpm_ctx)
     }
 
     hs_error_t err;
-    hs_compile_error_t *compile_err = NULL;
     SCHSCompileData *cd = NULL;
     PatternDatabase *pd = NULL;
 
@@ -620,8 +974,9 @@ int SCHSPreparePatterns(MpmCtx *mpm_ctx)
     SCFree(ctx->init_hash);
     ctx->init_hash = NULL;
 
-    /* Serialise whole database compilation as a relatively easy way to ensure
-     * dedupe is safe. */
+    /* Only the lookup and insertion in the global database hash are
+     * serialised, so that multiple threads can compile databases at the
+     * same time. */
     SCMutexLock(&g_db_table_mutex);
 
     /* Init global pattern database hash if necessary. */
@@ -649,90 +1004,83 @@ int SCHSPreparePatterns(MpmCtx *mpm_ctx)
         SCMutexUnlock(&g_db_table_mutex);
         PatternDatabaseFree(pd);
         SCHSFreeCompileData(cd);
+        SCHSPrepareStreamDatabase(mpm_ctx, pd_cached);
         return 0;
     }
+    SCMutexUnlock(&g_db_table_mutex);
 
     BUG_ON(ctx->pattern_db != NULL); /* already built? */
+    BUG_ON(mpm_ctx->pattern_cnt == 0);
 
-    for (uint32_t i = 0; i < pd->pattern_cnt; i++) {
-        const SCHSPattern *p = pd->parray[i];
-
-        cd->ids[i] = i;
-        cd->flags[i] = HS_FLAG_SINGLEMATCH;
-        if (p->flags & MPM_PATTERN_FLAG_NOCASE) {
-            cd->flags[i] |= HS_FLAG_CASELESS;
-        }
-
-        cd->expressions[i] = HSRenderPattern(p->original_pat, p->len);
-
-        if (p->flags & (MPM_PATTERN_FLAG_OFFSET | MPM_PATTERN_FLAG_DEPTH)) {
-            cd->ext[i] = SCMalloc(sizeof(hs_expr_ext_t));
-            if (cd->ext[i] == NULL) {
-                SCMutexUnlock(&g_db_table_mutex);
-                goto error;
-            }
-            memset(cd->ext[i], 0, sizeof(hs_expr_ext_t));
-
-            if (p->flags & MPM_PATTERN_FLAG_OFFSET) {
-                cd->ext[i]->flags |= HS_EXT_FLAG_MIN_OFFSET;
-                cd->ext[i]->min_offset = p->offset + p->len;
-            }
-            if (p->flags & MPM_PATTERN_FLAG_DEPTH) {
-                cd->ext[i]->flags |= HS_EXT_FLAG_MAX_OFFSET;
-                cd->ext[i]->max_offset = p->offset + p->depth;
-            }
+    /* try the on-disk cache before compiling */
+    char cache_file[PATH_MAX] = "";
+    const char *cache_path = SCHSCachePath();
+    if (cache_path != NULL) {
+        uint32_t h[4];
+        SCHSCacheHashInit(h, NULL);
+        SCHSCacheHashPatterns(h, pd);
+        if (SCHSCacheFileName(h, cache_path, cache_file, sizeof(cache_file)) != 0) {
+            cache_path = NULL;
         }
     }
-
-    BUG_ON(mpm_ctx->pattern_cnt == 0);
-
-    err = hs_compile_ext_multi((const char *const *)cd->expressions, cd->flags,
-                               cd->ids, (const hs_expr_ext_t *const *)cd->ext,
-                               cd->pattern_cnt, HS_MODE_BLOCK, NULL, &pd->hs_db,
-                               &compile_err);
-
-    if (err != HS_SUCCESS) {
-        SCLogError(SC_ERR_FATAL, "failed to compile hyperscan database");
-        if (compile_err) {
-            SCLogError(SC_ERR_FATAL, "compile error: %s", compile_err->message);
+    if (cache_path == NULL || SCHSCacheLoad(&pd->hs_db, cache_file) != 0) {
+        if (SCHSCompilePatternDatabase(pd, cd) != 0) {
+            goto error;
+        }
+        if (cache_path != NULL) {
+            SCHSCacheSave(pd->hs_db, cache_path, cache_file);
         }
-        hs_free_compile_error(compile_err);
-        SCMutexUnlock(&g_db_table_mutex);
-        goto error;
     }
 
-    ctx->pattern_db = pd;
-
     SCMutexLock(&g_scratch_proto_mutex);
     err = hs_alloc_scratch(pd->hs_db, &g_scratch_proto);
     SCMutexUnlock(&g_scratch_proto_mutex);
     if (err != HS_SUCCESS) {
         SCLogError(SC_ERR_FATAL, "failed to allocate scratch");
-        SCMutexUnlock(&g_db_table_mutex);
         goto error;
     }
 
-    err = hs_database_size(pd->hs_db, &ctx->hs_db_size);
+    size_t db_size = 0;
+    err = hs_database_size(pd->hs_db, &db_size);
     if (err != HS_SUCCESS) {
         SCLogError(SC_ERR_FATAL, "failed to query database size");
-        SCMutexUnlock(&g_db_table_mutex);
         goto error;
     }
 
-    mpm_ctx->memory_cnt++;
-    mpm_ctx->memory_size += ctx->hs_db_size;
-
-    SCLogDebug("Built %" PRIu32 " patterns into a database of size %" PRIuMAX
-               " bytes", mpm_ctx->pattern_cnt, (uintmax_t)ctx->hs_db_size);
+    SCMutexLock(&g_db_table_mutex);
+    /* another thread may have built the same database in the meantime */
+    pd_cached = HashTableLookup(g_db_table, pd, 1);
+    if (pd_cached != NULL) {
+        SCLogDebug("Reusing database %p built by another thread",
+                   pd_cached->hs_db);
+        pd_cached->ref_cnt++;
+        ctx->pattern_db = pd_cached;
+        SCMutexUnlock(&g_db_table_mutex);
+        PatternDatabaseFree(pd);
+        SCHSFreeCompileData(cd);
+        SCHSPrepareStreamDatabase(mpm_ctx, pd_cached);
+        return 0;
+    }
 
     /* Cache this database globally for later. */
     pd->ref_cnt = 1;
     int r = HashTableAdd(g_db_table, pd, 1);
     SCMutexUnlock(&g_db_table_mutex);
-    if (r < 0)
+    if (r < 0) {
+        pd->ref_cnt = 0;
         goto error;
+    }
+
+    ctx->pattern_db = pd;
+    ctx->hs_db_size = db_size;
+    mpm_ctx->memory_cnt++;
+    mpm_ctx->memory_size += ctx->hs_db_size;
+
+    SCLogDebug("Built %" PRIu32 " patterns into a database of size %" PRIuMAX
+               " bytes", mpm_ctx->pattern_cnt, (uintmax_t)ctx->hs_db_size);
 
     SCHSFreeCompileData(cd);
+    SCHSPrepareStreamDatabase(mpm_ctx, pd);
     return 0;
 
 error:
@@ -745,10 +1093,21 @@ error:
     return -1;
 }
 
-/**
- * \brief Init the mpm thread context.
- *
- * \param mpm_ctx        Pointer to the mpm context.
+/** \brief drop a reference to a pattern database, g_db_table_mutex held */
+static void PatternDatabaseRelease(PatternDatabase *pd)
+{
+    BUG_ON(pd->ref_cnt == 0);
+    pd->ref_cnt--;
+    if (pd->ref_cnt == 0) {
+        HashTableRemove(g_db_table, pd, 1);
+        PatternDatabaseFree(pd);
+    }
+}
+
+/**
+ * \brief Init the mpm thread context.
+ *
+ * \param mpm_ctx        Pointer to the mpm context.
  * \param mpm_thread_ctx Pointer to the mpm thread context.
  */
 void SCHSInitThreadCtx(MpmCtx *mpm_ctx, MpmThreadCtx *mpm_thread_ctx)
@@ -778,187 +1137,869 @@ void SCHSInitThreadCtx(MpmCtx *mpm_ctx, MpmThreadCtx *mpm_thread_ctx)
         return;
     }
 
-    hs_error_t err = hs_clone_scratch(g_scratch_proto,
-                                      (hs_scratch_t **)&ctx->scratch);
-
+    hs_error_t err = hs_clone_scratch(g_scratch_proto,
+                                      (hs_scratch_t **)&ctx->scratch);
+
+    SCMutexUnlock(&g_scratch_proto_mutex);
+
+    if (err != HS_SUCCESS) {
+        SCLogError(SC_ERR_FATAL, "Unable to clone scratch prototype");
+        exit(EXIT_FAILURE);
+    }
+
+    err = hs_scratch_size(ctx->scratch, &ctx->scratch_size);
+    if (err != HS_SUCCESS) {
+        SCLogError(SC_ERR_FATAL, "Unable to query scratch size");
+        exit(EXIT_FAILURE);
+    }
+
+    mpm_thread_ctx->memory_cnt++;
+    mpm_thread_ctx->memory_size += ctx->scratch_size;
+}
+
+/**
+ * \brief Initialize the HS context.
+ *
+ * \param mpm_ctx       Mpm context.
+ */
+void SCHSInitCtx(MpmCtx *mpm_ctx)
+{
+    if (mpm_ctx->ctx != NULL)
+        return;
+
+    mpm_ctx->ctx = SCMalloc(sizeof(SCHSCtx));
+    if (mpm_ctx->ctx == NULL) {
+        exit(EXIT_FAILURE);
+    }
+    memset(mpm_ctx->ctx, 0, sizeof(SCHSCtx));
+
+    mpm_ctx->memory_cnt++;
+    mpm_ctx->memory_size += sizeof(SCHSCtx);
+
+    /* initialize the hash we use to speed up pattern insertions */
+    SCHSCtx *ctx = (SCHSCtx *)mpm_ctx->ctx;
+    ctx->init_hash = SCMalloc(sizeof(SCHSPattern *) * INIT_HASH_SIZE);
+    if (ctx->init_hash == NULL) {
+        exit(EXIT_FAILURE);
+    }
+    memset(ctx->init_hash, 0, sizeof(SCHSPattern *) * INIT_HASH_SIZE);
+}
+
+/**
+ * \brief Destroy the mpm thread context.
+ *
+ * \param mpm_ctx        Pointer to the mpm context.
+ * \param mpm_thread_ctx Pointer to the mpm thread context.
+ */
+void SCHSDestroyThreadCtx(MpmCtx *mpm_ctx, MpmThreadCtx *mpm_thread_ctx)
+{
+    SCHSPrintSearchStats(mpm_thread_ctx);
+
+    if (mpm_thread_ctx->ctx != NULL) {
+        SCHSThreadCtx *thr_ctx = (SCHSThreadCtx *)mpm_thread_ctx->ctx;
+
+        if (thr_ctx->scratch != NULL) {
+            hs_free_scratch(thr_ctx->scratch);
+            mpm_thread_ctx->memory_cnt--;
+            mpm_thread_ctx->memory_size -= thr_ctx->scratch_size;
+        }
+
+        SCFree(mpm_thread_ctx->ctx);
+        mpm_thread_ctx->ctx = NULL;
+        mpm_thread_ctx->memory_cnt--;
+        mpm_thread_ctx->memory_size -= sizeof(SCHSThreadCtx);
+    }
+}
+
+/**
+ * \brief Destroy the mpm context.
+ *
+ * \param mpm_ctx Pointer to the mpm context.
+ */
+void SCHSDestroyCtx(MpmCtx *mpm_ctx)
+{
+    SCHSCtx *ctx = (SCHSCtx *)mpm_ctx->ctx;
+    if (ctx == NULL)
+        return;
+
+    if (ctx->init_hash != NULL) {
+        SCFree(ctx->init_hash);
+        ctx->init_hash = NULL;
+        mpm_ctx->memory_cnt--;
+        mpm_ctx->memory_size -= (INIT_HASH_SIZE * sizeof(SCHSPattern *));
+    }
+
+    /* Decrement pattern database ref count, and delete it entirely if the
+     * count has dropped to zero. */
+    SCMutexLock(&g_db_table_mutex);
+    PatternDatabase *pd = ctx->pattern_db;
+    if (pd) {
+        PatternDatabaseRelease(pd);
+    }
+    SCMutexUnlock(&g_db_table_mutex);
+
+    SCFree(mpm_ctx->ctx);
+    mpm_ctx->memory_cnt--;
+    mpm_ctx->memory_size -= sizeof(SCHSCtx);
+}
+
+typedef struct SCHSCallbackCtx_ {
+    SCHSCtx *ctx;
+    void *pmq;
+    uint32_t match_count;
+} SCHSCallbackCtx;
+
+/* Hyperscan MPM match event handler */
+static int SCHSMatchEvent(unsigned int id, unsigned long long from,
+                          unsigned long long to, unsigned int flags,
+                          void *ctx)
+{
+    SCHSCallbackCtx *cctx = ctx;
+    PrefilterRuleStore *pmq = cctx->pmq;
+    const PatternDatabase *pd = cctx->ctx->pattern_db;
+    const SCHSPattern *pat = pd->parray[id];
+
+    SCLogDebug("Hyperscan Match %" PRIu32 ": id=%" PRIu32 " @ %" PRIuMAX
+               " (pat id=%" PRIu32 ")",
+               cctx->match_count, (uint32_t)id, (uintmax_t)to, pat->id);
+
+    PrefilterAddSids(pmq, pat->sids, pat->sids_size);
+
+    cctx->match_count++;
+    return 0;
+}
+
+/**
+ * \brief The Hyperscan search function.
+ *
+ * \param mpm_ctx        Pointer to the mpm context.
+ * \param mpm_thread_ctx Pointer to the mpm thread context.
+ * \param pmq            Pointer to the Pattern Matcher Queue to hold
+ *                       search matches.
+ * \param buf            Buffer to be searched.
+ * \param buflen         Buffer length.
+ *
+ * \retval matches Match count.
+ */
+uint32_t SCHSSearch(const MpmCtx *mpm_ctx, MpmThreadCtx *mpm_thread_ctx,
+                    PrefilterRuleStore *pmq, const uint8_t *buf, const uint32_t buflen)
+{
+    uint32_t ret = 0;
+    SCHSCtx *ctx = (SCHSCtx *)mpm_ctx->ctx;
+    SCHSThreadCtx *hs_thread_ctx = (SCHSThreadCtx *)(mpm_thread_ctx->ctx);
+    const PatternDatabase *pd = ctx->pattern_db;
+
+    if (unlikely(buflen == 0)) {
+        return 0;
+    }
+
+    SCHSCallbackCtx cctx = {.ctx = ctx, .pmq = pmq, .match_count = 0};
+
+    /* scratch should have been cloned from g_scratch_proto at thread init. */
+    hs_scratch_t *scratch = hs_thread_ctx->scratch;
+    BUG_ON(pd->hs_db == NULL);
+    BUG_ON(scratch == NULL);
+
+    hs_error_t err = hs_scan(pd->hs_db, (const char *)buf, buflen, 0, scratch,
+                             SCHSMatchEvent, &cctx);
+    if (err != HS_SUCCESS) {
+        /* An error value (other than HS_SCAN_TERMINATED) from hs_scan()
+         * indicates that it was passed an invalid database or scratch region,
+         * which is not something we can recover from at scan time. */
+        SCLogError(SC_ERR_FATAL, "Hyperscan returned error %d", err);
+        exit(EXIT_FAILURE);
+    } else {
+        ret = cctx.match_count;
+    }
+
+    return ret;
+}
+
+/* initial size of the match table of a stream state, it grows up to the
+ * pattern count of the database */
+#define SCHS_STREAM_MATCHES 16
+
+typedef struct SCHSStreamMatch_ {
+    uint32_t id;    /**< pattern id */
+    uint64_t end;   /**< stream offset of the end of its last match */
+} SCHSStreamMatch;
+
+struct SCHSStreamState_ {
+    hs_stream_t *stream;
+    /* stream_db_id of the database the stream was opened against */
+    uint32_t db_id;
+    /* memory accounted for this state */
+    uint32_t size;
+
+    bool disabled;
+    /* the match table couldn't grow, restart at the next window */
+    bool overflow;
+
+    uint64_t base;      /**< stream offset of the start of the hs stream */
+    uint64_t scanned;   /**< stream offset up to where data was scanned */
+    uint64_t win;       /**< stream offset of the last window */
+
+    /* last match of each pattern that matched in the window */
+    uint32_t match_cnt;
+    uint32_t match_size;
+    SCHSStreamMatch *matches;
+};
+
+void SCHSStreamSetMemcap(const uint64_t size)
+{
+    g_stream_memcap = size;
+}
+
+uint64_t SCHSStreamGetMemuse(void)
+{
+    return SC_ATOMIC_GET(g_stream_memuse);
+}
+
+static inline bool SCHSStreamCheckMemcap(const uint64_t size)
+{
+    return (g_stream_memcap == 0 ||
+            SC_ATOMIC_GET(g_stream_memuse) + size <= g_stream_memcap);
+}
+
+static void SCHSStreamStateClose(SCHSStreamState *state)
+{
+    if (state->stream != NULL) {
+        hs_close_stream(state->stream, NULL, NULL, NULL);
+        state->stream = NULL;
+    }
+    if (state->matches != NULL) {
+        SCFree(state->matches);
+        state->matches = NULL;
+    }
+    (void)SC_ATOMIC_SUB(g_stream_memuse, state->size - sizeof(*state));
+    state->size = sizeof(*state);
+    state->match_cnt = state->match_size = 0;
+    state->db_id = 0;
+}
+
+/** \internal
+ *  \brief give up on streaming for this state, the owner scans in block
+ *          mode from now on */
+static void SCHSStreamStateDisable(SCHSStreamState *state)
+{
+    SCHSStreamStateClose(state);
+    state->disabled = true;
+}
+
+/** \internal
+ *  \brief (re)open the stream against the streaming database of pd
+ *  \retval 0 ok, -1 the state is disabled */
+static int SCHSStreamStateOpen(SCHSStreamState *state, const PatternDatabase *pd)
+{
+    SCHSStreamStateClose(state);
+
+    size_t stream_size = 0;
+    if (hs_stream_size(pd->hs_stream_db, &stream_size) != HS_SUCCESS ||
+            !SCHSStreamCheckMemcap(stream_size) ||
+            hs_open_stream(pd->hs_stream_db, 0, &state->stream) != HS_SUCCESS) {
+        state->stream = NULL;
+        SCHSStreamStateDisable(state);
+        return -1;
+    }
+    (void)SC_ATOMIC_ADD(g_stream_memuse, stream_size);
+    state->size = sizeof(*state) + stream_size;
+    state->db_id = pd->stream_db_id;
+    state->base = state->scanned = state->win = 0;
+    state->overflow = false;
+    return 0;
+}
+
+/** \internal
+ *  \brief restart the stream at a new offset, forgetting all matches */
+static void SCHSStreamStateReset(SCHSStreamState *state, const uint64_t offset)
+{
+    if (state->scanned != state->base) {
+        hs_reset_stream(state->stream, 0, NULL, NULL, NULL);
+    }
+    state->base = state->scanned = state->win = offset;
+    state->match_cnt = 0;
+    state->overflow = false;
+}
+
+void SCHSStreamStateFree(SCHSStreamState *state)
+{
+    if (state == NULL) {
+        return;
+    }
+    SCHSStreamStateClose(state);
+    (void)SC_ATOMIC_SUB(g_stream_memuse, sizeof(*state));
+    SCFree(state);
+}
+
+static SCHSStreamState *SCHSStreamStateAlloc(void)
+{
+    if (!SCHSStreamCheckMemcap(sizeof(SCHSStreamState))) {
+        return NULL;
+    }
+    SCHSStreamState *state = SCCalloc(1, sizeof(*state));
+    if (state == NULL) {
+        return NULL;
+    }
+    (void)SC_ATOMIC_ADD(g_stream_memuse, sizeof(*state));
+    state->size = sizeof(*state);
+    return state;
+}
+
+/** \internal
+ *  \brief grow the match table, at most to the pattern count of the
+ *          database as a pattern is in the table once
+ *  \retval 0 ok, -1 memcap reached or no memory */
+static int SCHSStreamStateGrow(SCHSStreamState *state, const uint32_t max)
+{
+    const uint32_t size = state->match_size == 0 ?
+            MIN(SCHS_STREAM_MATCHES, max) : MIN(state->match_size * 2, max);
+    if (size <= state->match_size) {
+        return -1;
+    }
+    const uint32_t grow = (size - state->match_size) * sizeof(SCHSStreamMatch);
+    if (!SCHSStreamCheckMemcap(grow)) {
+        return -1;
+    }
+    SCHSStreamMatch *ptr = SCRealloc(state->matches, size * sizeof(SCHSStreamMatch));
+    if (ptr == NULL) {
+        return -1;
+    }
+    (void)SC_ATOMIC_ADD(g_stream_memuse, grow);
+    state->size += grow;
+    state->matches = ptr;
+    state->match_size = size;
+    return 0;
+}
+
+typedef struct SCHSStreamCallbackCtx_ {
+    SCHSStreamState *state;
+    const PatternDatabase *pd;
+} SCHSStreamCallbackCtx;
+
+/* Hyperscan streaming match event handler: remember the last match of
+ * each pattern */
+static int SCHSStreamMatchEvent(unsigned int id, unsigned long long from,
+                                unsigned long long to, unsigned int flags,
+                                void *ctx)
+{
+    SCHSStreamCallbackCtx *cctx = ctx;
+    SCHSStreamState *state = cctx->state;
+    const uint64_t end = state->base + to;
+
+    for (uint32_t i = 0; i < state->match_cnt; i++) {
+        if (state->matches[i].id == id) {
+            state->matches[i].end = end;
+            return 0;
+        }
+    }
+    if (state->match_cnt == state->match_size) {
+        /* matches that start before the window are of no use anymore */
+        for (uint32_t i = 0; i < state->match_cnt; ) {
+            const SCHSPattern *pat = cctx->pd->parray[state->matches[i].id];
+            if (state->matches[i].end - pat->len < state->win) {
+                state->matches[i] = state->matches[--state->match_cnt];
+                continue;
+            }
+            i++;
+        }
+    }
+    if (state->match_cnt == state->match_size &&
+            SCHSStreamStateGrow(state, cctx->pd->pattern_cnt) != 0) {
+        /* terminate the scan, the state can't be trusted anymore */
+        state->overflow = true;
+        return 1;
+    }
+    state->matches[state->match_cnt].id = id;
+    state->matches[state->match_cnt].end = end;
+    state->match_cnt++;
+    return 0;
+}
+
+/**
+ * \brief Search a window of a stream, scanning only the data that wasn't
+ *        scanned by an earlier call.
+ *
+ * Windows of the same stream are passed with their stream offset, which
+ * may overlap earlier windows. Sids are added for the patterns that have
+ * a match that lies entirely in the window, like SCHSSearch() would do.
+ * Offset and depth of the patterns are not checked.
+ *
+ * The state is created on first use. If that isn't possible because of
+ * the memcap, or if the window can't be handled incrementally, the window
+ * is scanned in block mode.
+ *
+ * \param state  state of the stream, owned by the caller and freed with
+ *               SCHSStreamStateFree()
+ * \param offset stream offset of buf
+ *
+ * \retval matches Match count.
+ */
+uint32_t SCHSStreamSearch(const MpmCtx *mpm_ctx, MpmThreadCtx *mpm_thread_ctx,
+        SCHSStreamState **state, PrefilterRuleStore *pmq,
+        const uint8_t *buf, const uint32_t buflen, const uint64_t offset)
+{
+    const SCHSCtx *ctx = (const SCHSCtx *)mpm_ctx->ctx;
+    SCHSThreadCtx *hs_thread_ctx = (SCHSThreadCtx *)(mpm_thread_ctx->ctx);
+    const PatternDatabase *pd = ctx->pattern_db;
+
+    if (unlikely(buflen == 0)) {
+        return 0;
+    }
+    if (pd == NULL || pd->hs_stream_db == NULL) {
+        goto block;
+    }
+
+    SCHSStreamState *s = *state;
+    if (s == NULL) {
+        s = *state = SCHSStreamStateAlloc();
+        if (s == NULL) {
+            goto block;
+        }
+    }
+    if (s->disabled) {
+        goto block;
+    }
+    if (s->db_id != pd->stream_db_id && SCHSStreamStateOpen(s, pd) != 0) {
+        goto block;
+    }
+
+    /* the matches of the last scan are incomplete, start over */
+    if (s->overflow) {
+        SCHSStreamStateReset(s, offset);
+    }
+    /* matches before the last window were forgotten, and for a window
+     * ending before the scanned data only the last match of a pattern is
+     * known, which may be beyond the window */
+    const uint64_t end = offset + buflen;
+    if (offset < s->win || end < s->scanned) {
+        goto block;
+    }
+    /* data missing between the scanned data and the window */
+    if (offset > s->scanned) {
+        SCHSStreamStateReset(s, offset);
+    }
+    s->win = offset;
+
+    if (end > s->scanned) {
+        const uint32_t skip = (uint32_t)(s->scanned - offset);
+
+        /* scratch should have been cloned from g_scratch_proto at thread init. */
+        hs_scratch_t *scratch = hs_thread_ctx->scratch;
+        BUG_ON(scratch == NULL);
+
+        SCHSStreamCallbackCtx cctx = { .state = s, .pd = pd };
+        hs_error_t err = hs_scan_stream(s->stream, (const char *)buf + skip,
+                buflen - skip, 0, scratch, SCHSStreamMatchEvent, &cctx);
+        if (err != HS_SUCCESS && err != HS_SCAN_TERMINATED) {
+            /* see SCHSSearch() */
+            SCLogError(SC_ERR_FATAL, "Hyperscan returned error %d", err);
+            exit(EXIT_FAILURE);
+        }
+        s->scanned = end;
+
+        if (s->overflow) {
+            SCLogDebug("match table full, restarting at the next window");
+            goto block;
+        }
+    }
+
+    /* report the matches in the window, windows don't move back so the
+     * ones that start before it are of no use anymore */
+    uint32_t ret = 0;
+    for (uint32_t i = 0; i < s->match_cnt; ) {
+        const SCHSPattern *pat = pd->parray[s->matches[i].id];
+        if (s->matches[i].end - pat->len < offset) {
+            s->matches[i] = s->matches[--s->match_cnt];
+            continue;
+        }
+        PrefilterAddSids(pmq, pat->sids, pat->sids_size);
+        ret++;
+        i++;
+    }
+    return ret;
+
+block:
+    return SCHSSearch(mpm_ctx, mpm_thread_ctx, pmq, buf, buflen);
+}
+
+static uint32_t SCHSMultiHash(HashTable *ht, void *data, uint16_t len)
+{
+    const SCHSMultiCtx *ctx = data;
+    uint32_t hash = hashlittle_safe(ctx->pds, ctx->pd_cnt * sizeof(void *), ctx->pd_cnt);
+    return hash % ht->array_size;
+}
+
+static char SCHSMultiCompare(void *data1, uint16_t len1, void *data2, uint16_t len2)
+{
+    const SCHSMultiCtx *ctx1 = data1;
+    const SCHSMultiCtx *ctx2 = data2;
+    return (ctx1->pd_cnt == ctx2->pd_cnt &&
+            memcmp(ctx1->pds, ctx2->pds, ctx1->pd_cnt * sizeof(void *)) == 0);
+}
+
+static void SCHSMultiTableFree(void *data)
+{
+    /* Stub, like PatternDatabaseTableFree(). Databases are freed when the
+     * last user is gone. */
+}
+
+/** \brief free a multi buffer database, g_db_table_mutex held */
+static void SCHSMultiFreeLocked(SCHSMultiCtx *ctx)
+{
+    if (ctx->parray != NULL) {
+        for (uint32_t i = 0; i < ctx->pattern_cnt; i++) {
+            SCFree(ctx->parray[i].sids);
+        }
+        SCFree(ctx->parray);
+    }
+    if (ctx->pds != NULL) {
+        for (uint16_t i = 0; i < ctx->pd_cnt; i++) {
+            if (ctx->pds[i] != NULL)
+                PatternDatabaseRelease(ctx->pds[i]);
+        }
+        SCFree(ctx->pds);
+    }
+    hs_free_database(ctx->hs_db);
+    SCFree(ctx);
+}
+
+static int SCHSMultiCompile(SCHSMultiCtx *ctx)
+{
+    SCHSCompileData *cd = SCHSAllocCompileData(ctx->pattern_cnt);
+    if (cd == NULL) {
+        return -1;
+    }
+
+    uint32_t n = 0;
+    for (uint16_t b = 0; b < ctx->pd_cnt; b++) {
+        const PatternDatabase *pd = ctx->pds[b];
+        if (pd == NULL)
+            continue;
+
+        for (uint32_t i = 0; i < pd->pattern_cnt; i++, n++) {
+            const SCHSPattern *p = pd->parray[i];
+            SCHSMultiPattern *mp = &ctx->parray[n];
+
+            /* offsets in a vectored scan are relative to the start of the
+             * first buffer, so offset and depth are checked on match. A
+             * match also has to start in the buffer. */
+            mp->len = p->len;
+            mp->buffer = b;
+            mp->min_end = p->len;
+            mp->max_end = UINT32_MAX;
+            if (p->flags & MPM_PATTERN_FLAG_OFFSET) {
+                mp->min_end = p->offset + p->len;
+            }
+            if (p->flags & MPM_PATTERN_FLAG_DEPTH) {
+                mp->max_end = p->offset + p->depth;
+            }
+            mp->sids = SCMalloc(p->sids_size * sizeof(SigIntId));
+            if (mp->sids == NULL) {
+                goto error;
+            }
+            memcpy(mp->sids, p->sids, p->sids_size * sizeof(SigIntId));
+            mp->sids_size = p->sids_size;
+
+            /* no HS_FLAG_SINGLEMATCH: the first match of a pattern may be
+             * in another buffer */
+            cd->ids[n] = n;
+            if (p->flags & MPM_PATTERN_FLAG_NOCASE) {
+                cd->flags[n] |= HS_FLAG_CASELESS;
+            }
+            cd->expressions[n] = HSRenderPattern(p->original_pat, p->len);
+            if (cd->expressions[n] == NULL) {
+                goto error;
+            }
+        }
+    }
+
+    /* the buffer of a pattern is part of its match id, so the pattern
+     * count of each buffer is part of the cache hash */
+    char cache_file[PATH_MAX] = "";
+    const char *cache_path = SCHSCachePath();
+    if (cache_path != NULL) {
+        uint32_t h[4];
+        SCHSCacheHashInit(h, "multi");
+        for (uint16_t b = 0; b < ctx->pd_cnt; b++) {
+            const PatternDatabase *pd = ctx->pds[b];
+            const uint32_t meta[2] = { b, pd != NULL ? pd->pattern_cnt : 0 };
+            hashlittle2(meta, sizeof(meta), &h[0], &h[1]);
+            hashlittle2(meta, sizeof(meta), &h[2], &h[3]);
+            if (pd != NULL) {
+                SCHSCacheHashPatterns(h, pd);
+            }
+        }
+        if (SCHSCacheFileName(h, cache_path, cache_file, sizeof(cache_file)) != 0) {
+            cache_path = NULL;
+        }
+    }
+
+    hs_error_t err;
+    hs_database_t *db = NULL;
+    if (cache_path == NULL || SCHSCacheLoad(&db, cache_file) != 0) {
+        hs_compile_error_t *compile_err = NULL;
+        err = hs_compile_ext_multi((const char *const *)cd->expressions,
+                cd->flags, cd->ids, (const hs_expr_ext_t *const *)cd->ext,
+                cd->pattern_cnt, HS_MODE_VECTORED, NULL, &db, &compile_err);
+        if (err != HS_SUCCESS) {
+            SCLogError(SC_ERR_FATAL, "failed to compile hyperscan multi buffer database");
+            if (compile_err) {
+                SCLogError(SC_ERR_FATAL, "compile error: %s", compile_err->message);
+            }
+            hs_free_compile_error(compile_err);
+            goto error;
+        }
+        if (cache_path != NULL) {
+            SCHSCacheSave(db, cache_path, cache_file);
+        }
+    }
+    ctx->hs_db = db;
+
+    SCMutexLock(&g_scratch_proto_mutex);
+    err = hs_alloc_scratch(ctx->hs_db, &g_scratch_proto);
     SCMutexUnlock(&g_scratch_proto_mutex);
-
     if (err != HS_SUCCESS) {
-        SCLogError(SC_ERR_FATAL, "Unable to clone scratch prototype");
-        exit(EXIT_FAILURE);
+        SCLogError(SC_ERR_FATAL, "failed to allocate scratch");
+        goto error;
     }
 
-    err = hs_scratch_size(ctx->scratch, &ctx->scratch_size);
-    if (err != HS_SUCCESS) {
-        SCLogError(SC_ERR_FATAL, "Unable to query scratch size");
-        exit(EXIT_FAILURE);
-    }
+    SCHSFreeCompileData(cd);
+    return 0;
 
-    mpm_thread_ctx->memory_cnt++;
-    mpm_thread_ctx->memory_size += ctx->scratch_size;
+error:
+    SCHSFreeCompileData(cd);
+    return -1;
 }
 
 /**
- * \brief Initialize the HS context.
+ * \brief Build a vectored database for the patterns of multiple mpm contexts.
  *
- * \param mpm_ctx       Mpm context.
+ * The patterns of mpm_ctxs[i] only match in the buffer with id i passed
+ * to SCHSMultiSearch(). The contexts must have been prepared. Databases
+ * built from the same contexts are shared.
+ *
+ * \retval ctx the database or NULL on error
  */
-void SCHSInitCtx(MpmCtx *mpm_ctx)
+SCHSMultiCtx *SCHSMultiBuild(const MpmCtx **mpm_ctxs, const uint16_t cnt)
 {
-    if (mpm_ctx->ctx != NULL)
-        return;
+    SCHSMultiCtx *ctx = SCCalloc(1, sizeof(*ctx));
+    if (ctx == NULL) {
+        return NULL;
+    }
+    ctx->pds = SCCalloc(cnt, sizeof(void *));
+    if (ctx->pds == NULL) {
+        SCFree(ctx);
+        return NULL;
+    }
+    ctx->pd_cnt = cnt;
 
-    mpm_ctx->ctx = SCMalloc(sizeof(SCHSCtx));
-    if (mpm_ctx->ctx == NULL) {
-        exit(EXIT_FAILURE);
+    SCMutexLock(&g_db_table_mutex);
+    if (g_multi_db_table == NULL) {
+        g_multi_db_table = HashTableInit(INIT_DB_HASH_SIZE, SCHSMultiHash,
+                SCHSMultiCompare, SCHSMultiTableFree);
+        if (g_multi_db_table == NULL) {
+            goto error;
+        }
     }
-    memset(mpm_ctx->ctx, 0, sizeof(SCHSCtx));
 
-    mpm_ctx->memory_cnt++;
-    mpm_ctx->memory_size += sizeof(SCHSCtx);
+    for (uint16_t i = 0; i < cnt; i++) {
+        const SCHSCtx *hs_ctx = mpm_ctxs[i]->ctx;
+        if (mpm_ctxs[i]->mpm_type != MPM_HS || hs_ctx == NULL) {
+            goto error;
+        }
+        PatternDatabase *pd = hs_ctx->pattern_db;
+        if (pd != NULL) {
+            pd->ref_cnt++;
+            ctx->pds[i] = pd;
+            ctx->pattern_cnt += pd->pattern_cnt;
+        }
+    }
+    if (ctx->pattern_cnt == 0) {
+        goto error;
+    }
 
-    /* initialize the hash we use to speed up pattern insertions */
-    SCHSCtx *ctx = (SCHSCtx *)mpm_ctx->ctx;
-    ctx->init_hash = SCMalloc(sizeof(SCHSPattern *) * INIT_HASH_SIZE);
-    if (ctx->init_hash == NULL) {
-        exit(EXIT_FAILURE);
+    SCHSMultiCtx *cached = HashTableLookup(g_multi_db_table, ctx, 1);
+    if (cached != NULL) {
+        cached->ref_cnt++;
+        SCHSMultiFreeLocked(ctx);
+        SCMutexUnlock(&g_db_table_mutex);
+        return cached;
     }
-    memset(ctx->init_hash, 0, sizeof(SCHSPattern *) * INIT_HASH_SIZE);
-}
 
-/**
- * \brief Destroy the mpm thread context.
- *
- * \param mpm_ctx        Pointer to the mpm context.
- * \param mpm_thread_ctx Pointer to the mpm thread context.
- */
-void SCHSDestroyThreadCtx(MpmCtx *mpm_ctx, MpmThreadCtx *mpm_thread_ctx)
-{
-    SCHSPrintSearchStats(mpm_thread_ctx);
+    /* the pattern databases are referenced, so this can be done unlocked */
+    SCMutexUnlock(&g_db_table_mutex);
+    ctx->parray = SCCalloc(ctx->pattern_cnt, sizeof(SCHSMultiPattern));
+    int r = (ctx->parray != NULL) ? SCHSMultiCompile(ctx) : -1;
+    SCMutexLock(&g_db_table_mutex);
+    if (r != 0) {
+        goto error;
+    }
 
-    if (mpm_thread_ctx->ctx != NULL) {
-        SCHSThreadCtx *thr_ctx = (SCHSThreadCtx *)mpm_thread_ctx->ctx;
+    /* another thread may have built the same database in the meantime */
+    cached = HashTableLookup(g_multi_db_table, ctx, 1);
+    if (cached != NULL) {
+        cached->ref_cnt++;
+        SCHSMultiFreeLocked(ctx);
+        SCMutexUnlock(&g_db_table_mutex);
+        return cached;
+    }
+    ctx->ref_cnt = 1;
+    if (HashTableAdd(g_multi_db_table, ctx, 1) != 0) {
+        goto error;
+    }
+    SCMutexUnlock(&g_db_table_mutex);
 
-        if (thr_ctx->scratch != NULL) {
-            hs_free_scratch(thr_ctx->scratch);
-            mpm_thread_ctx->memory_cnt--;
-            mpm_thread_ctx->memory_size -= thr_ctx->scratch_size;
-        }
+    SCLogDebug("built multi buffer database with %" PRIu32 " patterns "
+               "for %u buffers", ctx->pattern_cnt, cnt);
+    return ctx;
 
-        SCFree(mpm_thread_ctx->ctx);
-        mpm_thread_ctx->ctx = NULL;
-        mpm_thread_ctx->memory_cnt--;
-        mpm_thread_ctx->memory_size -= sizeof(SCHSThreadCtx);
-    }
+error:
+    SCHSMultiFreeLocked(ctx);
+    SCMutexUnlock(&g_db_table_mutex);
+    return NULL;
 }
 
-/**
- * \brief Destroy the mpm context.
- *
- * \param mpm_ctx Pointer to the mpm context.
- */
-void SCHSDestroyCtx(MpmCtx *mpm_ctx)
+/** \brief get another reference to a database from SCHSMultiBuild() */
+SCHSMultiCtx *SCHSMultiRef(SCHSMultiCtx *ctx)
 {
-    SCHSCtx *ctx = (SCHSCtx *)mpm_ctx->ctx;
-    if (ctx == NULL)
-        return;
+    SCMutexLock(&g_db_table_mutex);
+    BUG_ON(ctx->ref_cnt == 0);
+    ctx->ref_cnt++;
+    SCMutexUnlock(&g_db_table_mutex);
+    return ctx;
+}
 
-    if (ctx->init_hash != NULL) {
-        SCFree(ctx->init_hash);
-        ctx->init_hash = NULL;
-        mpm_ctx->memory_cnt--;
-        mpm_ctx->memory_size -= (INIT_HASH_SIZE * sizeof(SCHSPattern *));
+void SCHSMultiFree(SCHSMultiCtx *ctx)
+{
+    if (ctx == NULL) {
+        return;
     }
 
-    /* Decrement pattern database ref count, and delete it entirely if the
-     * count has dropped to zero. */
     SCMutexLock(&g_db_table_mutex);
-    PatternDatabase *pd = ctx->pattern_db;
-    if (pd) {
-        BUG_ON(pd->ref_cnt == 0);
-        pd->ref_cnt--;
-        if (pd->ref_cnt == 0) {
-            HashTableRemove(g_db_table, pd, 1);
-            PatternDatabaseFree(pd);
-        }
+    BUG_ON(ctx->ref_cnt == 0);
+    ctx->ref_cnt--;
+    if (ctx->ref_cnt == 0) {
+        HashTableRemove(g_multi_db_table, ctx, 1);
+        SCHSMultiFreeLocked(ctx);
     }
     SCMutexUnlock(&g_db_table_mutex);
+}
 
-    SCFree(mpm_ctx->ctx);
-    mpm_ctx->memory_cnt--;
-    mpm_ctx->memory_size -= sizeof(SCHSCtx);
+SCHSMultiThreadCtx *SCHSMultiThreadInit(const SCHSMultiCtx *ctx)
+{
+    SCHSMultiThreadCtx *thread_ctx = SCCalloc(1, sizeof(*thread_ctx));
+    if (thread_ctx == NULL) {
+        return NULL;
+    }
+    thread_ctx->seen = SCCalloc(ctx->pattern_cnt, sizeof(uint32_t));
+    if (thread_ctx->seen == NULL) {
+        SCFree(thread_ctx);
+        return NULL;
+    }
+    thread_ctx->pattern_cnt = ctx->pattern_cnt;
+    return thread_ctx;
 }
 
-typedef struct SCHSCallbackCtx_ {
-    SCHSCtx *ctx;
-    void *pmq;
+void SCHSMultiThreadFree(SCHSMultiThreadCtx *thread_ctx)
+{
+    if (thread_ctx == NULL) {
+        return;
+    }
+    SCFree(thread_ctx->seen);
+    SCFree(thread_ctx);
+}
+
+typedef struct SCHSMultiCallbackCtx_ {
+    const SCHSMultiCtx *ctx;
+    SCHSMultiThreadCtx *thread_ctx;
+    PrefilterRuleStore *pmq;
+    const uint32_t *lens;
+    const uint16_t *ids;
+    uint32_t cnt;
     uint32_t match_count;
-} SCHSCallbackCtx;
+} SCHSMultiCallbackCtx;
 
-/* Hyperscan MPM match event handler */
-static int SCHSMatchEvent(unsigned int id, unsigned long long from,
-                          unsigned long long to, unsigned int flags,
-                          void *ctx)
+/* Hyperscan multi buffer match event handler */
+static int SCHSMultiMatchEvent(unsigned int id, unsigned long long from,
+                               unsigned long long to, unsigned int flags,
+                               void *ctx)
 {
-    SCHSCallbackCtx *cctx = ctx;
-    PrefilterRuleStore *pmq = cctx->pmq;
-    const PatternDatabase *pd = cctx->ctx->pattern_db;
-    const SCHSPattern *pat = pd->parray[id];
+    SCHSMultiCallbackCtx *cctx = ctx;
+    SCHSMultiThreadCtx *thread_ctx = cctx->thread_ctx;
+    const SCHSMultiPattern *pat = &cctx->ctx->parray[id];
 
-    SCLogDebug("Hyperscan Match %" PRIu32 ": id=%" PRIu32 " @ %" PRIuMAX
-               " (pat id=%" PRIu32 ")",
-               cctx->match_count, (uint32_t)id, (uintmax_t)to, pat->id);
+    if (thread_ctx->seen[id] == thread_ctx->scan) {
+        return 0;
+    }
 
-    PrefilterAddSids(pmq, pat->sids, pat->sids_size);
+    /* find the buffer the match ends in */
+    unsigned long long start = 0;
+    uint32_t b = 0;
+    for ( ; b < cctx->cnt; b++) {
+        if (to <= start + cctx->lens[b])
+            break;
+        start += cctx->lens[b];
+    }
+    if (b == cctx->cnt || cctx->ids[b] != pat->buffer) {
+        return 0;
+    }
+    const unsigned long long end = to - start;
+    if (end < pat->min_end || end > pat->max_end) {
+        return 0;
+    }
+
+    SCLogDebug("Hyperscan Match %" PRIu32 ": id=%" PRIu32 " buffer %u @ %" PRIuMAX,
+               cctx->match_count, (uint32_t)id, pat->buffer, (uintmax_t)end);
 
+    thread_ctx->seen[id] = thread_ctx->scan;
+    PrefilterAddSids(cctx->pmq, pat->sids, pat->sids_size);
     cctx->match_count++;
     return 0;
 }
 
 /**
- * \brief The Hyperscan search function.
+ * \brief Scan multiple buffers in one call.
  *
- * \param mpm_ctx        Pointer to the mpm context.
- * \param mpm_thread_ctx Pointer to the mpm thread context.
- * \param pmq            Pointer to the Pattern Matcher Queue to hold
- *                       search matches.
- * \param buf            Buffer to be searched.
- * \param buflen         Buffer length.
+ * \param bufs  buffers to scan, none of them empty
+ * \param lens  lengths of the buffers
+ * \param ids   for each buffer the index of its mpm context in the
+ *              SCHSMultiBuild() call
+ * \param cnt   number of buffers
  *
  * \retval matches Match count.
  */
-uint32_t SCHSSearch(const MpmCtx *mpm_ctx, MpmThreadCtx *mpm_thread_ctx,
-                    PrefilterRuleStore *pmq, const uint8_t *buf, const uint32_t buflen)
+uint32_t SCHSMultiSearch(const SCHSMultiCtx *ctx, MpmThreadCtx *mpm_thread_ctx,
+        SCHSMultiThreadCtx *thread_ctx, PrefilterRuleStore *pmq,
+        const uint8_t **bufs, const uint32_t *lens, const uint16_t *ids,
+        const uint32_t cnt)
 {
-    uint32_t ret = 0;
-    SCHSCtx *ctx = (SCHSCtx *)mpm_ctx->ctx;
     SCHSThreadCtx *hs_thread_ctx = (SCHSThreadCtx *)(mpm_thread_ctx->ctx);
-    const PatternDatabase *pd = ctx->pattern_db;
 
-    if (unlikely(buflen == 0)) {
+    if (unlikely(cnt == 0)) {
         return 0;
     }
 
-    SCHSCallbackCtx cctx = {.ctx = ctx, .pmq = pmq, .match_count = 0};
+    if (unlikely(++thread_ctx->scan == 0)) {
+        memset(thread_ctx->seen, 0, thread_ctx->pattern_cnt * sizeof(uint32_t));
+        thread_ctx->scan = 1;
+    }
+
+    SCHSMultiCallbackCtx cctx = { .ctx = ctx, .thread_ctx = thread_ctx,
+        .pmq = pmq, .lens = lens, .ids = ids, .cnt = cnt, .match_count = 0 };
 
     /* scratch should have been cloned from g_scratch_proto at thread init. */
     hs_scratch_t *scratch = hs_thread_ctx->scratch;
-    BUG_ON(pd->hs_db == NULL);
+    BUG_ON(ctx->hs_db == NULL);
     BUG_ON(scratch == NULL);
 
-    hs_error_t err = hs_scan(pd->hs_db, (const char *)buf, buflen, 0, scratch,
-                             SCHSMatchEvent, &cctx);
+    hs_error_t err = hs_scan_vector(ctx->hs_db, (const char *const *)bufs,
+            lens, cnt, 0, scratch, SCHSMultiMatchEvent, &cctx);
     if (err != HS_SUCCESS) {
-        /* An error value (other than HS_SCAN_TERMINATED) from hs_scan()
-         * indicates that it was passed an invalid database or scratch region,
-         * which is not something we can recover from at scan time. */
+        /* see SCHSSearch() */
         SCLogError(SC_ERR_FATAL, "Hyperscan returned error %d", err);
         exit(EXIT_FAILURE);
-    } else {
-        ret = cctx.match_count;
     }
-
-    return ret;
+    return cctx.match_count;
 }
 
 /**
@@ -1090,6 +2131,10 @@ void MpmHSGlobalCleanup(void)
         HashTableFree(g_db_table);
         g_db_table = NULL;
     }
+    if (g_multi_db_table != NULL) {
+        HashTableFree(g_multi_db_table);
+        g_multi_db_table = NULL;
+    }
     SCMutexUnlock(&g_db_table_mutex);
 }
 
@@ -2145,6 +3190,246 @@ end:
     return result;
 }
 
+/**
+ * \test Check that a database is stored in and loaded from the cache.
+ */
+static int SCHSTest30(void)
+{
+    MpmCtx mpm_ctx;
+    MpmThreadCtx mpm_thread_ctx;
+    PrefilterRuleStore pmq;
+    char dir[] = "/tmp/suricata-hs-cache-XXXXXX";
+    char file[PATH_MAX];
+    const char *buf = "abcdefghjiklmnopqrstuvwxyz";
+
+    FAIL_IF_NULL(mkdtemp(dir));
+    ConfCreateContextBackup();
+    ConfInit();
+    FAIL_IF_NOT(ConfSet("detect.sgh-mpm-caching", "yes"));
+    FAIL_IF_NOT(ConfSet("detect.sgh-mpm-caching-path", dir));
+    PmqSetup(&pmq);
+
+    /* compile and store */
+    memset(&mpm_ctx, 0, sizeof(MpmCtx));
+    MpmInitCtx(&mpm_ctx, MPM_HS);
+    MpmAddPatternCS(&mpm_ctx, (uint8_t *)"cdef", 4, 0, 0, 0, 0, 0);
+    MpmAddPatternCI(&mpm_ctx, (uint8_t *)"XYZ", 3, 0, 0, 0, 1, 0);
+    FAIL_IF(SCHSPreparePatterns(&mpm_ctx) != 0);
+    SCHSCtx *ctx = (SCHSCtx *)mpm_ctx.ctx;
+    uint32_t h[4];
+    SCHSCacheHashInit(h, NULL);
+    SCHSCacheHashPatterns(h, ctx->pattern_db);
+    FAIL_IF(SCHSCacheFileName(h, dir, file, sizeof(file)) != 0);
+    FAIL_IF(access(file, R_OK) != 0);
+    /* last reference, so the database is dropped from the global table */
+    SCHSDestroyCtx(&mpm_ctx);
+
+    /* load */
+    memset(&mpm_ctx, 0, sizeof(MpmCtx));
+    memset(&mpm_thread_ctx, 0, sizeof(MpmThreadCtx));
+    MpmInitCtx(&mpm_ctx, MPM_HS);
+    MpmAddPatternCS(&mpm_ctx, (uint8_t *)"cdef", 4, 0, 0, 0, 0, 0);
+    MpmAddPatternCI(&mpm_ctx, (uint8_t *)"XYZ", 3, 0, 0, 0, 1, 0);
+    FAIL_IF(SCHSPreparePatterns(&mpm_ctx) != 0);
+    SCHSInitThreadCtx(&mpm_ctx, &mpm_thread_ctx);
+
+    uint32_t cnt = SCHSSearch(&mpm_ctx, &mpm_thread_ctx, &pmq, (uint8_t *)buf,
+                              strlen(buf));
+    FAIL_IF(cnt != 2);
+
+    SCHSDestroyCtx(&mpm_ctx);
+    SCHSDestroyThreadCtx(&mpm_ctx, &mpm_thread_ctx);
+    PmqFree(&pmq);
+    ConfRestoreContextBackup();
+    unlink(file);
+    rmdir(dir);
+    PASS;
+}
+
+/**
+ * \test Check that the patterns of a multi buffer database only match in
+ *       their own buffer, within offset and depth.
+ */
+static int SCHSTest31(void)
+{
+    MpmCtx mpm_ctx0, mpm_ctx1;
+    MpmThreadCtx mpm_thread_ctx;
+    PrefilterRuleStore pmq;
+
+    memset(&mpm_ctx0, 0, sizeof(MpmCtx));
+    memset(&mpm_ctx1, 0, sizeof(MpmCtx));
+    memset(&mpm_thread_ctx, 0, sizeof(MpmThreadCtx));
+    MpmInitCtx(&mpm_ctx0, MPM_HS);
+    MpmInitCtx(&mpm_ctx1, MPM_HS);
+    PmqSetup(&pmq);
+
+    MpmAddPatternCS(&mpm_ctx0, (uint8_t *)"abcd", 4, 0, 0, 0, 0, 0);
+    MpmAddPatternCS(&mpm_ctx0, (uint8_t *)"efgh", 4, 0, 4, 1, 1, 0);
+    MpmAddPatternCI(&mpm_ctx1, (uint8_t *)"XYZ", 3, 0, 0, 0, 2, 0);
+    MpmAddPatternCS(&mpm_ctx1, (uint8_t *)"cdxy", 4, 0, 0, 1, 3, 0);
+    FAIL_IF(SCHSPreparePatterns(&mpm_ctx0) != 0);
+    FAIL_IF(SCHSPreparePatterns(&mpm_ctx1) != 0);
+
+    const MpmCtx *mpm_ctxs[2] = { &mpm_ctx0, &mpm_ctx1 };
+    SCHSMultiCtx *ctx = SCHSMultiBuild(mpm_ctxs, 2);
+    FAIL_IF_NULL(ctx);
+    /* same contexts, same database */
+    SCHSMultiCtx *ctx2 = SCHSMultiBuild(mpm_ctxs, 2);
+    FAIL_IF(ctx2 != ctx);
+    SCHSMultiFree(ctx2);
+
+    SCHSInitThreadCtx(&mpm_ctx0, &mpm_thread_ctx);
+    SCHSMultiThreadCtx *thread_ctx = SCHSMultiThreadInit(ctx);
+    FAIL_IF_NULL(thread_ctx);
+
+    /* 'efgh' is past its depth, 'cdxy' crosses the buffers */
+    const uint8_t *bufs[2] = { (const uint8_t *)"xxefghabcd", (const uint8_t *)"xyz" };
+    uint32_t lens[2] = { 10, 3 };
+    uint16_t ids[2] = { 0, 1 };
+    uint32_t cnt = SCHSMultiSearch(ctx, &mpm_thread_ctx, thread_ctx, &pmq,
+            bufs, lens, ids, 2);
+    FAIL_IF(cnt != 2);
+    FAIL_IF(pmq.rule_id_array_cnt != 2);
+    PmqReset(&pmq);
+
+    /* patterns of buffer 0 in buffer 1 */
+    bufs[0] = (const uint8_t *)"efghabcd";
+    lens[0] = 8;
+    ids[0] = 1;
+    cnt = SCHSMultiSearch(ctx, &mpm_thread_ctx, thread_ctx, &pmq,
+            bufs, lens, ids, 1);
+    FAIL_IF(cnt != 0);
+
+    ids[0] = 0;
+    cnt = SCHSMultiSearch(ctx, &mpm_thread_ctx, thread_ctx, &pmq,
+            bufs, lens, ids, 1);
+    FAIL_IF(cnt != 2);
+
+    SCHSMultiThreadFree(thread_ctx);
+    SCHSMultiFree(ctx);
+    SCHSDestroyCtx(&mpm_ctx0);
+    SCHSDestroyCtx(&mpm_ctx1);
+    SCHSDestroyThreadCtx(&mpm_ctx0, &mpm_thread_ctx);
+    PmqFree(&pmq);
+    PASS;
+}
+
+static int SCHSTest32(void)
+{
+    MpmCtx mpm_ctx;
+    MpmThreadCtx mpm_thread_ctx;
+    PrefilterRuleStore pmq;
+    SCHSStreamState *state = NULL;
+
+    memset(&mpm_ctx, 0, sizeof(MpmCtx));
+    memset(&mpm_thread_ctx, 0, sizeof(MpmThreadCtx));
+    MpmInitCtx(&mpm_ctx, MPM_HS);
+    mpm_ctx.flags |= MPMCTX_FLAGS_STREAMING;
+    PmqSetup(&pmq);
+
+    MpmAddPatternCS(&mpm_ctx, (uint8_t *)"abcd", 4, 0, 0, 0, 0, 0);
+    MpmAddPatternCS(&mpm_ctx, (uint8_t *)"wxyz", 4, 0, 0, 1, 1, 0);
+    FAIL_IF(SCHSPreparePatterns(&mpm_ctx) != 0);
+    SCHSInitThreadCtx(&mpm_ctx, &mpm_thread_ctx);
+    const uint64_t memuse = SCHSStreamGetMemuse();
+
+    uint32_t cnt = SCHSStreamSearch(&mpm_ctx, &mpm_thread_ctx, &state, &pmq,
+            (uint8_t *)"xxab", 4, 0);
+    FAIL_IF(cnt != 0);
+    FAIL_IF_NULL(state);
+    FAIL_IF(SCHSStreamGetMemuse() <= memuse);
+
+    /* window grows, only 'cdwx' is scanned */
+    cnt = SCHSStreamSearch(&mpm_ctx, &mpm_thread_ctx, &state, &pmq,
+            (uint8_t *)"xxabcdwx", 8, 0);
+    FAIL_IF(cnt != 1);
+    FAIL_IF(pmq.rule_id_array_cnt != 1);
+    PmqReset(&pmq);
+
+    /* 'abcd' starts before the window */
+    cnt = SCHSStreamSearch(&mpm_ctx, &mpm_thread_ctx, &state, &pmq,
+            (uint8_t *)"cdwxyz", 6, 4);
+    FAIL_IF(cnt != 1);
+    FAIL_IF(pmq.rule_id_array_cnt != 1 || pmq.rule_id_array[0] != 1);
+    PmqReset(&pmq);
+
+    /* window moved back, block scan */
+    cnt = SCHSStreamSearch(&mpm_ctx, &mpm_thread_ctx, &state, &pmq,
+            (uint8_t *)"xxabcdwxyz", 10, 0);
+    FAIL_IF(cnt != 2);
+    PmqReset(&pmq);
+
+    /* gap, the stream restarts */
+    cnt = SCHSStreamSearch(&mpm_ctx, &mpm_thread_ctx, &state, &pmq,
+            (uint8_t *)"yzabcd", 6, 100);
+    FAIL_IF(cnt != 1);
+    FAIL_IF(pmq.rule_id_array_cnt != 1 || pmq.rule_id_array[0] != 0);
+    PmqReset(&pmq);
+
+    SCHSStreamStateFree(state);
+    FAIL_IF(SCHSStreamGetMemuse() != memuse);
+
+    SCHSDestroyCtx(&mpm_ctx);
+    SCHSDestroyThreadCtx(&mpm_ctx, &mpm_thread_ctx);
+    PmqFree(&pmq);
+    PASS;
+}
+
+static int SCHSTest33(void)
+{
+    MpmCtx mpm_ctx;
+    MpmThreadCtx mpm_thread_ctx;
+    PrefilterRuleStore pmq;
+    SCHSStreamState *state = NULL;
+    char buf[256] = "";
+
+    memset(&mpm_ctx, 0, sizeof(MpmCtx));
+    memset(&mpm_thread_ctx, 0, sizeof(MpmThreadCtx));
+    MpmInitCtx(&mpm_ctx, MPM_HS);
+    mpm_ctx.flags |= MPMCTX_FLAGS_STREAMING;
+    PmqSetup(&pmq);
+
+    /* more patterns match than the initial size of the match table */
+    for (uint32_t i = 0; i < 40; i++) {
+        char pat[4];
+        snprintf(pat, sizeof(pat), "p%02u", i);
+        MpmAddPatternCS(&mpm_ctx, (uint8_t *)pat, 3, 0, 0, i, i, 0);
+        strlcat(buf, pat, sizeof(buf));
+    }
+    FAIL_IF(SCHSPreparePatterns(&mpm_ctx) != 0);
+    SCHSInitThreadCtx(&mpm_ctx, &mpm_thread_ctx);
+
+    const uint32_t len = strlen(buf);
+    uint32_t cnt = SCHSStreamSearch(&mpm_ctx, &mpm_thread_ctx, &state, &pmq,
+            (uint8_t *)buf, len, 0);
+    FAIL_IF(cnt != 40);
+    FAIL_IF_NULL(state);
+    FAIL_IF(state->disabled || state->overflow);
+    FAIL_IF(state->match_size < 40);
+    PmqReset(&pmq);
+
+    /* window grows, matches are remembered */
+    strlcat(buf, "xx", sizeof(buf));
+    cnt = SCHSStreamSearch(&mpm_ctx, &mpm_thread_ctx, &state, &pmq,
+            (uint8_t *)buf, len + 2, 0);
+    FAIL_IF(cnt != 40);
+    FAIL_IF(state->scanned != len + 2);
+    PmqReset(&pmq);
+
+    /* window moves past the first 20 patterns */
+    cnt = SCHSStreamSearch(&mpm_ctx, &mpm_thread_ctx, &state, &pmq,
+            (uint8_t *)buf + 60, len + 2 - 60, 60);
+    FAIL_IF(cnt != 20);
+    FAIL_IF(state->match_cnt != 20);
+    PmqReset(&pmq);
+
+    SCHSStreamStateFree(state);
+    SCHSDestroyCtx(&mpm_ctx);
+    SCHSDestroyThreadCtx(&mpm_ctx, &mpm_thread_ctx);
+    PmqFree(&pmq);
+    PASS;
+}
+
 #endif /* UNITTESTS */
 
 void SCHSRegisterTests(void)
@@ -2179,6 +3464,10 @@ void SCHSRegisterTests(void)
     UtRegisterTest("SCHSTest27", SCHSTest27);
     UtRegisterTest("SCHSTest28", SCHSTest28);
     UtRegisterTest("SCHSTest29", SCHSTest29);
+    UtRegisterTest("SCHSTest30", SCHSTest30);
+    UtRegisterTest("SCHSTest31", SCHSTest31);
+    UtRegisterTest("SCHSTest32", SCHSTest32);
+    UtRegisterTest("SCHSTest33", SCHSTest33);
 #endif
 
     return;
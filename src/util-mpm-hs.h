@@ -69,6 +69,63 @@ typedef struct SCHSThreadCtx_ {
     size_t scratch_size;
 } SCHSThreadCtx;
 
+/** pattern of a multi buffer database */
+typedef struct SCHSMultiPattern_ {
+    uint16_t len;
+    /* index of the buffer the pattern is for */
+    uint16_t buffer;
+    /* range the end of a match in the buffer has to be in, from the
+     * pattern's offset and depth */
+    uint32_t min_end;
+    uint32_t max_end;
+
+    uint32_t sids_size;
+    SigIntId *sids;
+} SCHSMultiPattern;
+
+/** Vectored database holding the patterns of multiple buffers, so that
+ *  the buffers are scanned in a single call. */
+typedef struct SCHSMultiCtx_ {
+    /* pattern databases of the buffers, referenced while we exist */
+    void **pds;
+    uint16_t pd_cnt;
+
+    void *hs_db;
+    SCHSMultiPattern *parray;
+    uint32_t pattern_cnt;
+
+    /* number of users, databases are shared between rule groups */
+    uint32_t ref_cnt;
+} SCHSMultiCtx;
+
+typedef struct SCHSMultiThreadCtx_ {
+    /* scan that last reported each pattern, so that a pattern is reported
+     * once per scan */
+    uint32_t *seen;
+    uint32_t scan;
+    uint32_t pattern_cnt;
+} SCHSMultiThreadCtx;
+
+SCHSMultiCtx *SCHSMultiBuild(const MpmCtx **mpm_ctxs, const uint16_t cnt);
+SCHSMultiCtx *SCHSMultiRef(SCHSMultiCtx *ctx);
+void SCHSMultiFree(SCHSMultiCtx *ctx);
+SCHSMultiThreadCtx *SCHSMultiThreadInit(const SCHSMultiCtx *ctx);
+void SCHSMultiThreadFree(SCHSMultiThreadCtx *thread_ctx);
+uint32_t SCHSMultiSearch(const SCHSMultiCtx *ctx, MpmThreadCtx *mpm_thread_ctx,
+        SCHSMultiThreadCtx *thread_ctx, PrefilterRuleStore *pmq,
+        const uint8_t **bufs, const uint32_t *lens, const uint16_t *ids,
+        const uint32_t cnt);
+
+/** per flow direction state of a streaming scan, see SCHSStreamSearch() */
+typedef struct SCHSStreamState_ SCHSStreamState;
+
+void SCHSStreamSetMemcap(const uint64_t size);
+uint64_t SCHSStreamGetMemuse(void);
+void SCHSStreamStateFree(SCHSStreamState *state);
+uint32_t SCHSStreamSearch(const MpmCtx *mpm_ctx, MpmThreadCtx *mpm_thread_ctx,
+        SCHSStreamState **state, PrefilterRuleStore *pmq,
+        const uint8_t *buf, const uint32_t buflen, const uint64_t offset);
+
 void MpmHSRegister(void);
 
 void MpmHSGlobalCleanup(void);
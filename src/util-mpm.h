@@ -84,6 +84,8 @@ typedef struct MpmPattern_ {
  * one per sgh. */
 #define MPMCTX_FLAGS_GLOBAL     BIT_U8(0)
 #define MPMCTX_FLAGS_NODEPTH    BIT_U8(1)
+/** also build a streaming database, see SCHSStreamSearch() */
+#define MPMCTX_FLAGS_STREAMING  BIT_U8(2)
 
 typedef struct MpmCtx_ {
     void *ctx;
@@ -0,0 +1,132 @@
+/* Copyright (C) 2020 Open Information Security Foundation
+ *
+ * You can copy, redistribute or modify this Program under the terms of
+ * the GNU General Public License version 2 as published by the Free
+ * Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * version 2 along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/**
+ * \file
+ *
+ * NUMA aware memory placement.
+ *
+ * When 'threading.numa-aware' is enabled, a thread that is pinned to cpus
+ * of a single NUMA node sets its memory policy to prefer that node. The
+ * per thread structures it allocates itself (packet pool, stream segment
+ * and session pools, flows it allocates in the flow engine, its flow hash
+ * in 'flow.thread-local' mode) then live on the node of the thread.
+ *
+ * The node of a thread and of an allocation can be queried, so that the
+ * flow engine can keep spare flows per node and count remote accesses.
+ */
+
+#include "suricata-common.h"
+#include "threads.h"
+#include "conf.h"
+#include "util-debug.h"
+#include "util-numa.h"
+
+#ifdef HAVE_LIBNUMA
+#include <numa.h>
+#endif
+
+static bool numa_enabled = false;
+static int numa_nodes = 0;
+
+/** node the calling thread is bound to, NUMA_NODE_NONE if unbound */
+static thread_local int numa_thread_node = NUMA_NODE_NONE;
+
+/**
+ *  \brief read the 'threading.numa-aware' setting
+ *
+ *  \warning Not thread safe, call before the threads are started.
+ */
+void NumaSetupFromConfig(void)
+{
+    int enabled = 0;
+    if (ConfGetBool("threading.numa-aware", &enabled) != 1 || enabled == 0)
+        return;
+
+#ifdef HAVE_LIBNUMA
+    if (numa_available() < 0) {
+        SCLogWarning(SC_ERR_NOT_SUPPORTED, "threading.numa-aware is enabled, "
+                "but the system has no NUMA support. Disabling.");
+        return;
+    }
+    numa_nodes = numa_max_node() + 1;
+    numa_enabled = true;
+    SCLogConfig("NUMA aware allocation enabled: %d node(s)", numa_nodes);
+#else
+    SCLogWarning(SC_ERR_NOT_SUPPORTED, "threading.numa-aware is enabled, "
+            "but Suricata was built without libnuma. Disabling.");
+#endif
+}
+
+bool NumaEnabled(void)
+{
+    return numa_enabled;
+}
+
+/** \retval nodes number of nodes, 0 if NUMA awareness is disabled */
+int NumaNodeCount(void)
+{
+    return numa_nodes;
+}
+
+/**
+ *  \brief bind the memory policy of the calling thread to its node
+ *
+ *  Call after setting up the cpu affinity of the thread. If all cpus the
+ *  thread may run on are part of the same node, the thread prefers memory
+ *  of that node. Otherwise the thread is left alone.
+ */
+void NumaThreadBind(void)
+{
+#ifdef HAVE_LIBNUMA
+    if (!numa_enabled)
+        return;
+
+    cpu_set_t cs;
+    CPU_ZERO(&cs);
+    if (sched_getaffinity(0, sizeof(cs), &cs) != 0)
+        return;
+
+    int node = NUMA_NODE_NONE;
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+        if (!CPU_ISSET(cpu, &cs))
+            continue;
+
+        int n = numa_node_of_cpu(cpu);
+        if (n < 0)
+            return;
+        if (node == NUMA_NODE_NONE) {
+            node = n;
+        } else if (node != n) {
+            SCLogDebug("thread cpus span more than one node");
+            return;
+        }
+    }
+    if (node == NUMA_NODE_NONE)
+        return;
+
+    numa_set_preferred(node);
+    numa_thread_node = node;
+    SCLogPerf("thread %lu bound to NUMA node %d", SCGetThreadIdLong(), node);
+#endif
+}
+
+/** \retval node the node the calling thread is bound to, or NUMA_NODE_NONE */
+int NumaThreadNode(void)
+{
+    return numa_thread_node;
+}
@@ -0,0 +1,38 @@
+/* Copyright (C) 2020 Open Information Security Foundation
+ *
+ * You can copy, redistribute or modify this Program under the terms of
+ * the GNU General Public License version 2 as published by the Free
+ * Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * version 2 along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/**
+ * \file
+ *
+ * NUMA aware memory placement. Threads pinned to the cpus of a single
+ * NUMA node prefer memory of that node for their allocations.
+ */
+
+#ifndef __UTIL_NUMA_H__
+#define __UTIL_NUMA_H__
+
+/** node id for memory or threads without a known node */
+#define NUMA_NODE_NONE  -1
+
+void NumaSetupFromConfig(void);
+bool NumaEnabled(void);
+int NumaNodeCount(void);
+
+void NumaThreadBind(void);
+int NumaThreadNode(void);
+
+#endif /* __UTIL_NUMA_H__ */
@@ -36,6 +36,15 @@
 #endif
 #endif
 
+/** prefetch the cache line at 'addr' for reading */
+#if CPPCHECK==1
+#define prefetch(addr)
+#else
+#ifndef prefetch
+#define prefetch(addr) __builtin_prefetch((addr), 0, 3)
+#endif
+#endif
+
 /** from http://en.wikipedia.org/wiki/Memory_ordering
  *
  *  C Compiler memory barrier
@@ -43,6 +43,7 @@
 #include "util-pool-thread.h"
 #include "util-unittest.h"
 #include "util-debug.h"
+#include "util-hugepage.h"
 
 static int PoolMemset(void *pitem, void *initdata)
 {
@@ -142,12 +143,21 @@ Pool *PoolInit(uint32_t size, uint32_t prealloc_size, uint32_t elt_size,
             pb++;
         }
 
-        p->data_buffer = SCCalloc(prealloc_size, elt_size);
+        p->data_buffer = HugePageAlloc((size_t)prealloc_size * elt_size);
         /* FIXME better goto */
         if (p->data_buffer == NULL) {
             SCLogError(SC_ERR_POOL_INIT, "alloc error");
             goto error;
         }
+    } else if (HugePageEnabled() && prealloc_size > 0 && elt_size > 0) {
+        /* unlimited pool: place the preallocated items in one huge page
+         * backed block as well. Memuse accounting is done by the Init and
+         * Cleanup callbacks, so it is not affected by skipping Alloc. */
+        p->data_buffer = HugePageAlloc((size_t)prealloc_size * elt_size);
+        if (p->data_buffer == NULL) {
+            SCLogError(SC_ERR_POOL_INIT, "alloc error");
+            goto error;
+        }
     }
     /* prealloc the buckets and requeue them to the alloc list */
     for (u32 = 0; u32 < prealloc_size; u32++) {
@@ -159,7 +169,9 @@ Pool *PoolInit(uint32_t size, uint32_t prealloc_size, uint32_t elt_size,
             }
             memset(pb, 0, sizeof(PoolBucket));
 
-            if (p->Alloc) {
+            if (p->data_buffer) {
+                pb->data = (char *)p->data_buffer + u32 * elt_size;
+            } else if (p->Alloc) {
                 pb->data = p->Alloc();
             } else {
                 pb->data = SCMalloc(p->elt_size);
@@ -171,10 +183,12 @@ Pool *PoolInit(uint32_t size, uint32_t prealloc_size, uint32_t elt_size,
             }
             if (p->Init(pb->data, p->InitData) != 1) {
                 SCLogError(SC_ERR_POOL_INIT, "init error");
-                if (p->Free)
-                    p->Free(pb->data);
-                else
-                    SCFree(pb->data);
+                if (PoolDataPreAllocated(p, pb->data) == 0) {
+                    if (p->Free)
+                        p->Free(pb->data);
+                    else
+                        SCFree(pb->data);
+                }
                 SCFree(pb);
                 goto error;
             }
@@ -261,7 +275,7 @@ void PoolFree(Pool *p)
     if (p->pb_buffer)
         SCFree(p->pb_buffer);
     if (p->data_buffer)
-        SCFree(p->data_buffer);
+        HugePageFree(p->data_buffer);
     SCFree(p);
 }
 
@@ -0,0 +1,434 @@
+/* Copyright (C) 2020 Open Information Security Foundation
+ *
+ * You can copy, redistribute or modify this Program under the terms of
+ * the GNU General Public License version 2 as published by the Free
+ * Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * version 2 along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/**
+ * \file
+ *
+ * Read only longest prefix match tables compiled from a radix tree.
+ *
+ * A best match lookup in the radix tree follows a pointer per bit that
+ * differs and then climbs back up, chopping the ip against each netmask
+ * it finds on the way. Once a tree is complete it can be compiled into a
+ * multibit trie: a 65536 entry table indexed by the first 16 bits of the
+ * ip, and chunks of 256 entries indexed by each next byte. Netblocks are
+ * expanded over all the entries they cover (controlled prefix expansion)
+ * and pushed down into the chunks, so every entry holds its best match
+ * and a lookup is 1 memory access for most ips and at most 3 for ipv4.
+ *
+ * This is the DIR-16-8-8 variant of DIR-24-8: a 2^24 entry first level
+ * per tree is too much with one tree per reputation category. Ipv6 uses
+ * the same layout with up to 15 levels.
+ */
+
+#include "suricata-common.h"
+#include "util-debug.h"
+#include "util-radix-tree.h"
+#include "util-radix-lpm.h"
+#include "util-unittest.h"
+
+#define SC_RADIX_LPM_ROOT_SIZE      65536
+#define SC_RADIX_LPM_CHUNK_SIZE     256
+
+typedef struct SCRadixLpmEntry_ {
+    const uint8_t *stream;
+    uint16_t bitlen;
+    uint8_t netmask;
+    uint32_t result;
+} SCRadixLpmEntry;
+
+typedef struct SCRadixLpmBuilder_ {
+    SCRadixLpm *lpm;
+    SCRadixLpmEntry *entries;
+    uint32_t entries_cnt;
+    uint64_t memuse;
+} SCRadixLpmBuilder;
+
+static int SCRadixLpmCount(const SCRadixNode *node, uint32_t *cnt)
+{
+    if (node == NULL)
+        return 0;
+
+    if (node->prefix != NULL) {
+        const SCRadixPrefix *prefix = node->prefix;
+        if (prefix->bitlen != 32 && prefix->bitlen != 128)
+            return -1;
+
+        for (const SCRadixUserData *ud = prefix->user_data; ud != NULL; ud = ud->next) {
+            if (ud->netmask > prefix->bitlen)
+                return -1;
+            (*cnt)++;
+        }
+    }
+
+    if (SCRadixLpmCount(node->left, cnt) < 0)
+        return -1;
+    return SCRadixLpmCount(node->right, cnt);
+}
+
+static void SCRadixLpmCollect(SCRadixNode *node, SCRadixLpmBuilder *b)
+{
+    if (node == NULL)
+        return;
+
+    if (node->prefix != NULL) {
+        for (SCRadixUserData *ud = node->prefix->user_data; ud != NULL; ud = ud->next) {
+            SCRadixLpm *lpm = b->lpm;
+            lpm->results[lpm->results_cnt].node = node;
+            lpm->results[lpm->results_cnt].user = ud->user;
+
+            SCRadixLpmEntry *e = &b->entries[b->entries_cnt++];
+            e->stream = node->prefix->stream;
+            e->bitlen = node->prefix->bitlen;
+            e->netmask = ud->netmask;
+            e->result = lpm->results_cnt++;
+        }
+    }
+
+    SCRadixLpmCollect(node->left, b);
+    SCRadixLpmCollect(node->right, b);
+}
+
+static int SCRadixLpmEntryCompare(const void *a, const void *b)
+{
+    const SCRadixLpmEntry *e1 = a;
+    const SCRadixLpmEntry *e2 = b;
+    return (int)e1->netmask - (int)e2->netmask;
+}
+
+/**
+ * \brief grow the table by a chunk and fill it with a value
+ *
+ * \retval offset offset of the chunk in the table, 0 on error
+ */
+static uint32_t SCRadixLpmNewChunk(SCRadixLpmBuilder *b, SCRadixLpmTable *t,
+                                   uint32_t val)
+{
+    if (b->memuse + SC_RADIX_LPM_CHUNK_SIZE * sizeof(uint32_t) > SC_RADIX_LPM_MEMCAP)
+        return 0;
+
+    if (t->size + SC_RADIX_LPM_CHUNK_SIZE > t->alloc) {
+        uint32_t alloc = t->alloc * 2;
+        uint32_t *tbl = SCRealloc(t->tbl, alloc * sizeof(uint32_t));
+        if (unlikely(tbl == NULL))
+            return 0;
+        t->tbl = tbl;
+        t->alloc = alloc;
+    }
+
+    uint32_t offset = t->size;
+    for (uint32_t u = 0; u < SC_RADIX_LPM_CHUNK_SIZE; u++) {
+        t->tbl[offset + u] = val;
+    }
+    t->size += SC_RADIX_LPM_CHUNK_SIZE;
+    b->memuse += SC_RADIX_LPM_CHUNK_SIZE * sizeof(uint32_t);
+    return offset;
+}
+
+static void SCRadixLpmSet(SCRadixLpmTable *t, uint32_t slot, uint32_t val)
+{
+    uint32_t e = t->tbl[slot];
+    if (e & SC_RADIX_LPM_CHILD) {
+        /* netblocks are added shortest first, so anything below is covered
+         * by this netblock as well */
+        uint32_t offset = e & ~SC_RADIX_LPM_CHILD;
+        for (uint32_t u = 0; u < SC_RADIX_LPM_CHUNK_SIZE; u++) {
+            SCRadixLpmSet(t, offset + u, val);
+        }
+    } else {
+        t->tbl[slot] = val;
+    }
+}
+
+static int SCRadixLpmInsert(SCRadixLpmBuilder *b, const SCRadixLpmEntry *entry)
+{
+    SCRadixLpmTable *t = (entry->bitlen == 32) ? &b->lpm->v4 : &b->lpm->v6;
+
+    if (t->tbl == NULL) {
+        size_t size = SC_RADIX_LPM_ROOT_SIZE * sizeof(uint32_t);
+        if (b->memuse + size > SC_RADIX_LPM_MEMCAP)
+            return -1;
+        t->tbl = SCCalloc(SC_RADIX_LPM_ROOT_SIZE, sizeof(uint32_t));
+        if (unlikely(t->tbl == NULL))
+            return -1;
+        t->size = t->alloc = SC_RADIX_LPM_ROOT_SIZE;
+        b->memuse += size;
+    }
+
+    const uint8_t *stream = entry->stream;
+    uint32_t base = 0;
+    uint32_t idx = (stream[0] << 8) | stream[1];
+    uint32_t level_bits = 16;
+    uint32_t byte = 2;
+
+    while (entry->netmask > level_bits) {
+        uint32_t e = t->tbl[base + idx];
+        if (!(e & SC_RADIX_LPM_CHILD)) {
+            uint32_t offset = SCRadixLpmNewChunk(b, t, e);
+            if (offset == 0)
+                return -1;
+            e = SC_RADIX_LPM_CHILD | offset;
+            t->tbl[base + idx] = e;
+        }
+        base = e & ~SC_RADIX_LPM_CHILD;
+        idx = stream[byte++];
+        level_bits += 8;
+    }
+
+    /* the netblock covers 2^(level_bits - netmask) entries of this level */
+    uint32_t span = 1U << (level_bits - entry->netmask);
+    uint32_t first = idx & ~(span - 1);
+    for (uint32_t u = first; u < first + span; u++) {
+        SCRadixLpmSet(t, base + u, entry->result);
+    }
+    return 0;
+}
+
+static void SCRadixLpmShrink(SCRadixLpmTable *t)
+{
+    if (t->tbl != NULL && t->size < t->alloc) {
+        uint32_t *tbl = SCRealloc(t->tbl, t->size * sizeof(uint32_t));
+        if (tbl != NULL) {
+            t->tbl = tbl;
+            t->alloc = t->size;
+        }
+    }
+}
+
+/**
+ * \brief compile the netblocks of an ip radix tree into lookup tables
+ *
+ * The tables point to the nodes and user data of the tree, so they have
+ * to be freed before the tree is changed.
+ *
+ * \retval lpm the tables, or NULL if the tree holds non ip keys, the
+ *             tables would exceed SC_RADIX_LPM_MEMCAP or on error
+ */
+SCRadixLpm *SCRadixLpmBuild(const SCRadixTree *tree)
+{
+    uint32_t cnt = 0;
+
+    if (tree == NULL || SCRadixLpmCount(tree->head, &cnt) < 0 || cnt >= SC_RADIX_LPM_CHILD)
+        return NULL;
+
+    SCRadixLpmBuilder b;
+    memset(&b, 0, sizeof(b));
+
+    b.lpm = SCCalloc(1, sizeof(SCRadixLpm));
+    if (unlikely(b.lpm == NULL))
+        return NULL;
+    /* result 0 is 'no match' */
+    b.lpm->results = SCCalloc(cnt + 1, sizeof(SCRadixLpmResult));
+    if (unlikely(b.lpm->results == NULL))
+        goto error;
+    b.lpm->results_cnt = 1;
+    if (cnt > 0) {
+        b.entries = SCCalloc(cnt, sizeof(SCRadixLpmEntry));
+        if (unlikely(b.entries == NULL))
+            goto error;
+    }
+
+    SCRadixLpmCollect(tree->head, &b);
+    qsort(b.entries, b.entries_cnt, sizeof(SCRadixLpmEntry), SCRadixLpmEntryCompare);
+
+    for (uint32_t i = 0; i < b.entries_cnt; i++) {
+        if (SCRadixLpmInsert(&b, &b.entries[i]) < 0) {
+            SCLogDebug("tree %p: tables exceed %u bytes", tree, SC_RADIX_LPM_MEMCAP);
+            goto error;
+        }
+    }
+    SCRadixLpmShrink(&b.lpm->v4);
+    SCRadixLpmShrink(&b.lpm->v6);
+
+    SCLogDebug("tree %p: %u netblocks compiled into %"PRIu64" bytes", tree,
+            b.entries_cnt, b.memuse);
+    SCFree(b.entries);
+    return b.lpm;
+
+error:
+    if (b.entries != NULL)
+        SCFree(b.entries);
+    SCRadixLpmFree(b.lpm);
+    return NULL;
+}
+
+void SCRadixLpmFree(SCRadixLpm *lpm)
+{
+    if (lpm == NULL)
+        return;
+
+    if (lpm->v4.tbl != NULL)
+        SCFree(lpm->v4.tbl);
+    if (lpm->v6.tbl != NULL)
+        SCFree(lpm->v6.tbl);
+    if (lpm->results != NULL)
+        SCFree(lpm->results);
+    SCFree(lpm);
+}
+
+#ifdef UNITTESTS
+static void SCRadixLpmTestFree(void *data)
+{
+    (void)data;
+}
+
+static uint32_t SCRadixLpmTestRand(uint32_t *state)
+{
+    *state = *state * 1103515245 + 12345;
+    return *state >> 8;
+}
+
+/** \brief compare lpm and radix results for random ips and ips near the
+ *         netblocks in the tree */
+static int SCRadixLpmTestCompare(SCRadixTree *tree, const SCRadixLpm *lpm,
+                                 uint16_t bitlen, uint32_t seed,
+                                 uint8_t nets[][16], int nets_cnt)
+{
+    for (int i = 0; i < 4096; i++) {
+        uint8_t addr[16];
+        for (int j = 0; j < 16; j++)
+            addr[j] = (uint8_t)SCRadixLpmTestRand(&seed);
+        if (i % 2 == 0) {
+            /* keep a random number of leading bits of a netblock */
+            const uint8_t *net = nets[SCRadixLpmTestRand(&seed) % nets_cnt];
+            int keep = SCRadixLpmTestRand(&seed) % (bitlen + 1);
+            for (int j = 0; j < keep / 8; j++)
+                addr[j] = net[j];
+            if (keep % 8) {
+                uint8_t mask = 0xff << (8 - keep % 8);
+                addr[keep / 8] = (net[keep / 8] & mask) | (addr[keep / 8] & ~mask);
+            }
+        }
+
+        void *user = NULL;
+        SCRadixNode *node;
+        if (bitlen == 32)
+            node = SCRadixFindKeyIPV4BestMatch(addr, tree, &user);
+        else
+            node = SCRadixFindKeyIPV6BestMatch(addr, tree, &user);
+
+        const SCRadixLpmResult *res = SCRadixLpmLookup(lpm, addr, bitlen);
+        FAIL_IF(res->node != node);
+        FAIL_IF(res->user != user);
+    }
+    PASS;
+}
+
+static int SCRadixLpmTestRandom(uint16_t bitlen, int with_default)
+{
+    static int user[256];
+    uint8_t nets[256][16];
+    uint32_t seed = bitlen + with_default;
+
+    SCRadixTree *tree = SCRadixCreateRadixTree(SCRadixLpmTestFree, NULL);
+    FAIL_IF_NULL(tree);
+
+    /* nested netblocks: later ones are mostly taken inside earlier ones */
+    for (int i = 0; i < 256; i++) {
+        for (int j = 0; j < 16; j++)
+            nets[i][j] = (uint8_t)SCRadixLpmTestRand(&seed);
+        if (i > 0 && SCRadixLpmTestRand(&seed) % 4) {
+            const uint8_t *parent = nets[SCRadixLpmTestRand(&seed) % i];
+            int keep = bitlen / 4 + SCRadixLpmTestRand(&seed) % (bitlen / 2);
+            memcpy(nets[i], parent, keep / 8);
+        }
+        uint8_t netmask = 1 + SCRadixLpmTestRand(&seed) % bitlen;
+
+        uint8_t key[16];
+        memcpy(key, nets[i], sizeof(key));
+        if (bitlen == 32)
+            (void)SCRadixAddKeyIPV4Netblock(key, tree, &user[i], netmask);
+        else
+            (void)SCRadixAddKeyIPV6Netblock(key, tree, &user[i], netmask);
+    }
+    if (with_default) {
+        uint8_t key[16] = { 0 };
+        if (bitlen == 32)
+            (void)SCRadixAddKeyIPV4Netblock(key, tree, &user[0], 0);
+        else
+            (void)SCRadixAddKeyIPV6Netblock(key, tree, &user[0], 0);
+    }
+
+    SCRadixLpm *lpm = SCRadixLpmBuild(tree);
+    FAIL_IF_NULL(lpm);
+    FAIL_IF_NOT(SCRadixLpmTestCompare(tree, lpm, bitlen, seed, nets, 256));
+
+    SCRadixLpmFree(lpm);
+    SCRadixReleaseRadixTree(tree);
+    PASS;
+}
+
+/** \test ipv4 lookups match the radix tree */
+static int SCRadixLpmTest01(void)
+{
+    FAIL_IF_NOT(SCRadixLpmTestRandom(32, 0));
+    FAIL_IF_NOT(SCRadixLpmTestRandom(32, 1));
+    PASS;
+}
+
+/** \test ipv6 lookups match the radix tree */
+static int SCRadixLpmTest02(void)
+{
+    FAIL_IF_NOT(SCRadixLpmTestRandom(128, 0));
+    FAIL_IF_NOT(SCRadixLpmTestRandom(128, 1));
+    PASS;
+}
+
+/** \test mixed ipv4 and ipv6 tree, hosts and non ip keys */
+static int SCRadixLpmTest03(void)
+{
+    static int user[4];
+    uint8_t addr[16];
+
+    SCRadixTree *tree = SCRadixCreateRadixTree(SCRadixLpmTestFree, NULL);
+    FAIL_IF_NULL(tree);
+    FAIL_IF_NULL(SCRadixAddKeyIPV4String("192.168.0.0/16", tree, &user[0]));
+    FAIL_IF_NULL(SCRadixAddKeyIPV4String("192.168.1.1", tree, &user[1]));
+    FAIL_IF_NULL(SCRadixAddKeyIPV6String("2001:db8::/32", tree, &user[2]));
+
+    SCRadixLpm *lpm = SCRadixLpmBuild(tree);
+    FAIL_IF_NULL(lpm);
+
+    FAIL_IF(inet_pton(AF_INET, "192.168.1.1", addr) <= 0);
+    FAIL_IF(SCRadixLpmLookup(lpm, addr, 32)->user != &user[1]);
+    FAIL_IF(inet_pton(AF_INET, "192.168.1.2", addr) <= 0);
+    FAIL_IF(SCRadixLpmLookup(lpm, addr, 32)->user != &user[0]);
+    FAIL_IF(inet_pton(AF_INET, "10.0.0.1", addr) <= 0);
+    FAIL_IF_NOT_NULL(SCRadixLpmLookup(lpm, addr, 32)->node);
+    FAIL_IF(inet_pton(AF_INET6, "2001:db8::1", addr) <= 0);
+    FAIL_IF(SCRadixLpmLookup(lpm, addr, 128)->user != &user[2]);
+    FAIL_IF(inet_pton(AF_INET6, "2001:db9::1", addr) <= 0);
+    FAIL_IF_NOT_NULL(SCRadixLpmLookup(lpm, addr, 128)->node);
+    SCRadixLpmFree(lpm);
+
+    /* generic keys can't be compiled */
+    uint8_t key[4] = { 'a', 'b', 'c', 'd' };
+    FAIL_IF_NULL(SCRadixAddKeyGeneric(key, 32, tree, &user[3]));
+    FAIL_IF_NOT_NULL(SCRadixLpmBuild(tree));
+
+    SCRadixReleaseRadixTree(tree);
+    PASS;
+}
+#endif /* UNITTESTS */
+
+void SCRadixLpmRegisterTests(void)
+{
+#ifdef UNITTESTS
+    UtRegisterTest("SCRadixLpmTest01", SCRadixLpmTest01);
+    UtRegisterTest("SCRadixLpmTest02", SCRadixLpmTest02);
+    UtRegisterTest("SCRadixLpmTest03", SCRadixLpmTest03);
+#endif
+}
@@ -0,0 +1,87 @@
+/* Copyright (C) 2020 Open Information Security Foundation
+ *
+ * You can copy, redistribute or modify this Program under the terms of
+ * the GNU General Public License version 2 as published by the Free
+ * Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * version 2 along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/**
+ * \file
+ *
+ * Read only longest prefix match tables compiled from a radix tree.
+ */
+
+#ifndef __UTIL_RADIX_LPM_H__
+#define __UTIL_RADIX_LPM_H__
+
+#include "util-radix-tree.h"
+
+/** max memory for the tables of one tree, above it we keep the radix walk */
+#define SC_RADIX_LPM_MEMCAP         (64 * 1024 * 1024)
+
+/** table entry points to a chunk of 256 entries for the next byte */
+#define SC_RADIX_LPM_CHILD          0x80000000U
+
+/** result of a lookup: the node and user data of the best match */
+typedef struct SCRadixLpmResult_ {
+    SCRadixNode *node;
+    void *user;
+} SCRadixLpmResult;
+
+/**
+ * \brief multibit trie with a 16 bit first level and 8 bit chunks below.
+ *
+ * Entries are either an index in the results array, 0 meaning no match,
+ * or SC_RADIX_LPM_CHILD | the offset of a 256 entry chunk in tbl. The
+ * first 65536 entries of tbl are the first level.
+ */
+typedef struct SCRadixLpmTable_ {
+    uint32_t *tbl;
+    uint32_t size;      /**< entries in use */
+    uint32_t alloc;     /**< entries allocated */
+} SCRadixLpmTable;
+
+typedef struct SCRadixLpm_ {
+    SCRadixLpmTable v4;
+    SCRadixLpmTable v6;
+    SCRadixLpmResult *results;
+    uint32_t results_cnt;
+} SCRadixLpm;
+
+SCRadixLpm *SCRadixLpmBuild(const SCRadixTree *);
+void SCRadixLpmFree(SCRadixLpm *);
+void SCRadixLpmRegisterTests(void);
+
+/**
+ * \brief find the longest prefix matching an ip
+ *
+ * \param key_stream ipv4 or ipv6 address in network byte order
+ * \param key_bitlen 32 or 128
+ *
+ * \retval res result, with a NULL node if nothing matched
+ */
+static inline const SCRadixLpmResult *SCRadixLpmLookup(const SCRadixLpm *lpm,
+        const uint8_t *key_stream, uint16_t key_bitlen)
+{
+    const SCRadixLpmTable *t = (key_bitlen == 32) ? &lpm->v4 : &lpm->v6;
+    if (t->tbl == NULL || (key_bitlen != 32 && key_bitlen != 128))
+        return &lpm->results[0];
+
+    uint32_t e = t->tbl[(key_stream[0] << 8) | key_stream[1]];
+    for (int i = 2; i < key_bitlen / 8 && (e & SC_RADIX_LPM_CHILD); i++) {
+        e = t->tbl[(e & ~SC_RADIX_LPM_CHILD) + key_stream[i]];
+    }
+    return &lpm->results[e];
+}
+
+#endif /* __UTIL_RADIX_LPM_H__ */
@@ -30,6 +30,9 @@
 #include "util-ip.h"
 #include "util-unittest.h"
 #include "util-memcmp.h"
+#include "util-bloomfilter.h"
+#include "util-hash-lookup3.h"
+#include "util-radix-lpm.h"
 
 /**
  * \brief Allocates and returns a new instance of SCRadixUserData.
@@ -413,6 +416,244 @@ static void SCRadixReleaseNode(SCRadixNode *node, SCRadixTree *tree)
     return;
 }
 
+/** below this many netblocks the tree walk is cheap enough on its own */
+#define SC_RADIX_PREFILTER_MIN_ENTRIES  1024
+/** bloom filter bits per netblock */
+#define SC_RADIX_PREFILTER_BITS         16
+#define SC_RADIX_PREFILTER_HASH_ITER    4
+
+/**
+ * \brief Bloom filter over all netblocks of an ip radix tree.
+ *
+ * Each netblock is added as its netmask followed by its chopped address.
+ * A lookup chops the ip against each netmask present in the tree, longest
+ * first, and only walks the tree if one of them may be in the filter. The
+ * /0 netblock would match everything, so it is kept out of the filter and
+ * returned directly on a miss.
+ */
+typedef struct SCRadixPrefilter_ {
+    BloomFilter *bf;
+    /* 32 for ipv4, 128 for ipv6 */
+    uint16_t bitlen;
+    uint16_t netmask_cnt;
+    /* netmasks present in the tree, longest first, /0 excluded */
+    uint8_t netmasks[128];
+    /* node and user data of the /0 netblock, if any */
+    SCRadixNode *default_node;
+    void *default_user;
+} SCRadixPrefilter;
+
+static void SCRadixFreePrefilter(SCRadixTree *tree)
+{
+    if (tree->prefilter != NULL) {
+        BloomFilterFree(tree->prefilter->bf);
+        SCFree(tree->prefilter);
+        tree->prefilter = NULL;
+    }
+}
+
+/**
+ * \brief Drops the prefilter and lookup tables built from the tree, as
+ *        they no longer cover it once keys are added or removed.
+ */
+static void SCRadixFreeLookupTables(SCRadixTree *tree)
+{
+    SCRadixFreePrefilter(tree);
+    if (tree->lpm != NULL) {
+        SCRadixLpmFree(tree->lpm);
+        tree->lpm = NULL;
+    }
+}
+
+static uint32_t SCRadixPrefilterHash(const void *data, uint16_t datalen,
+                                     uint8_t iter, uint32_t hash_size)
+{
+    return hashlittle_safe(data, datalen, iter) % hash_size;
+}
+
+/**
+ * \brief Walks a subtree and collects the netmasks of all its netblocks
+ *
+ * \retval cnt number of netblocks, excluding /0, or -1 if the subtree holds
+ *             a key that is not an ip netblock of the prefilter bitlen
+ */
+static int SCRadixPrefilterScan(SCRadixNode *node, SCRadixPrefilter *pf,
+                                uint8_t *seen)
+{
+    int cnt = 0;
+
+    if (node == NULL)
+        return 0;
+
+    if (node->prefix != NULL) {
+        if (node->prefix->bitlen != pf->bitlen)
+            return -1;
+
+        SCRadixUserData *ud = node->prefix->user_data;
+        for ( ; ud != NULL; ud = ud->next) {
+            if (ud->netmask > pf->bitlen)
+                return -1;
+            if (ud->netmask == 0) {
+                pf->default_node = node;
+                pf->default_user = ud->user;
+                continue;
+            }
+            seen[ud->netmask] = 1;
+            cnt++;
+        }
+    }
+
+    int l = SCRadixPrefilterScan(node->left, pf, seen);
+    if (l < 0)
+        return -1;
+    int r = SCRadixPrefilterScan(node->right, pf, seen);
+    if (r < 0)
+        return -1;
+
+    return cnt + l + r;
+}
+
+static void SCRadixPrefilterFill(SCRadixNode *node, SCRadixPrefilter *pf)
+{
+    uint8_t key[1 + 16];
+
+    if (node == NULL)
+        return;
+
+    if (node->prefix != NULL) {
+        SCRadixUserData *ud = node->prefix->user_data;
+        for ( ; ud != NULL; ud = ud->next) {
+            if (ud->netmask == 0)
+                continue;
+            key[0] = ud->netmask;
+            memcpy(key + 1, node->prefix->stream, pf->bitlen / 8);
+            MaskIPNetblock(key + 1, ud->netmask, pf->bitlen);
+            BloomFilterAdd(pf->bf, key, 1 + pf->bitlen / 8);
+        }
+    }
+
+    SCRadixPrefilterFill(node->left, pf);
+    SCRadixPrefilterFill(node->right, pf);
+}
+
+static int SCRadixBuildPrefilterMin(SCRadixTree *tree, int min_entries)
+{
+    if (tree == NULL)
+        return -1;
+
+    SCRadixFreePrefilter(tree);
+
+    /* all keys in an ip tree have the same bitlen, find one */
+    SCRadixNode *node = tree->head;
+    while (node != NULL && node->prefix == NULL)
+        node = node->left ? node->left : node->right;
+    if (node == NULL)
+        return 0;
+    if (node->prefix->bitlen != 32 && node->prefix->bitlen != 128)
+        return -1;
+
+    SCRadixPrefilter *pf = SCMalloc(sizeof(*pf));
+    if (unlikely(pf == NULL))
+        return -1;
+    memset(pf, 0, sizeof(*pf));
+    pf->bitlen = node->prefix->bitlen;
+
+    uint8_t seen[129];
+    memset(seen, 0, sizeof(seen));
+    int cnt = SCRadixPrefilterScan(tree->head, pf, seen);
+    if (cnt < 0 || cnt < min_entries) {
+        SCFree(pf);
+        return cnt < 0 ? -1 : 0;
+    }
+
+    for (int i = pf->bitlen; i > 0; i--) {
+        if (seen[i])
+            pf->netmasks[pf->netmask_cnt++] = (uint8_t)i;
+    }
+
+    if (cnt > 0) {
+        uint64_t bits = (uint64_t)cnt * SC_RADIX_PREFILTER_BITS;
+        if (bits > UINT32_MAX)
+            bits = UINT32_MAX;
+        pf->bf = BloomFilterInit((uint32_t)bits, SC_RADIX_PREFILTER_HASH_ITER,
+                SCRadixPrefilterHash);
+        if (pf->bf == NULL) {
+            SCFree(pf);
+            return -1;
+        }
+        SCRadixPrefilterFill(tree->head, pf);
+    }
+
+    tree->prefilter = pf;
+    SCLogDebug("prefilter for tree %p: %d netblocks, %u netmasks", tree,
+            cnt, pf->netmask_cnt);
+    return 0;
+}
+
+/**
+ * \brief Builds a bloom filter over all the netblocks in an ip tree, so
+ *        that best match lookups of ips not covered by any netblock don't
+ *        have to walk the tree.
+ *
+ *        Call once the tree is complete. Adding or removing keys drops the
+ *        filter again. Small trees and trees with non ip keys don't get one.
+ *
+ * \param tree Pointer to the Radix tree
+ *
+ * \retval 0 on success, also if no filter was needed
+ * \retval -1 on error or if the tree holds non ip keys
+ */
+int SCRadixBuildPrefilter(SCRadixTree *tree)
+{
+    return SCRadixBuildPrefilterMin(tree, SC_RADIX_PREFILTER_MIN_ENTRIES);
+}
+
+/**
+ * \brief Compiles the netblocks of an ip tree into read only lookup
+ *        tables, which best match lookups use instead of walking the tree.
+ *
+ *        Call once the tree is complete. Adding or removing keys drops the
+ *        tables again.
+ *
+ * \param tree Pointer to the Radix tree
+ *
+ * \retval 0 on success
+ * \retval -1 if the tree holds non ip keys, the tables would be too
+ *            large or on error
+ */
+int SCRadixBuildLpm(SCRadixTree *tree)
+{
+    if (tree == NULL)
+        return -1;
+
+    SCRadixFreeLookupTables(tree);
+    tree->lpm = SCRadixLpmBuild(tree);
+    return tree->lpm != NULL ? 0 : -1;
+}
+
+/**
+ * \brief Checks an ip against the prefilter
+ *
+ * \retval 1 the ip may be in one of the netblocks, other than /0
+ * \retval 0 the ip is in none of them
+ */
+static int SCRadixPrefilterTest(const SCRadixPrefilter *pf, const uint8_t *key_stream)
+{
+    uint8_t key[1 + 16];
+    const uint16_t len = 1 + pf->bitlen / 8;
+
+    memcpy(key + 1, key_stream, pf->bitlen / 8);
+    /* netmasks are sorted longest first, so we can keep chopping the same
+     * copy of the ip */
+    for (uint16_t i = 0; i < pf->netmask_cnt; i++) {
+        key[0] = pf->netmasks[i];
+        MaskIPNetblock(key + 1, pf->netmasks[i], pf->bitlen);
+        if (BloomFilterTest(pf->bf, key, len))
+            return 1;
+    }
+    return 0;
+}
+
 /**
  * \brief Creates a new Radix tree
  *
@@ -467,6 +708,7 @@ void SCRadixReleaseRadixTree(SCRadixTree *tree)
     if (tree == NULL)
         return;
 
+    SCRadixFreeLookupTables(tree);
     SCRadixReleaseRadixSubtree(tree->head, tree);
     tree->head = NULL;
     SCFree(tree);
@@ -513,6 +755,8 @@ static SCRadixNode *SCRadixAddKey(uint8_t *key_stream, uint16_t key_bitlen,
         return NULL;
     }
 
+    SCRadixFreeLookupTables(tree);
+
     /* chop the ip address against a netmask */
     MaskIPNetblock(key_stream, netmask, key_bitlen);
 
@@ -1134,6 +1378,8 @@ static void SCRadixRemoveKey(uint8_t *key_stream, uint16_t key_bitlen,
     if (node == NULL)
         return;
 
+    SCRadixFreeLookupTables(tree);
+
     if ( (prefix = SCRadixCreatePrefix(key_stream, key_bitlen, NULL, 255)) == NULL)
         return;
 
@@ -1414,6 +1660,22 @@ static SCRadixNode *SCRadixFindKey(uint8_t *key_stream, uint16_t key_bitlen,
     if (key_bitlen > 255)
         return NULL;
 
+    if (!exact_match && tree->lpm != NULL) {
+        const SCRadixLpmResult *res = SCRadixLpmLookup(tree->lpm, key_stream, key_bitlen);
+        if (user_data_result != NULL)
+            *user_data_result = res->user;
+        return res->node;
+    }
+
+    const SCRadixPrefilter *pf = tree->prefilter;
+    if (!exact_match && pf != NULL && key_bitlen == pf->bitlen &&
+            !SCRadixPrefilterTest(pf, key_stream)) {
+        /* only the /0 netblock can match */
+        if (user_data_result != NULL)
+            *user_data_result = pf->default_user;
+        return pf->default_node;
+    }
+
     memset(tmp_stream, 0, 255);
     memcpy(tmp_stream, key_stream, key_bitlen / 8);
 
@@ -4041,6 +4303,110 @@ this_end:
     return result;
 }
 
+
+static void SCRadixTestPrefilterFree(void *data)
+{
+    (void)data;
+}
+
+static int SCRadixTestPrefilterLookups(SCRadixTree *tree, const char **ips,
+                                       int af)
+{
+    for (int i = 0; ips[i] != NULL; i++) {
+        uint8_t addr[16];
+        void *u1 = NULL, *u2 = NULL;
+        SCRadixNode *n1, *n2;
+
+        FAIL_IF(inet_pton(af, ips[i], addr) <= 0);
+        FAIL_IF_NOT_NULL(tree->prefilter);
+        if (af == AF_INET)
+            n1 = SCRadixFindKeyIPV4BestMatch(addr, tree, &u1);
+        else
+            n1 = SCRadixFindKeyIPV6BestMatch(addr, tree, &u1);
+
+        FAIL_IF(SCRadixBuildPrefilterMin(tree, 0) != 0);
+        FAIL_IF_NULL(tree->prefilter);
+        if (af == AF_INET)
+            n2 = SCRadixFindKeyIPV4BestMatch(addr, tree, &u2);
+        else
+            n2 = SCRadixFindKeyIPV6BestMatch(addr, tree, &u2);
+        SCRadixFreePrefilter(tree);
+
+        FAIL_IF(n1 != n2);
+        FAIL_IF(u1 != u2);
+    }
+    PASS;
+}
+
+/**
+ * \test best match lookups give the same result with and without the
+ *       prefilter, with and without a /0 netblock in the tree
+ */
+static int SCRadixTestPrefilter27(void)
+{
+    static int u[8];
+    const char *ips[] = { "192.168.1.1", "192.168.1.5", "192.168.2.7",
+        "10.1.2.3", "10.200.0.1", "11.0.0.1", "172.16.0.1", "0.0.0.0",
+        "255.255.255.255", NULL };
+
+    SCRadixTree *tree = SCRadixCreateRadixTree(SCRadixTestPrefilterFree, NULL);
+    FAIL_IF_NULL(tree);
+    FAIL_IF_NULL(SCRadixAddKeyIPV4String("192.168.0.0/16", tree, &u[0]));
+    FAIL_IF_NULL(SCRadixAddKeyIPV4String("192.168.1.0/24", tree, &u[1]));
+    FAIL_IF_NULL(SCRadixAddKeyIPV4String("192.168.1.5", tree, &u[2]));
+    FAIL_IF_NULL(SCRadixAddKeyIPV4String("10.0.0.0/8", tree, &u[3]));
+    FAIL_IF_NULL(SCRadixAddKeyIPV4String("172.16.0.1", tree, &u[4]));
+
+    FAIL_IF_NOT(SCRadixTestPrefilterLookups(tree, ips, AF_INET));
+
+    /* ip not in the tree without a /0 */
+    uint8_t addr[4];
+    void *user = &u[7];
+    FAIL_IF(inet_pton(AF_INET, "11.0.0.1", addr) <= 0);
+    FAIL_IF(SCRadixBuildPrefilterMin(tree, 0) != 0);
+    FAIL_IF_NOT_NULL(SCRadixFindKeyIPV4BestMatch(addr, tree, &user));
+    FAIL_IF_NOT_NULL(user);
+
+    /* adding a key drops the prefilter */
+    FAIL_IF_NULL(SCRadixAddKeyIPV4String("0.0.0.0/0", tree, &u[5]));
+    FAIL_IF_NOT_NULL(tree->prefilter);
+
+    FAIL_IF_NOT(SCRadixTestPrefilterLookups(tree, ips, AF_INET));
+
+    FAIL_IF(SCRadixBuildPrefilterMin(tree, 0) != 0);
+    FAIL_IF_NULL(SCRadixFindKeyIPV4BestMatch(addr, tree, &user));
+    FAIL_IF(user != &u[5]);
+
+    /* small trees don't get a prefilter */
+    FAIL_IF(SCRadixBuildPrefilter(tree) != 0);
+    FAIL_IF_NOT_NULL(tree->prefilter);
+
+    SCRadixReleaseRadixTree(tree);
+    PASS;
+}
+
+/** \test same as 27 for ipv6 */
+static int SCRadixTestPrefilter28(void)
+{
+    static int u[4];
+    const char *ips[] = { "2001:db8::1", "2001:db8:1::1", "2001:db8:1::5",
+        "2001:db9::1", "fe80::1", "::", NULL };
+
+    SCRadixTree *tree = SCRadixCreateRadixTree(SCRadixTestPrefilterFree, NULL);
+    FAIL_IF_NULL(tree);
+    FAIL_IF_NULL(SCRadixAddKeyIPV6String("2001:db8::/32", tree, &u[0]));
+    FAIL_IF_NULL(SCRadixAddKeyIPV6String("2001:db8:1::/48", tree, &u[1]));
+    FAIL_IF_NULL(SCRadixAddKeyIPV6String("2001:db8:1::5", tree, &u[2]));
+
+    FAIL_IF_NOT(SCRadixTestPrefilterLookups(tree, ips, AF_INET6));
+
+    FAIL_IF_NULL(SCRadixAddKeyIPV6String("::/0", tree, &u[3]));
+    FAIL_IF_NOT(SCRadixTestPrefilterLookups(tree, ips, AF_INET6));
+
+    SCRadixReleaseRadixTree(tree);
+    PASS;
+}
+
 #endif
 
 void SCRadixRegisterTests(void)
@@ -4087,6 +4453,8 @@ void SCRadixRegisterTests(void)
                    SCRadixTestIPV4NetblockInsertion25);
     UtRegisterTest("SCRadixTestIPV4NetblockInsertion26",
                    SCRadixTestIPV4NetblockInsertion26);
+    UtRegisterTest("SCRadixTestPrefilter27", SCRadixTestPrefilter27);
+    UtRegisterTest("SCRadixTestPrefilter28", SCRadixTestPrefilter28);
 #endif
 
     return;
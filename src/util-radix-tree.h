@@ -91,6 +91,14 @@ typedef struct SCRadixTree_ {
      * held by the user field of SCRadixNode */
     void (*PrintData)(void *);
     void (*Free)(void *);
+
+    /* optional bloom filter over all netblocks in the tree, used to skip
+     * the walk for best match lookups of ips that are not in the tree */
+    struct SCRadixPrefilter_ *prefilter;
+
+    /* optional read only lookup tables compiled from the tree, used for best
+     * match lookups instead of the tree walk */
+    struct SCRadixLpm_ *lpm;
 } SCRadixTree;
 
 
@@ -100,6 +108,8 @@ void SCRadixChopIPAddressAgainstNetmask(uint8_t *, uint8_t, uint16_t);
 
 SCRadixTree *SCRadixCreateRadixTree(void (*Free)(void*), void (*PrintData)(void*));
 void SCRadixReleaseRadixTree(SCRadixTree *);
+int SCRadixBuildPrefilter(SCRadixTree *);
+int SCRadixBuildLpm(SCRadixTree *);
 
 SCRadixNode *SCRadixAddKeyGeneric(uint8_t *, uint16_t, SCRadixTree *, void *);
 SCRadixNode *SCRadixAddKeyIPV4(uint8_t *, SCRadixTree *, void *);
@@ -0,0 +1,391 @@
+/* Copyright (C) 2020 Open Information Security Foundation
+ *
+ * You can copy, redistribute or modify this Program under the terms of
+ * the GNU General Public License version 2 as published by the Free
+ * Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * version 2 along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/**
+ * \file
+ *
+ * Hierarchical timer wheel.
+ *
+ * Level 0 has a slot per second for the next 256 seconds. Each slot of a
+ * higher level covers a full rotation of the level below it. When level 0
+ * wraps around, the next slot of level 1 is 'cascaded': its entries are
+ * re-added, which places them in level 0. The same goes for the higher
+ * levels. This way adding is O(1) and expiring costs O(1) per second plus
+ * the work on the entries that are due.
+ */
+
+#include "suricata-common.h"
+#include "util-timer-wheel.h"
+#include "util-unittest.h"
+#include "util-debug.h"
+
+/** if time moves forward more than this many seconds in one go, the wheel
+ *  is rebuilt instead of stepping through every second */
+#define TIMER_WHEEL_MAX_STEPS   (1 << 16)
+
+#define TIMER_WHEEL_SLOT_INIT_SIZE 8
+
+void TimerWheelInit(TimerWheel *tw, uint32_t now)
+{
+    memset(tw, 0, sizeof(*tw));
+    tw->now = now;
+}
+
+static void TimerWheelSlotFree(TimerWheelSlot *s)
+{
+    if (s->entries != NULL)
+        SCFree(s->entries);
+    memset(s, 0, sizeof(*s));
+}
+
+void TimerWheelDestroy(TimerWheel *tw)
+{
+    for (int i = 0; i < TIMER_WHEEL_L0_SIZE; i++) {
+        TimerWheelSlotFree(&tw->l0[i]);
+    }
+    for (int l = 0; l < TIMER_WHEEL_LEVELS; l++) {
+        for (int i = 0; i < TIMER_WHEEL_LN_SIZE; i++) {
+            TimerWheelSlotFree(&tw->ln[l][i]);
+        }
+    }
+    TimerWheelSlotFree(&tw->overflow);
+    tw->cnt = 0;
+}
+
+static int TimerWheelSlotAppend(TimerWheelSlot *s, uint32_t id, uint32_t ts)
+{
+    if (s->cnt == s->size) {
+        uint32_t new_size = s->size ? s->size * 2 : TIMER_WHEEL_SLOT_INIT_SIZE;
+        TimerWheelEntry *ptr = SCRealloc(s->entries, new_size * sizeof(TimerWheelEntry));
+        if (unlikely(ptr == NULL))
+            return -1;
+        s->entries = ptr;
+        s->size = new_size;
+    }
+    s->entries[s->cnt].id = id;
+    s->entries[s->cnt].ts = ts;
+    s->cnt++;
+    return 0;
+}
+
+static TimerWheelSlot *TimerWheelGetSlot(TimerWheel *tw, uint32_t ts)
+{
+    /* entries that are due go in the first slot that will still be
+     * processed. While expiring that is the next one. */
+    const uint32_t base = tw->expiring ? tw->now + 1 : tw->now;
+    if (ts < base)
+        ts = base;
+
+    const uint32_t delta = ts - tw->now;
+    if (delta < TIMER_WHEEL_L0_SIZE) {
+        return &tw->l0[ts & TIMER_WHEEL_L0_MASK];
+    }
+
+    uint32_t shift = TIMER_WHEEL_L0_BITS;
+    for (int l = 0; l < TIMER_WHEEL_LEVELS; l++) {
+        if (delta < (1U << (shift + TIMER_WHEEL_LN_BITS))) {
+            return &tw->ln[l][(ts >> shift) & TIMER_WHEEL_LN_MASK];
+        }
+        shift += TIMER_WHEEL_LN_BITS;
+    }
+    return &tw->overflow;
+}
+
+/** \brief add an entry to the wheel
+ *
+ *  Entries with a time in the past are handed to the expire callback
+ *  on the next call to TimerWheelExpire(). If called from the expire
+ *  callback, they will be expired in the next second.
+ *
+ *  \retval 0 ok
+ *  \retval -1 memory allocation failure
+ */
+int TimerWheelAdd(TimerWheel *tw, uint32_t id, uint32_t ts)
+{
+    TimerWheelSlot *s = TimerWheelGetSlot(tw, ts);
+    if (TimerWheelSlotAppend(s, id, ts) != 0)
+        return -1;
+    tw->cnt++;
+    return 0;
+}
+
+/** \internal
+ *  \brief move all entries of a slot to their new place in the wheel */
+static void TimerWheelCascade(TimerWheel *tw, TimerWheelSlot *s)
+{
+    TimerWheelSlot tmp = *s;
+    memset(s, 0, sizeof(*s));
+
+    for (uint32_t i = 0; i < tmp.cnt; i++) {
+        tw->cnt--;
+        if (TimerWheelAdd(tw, tmp.entries[i].id, tmp.entries[i].ts) != 0) {
+            SCLogWarning(SC_ERR_MEM_ALLOC, "timer wheel: failed to move "
+                    "entry %u", tmp.entries[i].id);
+        }
+    }
+
+    /* reuse the memory if nothing was added to the slot */
+    if (s->entries == NULL) {
+        tmp.cnt = 0;
+        *s = tmp;
+    } else {
+        SCFree(tmp.entries);
+    }
+}
+
+static void TimerWheelCascadeLevels(TimerWheel *tw, const uint32_t t)
+{
+    uint32_t shift = TIMER_WHEEL_L0_BITS;
+    int l = 0;
+
+    /* find the highest level that wraps at 't' */
+    while (l < TIMER_WHEEL_LEVELS - 1 &&
+            ((t >> (shift + TIMER_WHEEL_LN_BITS * l)) & TIMER_WHEEL_LN_MASK) == 0) {
+        l++;
+    }
+    if (l == TIMER_WHEEL_LEVELS - 1 &&
+            ((t >> (shift + TIMER_WHEEL_LN_BITS * l)) & TIMER_WHEEL_LN_MASK) == 0) {
+        TimerWheelCascade(tw, &tw->overflow);
+    }
+
+    /* cascade top down, so entries can drop down more than one level */
+    for (; l >= 0; l--) {
+        uint32_t idx = (t >> (shift + TIMER_WHEEL_LN_BITS * l)) & TIMER_WHEEL_LN_MASK;
+        TimerWheelCascade(tw, &tw->ln[l][idx]);
+    }
+}
+
+static uint32_t TimerWheelExpireSlot(TimerWheel *tw, TimerWheelSlot *s,
+        TimerWheelExpireFunc Expire, void *data)
+{
+    TimerWheelSlot tmp = *s;
+    memset(s, 0, sizeof(*s));
+    const uint32_t cnt = tmp.cnt;
+
+    tw->expiring = true;
+    for (uint32_t i = 0; i < cnt; i++) {
+        tw->cnt--;
+        Expire(tmp.entries[i].id, tmp.entries[i].ts, data);
+    }
+    tw->expiring = false;
+
+    if (s->entries == NULL) {
+        tmp.cnt = 0;
+        *s = tmp;
+    } else {
+        SCFree(tmp.entries);
+    }
+    return cnt;
+}
+
+/** \internal
+ *  \brief handle a big jump in time by re-adding all entries */
+static uint32_t TimerWheelRebuild(TimerWheel *tw, uint32_t now,
+        TimerWheelExpireFunc Expire, void *data)
+{
+    TimerWheelSlot all;
+    memset(&all, 0, sizeof(all));
+
+    TimerWheelSlot *slots[TIMER_WHEEL_L0_SIZE + TIMER_WHEEL_LEVELS * TIMER_WHEEL_LN_SIZE + 1];
+    int n = 0;
+    for (int i = 0; i < TIMER_WHEEL_L0_SIZE; i++)
+        slots[n++] = &tw->l0[i];
+    for (int l = 0; l < TIMER_WHEEL_LEVELS; l++)
+        for (int i = 0; i < TIMER_WHEEL_LN_SIZE; i++)
+            slots[n++] = &tw->ln[l][i];
+    slots[n++] = &tw->overflow;
+
+    for (int i = 0; i < n; i++) {
+        TimerWheelSlot *s = slots[i];
+        for (uint32_t e = 0; e < s->cnt; e++) {
+            if (TimerWheelSlotAppend(&all, s->entries[e].id, s->entries[e].ts) != 0) {
+                SCLogWarning(SC_ERR_MEM_ALLOC, "timer wheel: failed to move "
+                        "entry %u", s->entries[e].id);
+            }
+        }
+        s->cnt = 0;
+    }
+    tw->cnt = 0;
+    tw->now = now;
+
+    uint32_t expired = 0;
+    for (uint32_t e = 0; e < all.cnt; e++) {
+        if (all.entries[e].ts <= now) {
+            tw->expiring = true;
+            Expire(all.entries[e].id, all.entries[e].ts, data);
+            tw->expiring = false;
+            expired++;
+        } else {
+            (void)TimerWheelAdd(tw, all.entries[e].id, all.entries[e].ts);
+        }
+    }
+    TimerWheelSlotFree(&all);
+
+    /* entries added by the callback are in the next second */
+    tw->now = now + 1;
+    return expired;
+}
+
+/** \brief expire all entries with a time up to and including 'now'
+ *
+ *  The callback may add new entries to the wheel.
+ *
+ *  \retval cnt number of expired entries
+ */
+uint32_t TimerWheelExpire(TimerWheel *tw, uint32_t now,
+        TimerWheelExpireFunc Expire, void *data)
+{
+    if (now < tw->now)
+        return 0;
+
+    if (tw->cnt == 0) {
+        tw->now = now + 1;
+        return 0;
+    }
+
+    if (now - tw->now > TIMER_WHEEL_MAX_STEPS) {
+        return TimerWheelRebuild(tw, now, Expire, data);
+    }
+
+    uint32_t expired = 0;
+    while (tw->now <= now) {
+        const uint32_t t = tw->now;
+        if ((t & TIMER_WHEEL_L0_MASK) == 0) {
+            TimerWheelCascadeLevels(tw, t);
+        }
+        expired += TimerWheelExpireSlot(tw, &tw->l0[t & TIMER_WHEEL_L0_MASK],
+                Expire, data);
+        tw->now = t + 1;
+    }
+    return expired;
+}
+
+#ifdef UNITTESTS
+
+typedef struct TimerWheelTestData_ {
+    uint32_t now;
+    uint32_t cnt;
+    uint32_t late;
+    uint32_t readd;
+} TimerWheelTestData;
+
+static TimerWheel *test_tw = NULL;
+
+static void TimerWheelTestExpire(uint32_t id, uint32_t ts, void *data)
+{
+    TimerWheelTestData *td = data;
+    td->cnt++;
+    /* id holds the time the entry should fire at */
+    if (id != td->now)
+        td->late++;
+    if (td->readd > 0) {
+        td->readd--;
+        /* due entry added from the callback */
+        (void)TimerWheelAdd(test_tw, td->now + 1, ts);
+    }
+}
+
+/** \test entries fire exactly at their time, on all levels */
+static int TimerWheelTest01(void)
+{
+    TimerWheel tw;
+    TimerWheelInit(&tw, 1000);
+    test_tw = &tw;
+
+    const uint32_t times[] = { 1000, 1001, 1255, 1256, 1300, 1535, 1536,
+        20000, 17384, 1000 + (1 << 20) + 7, 1000 + (1 << 22) };
+    const uint32_t n = sizeof(times) / sizeof(times[0]);
+    for (uint32_t i = 0; i < n; i++) {
+        FAIL_IF(TimerWheelAdd(&tw, times[i], times[i]) != 0);
+    }
+    FAIL_IF(tw.cnt != n);
+
+    TimerWheelTestData td;
+    memset(&td, 0, sizeof(td));
+    for (uint32_t t = 1000; t <= 1000 + (1 << 22); t++) {
+        td.now = t;
+        TimerWheelExpire(&tw, t, TimerWheelTestExpire, &td);
+    }
+    FAIL_IF(td.cnt != n);
+    FAIL_IF(td.late != 0);
+    FAIL_IF(tw.cnt != 0);
+
+    TimerWheelDestroy(&tw);
+    PASS;
+}
+
+/** \test entries in the past and entries added from the callback */
+static int TimerWheelTest02(void)
+{
+    TimerWheel tw;
+    TimerWheelInit(&tw, 100);
+    test_tw = &tw;
+
+    FAIL_IF(TimerWheelAdd(&tw, 100, 10) != 0);
+
+    TimerWheelTestData td;
+    memset(&td, 0, sizeof(td));
+    td.now = 100;
+    td.readd = 1;
+    FAIL_IF(TimerWheelExpire(&tw, 100, TimerWheelTestExpire, &td) != 1);
+    FAIL_IF(td.late != 0);
+    /* the re-added entry fires in the next second */
+    FAIL_IF(tw.cnt != 1);
+
+    td.now = 101;
+    FAIL_IF(TimerWheelExpire(&tw, 101, TimerWheelTestExpire, &td) != 1);
+    FAIL_IF(td.late != 0);
+    FAIL_IF(tw.cnt != 0);
+
+    TimerWheelDestroy(&tw);
+    PASS;
+}
+
+/** \test big jump in time */
+static int TimerWheelTest03(void)
+{
+    TimerWheel tw;
+    TimerWheelInit(&tw, 0);
+    test_tw = &tw;
+
+    FAIL_IF(TimerWheelAdd(&tw, 1, 500) != 0);
+    FAIL_IF(TimerWheelAdd(&tw, 2, 1000000) != 0);
+    FAIL_IF(TimerWheelAdd(&tw, 3, 3000000) != 0);
+
+    TimerWheelTestData td;
+    memset(&td, 0, sizeof(td));
+    FAIL_IF(TimerWheelExpire(&tw, 2000000, TimerWheelTestExpire, &td) != 2);
+    FAIL_IF(tw.cnt != 1);
+    FAIL_IF(tw.now != 2000001);
+
+    FAIL_IF(TimerWheelExpire(&tw, 2999999, TimerWheelTestExpire, &td) != 0);
+    FAIL_IF(TimerWheelExpire(&tw, 3000000, TimerWheelTestExpire, &td) != 1);
+    FAIL_IF(tw.cnt != 0);
+
+    TimerWheelDestroy(&tw);
+    PASS;
+}
+#endif /* UNITTESTS */
+
+void TimerWheelRegisterTests(void)
+{
+#ifdef UNITTESTS
+    UtRegisterTest("TimerWheelTest01", TimerWheelTest01);
+    UtRegisterTest("TimerWheelTest02", TimerWheelTest02);
+    UtRegisterTest("TimerWheelTest03", TimerWheelTest03);
+#endif
+}
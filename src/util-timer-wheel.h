@@ -0,0 +1,81 @@
+/* Copyright (C) 2020 Open Information Security Foundation
+ *
+ * You can copy, redistribute or modify this Program under the terms of
+ * the GNU General Public License version 2 as published by the Free
+ * Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * version 2 along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/**
+ * \file
+ *
+ * Hierarchical timer wheel with a one second resolution. Entries are
+ * 32 bit ids (e.g. a hash row index) with an expiry time in seconds.
+ *
+ * The wheel is not thread safe, it's meant to be owned by one thread.
+ */
+
+#ifndef __UTIL_TIMER_WHEEL_H__
+#define __UTIL_TIMER_WHEEL_H__
+
+/** level 0 has 256 slots of 1 second */
+#define TIMER_WHEEL_L0_BITS     8
+#define TIMER_WHEEL_L0_SIZE     (1 << TIMER_WHEEL_L0_BITS)
+#define TIMER_WHEEL_L0_MASK     (TIMER_WHEEL_L0_SIZE - 1)
+/** higher levels have 64 slots, each covering a full lower level */
+#define TIMER_WHEEL_LN_BITS     6
+#define TIMER_WHEEL_LN_SIZE     (1 << TIMER_WHEEL_LN_BITS)
+#define TIMER_WHEEL_LN_MASK     (TIMER_WHEEL_LN_SIZE - 1)
+/** number of levels above level 0. Entries further out than the
+ *  top level go into an overflow slot. */
+#define TIMER_WHEEL_LEVELS      3
+
+typedef struct TimerWheelEntry_ {
+    uint32_t id;
+    uint32_t ts;
+} TimerWheelEntry;
+
+typedef struct TimerWheelSlot_ {
+    TimerWheelEntry *entries;
+    uint32_t cnt;
+    uint32_t size;
+} TimerWheelSlot;
+
+typedef struct TimerWheel_ {
+    /** next second to process. All entries that expire before this
+     *  time have been handed to the callback. */
+    uint32_t now;
+    /** set while the expire callback runs */
+    bool expiring;
+    /** number of entries in the wheel */
+    uint32_t cnt;
+
+    TimerWheelSlot l0[TIMER_WHEEL_L0_SIZE];
+    TimerWheelSlot ln[TIMER_WHEEL_LEVELS][TIMER_WHEEL_LN_SIZE];
+    TimerWheelSlot overflow;
+} TimerWheel;
+
+/** \brief expire callback
+ *  \param id id of the entry
+ *  \param ts time the entry was scheduled for
+ *  \param data user data passed to TimerWheelExpire() */
+typedef void (*TimerWheelExpireFunc)(uint32_t id, uint32_t ts, void *data);
+
+void TimerWheelInit(TimerWheel *tw, uint32_t now);
+void TimerWheelDestroy(TimerWheel *tw);
+int TimerWheelAdd(TimerWheel *tw, uint32_t id, uint32_t ts);
+uint32_t TimerWheelExpire(TimerWheel *tw, uint32_t now,
+        TimerWheelExpireFunc Expire, void *data);
+
+void TimerWheelRegisterTests(void);
+
+#endif /* __UTIL_TIMER_WHEEL_H__ */